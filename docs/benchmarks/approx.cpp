@@ -0,0 +1,63 @@
+// Benchmarks comparing large arrays approximately element by element
+// using nytl::Approx against the batched nytl::approxCompare.
+
+#include "bench.hpp"
+#include <nytl/approx.hpp>
+#include <nytl/approxVec.hpp>
+#include <nytl/mat.hpp>
+
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 1024;
+
+} // anon namespace
+
+BENCHMARK(approx) {
+	std::vector<float> a(count), b(count);
+	for(auto i = 0u; i < count; ++i) {
+		a[i] = 0.001f * i;
+		b[i] = a[i] + 0.0000001f;
+	}
+
+	bench::measure("Approx per element", count, [&]{
+		auto equal = true;
+		for(auto i = 0u; i < count; ++i) {
+			equal &= (a[i] == nytl::approx(b[i], 0.0001));
+		}
+		bench::doNotOptimize(equal);
+	});
+
+	bench::measure("approxEqual", count, [&]{
+		auto equal = nytl::approxEqual(a, b, 0.0001);
+		bench::doNotOptimize(equal);
+	});
+
+	bench::measure("approxCompare, mixed", count, [&]{
+		auto res = nytl::approxCompare(a, b, 0.0001);
+		bench::doNotOptimize(res);
+	});
+
+	bench::measure("approxCompare, ulp", count, [&]{
+		auto res = nytl::approxCompare(a, b, 16, nytl::ApproxMode::ulp);
+		bench::doNotOptimize(res);
+	});
+
+	std::vector<nytl::Mat4f> ma(count / 16), mb(count / 16);
+	for(auto i = 0u; i < ma.size(); ++i) {
+		for(auto r = 0u; r < 4; ++r) {
+			for(auto c = 0u; c < 4; ++c) {
+				ma[i][r][c] = mb[i][r][c] = 0.1f * (i + r + c);
+			}
+		}
+	}
+
+	bench::measure("Mat4 approx", count, [&]{
+		auto equal = true;
+		for(auto i = 0u; i < ma.size(); ++i) {
+			equal &= (ma[i] == nytl::approx(mb[i]));
+		}
+		bench::doNotOptimize(equal);
+	});
+}
@@ -0,0 +1,75 @@
+// Compares waiting for the next call of a callback by registering a
+// one-shot function that disconnects itself with co_await next().
+// Needs C++20 coroutines, empty otherwise.
+
+#include "bench.hpp"
+#include <nytl/awaitableCallback.hpp>
+#include <nytl/recursiveCallback.hpp>
+
+#if NYTL_COROUTINES
+
+namespace {
+
+struct Detached {
+	struct promise_type {
+		Detached get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+} // anon namespace
+
+BENCHMARK(await) {
+	constexpr auto waits = 1000u;
+
+	nytl::RecursiveCallback<void(int)> rcb;
+	auto sum = 0;
+	bench::measure("one-shot function", waits, [&]{
+		for(auto i = 0u; i < waits; ++i) {
+			rcb.add([&](auto conn, int value) {
+				sum += value;
+				conn.disconnect();
+			});
+			rcb(1);
+		}
+		bench::doNotOptimize(sum);
+	});
+
+	nytl::AwaitableCallback<void(int)> acb;
+	auto stop = false;
+	auto waiter = [&]() -> Detached {
+		while(!stop) {
+			sum += co_await acb.next();
+		}
+	};
+
+	waiter();
+	bench::measure("co_await next", waits, [&]{
+		for(auto i = 0u; i < waits; ++i) {
+			acb(1);
+		}
+		bench::doNotOptimize(sum);
+	});
+
+	auto consumer = [&]() -> Detached {
+		auto gen = acb.emissions();
+		while(auto value = co_await gen.next()) {
+			sum += *value;
+		}
+	};
+
+	stop = true;
+	acb(0);
+	consumer();
+	bench::measure("emissions generator", waits, [&]{
+		for(auto i = 0u; i < waits; ++i) {
+			acb(1);
+		}
+		bench::doNotOptimize(sum);
+	});
+}
+
+#endif // NYTL_COROUTINES
@@ -0,0 +1,68 @@
+// Benchmarks the batched point transformations from nytl/batchOps.hpp
+// against transforming one point at a time via Mat * Vec.
+
+#include "bench.hpp"
+#include <nytl/batchOps.hpp>
+#include <nytl/mat.hpp>
+#include <nytl/vec.hpp>
+
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 1024;
+
+const nytl::Mat4f affine {
+	0.f, -1.f, 0.f, 1.f,
+	1.f, 0.f, 0.f, -3.f,
+	0.f, 0.f, 1.f, 2.f,
+	0.f, 0.f, 0.f, 1.f,
+};
+
+const nytl::Mat4f projection {
+	1.f, 0.f, 0.f, 0.f,
+	0.f, 1.f, 0.f, 0.f,
+	0.f, 0.f, 1.f, -1.f,
+	0.f, 0.f, 1.f, 0.f,
+};
+
+} // anon namespace
+
+BENCHMARK(transform) {
+	std::vector<nytl::Vec3f> points(count);
+	for(auto i = 0u; i < count; ++i) {
+		points[i] = {0.001f * i, 1.f, 2.f - 0.001f * i};
+	}
+
+	auto out = points;
+	bench::measure("Mat4f * Vec4f", count, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			auto& p = points[i];
+			auto r = affine * nytl::Vec4f{p.x, p.y, p.z, 1.f};
+			out[i] = {r[0], r[1], r[2]};
+		}
+		bench::clobber();
+	});
+	nytl::TaskScheduler single(0);
+	bench::measure("transformPoints", count, [&]{
+		nytl::transformPoints(affine, points, out, &single);
+		bench::clobber();
+	});
+
+	bench::measure("transformPoints (all threads)", count, [&]{
+		nytl::transformPoints(affine, points, out);
+		bench::clobber();
+	});
+	bench::measure("Mat4f * Vec4f, perspective divide", count, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			auto& p = points[i];
+			auto r = projection * nytl::Vec4f{p.x, p.y, p.z, 1.f};
+			out[i] = {r[0] / r[3], r[1] / r[3], r[2] / r[3]};
+		}
+		bench::clobber();
+	});
+	bench::measure("projectPoints", count, [&]{
+		nytl::projectPoints(projection, points, out, &single);
+		bench::clobber();
+	});
+}
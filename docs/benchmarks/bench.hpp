@@ -0,0 +1,316 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// Extremely lightweight header-only benchmarking helper for the nytl benchmarks.
+// Mirrors the interface of bugged.hpp used by the unit tests:
+// Use the BENCHMARK(name) macro to declare a benchmark unit and call
+// bench::measure inside it for every variant that should be timed.
+// Benchmarks should be built with optimizations, i.e. configure
+// meson with `--buildtype=release -Dbenchmarks=true`.
+//
+// Every benchmark executable accepts the following arguments:
+//  --filter <str>: only runs the units whose name contains str
+//  --json <file>: additionally writes all results as json to the given file.
+//    Two such files can be compared with compare.py.
+
+#pragma once
+
+#include <algorithm> // std::sort
+#include <chrono> // std::chrono::steady_clock
+#include <cstdint> // std::uint64_t
+#include <cstdio> // std::printf
+#include <cstring> // std::strcmp
+#include <string> // std::string
+#include <vector> // std::vector
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+	#include <linux/perf_event.h> // perf_event_attr
+	#include <sys/syscall.h> // SYS_perf_event_open
+	#include <unistd.h> // syscall
+	#define BENCH_PERF 1
+#else
+	#define BENCH_PERF 0
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h> // __rdtsc
+	#define BENCH_TSC 1
+#else
+	#define BENCH_TSC 0
+#endif
+
+namespace bench {
+
+/// Makes sure the compiler assumes the given value is read, i.e. the
+/// computation producing it cannot be optimized out.
+template<typename T>
+inline void doNotOptimize(const T& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+/// Makes sure the compiler assumes all memory is read and written.
+inline void clobber() {
+	asm volatile("" : : : "memory");
+}
+
+/// Counts the cpu cycles of the calling thread using perf_event where
+/// permitted. Falls back to the time stamp counter on x86 (which counts
+/// at a constant reference frequency, not the actual clock).
+class CycleCounter {
+public:
+	static CycleCounter& get() {
+		static CycleCounter counter;
+		return counter;
+	}
+
+	/// Returns the name of the used counter, nullptr if there is none.
+	const char* source() const { return source_; }
+
+	std::uint64_t now() const {
+#if BENCH_PERF
+		if(fd_ >= 0) {
+			std::uint64_t value {};
+			if(::read(fd_, &value, sizeof(value)) == sizeof(value)) {
+				return value;
+			}
+		}
+#endif // BENCH_PERF
+
+#if BENCH_TSC
+		return __rdtsc();
+#else
+		return 0;
+#endif // BENCH_TSC
+	}
+
+	~CycleCounter() {
+#if BENCH_PERF
+		if(fd_ >= 0) {
+			::close(fd_);
+		}
+#endif // BENCH_PERF
+	}
+
+protected:
+	CycleCounter() {
+#if BENCH_PERF
+		perf_event_attr attr {};
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_CPU_CYCLES;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd_ = int(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+		if(fd_ >= 0) {
+			source_ = "perf";
+			return;
+		}
+#endif // BENCH_PERF
+
+#if BENCH_TSC
+		source_ = "tsc";
+#endif // BENCH_TSC
+	}
+
+	int fd_ {-1};
+	const char* source_ {};
+};
+
+/// Statistics of the samples of one measurement.
+/// All values are per call of the measured function.
+struct Result {
+	std::string unit;
+	std::string name;
+	std::size_t elements;
+	double min; // ns
+	double median; // ns
+	double p99; // ns, simply the slowest sample for small sample counts
+	double cycles; // median, 0 if no cycle counter is available
+};
+
+/// Static class that holds all benchmarks to be run.
+class Benchmarking {
+public:
+	struct Unit {
+		using FuncPtr = void(*)();
+		std::string name;
+		FuncPtr func;
+	};
+
+	/// Adds the given unit to the list of units to run.
+	/// Always returns 0, useful for static calling.
+	static int add(const Unit& unit) {
+		units().push_back(unit);
+		return 0;
+	}
+
+	/// Runs all registered benchmark units, see the file description
+	/// for the supported arguments.
+	static int run(int argc = 0, const char* const* argv = nullptr) {
+		const char* filter {};
+		const char* json {};
+		for(auto i = 1; i + 1 < argc; i += 2) {
+			if(!std::strcmp(argv[i], "--filter")) {
+				filter = argv[i + 1];
+			} else if(!std::strcmp(argv[i], "--json")) {
+				json = argv[i + 1];
+			} else {
+				std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+				return 1;
+			}
+		}
+
+		for(auto& unit : units()) {
+			if(filter && unit.name.find(filter) == std::string::npos) {
+				continue;
+			}
+
+			std::printf("%s\n", unit.name.c_str());
+			current() = unit.name;
+			unit.func();
+		}
+
+		return json ? writeJson(json) : 0;
+	}
+
+	static std::vector<Unit>& units() {
+		static std::vector<Unit> ret;
+		return ret;
+	}
+
+	static std::vector<Result>& results() {
+		static std::vector<Result> ret;
+		return ret;
+	}
+
+	static std::string& current() {
+		static std::string ret;
+		return ret;
+	}
+
+protected:
+	static void writeString(std::FILE* file, const std::string& str) {
+		std::fputc('"', file);
+		for(auto c : str) {
+			if(c == '"' || c == '\\') {
+				std::fputc('\\', file);
+			}
+			std::fputc(c, file);
+		}
+		std::fputc('"', file);
+	}
+
+	static int writeJson(const char* path) {
+		auto file = std::fopen(path, "w");
+		if(!file) {
+			std::fprintf(stderr, "Could not open %s\n", path);
+			return 1;
+		}
+
+		auto source = CycleCounter::get().source();
+		std::fprintf(file, "{\n  \"cycles\": \"%s\",\n  \"results\": [", source ? source : "");
+		auto first = true;
+		for(auto& result : results()) {
+			std::fprintf(file, "%s\n    {\"unit\": ", first ? "" : ",");
+			writeString(file, result.unit);
+			std::fprintf(file, ", \"name\": ");
+			writeString(file, result.name);
+			std::fprintf(file, ", \"elements\": %zu, \"min\": %.3f, \"median\": %.3f, "
+				"\"p99\": %.3f, \"cycles\": %.1f}", result.elements, result.min,
+				result.median, result.p99, result.cycles);
+			first = false;
+		}
+
+		std::fprintf(file, "\n  ]\n}\n");
+		std::fclose(file);
+		return 0;
+	}
+};
+
+/// Times the given function and prints the median time per call as well
+/// as the fastest and (roughly) 99th percentile sample.
+/// The function is first run for a warmup period, then called repeatedly
+/// (in batches that take roughly 5ms) for a fixed number of samples.
+/// \param elements The number of elements processed per call. If not
+/// zero, the time (and cycles, if available) per element is printed as well.
+/// Returns the median time per call in nanoseconds.
+template<typename F>
+double measure(const char* name, std::size_t elements, F&& func) {
+	using Clock = std::chrono::steady_clock;
+	constexpr auto sampleCount = 21u;
+	constexpr auto warmupTime = std::chrono::milliseconds(20);
+	constexpr auto batchTime = std::chrono::milliseconds(5);
+
+	// warmup: caches, branch predictors and cpu frequency
+	auto warmupStart = Clock::now();
+	while(Clock::now() - warmupStart < warmupTime) {
+		func();
+	}
+
+	// find the number of iterations per sample
+	auto iterations = std::size_t(1);
+	while(true) {
+		auto start = Clock::now();
+		for(auto i = 0u; i < iterations; ++i) {
+			func();
+		}
+
+		if(Clock::now() - start >= batchTime) {
+			break;
+		}
+
+		iterations *= 2;
+	}
+
+	auto& counter = CycleCounter::get();
+	std::vector<double> samples;
+	std::vector<double> cycles;
+	samples.reserve(sampleCount);
+	cycles.reserve(sampleCount);
+	for(auto s = 0u; s < sampleCount; ++s) {
+		auto startCycles = counter.now();
+		auto start = Clock::now();
+		for(auto i = 0u; i < iterations; ++i) {
+			func();
+		}
+
+		std::chrono::duration<double, std::nano> time = Clock::now() - start;
+		samples.push_back(time.count() / iterations);
+		cycles.push_back(double(counter.now() - startCycles) / iterations);
+	}
+
+	std::sort(samples.begin(), samples.end());
+	std::sort(cycles.begin(), cycles.end());
+
+	Result result {Benchmarking::current(), name, elements, samples.front(),
+		samples[samples.size() / 2], samples[(samples.size() * 99 - 1) / 100],
+		counter.source() ? cycles[cycles.size() / 2] : 0.0};
+	Benchmarking::results().push_back(result);
+
+	std::printf("  %-40s %12.2f ns [%.2f, %.2f]", name, result.median,
+		result.min, result.p99);
+	if(elements) {
+		std::printf(" %10.3f ns/elem", result.median / elements);
+		if(counter.source()) {
+			std::printf(" %8.2f cycles/elem", result.cycles / elements);
+		}
+	}
+
+	std::printf("\n");
+	return result.median;
+}
+
+} // namespace bench
+
+/// Declares a new benchmark unit. After this macro the function body should follow:
+/// ``` BENCHMARK(sum) { bench::measure("sum", n, [&]{ ... }); } ```
+#define BENCHMARK(name) \
+	static void BENCH_##name##_U(); \
+	namespace { static auto BENCH_##name = ::bench::Benchmarking::add({#name, \
+		BENCH_##name##_U}); } \
+	static void BENCH_##name##_U()
+
+#ifndef BENCH_NO_MAIN
+	int main(int argc, char** argv) { return bench::Benchmarking::run(argc, argv); }
+#endif // BENCH_NO_MAIN
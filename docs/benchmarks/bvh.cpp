@@ -0,0 +1,97 @@
+// Benchmarks building a nytl::SimplexBVH over a synthetic scene of
+// a million triangles (a noisy height field) and casting rays against it.
+
+#include "bench.hpp"
+#include <nytl/bvh.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto gridSize = 708u; // 2 * 708^2 ~ 1M triangles
+constexpr auto rayCount = 1024u * 16u;
+
+float height(unsigned x, unsigned y) {
+	return 4.f * std::sin(0.05f * x) * std::cos(0.07f * y) +
+		0.5f * std::sin(1.3f * x + 0.7f * y);
+}
+
+void printRate(const char* name, double ns) {
+	std::printf("  %-40s %12.3f M/s\n", name, 1e3 * rayCount / ns);
+}
+
+} // anon namespace
+
+BENCHMARK(bvh) {
+	std::vector<nytl::Triangle<3, float>> tris;
+	tris.reserve(2 * gridSize * gridSize);
+	for(auto y = 0u; y < gridSize; ++y) {
+		for(auto x = 0u; x < gridSize; ++x) {
+			nytl::Vec3f p00 {float(x), float(y), height(x, y)};
+			nytl::Vec3f p10 {float(x + 1), float(y), height(x + 1, y)};
+			nytl::Vec3f p01 {float(x), float(y + 1), height(x, y + 1)};
+			nytl::Vec3f p11 {float(x + 1), float(y + 1), height(x + 1, y + 1)};
+			tris.push_back({{{p00, p10, p11}}});
+			tris.push_back({{{p00, p11, p01}}});
+		}
+	}
+
+	// building takes too long to repeat it as often as bench::measure does
+	nytl::TaskScheduler single(0);
+	auto& global = nytl::TaskScheduler::global();
+	nytl::SimplexBVH<3, float, 2> bvh;
+	for(auto scheduler : {&single, &global}) {
+		auto start = std::chrono::steady_clock::now();
+		bvh.build(tris, *scheduler);
+		std::chrono::duration<double, std::milli> time =
+			std::chrono::steady_clock::now() - start;
+		std::printf("  build (%u threads, %zu triangles) %12.2f ms\n",
+			scheduler->concurrency(), tris.size(), time.count());
+	}
+
+	// rays from a camera above the scene, looking down at an angle
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> dist(0.f, 1.f);
+	std::vector<nytl::Vec3f> origins(rayCount), dirs(rayCount);
+	std::vector<std::optional<nytl::RayHit<float>>> hits(rayCount);
+	for(auto i = 0u; i < rayCount; ++i) {
+		origins[i] = {gridSize * 0.5f, -100.f, 200.f};
+		dirs[i] = {dist(rng) - 0.5f, 0.5f + 0.5f * dist(rng), -0.6f};
+	}
+
+	auto ns = bench::measure("intersectRay", rayCount, [&]{
+		for(auto i = 0u; i < rayCount; ++i) {
+			hits[i] = bvh.intersectRay(origins[i], dirs[i]);
+		}
+		bench::doNotOptimize(hits);
+	});
+	printRate("intersectRay rate", ns);
+
+	ns = bench::measure("anyHit", rayCount, [&]{
+		auto count = 0u;
+		for(auto i = 0u; i < rayCount; ++i) {
+			count += bvh.anyHit(origins[i], dirs[i]);
+		}
+		bench::doNotOptimize(count);
+	});
+	printRate("anyHit rate", ns);
+
+	ns = bench::measure("intersectRays (all threads)", rayCount, [&]{
+		bvh.intersectRays(origins, dirs, hits);
+		bench::doNotOptimize(hits);
+	});
+	printRate("intersectRays (all threads) rate", ns);
+
+	ns = bench::measure("closestPoint", rayCount, [&]{
+		auto sum = 0.f;
+		for(auto i = 0u; i < rayCount; ++i) {
+			sum += bvh.closestPoint(origins[i] + 100.f * dirs[i])->distance;
+		}
+		bench::doNotOptimize(sum);
+	});
+	printRate("closestPoint rate", ns);
+}
@@ -0,0 +1,74 @@
+// Benchmarks calling callbacks with N listeners and compares Callback::call
+// with Callback::callParallel for small listener counts: trivial listeners
+// measure the dispatch overhead, heavy ones the speedup.
+
+#include "bench.hpp"
+#include <nytl/callback.hpp>
+#include <nytl/recursiveCallback.hpp>
+#include <nytl/tasks.hpp>
+
+#include <string>
+
+namespace {
+
+// roughly 20us of work
+float heavy(float value) {
+	for(auto i = 0u; i < 10000; ++i) {
+		value = value * 0.999f + 0.5f;
+		bench::clobber();
+	}
+	return value;
+}
+
+} // anon namespace
+
+BENCHMARK(call) {
+	for(auto count : {1u, 4u, 16u, 64u}) {
+		nytl::Callback<void(int)> cb;
+		nytl::RecursiveCallback<void(int)> rcb;
+		auto sum = 0;
+		for(auto i = 0u; i < count; ++i) {
+			cb.add([&](int value) { sum += value; });
+			rcb.add([&](int value) { sum += value; });
+		}
+
+		auto suffix = " (" + std::to_string(count) + " listeners)";
+		bench::measure(("Callback" + suffix).c_str(), count, [&]{
+			cb(1);
+			bench::doNotOptimize(sum);
+		});
+
+		bench::measure(("RecursiveCallback" + suffix).c_str(), count, [&]{
+			rcb(1);
+			bench::doNotOptimize(sum);
+		});
+	}
+}
+
+BENCHMARK(call_parallel) {
+	auto& scheduler = nytl::TaskScheduler::global();
+	for(auto count : {1u, 2u, 4u, 8u, 32u}) {
+		nytl::Callback<float(float)> trivial, heavyCb;
+		for(auto i = 0u; i < count; ++i) {
+			trivial.add([](float v) { return v + 1.f; }, nytl::ListenerMode::independent);
+			heavyCb.add(heavy, nytl::ListenerMode::independent);
+		}
+
+		auto suffix = " (" + std::to_string(count) + " listeners)";
+		bench::measure(("call trivial" + suffix).c_str(), count, [&]{
+			bench::doNotOptimize(trivial.call(1.f));
+		});
+
+		bench::measure(("callParallel trivial" + suffix).c_str(), count, [&]{
+			bench::doNotOptimize(trivial.callParallel(scheduler, 1.f));
+		});
+
+		bench::measure(("call heavy" + suffix).c_str(), count, [&]{
+			bench::doNotOptimize(heavyCb.call(1.f));
+		});
+
+		bench::measure(("callParallel heavy" + suffix).c_str(), count, [&]{
+			bench::doNotOptimize(heavyCb.callParallel(scheduler, 1.f));
+		});
+	}
+}
@@ -0,0 +1,90 @@
+// Benchmarks cloning many small polymorphic objects (like commands
+// of an undo system) via the global heap against cloning them
+// into pmr memory resources.
+
+#include "bench.hpp"
+#include <nytl/clone.hpp>
+
+#include <memory_resource>
+#include <vector>
+#include <string>
+
+namespace {
+
+constexpr auto count = 1024 * 4;
+
+struct Command : public nytl::AbstractCloneable<Command> {
+	virtual int apply() const = 0;
+};
+
+struct MoveCommand : public nytl::DeriveCloneable<MoveCommand, Command> {
+	int from {}, to {};
+	int apply() const override { return to - from; }
+};
+
+struct RenameCommand : public nytl::DeriveCloneable<RenameCommand, Command> {
+	int id {};
+	char name[48] {};
+	int apply() const override { return id + name[0]; }
+};
+
+std::vector<std::unique_ptr<Command>> makeCommands() {
+	std::vector<std::unique_ptr<Command>> ret;
+	for(auto i = 0u; i < count; ++i) {
+		if(i % 3) {
+			auto cmd = std::make_unique<MoveCommand>();
+			cmd->from = i;
+			cmd->to = 2 * i;
+			ret.push_back(std::move(cmd));
+		} else {
+			auto cmd = std::make_unique<RenameCommand>();
+			cmd->id = i;
+			cmd->name[0] = 'a';
+			ret.push_back(std::move(cmd));
+		}
+	}
+	return ret;
+}
+
+} // anon namespace
+
+BENCHMARK(clone) {
+	auto commands = makeCommands();
+
+	bench::measure("global heap", count, [&]{
+		std::vector<std::unique_ptr<Command>> copies;
+		copies.reserve(count);
+		for(auto& cmd : commands) copies.push_back(nytl::clone(*cmd));
+		bench::doNotOptimize(copies);
+	});
+
+	bench::measure("monotonic arena", count, [&]{
+		std::pmr::monotonic_buffer_resource arena;
+		std::vector<nytl::ResourcePtr<Command>> copies;
+		copies.reserve(count);
+		for(auto& cmd : commands) copies.push_back(nytl::clone(*cmd, arena));
+		bench::doNotOptimize(copies);
+	});
+
+	std::vector<unsigned char> buffer(count * 64 * 2);
+	bench::measure("monotonic arena, preallocated", count, [&]{
+		std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+		std::vector<nytl::ResourcePtr<Command>> copies;
+		copies.reserve(count);
+		for(auto& cmd : commands) copies.push_back(nytl::clone(*cmd, arena));
+		bench::doNotOptimize(copies);
+	});
+
+	bench::measure("cloneAll", count, [&]{
+		auto copies = nytl::cloneAll(commands);
+		bench::doNotOptimize(copies);
+	});
+
+	std::pmr::unsynchronized_pool_resource pool;
+	bench::measure("unsynchronized pool", count, [&]{
+		std::vector<nytl::ResourcePtr<Command>> copies;
+		copies.reserve(count);
+		for(auto& cmd : commands) copies.push_back(nytl::clone(*cmd, pool));
+		bench::doNotOptimize(copies);
+	});
+}
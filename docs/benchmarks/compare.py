@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2017-2018 nyorain
+# Distributed under the Boost Software License, Version 1.0.
+# See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+# Compares two sets of benchmark results as written by the benchmarks
+# with `--json <file>`. Both arguments may be single json files or directories
+# (e.g. the benchmark build directories) whose json files are compared.
+# Results from directories are matched by file name, unit and benchmark name
+# since e.g. the -O0 and -O2 builds of a benchmark share the unit names.
+# Prints the relative change of every benchmark present in both sets and
+# exits with 1 if any of them got slower than the given threshold.
+#
+# Usage: compare.py [--threshold 5] [--metric median] <baseline> <current>
+
+import argparse
+import json
+import os
+import sys
+
+
+def load(path):
+	files = [path]
+	isdir = os.path.isdir(path)
+	if isdir:
+		files = sorted(os.path.join(path, f) for f in os.listdir(path)
+			if f.endswith('.json'))
+
+	results = {}
+	for file in files:
+		stem = os.path.splitext(os.path.basename(file))[0] if isdir else ''
+		with open(file) as f:
+			data = json.load(f)
+		for result in data.get('results', []):
+			key = (stem, result['unit'], result['name'])
+			if key in results:
+				sys.exit('{}: duplicate benchmark {} / {}'.format(file,
+					key[1], key[2]))
+			results[key] = result
+	return results
+
+
+def title(key):
+	return '{}: {}'.format(key[0], key[1]) if key[0] else key[1]
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Compares benchmark results')
+	parser.add_argument('baseline', help='json file or directory')
+	parser.add_argument('current', help='json file or directory')
+	parser.add_argument('--threshold', type=float, default=5.0,
+		help='regression threshold in percent (default: 5)')
+	parser.add_argument('--metric', choices=['min', 'median', 'p99', 'cycles'],
+		default='median', help='compared value (default: median)')
+	args = parser.parse_args()
+
+	baseline = load(args.baseline)
+	current = load(args.current)
+
+	regressions = 0
+	unit = None
+	for key in sorted(set(baseline) & set(current)):
+		old = baseline[key][args.metric]
+		new = current[key][args.metric]
+		if old <= 0:
+			continue
+
+		if key[:2] != unit:
+			unit = key[:2]
+			print(title(key))
+
+		change = 100.0 * (new - old) / old
+		mark = ''
+		if change > args.threshold:
+			mark = '  REGRESSION'
+			regressions += 1
+		elif change < -args.threshold:
+			mark = '  improvement'
+
+		print('  {:<40} {:>12.2f} -> {:>12.2f} {:>+8.1f}%{}'.format(
+			key[2], old, new, change, mark))
+
+	missing = sorted(set(baseline) ^ set(current))
+	for key in missing:
+		where = 'baseline' if key in baseline else 'current'
+		print('only in {}: {} / {}'.format(where, title(key), key[2]))
+
+	if regressions:
+		print('{} regression(s) above {}%'.format(regressions, args.threshold))
+		return 1
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,104 @@
+// Benchmarks nytl::DamageTracker on a synthetic trace resembling the damage of
+// a desktop application: blinking cursor, typing, a spinner, a moving sprite,
+// occasional scrolling and particle bursts.
+
+#include "bench.hpp"
+#include <nytl/damageTracker.hpp>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr nytl::Vec2i screen {1920, 1080};
+constexpr auto frameCount = 600u;
+
+std::vector<std::vector<nytl::Rect2i>> trace() {
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> burst(0, 300);
+	std::vector<std::vector<nytl::Rect2i>> frames(frameCount);
+	for(auto f = 0u; f < frameCount; ++f) {
+		auto& frame = frames[f];
+		auto i = int(f);
+		if(f % 30 == 0) {
+			frame.push_back({{400 + 10 * (i % 80), 200}, {2, 20}}); // cursor
+		}
+
+		frame.push_back({{400 + 10 * (i % 80), 200}, {10, 20}}); // typing
+		frame.push_back({{1800, 40}, {64, 64}}); // spinner
+		frame.push_back({{2 * i, 700}, {48, 48}}); // sprite, old position
+		frame.push_back({{2 * i + 2, 700}, {48, 48}}); // sprite, new position
+
+		if(f % 60 == 0) {
+			frame.push_back({{100, 300}, {800, 600}}); // scrolled list
+		}
+
+		if(f % 100 < 20) {
+			for(auto p = 0u; p < 200; ++p) {
+				frame.push_back({{1200 + burst(rng), 500 + burst(rng)}, {4, 4}});
+			}
+		}
+	}
+
+	return frames;
+}
+
+void run(const std::string& name, const nytl::DamageSettings& settings) {
+	static const auto frames = trace();
+	nytl::DamageTracker<int> tracker(screen, settings);
+	auto f = 0u;
+	auto step = [&]{
+		for(auto& rect : frames[f % frameCount]) {
+			tracker.add(rect);
+		}
+		auto damage = tracker.damage(1 + f % settings.maxAge);
+		tracker.nextFrame();
+		++f;
+		return damage;
+	};
+
+	// quality of the damage: drawn rects and area per frame
+	auto rects = 0.0;
+	auto area = 0.0;
+	for(auto i = 0u; i < frameCount; ++i) {
+		for(auto& rect : step()) {
+			rects += 1;
+			area += double(rect.size.x) * rect.size.y;
+		}
+	}
+	std::printf("  %-40s %8.1f rects %12.0f px per frame\n", name.c_str(),
+		rects / frameCount, area / frameCount);
+
+	auto added = std::size_t(0);
+	for(auto& frame : frames) {
+		added += frame.size();
+	}
+
+	bench::measure(name.c_str(), added / frameCount, [&]{
+		bench::doNotOptimize(step().data());
+	});
+}
+
+} // anon namespace
+
+BENCHMARK(damage) {
+	nytl::DamageSettings settings;
+	run("rects", settings);
+
+	settings.rectCost = 0;
+	settings.maxRects = 64;
+	run("rects_exact", settings);
+
+	settings.rectCost = 128 * 128;
+	settings.maxRects = 8;
+	run("rects_coarse", settings);
+
+	settings.mode = nytl::DamageMode::tiles;
+	settings.tileSize = 32;
+	run("tiles_32", settings);
+
+	settings.tileSize = 64;
+	run("tiles_64", settings);
+}
@@ -0,0 +1,83 @@
+// Benchmarks the expression templates from nytl/expr.hpp against the
+// eager operators for `a + b * s - c` chains on larger vectors and matrices.
+// The eager version materializes a temporary for every operation.
+
+#include "bench.hpp"
+#include <nytl/expr.hpp>
+#include <nytl/vec.hpp>
+#include <nytl/mat.hpp>
+
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024;
+using Vec64f = nytl::Vec<64, float>;
+using Mat16f = nytl::Mat<16, 16, float>;
+
+template<typename V>
+std::vector<V> makeVecs(float start) {
+	std::vector<V> ret(count);
+	for(auto& v : ret) {
+		auto data = reinterpret_cast<float*>(&v);
+		for(auto i = 0u; i < sizeof(V) / sizeof(float); ++i) {
+			data[i] = start;
+			start += 0.25f;
+		}
+	}
+	return ret;
+}
+
+} // anon namespace
+
+BENCHMARK(vec64) {
+	auto a = makeVecs<Vec64f>(1.f);
+	auto b = makeVecs<Vec64f>(2.f);
+	auto c = makeVecs<Vec64f>(3.f);
+	auto r = std::vector<Vec64f>(count);
+	auto s = 0.5f;
+	using nytl::expr::lazy;
+
+	bench::measure("eager", count * 64, [&]{
+		for(auto i = 0u; i < count; ++i) r[i] = a[i] + s * b[i] - c[i];
+		bench::clobber();
+	});
+	bench::measure("lazy", count * 64, [&]{
+		for(auto i = 0u; i < count; ++i) r[i] = lazy(a[i]) + s * lazy(b[i]) - c[i];
+		bench::clobber();
+	});
+	bench::measure("eager inplace", count * 64, [&]{
+		for(auto i = 0u; i < count; ++i) a[i] = a[i] + s * b[i] - c[i];
+		bench::clobber();
+	});
+	bench::measure("lazy assign inplace", count * 64, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			nytl::expr::assign(a[i], lazy(a[i]) + s * lazy(b[i]) - c[i]);
+		}
+		bench::clobber();
+	});
+}
+
+BENCHMARK(mat16) {
+	auto a = makeVecs<Mat16f>(1.f);
+	auto b = makeVecs<Mat16f>(2.f);
+	auto c = makeVecs<Mat16f>(3.f);
+	auto r = std::vector<Mat16f>(count);
+	auto s = 0.5f;
+	using nytl::expr::lazy;
+
+	bench::measure("eager", count * 256, [&]{
+		for(auto i = 0u; i < count; ++i) r[i] = a[i] + s * b[i] - c[i];
+		bench::clobber();
+	});
+	bench::measure("lazy", count * 256, [&]{
+		for(auto i = 0u; i < count; ++i) r[i] = lazy(a[i]) + s * lazy(b[i]) - c[i];
+		bench::clobber();
+	});
+	bench::measure("lazy assign", count * 256, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			nytl::expr::assign(r[i], lazy(a[i]) + s * lazy(b[i]) - c[i]);
+		}
+		bench::clobber();
+	});
+}
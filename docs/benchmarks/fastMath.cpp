@@ -0,0 +1,148 @@
+// Benchmarks the approximations from nytl/fastMath.hpp against the
+// standard library functions, for arrays as well as single Vecs.
+
+#include "bench.hpp"
+#include <nytl/fastMath.hpp>
+#include <nytl/vecOps.hpp>
+#include <nytl/vec.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 64;
+
+// values in [lo, hi)
+std::vector<float> values(float lo, float hi) {
+	std::vector<float> ret(count);
+	auto state = 12345u;
+	for(auto& val : ret) {
+		state = state * 1664525u + 1013904223u;
+		val = lo + (hi - lo) * float(state >> 8) / float(1u << 24);
+	}
+	return ret;
+}
+
+// compares std, fast for single values and fast for the whole array
+template<typename S, typename F, typename A>
+void compare(const char* name, const std::vector<float>& in, S stdFunc,
+		F fastFunc, A arrayFunc) {
+	std::vector<float> out(in.size());
+	bench::measure((std::string("std::") + name).c_str(), count, [&]{
+		for(auto i = 0u; i < count; ++i) out[i] = stdFunc(in[i]);
+		bench::clobber();
+	});
+	bench::measure((std::string("fast::") + name).c_str(), count, [&]{
+		for(auto i = 0u; i < count; ++i) out[i] = fastFunc(in[i]);
+		bench::clobber();
+	});
+	bench::measure((std::string("fast::") + name + " array").c_str(), count, [&]{
+		arrayFunc(in, out);
+		bench::clobber();
+	});
+}
+
+} // anon namespace
+
+BENCHMARK(trig) {
+	auto angles = values(-10.f, 10.f);
+	compare("sin", angles,
+		[](float x) { return std::sin(x); },
+		[](float x) { return nytl::fast::sin(x); },
+		[](auto& in, auto& out) { nytl::fast::sin(in, out); });
+
+	std::vector<float> s(count), c(count);
+	bench::measure("std::sin + std::cos", count, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			s[i] = std::sin(angles[i]);
+			c[i] = std::cos(angles[i]);
+		}
+		bench::clobber();
+	});
+	bench::measure("fast::sincos array", count, [&]{
+		nytl::fast::sincos(angles, s, c);
+		bench::clobber();
+	});
+
+	auto unit = values(-1.f, 1.f);
+	compare("acos", unit,
+		[](float x) { return std::acos(x); },
+		[](float x) { return nytl::fast::acos(x); },
+		[](auto& in, auto& out) { nytl::fast::acos(in, out); });
+
+	auto xs = values(-10.f, 10.f);
+	std::vector<float> out(count);
+	bench::measure("std::atan2", count, [&]{
+		for(auto i = 0u; i < count; ++i) out[i] = std::atan2(unit[i], xs[i]);
+		bench::clobber();
+	});
+	bench::measure("fast::atan2", count, [&]{
+		for(auto i = 0u; i < count; ++i) out[i] = nytl::fast::atan2(unit[i], xs[i]);
+		bench::clobber();
+	});
+	bench::measure("fast::atan2 array", count, [&]{
+		nytl::fast::atan2(unit, xs, out);
+		bench::clobber();
+	});
+}
+
+BENCHMARK(exp_log) {
+	compare("exp", values(-20.f, 20.f),
+		[](float x) { return std::exp(x); },
+		[](float x) { return nytl::fast::exp(x); },
+		[](auto& in, auto& out) { nytl::fast::exp(in, out); });
+	compare("log", values(1e-3f, 1e3f),
+		[](float x) { return std::log(x); },
+		[](float x) { return nytl::fast::log(x); },
+		[](auto& in, auto& out) { nytl::fast::log(in, out); });
+
+	// gamma correction
+	compare("pow", values(0.f, 1.f),
+		[](float x) { return std::pow(x, 1 / 2.2f); },
+		[](float x) { return nytl::fast::pow(x, 1 / 2.2f); },
+		[](auto& in, auto& out) { nytl::fast::pow(in, 1 / 2.2f, out); });
+}
+
+BENCHMARK(vec) {
+	auto vals = values(-10.f, 10.f);
+	std::vector<nytl::Vec3f> vecs(count / 3);
+	for(auto i = 0u; i < vecs.size(); ++i) {
+		vecs[i] = {vals[3 * i], vals[3 * i + 1], vals[3 * i + 2]};
+	}
+
+	auto work = vecs;
+	bench::measure("nytl::normalize", vecs.size(), [&]{
+		for(auto& vec : work) nytl::normalize(vec);
+		work = vecs;
+		bench::clobber();
+	});
+	bench::measure("fast::normalize", vecs.size(), [&]{
+		for(auto& vec : work) nytl::fast::normalize(vec);
+		work = vecs;
+		bench::clobber();
+	});
+	bench::measure("fast::normalize array", vecs.size(), [&]{
+		nytl::fast::normalize(work);
+		work = vecs;
+		bench::clobber();
+	});
+
+	bench::measure("Vec3f vec::cw::sin", vecs.size(), [&]{
+		for(auto i = 0u; i < vecs.size(); ++i) work[i] = nytl::vec::cw::sin(vecs[i]);
+		bench::clobber();
+	});
+	bench::measure("Vec3f fast::sin", vecs.size(), [&]{
+		for(auto i = 0u; i < vecs.size(); ++i) work[i] = nytl::fast::sin(vecs[i]);
+		bench::clobber();
+	});
+	bench::measure("Vec3f vec::cw::exp", vecs.size(), [&]{
+		for(auto i = 0u; i < vecs.size(); ++i) work[i] = nytl::vec::cw::exp(vecs[i]);
+		bench::clobber();
+	});
+	bench::measure("Vec3f fast::exp", vecs.size(), [&]{
+		for(auto i = 0u; i < vecs.size(); ++i) work[i] = nytl::fast::exp(vecs[i]);
+		bench::clobber();
+	});
+}
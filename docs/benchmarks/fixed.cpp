@@ -0,0 +1,141 @@
+// Benchmarks the fixed point operations from nytl/fixed.hpp against
+// the same operations on float.
+
+#include "bench.hpp"
+#include <nytl/fixed.hpp>
+#include <nytl/batchOps.hpp>
+#include <nytl/matOps.hpp>
+#include <nytl/vecOps.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 64;
+
+// points in [-10, 10)
+std::vector<nytl::Vec3f> points() {
+	std::vector<nytl::Vec3f> ret(count);
+	auto state = 12345u;
+	auto next = [&]{
+		state = state * 1664525u + 1013904223u;
+		return -10.f + 20.f * float(state >> 8) / float(1u << 24);
+	};
+
+	for(auto& p : ret) {
+		p = {next(), next(), next()};
+	}
+	return ret;
+}
+
+template<typename T>
+std::vector<nytl::Vec3<T>> convert(const std::vector<nytl::Vec3f>& vecs) {
+	std::vector<nytl::Vec3<T>> ret(vecs.size());
+	for(auto i = 0u; i < vecs.size(); ++i) {
+		ret[i] = {T(vecs[i].x), T(vecs[i].y), T(vecs[i].z)};
+	}
+	return ret;
+}
+
+template<typename T>
+nytl::Mat4<T> affine() {
+	return {
+		T(0.8f), T(-0.6f), T(0.f), T(1.f),
+		T(0.6f), T(0.8f), T(0.f), T(-3.f),
+		T(0.f), T(0.f), T(1.f), T(2.f),
+		T(0.f), T(0.f), T(0.f), T(1.f),
+	};
+}
+
+template<typename T>
+void vecOps(const char* name, const std::vector<nytl::Vec3f>& in) {
+	auto vecs = convert<T>(in);
+	auto work = vecs;
+	std::string prefix = name;
+
+	bench::measure((prefix + " dot").c_str(), count, [&]{
+		for(auto i = 0u; i + 1 < count; ++i) {
+			work[i].x = nytl::dot(vecs[i], vecs[i + 1]);
+		}
+		bench::clobber();
+	});
+	bench::measure((prefix + " cross").c_str(), count, [&]{
+		for(auto i = 0u; i + 1 < count; ++i) {
+			work[i] = nytl::cross(vecs[i], vecs[i + 1]);
+		}
+		bench::clobber();
+	});
+	bench::measure((prefix + " normalize").c_str(), count, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			work[i] = nytl::normalized(vecs[i]);
+		}
+		bench::clobber();
+	});
+}
+
+template<typename T>
+void matOps(const char* name) {
+	std::string prefix = name;
+	std::vector<nytl::Mat4<T>> mats(1024);
+	for(auto i = 0u; i < mats.size(); ++i) {
+		mats[i] = affine<T>();
+		mats[i][0][3] = T(0.01f * i);
+		mats[i][3][0] = T(0.001f * i);
+	}
+
+	auto work = mats;
+	bench::measure((prefix + " mat * mat").c_str(), mats.size(), [&]{
+		for(auto i = 0u; i + 1 < mats.size(); ++i) {
+			work[i] = mats[i] * mats[i + 1];
+		}
+		bench::clobber();
+	});
+	bench::measure((prefix + " inverse").c_str(), mats.size(), [&]{
+		for(auto i = 0u; i < mats.size(); ++i) {
+			work[i] = static_cast<nytl::Mat4<T>>(nytl::inverse(mats[i]));
+		}
+		bench::clobber();
+	});
+}
+
+template<typename T>
+void transform(const char* name, const std::vector<nytl::Vec3f>& in) {
+	std::string prefix = name;
+	auto vecs = convert<T>(in);
+	auto out = vecs;
+	auto m = affine<T>();
+
+	bench::measure((prefix + " mat * vec").c_str(), count, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			auto& p = vecs[i];
+			auto r = m * nytl::Vec4<T>{p.x, p.y, p.z, T(1.f)};
+			out[i] = {r[0], r[1], r[2]};
+		}
+		bench::clobber();
+	});
+	nytl::TaskScheduler single(0);
+	bench::measure((prefix + " transformPoints").c_str(), count, [&]{
+		nytl::transformPoints(m, vecs, out, &single);
+		bench::clobber();
+	});
+}
+
+} // anon namespace
+
+BENCHMARK(vec) {
+	auto in = points();
+	vecOps<float>("float", in);
+	vecOps<nytl::Fixed32>("Fixed32", in);
+}
+
+BENCHMARK(mat) {
+	matOps<float>("float");
+	matOps<nytl::Fixed32>("Fixed32");
+}
+
+BENCHMARK(transform) {
+	auto in = points();
+	transform<float>("float", in);
+	transform<nytl::Fixed32>("Fixed32", in);
+}
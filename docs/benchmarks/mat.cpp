@@ -0,0 +1,98 @@
+// Benchmarks the generic vec and mat operations at multiple sizes.
+
+#include "bench.hpp"
+#include <nytl/vecOps.hpp>
+#include <nytl/matOps.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto vecCount = 1024 * 16;
+constexpr auto matCount = 1024;
+
+template<std::size_t D>
+std::string sized(const char* name) {
+	return std::string(name) + " " + std::to_string(D);
+}
+
+template<std::size_t D>
+void vecOps() {
+	using Vec = nytl::Vec<D, float>;
+	std::vector<Vec> vecs(vecCount);
+	for(auto i = 0u; i < vecCount; ++i) {
+		for(auto j = 0u; j < D; ++j) {
+			vecs[i][j] = 1.f + float((i + j) % 17);
+		}
+	}
+
+	bench::measure(sized<D>("dot").c_str(), vecCount, [&]{
+		auto sum = 0.f;
+		for(auto i = 1u; i < vecCount; ++i) {
+			sum += nytl::dot(vecs[i - 1], vecs[i]);
+		}
+		bench::doNotOptimize(sum);
+	});
+
+	auto work = vecs;
+	bench::measure(sized<D>("normalize").c_str(), vecCount, [&]{
+		for(auto& vec : work) {
+			nytl::normalize(vec);
+		}
+		bench::doNotOptimize(work);
+	});
+}
+
+template<std::size_t D>
+void matOps() {
+	using Mat = nytl::SquareMat<D, float>;
+	std::vector<Mat> mats(matCount);
+	for(auto m = 0u; m < matCount; ++m) {
+		// diagonally dominant, i.e. invertible
+		for(auto r = 0u; r < D; ++r) {
+			for(auto c = 0u; c < D; ++c) {
+				mats[m][r][c] = (r == c) ? 2.f * D : float((m + r * c) % 3) - 1.f;
+			}
+		}
+	}
+
+	bench::measure(sized<D>("multiply").c_str(), matCount, [&]{
+		auto acc = mats[0];
+		for(auto& mat : mats) {
+			acc = 0.1f * (acc * mat);
+		}
+		bench::doNotOptimize(acc);
+	});
+
+	bench::measure(sized<D>("luDecomp").c_str(), matCount, [&]{
+		for(auto& mat : mats) {
+			auto lu = nytl::luDecomp(mat);
+			bench::doNotOptimize(lu);
+		}
+	});
+
+	bench::measure(sized<D>("inverse").c_str(), matCount, [&]{
+		for(auto& mat : mats) {
+			auto inv = nytl::inverse(mat);
+			bench::doNotOptimize(inv);
+		}
+	});
+}
+
+} // anon namespace
+
+BENCHMARK(vec) {
+	vecOps<2>();
+	vecOps<3>();
+	vecOps<4>();
+	vecOps<8>();
+	vecOps<16>();
+}
+
+BENCHMARK(mat) {
+	matOps<2>();
+	matOps<3>();
+	matOps<4>();
+	matOps<8>();
+}
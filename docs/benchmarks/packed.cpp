@@ -0,0 +1,96 @@
+// Benchmarks converting arrays to the storage types from nytl/packed.hpp,
+// value by value against the bulk pack/unpack functions.
+// The packed arrays need 2 (f16, bf16, snorm16) or 3 (Oct32) times less memory.
+
+#include "bench.hpp"
+#include <nytl/packed.hpp>
+#include <nytl/vecOps.hpp>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 64;
+
+// values in [-1, 1)
+std::vector<float> values() {
+	std::vector<float> ret(count);
+	auto state = 12345u;
+	for(auto& val : ret) {
+		state = state * 1664525u + 1013904223u;
+		val = -1.f + 2.f * float(state >> 8) / float(1u << 24);
+	}
+	return ret;
+}
+
+template<typename T>
+void compare(const char* name, const std::vector<float>& in) {
+	std::vector<T> packed(in.size());
+	std::vector<float> out(in.size());
+	bench::measure((std::string(name) + " pack loop").c_str(), count, [&]{
+		for(auto i = 0u; i < count; ++i) packed[i] = T(in[i]);
+		bench::clobber();
+	});
+	bench::measure((std::string(name) + " pack").c_str(), count, [&]{
+		nytl::pack(in, packed);
+		bench::clobber();
+	});
+	bench::measure((std::string(name) + " unpack loop").c_str(), count, [&]{
+		for(auto i = 0u; i < count; ++i) out[i] = float(packed[i]);
+		bench::clobber();
+	});
+	bench::measure((std::string(name) + " unpack").c_str(), count, [&]{
+		nytl::unpack(packed, out);
+		bench::clobber();
+	});
+}
+
+} // anon namespace
+
+BENCHMARK(scalar) {
+	auto vals = values();
+	compare<nytl::f16>("f16", vals);
+	compare<nytl::bf16>("bf16", vals);
+	compare<nytl::snorm16>("snorm16", vals);
+	compare<nytl::unorm8>("unorm8", vals);
+}
+
+BENCHMARK(normal) {
+	auto vals = values();
+	std::vector<nytl::Vec3f> normals(count / 3);
+	for(auto i = 0u; i < normals.size(); ++i) {
+		normals[i] = nytl::normalized(nytl::Vec3f {vals[3 * i],
+			vals[3 * i + 1], vals[3 * i + 2]});
+	}
+
+	std::vector<nytl::Oct32> octs(normals.size());
+	std::vector<nytl::Vec3f> out(normals.size());
+	bench::measure("Oct32 pack loop", normals.size(), [&]{
+		for(auto i = 0u; i < normals.size(); ++i) octs[i] = nytl::Oct32(normals[i]);
+		bench::clobber();
+	});
+	bench::measure("Oct32 pack", normals.size(), [&]{
+		nytl::pack(normals, octs);
+		bench::clobber();
+	});
+	bench::measure("Oct32 unpack loop", normals.size(), [&]{
+		for(auto i = 0u; i < normals.size(); ++i) out[i] = nytl::Vec3f(octs[i]);
+		bench::clobber();
+	});
+	bench::measure("Oct32 unpack", normals.size(), [&]{
+		nytl::unpack(octs, out);
+		bench::clobber();
+	});
+
+	std::vector<nytl::Vec3h> halfs(normals.size());
+	bench::measure("Vec3h pack loop", normals.size(), [&]{
+		for(auto i = 0u; i < normals.size(); ++i) halfs[i] = nytl::Vec3h(normals[i]);
+		bench::clobber();
+	});
+	bench::measure("Vec3h pack", normals.size(), [&]{
+		nytl::pack(normals, halfs);
+		bench::clobber();
+	});
+}
@@ -0,0 +1,77 @@
+// Benchmarks the scaling of the nytl::par algorithms from one thread up
+// to the number of hardware threads.
+
+#include "bench.hpp"
+#include <nytl/parallel.hpp>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr auto vecCount = 1024 * 1024 * 4;
+constexpr auto matCount = 1024 * 256;
+
+// 1, 2, 4, ... up to the number of hardware threads
+std::vector<unsigned> threadCounts() {
+	auto max = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<unsigned> ret;
+	for(auto t = 1u; t < max; t *= 2) {
+		ret.push_back(t);
+	}
+	ret.push_back(max);
+	return ret;
+}
+
+} // anon namespace
+
+BENCHMARK(parallel) {
+	std::vector<nytl::Vec3f> vecs(vecCount);
+	for(auto i = 0u; i < vecCount; ++i) {
+		vecs[i] = {float(i + 1), 1.f, -0.001f * i};
+	}
+
+	std::vector<nytl::Mat4f> mats(matCount);
+	for(auto i = 0u; i < matCount; ++i) {
+		mats[i] = {
+			2.f, float(i), 0.f, 1.f,
+			0.f, 1.f, 0.f, 0.f,
+			1.f, 0.f, 3.f, 0.f,
+			0.f, 0.f, 0.f, 1.f,
+		};
+	}
+
+	auto work = vecs;
+	auto inverses = mats;
+	auto points = vecs;
+	const auto& m = mats[1];
+
+	nytl::TaskScheduler scheduler(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+	for(auto threads : threadCounts()) {
+		auto policy = nytl::par::Policy {&scheduler, 0, threads};
+		auto suffix = " (" + std::to_string(threads) + " threads)";
+
+		bench::measure(("normalize" + suffix).c_str(), vecCount, [&]{
+			nytl::par::normalize(policy, work);
+			bench::doNotOptimize(work);
+		});
+
+		bench::measure(("inverse Mat4f" + suffix).c_str(), matCount, [&]{
+			nytl::par::inverse(policy, mats, inverses);
+			bench::doNotOptimize(inverses);
+		});
+
+		bench::measure(("transformPoints" + suffix).c_str(), vecCount, [&]{
+			nytl::par::transformPoints(policy, m, vecs, points);
+			bench::doNotOptimize(points);
+		});
+
+		bench::measure(("reduce" + suffix).c_str(), vecCount, [&]{
+			auto sum = nytl::par::reduce(policy, vecs, nytl::Vec3f {},
+				[](auto a, auto b) { return a + b; });
+			bench::doNotOptimize(sum);
+		});
+	}
+}
@@ -0,0 +1,102 @@
+// Benchmarks iterating and copying heterogeneous polymorphic objects
+// stored as vector<unique_ptr<Base>>, vector<nytl::Poly<Base>> and
+// nytl::PolyVector<Base>.
+
+#include "bench.hpp"
+#include <nytl/poly.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 256;
+
+struct Shape : public nytl::AbstractCloneable<Shape> {
+	virtual float area() const = 0;
+};
+
+struct Circle final : public nytl::DeriveCloneable<Circle, Shape> {
+	float radius {};
+	Circle(float r) : radius(r) {}
+	float area() const override { return 3.14159f * radius * radius; }
+};
+
+struct Rect final : public nytl::DeriveCloneable<Rect, Shape> {
+	float width {}, height {};
+	Rect(float w, float h) : width(w), height(h) {}
+	float area() const override { return width * height; }
+};
+
+} // anon namespace
+
+BENCHMARK(poly) {
+	std::vector<std::unique_ptr<Shape>> ptrs;
+	std::vector<nytl::Poly<Shape>> polys;
+	nytl::PolyVector<Shape> packed;
+
+	// simulate a fragmented heap by allocating the objects in random
+	// order, the containers hold them in insertion order
+	std::vector<unsigned> order(count);
+	for(auto i = 0u; i < count; ++i) order[i] = i;
+	std::shuffle(order.begin(), order.end(), std::mt19937(42));
+	std::vector<std::unique_ptr<Shape>> heap(count);
+	for(auto i : order) {
+		if(i % 2) heap[i] = std::make_unique<Circle>(float(i));
+		else heap[i] = std::make_unique<Rect>(float(i), 2.f);
+	}
+
+	for(auto i = 0u; i < count; ++i) {
+		if(i % 2) {
+			polys.emplace_back(Circle(float(i)));
+			packed.emplace_back<Circle>(float(i));
+		} else {
+			polys.emplace_back(Rect(float(i), 2.f));
+			packed.emplace_back<Rect>(float(i), 2.f);
+		}
+	}
+	ptrs = std::move(heap);
+
+	bench::measure("iterate vector<unique_ptr>", count, [&]{
+		auto sum = 0.f;
+		for(auto& shape : ptrs) sum += shape->area();
+		bench::doNotOptimize(sum);
+	});
+
+	bench::measure("iterate vector<Poly>", count, [&]{
+		auto sum = 0.f;
+		for(auto& shape : polys) sum += shape->area();
+		bench::doNotOptimize(sum);
+	});
+
+	bench::measure("iterate PolyVector", count, [&]{
+		auto sum = 0.f;
+		for(auto& shape : packed) sum += shape.area();
+		bench::doNotOptimize(sum);
+	});
+
+	bench::measure("iterate PolyVector, devirtualized", count, [&]{
+		auto sum = 0.f;
+		packed.forEach<Circle, Rect>([&](auto& shape) { sum += shape.area(); });
+		bench::doNotOptimize(sum);
+	});
+
+	bench::measure("copy vector<unique_ptr>", count, [&]{
+		std::vector<std::unique_ptr<Shape>> copy;
+		copy.reserve(count);
+		for(auto& shape : ptrs) copy.push_back(nytl::clone(*shape));
+		bench::doNotOptimize(copy);
+	});
+
+	bench::measure("copy vector<Poly>", count, [&]{
+		auto copy = polys;
+		bench::doNotOptimize(copy);
+	});
+
+	bench::measure("copy PolyVector", count, [&]{
+		auto copy = packed;
+		bench::doNotOptimize(copy);
+	});
+}
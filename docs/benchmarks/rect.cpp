@@ -0,0 +1,130 @@
+// Benchmarks the rect operations on random rects.
+
+#include "bench.hpp"
+#include <nytl/rectOps.hpp>
+#include <nytl/rectArray.hpp>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 4;
+
+std::vector<nytl::Rect2f> randomRects() {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> pos(0.f, 100.f);
+	std::uniform_real_distribution<float> size(1.f, 30.f);
+	std::vector<nytl::Rect2f> rects(count);
+	for(auto& rect : rects) {
+		rect = {{pos(rng), pos(rng)}, {size(rng), size(rng)}};
+	}
+	return rects;
+}
+
+} // anon namespace
+
+BENCHMARK(rect) {
+	auto rects = randomRects();
+
+	bench::measure("contains", count, [&]{
+		auto hits = 0u;
+		for(auto i = 1u; i < count; ++i) {
+			hits += nytl::contains(rects[i - 1], rects[i].position);
+		}
+		bench::doNotOptimize(hits);
+	});
+
+	bench::measure("intersects", count, [&]{
+		auto hits = 0u;
+		for(auto i = 1u; i < count; ++i) {
+			hits += nytl::intersects(rects[i - 1], rects[i]);
+		}
+		bench::doNotOptimize(hits);
+	});
+
+	bench::measure("intersection", count, [&]{
+		auto area = 0.f;
+		for(auto i = 1u; i < count; ++i) {
+			auto rect = nytl::intersection(rects[i - 1], rects[i]);
+			area += rect.size.x * rect.size.y;
+		}
+		bench::doNotOptimize(area);
+	});
+
+	bench::measure("difference", count, [&]{
+		auto pieces = std::size_t(0);
+		for(auto i = 1u; i < count; ++i) {
+			pieces += nytl::difference(rects[i - 1], rects[i]).size();
+		}
+		bench::doNotOptimize(pieces);
+	});
+}
+
+// one query against all rects: scalar loops vs the batched RectArray tests
+BENCHMARK(rect_array) {
+	auto rects = randomRects();
+	nytl::RectArray<2, float> array(rects);
+	nytl::Vec2f point {50.f, 50.f};
+	nytl::Rect2f query {{40.f, 40.f}, {20.f, 20.f}};
+	std::vector<std::uint32_t> ids;
+	std::vector<nytl::Rect2f> out;
+	std::vector<std::uint64_t> mask(array.maskSize());
+	ids.reserve(count);
+	out.reserve(count);
+
+	bench::measure("contains_loop", count, [&]{
+		ids.clear();
+		for(auto i = 0u; i < count; ++i) {
+			if(nytl::contains(rects[i], point)) {
+				ids.push_back(i);
+			}
+		}
+		bench::doNotOptimize(ids.data());
+	});
+
+	bench::measure("contains_mask", count, [&]{
+		array.containsMask(point, mask);
+		bench::doNotOptimize(mask.data());
+	});
+
+	bench::measure("contains_all", count, [&]{
+		ids.clear();
+		array.containsAll(point, ids);
+		bench::doNotOptimize(ids.data());
+	});
+
+	bench::measure("intersects_loop", count, [&]{
+		ids.clear();
+		for(auto i = 0u; i < count; ++i) {
+			if(nytl::intersects(rects[i], query)) {
+				ids.push_back(i);
+			}
+		}
+		bench::doNotOptimize(ids.data());
+	});
+
+	bench::measure("intersects_mask", count, [&]{
+		array.intersectsMask(query, mask);
+		bench::doNotOptimize(mask.data());
+	});
+
+	bench::measure("intersection_loop", count, [&]{
+		ids.clear();
+		out.clear();
+		for(auto i = 0u; i < count; ++i) {
+			if(nytl::intersects(rects[i], query)) {
+				ids.push_back(i);
+				out.push_back(nytl::intersection(rects[i], query));
+			}
+		}
+		bench::doNotOptimize(out.data());
+	});
+
+	bench::measure("intersection_all", count, [&]{
+		ids.clear();
+		out.clear();
+		array.intersectionAll(query, ids, out);
+		bench::doNotOptimize(out.data());
+	});
+}
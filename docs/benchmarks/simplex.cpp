@@ -0,0 +1,53 @@
+// Benchmarks casting a ray against many triangles with nytl::closestHit
+// from nytl/simplexOps.hpp against testing one triangle at a time.
+
+#include "bench.hpp"
+#include <nytl/simplexOps.hpp>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 1024;
+
+} // anon namespace
+
+BENCHMARK(simplex) {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+	std::vector<nytl::Triangle<3, float>> tris(count);
+	for(auto& tri : tris) {
+		nytl::Vec3f center {100 * dist(rng), 100 * dist(rng), 10 + 5 * dist(rng)};
+		for(auto& p : tri.points_) {
+			p = center + nytl::Vec3f {dist(rng), dist(rng), dist(rng)};
+		}
+	}
+
+	nytl::Vec3f origin {0.f, 0.f, 0.f};
+	nytl::Vec3f dir {0.1f, 0.2f, 1.f};
+
+	bench::measure("intersectRay loop", count, [&]{
+		std::optional<nytl::RayHit<float>> best;
+		for(auto i = 0u; i < tris.size(); ++i) {
+			auto maxT = best ? best->t : std::numeric_limits<float>::infinity();
+			auto hit = nytl::intersectRay(tris[i], origin, dir, maxT);
+			if(hit) {
+				best = hit;
+				best->index = i;
+			}
+		}
+		bench::doNotOptimize(best);
+	});
+
+	bench::measure("closestHit", count, [&]{
+		auto hit = nytl::closestHit(tris, origin, dir);
+		bench::doNotOptimize(hit);
+	});
+
+	bench::measure("anyHit (miss)", count, [&]{
+		auto hit = nytl::anyHit(tris, origin, -dir);
+		bench::doNotOptimize(hit);
+	});
+}
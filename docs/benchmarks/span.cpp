@@ -0,0 +1,60 @@
+// Compares span access with raw pointer access.
+// With the default contract policy (NYTL_CONTRACTS_OFF) all variants
+// must compile to the same loop and therefore show the same timings.
+// Build with -DNYTL_CONTRACTS=NYTL_CONTRACTS_THROW to see the cost of
+// enabled bounds checks and checked iterators.
+
+#include "bench.hpp"
+#include <nytl/span.hpp>
+#include <vector>
+#include <numeric>
+
+namespace {
+
+constexpr auto count = 1024 * 16;
+
+float sumPointer(const float* data, std::size_t size) {
+	auto ret = 0.f;
+	for(auto i = 0u; i < size; ++i) {
+		ret += data[i];
+	}
+	return ret;
+}
+
+float sumIndex(nytl::span<const float> values) {
+	auto ret = 0.f;
+	for(auto i = 0; i < values.size(); ++i) {
+		ret += values[i];
+	}
+	return ret;
+}
+
+float sumRange(nytl::span<const float> values) {
+	auto ret = 0.f;
+	for(auto v : values) {
+		ret += v;
+	}
+	return ret;
+}
+
+} // anon namespace
+
+BENCHMARK(span_access) {
+	std::vector<float> values(count);
+	std::iota(values.begin(), values.end(), 0.f);
+
+	bench::measure("pointer", count, [&]{
+		bench::doNotOptimize(sumPointer(values.data(), values.size()));
+	});
+	bench::measure("span operator[]", count, [&]{
+		bench::doNotOptimize(sumIndex(values));
+	});
+	bench::measure("span iterator", count, [&]{
+		bench::doNotOptimize(sumRange(values));
+	});
+	bench::measure("span subspan", count, [&]{
+		auto s = nytl::span<const float>(values);
+		bench::doNotOptimize(sumRange(s.subspan(0, count / 2)) +
+			sumRange(s.subspan(count / 2)));
+	});
+}
@@ -0,0 +1,124 @@
+// Benchmarks updating a nytl::SweepAndPrune with moving rects: coherent motion
+// (small steps, mostly handled by insertion sort) and random motion (every rect
+// teleports, sorted from scratch) for 10k to 1M rects.
+
+#include "bench.hpp"
+#include <nytl/sweepAndPrune.hpp>
+#include <nytl/rectOps.hpp>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Rects with velocities in a world with constant density
+template<std::size_t D>
+struct World {
+	std::vector<nytl::Rect<D, float>> rects;
+	std::vector<nytl::Vec<D, float>> velocities;
+	nytl::SweepAndPrune<D, float> sap;
+	float extent;
+	std::mt19937 rng {42};
+
+	explicit World(unsigned count) : extent(3.f * float(std::pow(count, 1.0 / D))) {
+		std::uniform_real_distribution<float> vel(-0.01f, 0.01f);
+		for(auto i = 0u; i < count; ++i) {
+			rects.push_back(random());
+			for(auto a = 0u; a < D; ++a) {
+				velocities.emplace_back()[a] = vel(rng);
+			}
+			sap.insert(rects.back());
+		}
+		sap.update();
+	}
+
+	nytl::Rect<D, float> random() {
+		std::uniform_real_distribution<float> pos(0.f, extent);
+		std::uniform_real_distribution<float> size(0.5f, 2.f);
+		nytl::Rect<D, float> ret;
+		for(auto a = 0u; a < D; ++a) {
+			ret.position[a] = pos(rng);
+			ret.size[a] = size(rng);
+		}
+		return ret;
+	}
+
+	// moves every rect by its velocity, bounces at the borders
+	void step() {
+		for(auto i = 0u; i < rects.size(); ++i) {
+			auto& rect = rects[i];
+			for(auto a = 0u; a < D; ++a) {
+				rect.position[a] += velocities[i][a];
+				if(rect.position[a] < 0.f || rect.position[a] > extent) {
+					velocities[i][a] = -velocities[i][a];
+				}
+			}
+			sap.set(i, rect);
+		}
+	}
+
+	void teleport() {
+		for(auto i = 0u; i < rects.size(); ++i) {
+			rects[i] = random();
+			sap.set(i, rects[i]);
+		}
+	}
+};
+
+template<std::size_t D>
+void run(unsigned count) {
+	auto suffix = std::to_string(D) + "d_" + std::to_string(count / 1000) + "k";
+	World<D> world(count);
+	nytl::TaskScheduler single(0);
+
+	bench::measure(("coherent_" + suffix).c_str(), count, [&]{
+		world.step();
+		world.sap.update(&single);
+		bench::doNotOptimize(world.sap.pairs().data());
+	});
+
+	auto& global = nytl::TaskScheduler::global();
+	if(global.concurrency() > 1 && count >= world.sap.minParallelCount) {
+		bench::measure(("coherent_threads_" + suffix).c_str(), count, [&]{
+			world.step();
+			world.sap.update(&global);
+			bench::doNotOptimize(world.sap.pairs().data());
+		});
+	}
+
+	bench::measure(("random_" + suffix).c_str(), count, [&]{
+		world.teleport();
+		world.sap.update(&single);
+		bench::doNotOptimize(world.sap.pairs().data());
+	});
+}
+
+} // anon namespace
+
+// brute force reference: testing all pairs
+BENCHMARK(sap_n2) {
+	World<2> world(1000 * 10);
+	auto& rects = world.rects;
+	bench::measure("intersects_2d_10k", rects.size(), [&]{
+		auto pairs = std::size_t(0);
+		for(auto a = 0u; a < rects.size(); ++a) {
+			for(auto b = a + 1; b < rects.size(); ++b) {
+				pairs += nytl::intersects(rects[a], rects[b]);
+			}
+		}
+		bench::doNotOptimize(pairs);
+	});
+}
+
+BENCHMARK(sap_2d) {
+	run<2>(1000 * 10);
+	run<2>(1000 * 100);
+	run<2>(1000 * 1000);
+}
+
+BENCHMARK(sap_3d) {
+	run<3>(1000 * 10);
+	run<3>(1000 * 100);
+}
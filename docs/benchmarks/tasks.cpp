@@ -0,0 +1,116 @@
+// Benchmarks the overhead of the nytl task scheduler: fork/join with tiny
+// tasks (fibonacci), parallelFor over vec arrays and task graph throughput.
+
+#include "bench.hpp"
+#include <nytl/tasks.hpp>
+#include <nytl/vecOps.hpp>
+
+#include <vector>
+
+namespace {
+
+constexpr auto fibN = 25u;
+constexpr auto fibCalls = 242785u; // number of calls for fib(25)
+constexpr auto vecCount = 1024 * 1024 * 4;
+
+unsigned fibSerial(unsigned n) {
+	return n < 2 ? n : fibSerial(n - 1) + fibSerial(n - 2);
+}
+
+unsigned fibTasks(nytl::TaskScheduler& scheduler, unsigned n) {
+	if(n < 2) {
+		return n;
+	}
+
+	unsigned a, b;
+	nytl::TaskGroup group(scheduler);
+	group.run([&]{ a = fibTasks(scheduler, n - 1); });
+	b = fibTasks(scheduler, n - 2);
+	group.wait();
+	return a + b;
+}
+
+} // anon namespace
+
+BENCHMARK(fib) {
+	auto& scheduler = nytl::TaskScheduler::global();
+
+	bench::measure("fib serial", fibCalls, [&]{
+		bench::doNotOptimize(fibSerial(fibN));
+	});
+
+	bench::measure("fib tasks", fibCalls, [&]{
+		bench::doNotOptimize(fibTasks(scheduler, fibN));
+	});
+}
+
+BENCHMARK(parallel_for) {
+	auto& scheduler = nytl::TaskScheduler::global();
+	std::vector<nytl::Vec3f> vecs(vecCount);
+	for(auto i = 0u; i < vecCount; ++i) {
+		vecs[i] = {float(i + 1), 1.f, -0.001f * i};
+	}
+
+	bench::measure("normalize serial", vecCount, [&]{
+		for(auto& vec : vecs) {
+			nytl::normalize(vec);
+		}
+		bench::doNotOptimize(vecs);
+	});
+
+	bench::measure("normalize parallelFor", vecCount, [&]{
+		nytl::parallelFor(scheduler, 0, vecs.size(), [&](auto i) {
+			nytl::normalize(vecs[i]);
+		});
+		bench::doNotOptimize(vecs);
+	});
+
+	bench::measure("dot parallelReduce", vecCount, [&]{
+		auto sum = nytl::parallelReduce(scheduler, 0, vecs.size(), 0.f,
+			[&](float acc, auto i) { return acc + nytl::dot(vecs[i], vecs[i]); },
+			[](float a, float b) { return a + b; });
+		bench::doNotOptimize(sum);
+	});
+}
+
+BENCHMARK(graph) {
+	auto& scheduler = nytl::TaskScheduler::global();
+
+	// layers of small tasks, every task depends on two tasks of the previous layer
+	constexpr auto layers = 64u;
+	constexpr auto width = 64u;
+	std::vector<float> values(layers * width, 1.f);
+	nytl::TaskGraph graph;
+	for(auto l = 0u; l < layers; ++l) {
+		for(auto w = 0u; w < width; ++w) {
+			auto id = l * width + w;
+			graph.add([&values, id, l, w]{
+				if(l > 0) {
+					auto prev = (l - 1) * width;
+					values[id] = 0.5f * (values[prev + w] + values[prev + (w + 1) % width]);
+				}
+			});
+
+			if(l > 0) {
+				graph.precede((l - 1) * width + w, id);
+				graph.precede((l - 1) * width + (w + 1) % width, id);
+			}
+		}
+	}
+
+	bench::measure("graph", graph.size(), [&]{
+		graph.run(scheduler);
+		bench::doNotOptimize(values);
+	});
+
+	// independent tasks
+	nytl::TaskGraph flat;
+	for(auto i = 0u; i < layers * width; ++i) {
+		flat.add([&values, i]{ values[i] += 1.f; });
+	}
+
+	bench::measure("graph independent", flat.size(), [&]{
+		flat.run(scheduler);
+		bench::doNotOptimize(values);
+	});
+}
@@ -0,0 +1,78 @@
+// Benchmarks nytl::Transform against plain Mat<4, 4> usage as done
+// in scene hierarchies: composing transforms and transforming points.
+
+#include "bench.hpp"
+#include <nytl/transform.hpp>
+#include <nytl/quat.hpp>
+#include <nytl/mat.hpp>
+#include <nytl/vecOps.hpp>
+
+#include <vector>
+
+namespace {
+
+constexpr auto count = 1024 * 4;
+
+std::vector<nytl::Transformf> makeTransforms() {
+	std::vector<nytl::Transformf> ret(count);
+	for(auto i = 0u; i < count; ++i) {
+		auto f = 0.001f * i;
+		ret[i].translation = {f, -f, 2 * f};
+		ret[i].rotation = nytl::axisAngle(nytl::normalized(nytl::Vec3f{1.f, f, 0.5f}), f);
+	}
+	return ret;
+}
+
+std::vector<nytl::Vec3f> makePoints() {
+	std::vector<nytl::Vec3f> ret(count);
+	for(auto i = 0u; i < count; ++i) {
+		ret[i] = {0.5f * i, 1.f - i, 0.25f};
+	}
+	return ret;
+}
+
+} // anon namespace
+
+BENCHMARK(compose) {
+	auto transforms = makeTransforms();
+	std::vector<nytl::Mat4f> mats;
+	for(auto& t : transforms) {
+		mats.push_back(nytl::toMat4(t));
+	}
+
+	// chains the transforms like a hierarchy update would
+	bench::measure("Mat4f * Mat4f", count, [&]{
+		auto acc = nytl::toMat4(nytl::Transformf {});
+		for(auto& m : mats) acc = acc * m;
+		bench::doNotOptimize(acc);
+	});
+	bench::measure("Transformf * Transformf", count, [&]{
+		auto acc = nytl::Transformf {};
+		for(auto& t : transforms) acc = acc * t;
+		bench::doNotOptimize(acc);
+	});
+}
+
+BENCHMARK(points) {
+	auto points = makePoints();
+	auto out = points;
+	auto t = makeTransforms()[count / 2];
+	auto m = nytl::toMat4(t);
+
+	bench::measure("Mat4f * Vec4f", count, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			auto& p = points[i];
+			auto r = m * nytl::Vec4f{p.x, p.y, p.z, 1.f};
+			out[i] = {r[0], r[1], r[2]};
+		}
+		bench::clobber();
+	});
+	bench::measure("apply(Transformf, Vec3f)", count, [&]{
+		for(auto i = 0u; i < count; ++i) out[i] = nytl::apply(t, points[i]);
+		bench::clobber();
+	});
+	bench::measure("applyAll(Transformf, span)", count, [&]{
+		nytl::applyAll(t, points, out);
+		bench::clobber();
+	});
+}
@@ -0,0 +1,59 @@
+// Benchmarks the utf helpers on corpora with different character widths.
+
+#include "bench.hpp"
+#include <nytl/utf.hpp>
+
+#include <string>
+
+namespace {
+
+constexpr auto corpusSize = 1024 * 64; // bytes
+
+// repeats the given text until the corpus has roughly corpusSize bytes
+std::string corpus(const char* text) {
+	std::string ret;
+	while(ret.size() < corpusSize) {
+		ret += text;
+	}
+	return ret;
+}
+
+void measure(const char* name, const std::string& utf8) {
+	auto chars = nytl::charCount(utf8);
+	auto prefix = std::string(name) + " ";
+
+	bench::measure((prefix + "charCount").c_str(), utf8.size(), [&]{
+		bench::doNotOptimize(nytl::charCount(utf8));
+	});
+
+	bench::measure((prefix + "toUtf32").c_str(), utf8.size(), [&]{
+		auto utf32 = nytl::toUtf32(utf8);
+		bench::doNotOptimize(utf32);
+	});
+
+	bench::measure((prefix + "toUtf16").c_str(), utf8.size(), [&]{
+		auto utf16 = nytl::toUtf16(utf8);
+		bench::doNotOptimize(utf16);
+	});
+
+	auto utf32 = nytl::toUtf32(utf8);
+	bench::measure((prefix + "toUtf8").c_str(), utf8.size(), [&]{
+		auto back = nytl::toUtf8(utf32);
+		bench::doNotOptimize(back);
+	});
+
+	bench::measure((prefix + "nth").c_str(), 64, [&]{
+		for(auto i = 0u; i < 64; ++i) {
+			bench::doNotOptimize(nytl::nth(utf8, (i * chars) / 64));
+		}
+	});
+}
+
+} // anon namespace
+
+BENCHMARK(utf) {
+	measure("ascii", corpus("The quick brown fox jumps over the lazy dog. "));
+	measure("latin", corpus("Falsches Üben von Xylophonmusik quält jeden größeren Zwerg. "));
+	measure("cjk", corpus("色は匂へど散りぬるを我が世誰ぞ常ならむ。"));
+	measure("emoji", corpus("😀🙃🚀🌍🎉🐙"));
+}
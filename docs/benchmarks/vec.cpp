@@ -0,0 +1,192 @@
+// Benchmarks generic (indexed) loops over the Vec specializations.
+// Vec3 (x,y,z members) should perform like the std::array backed Vec<4>
+// since indexed access folds to a single load once the loops are unrolled.
+// For comparison, 'switch' variants use a Vec3 with the previous
+// switch-and-throw operator[] implementation.
+// The operators are expanded over the component indices (no loops, no
+// zero-initialized results), 'loop' variants use loop based implementations
+// of the same operations instead. This matters mostly for unoptimized builds,
+// bench_vec_O0 and bench_vec_O1 are built with -O0/-O1 for that reason.
+
+#include "bench.hpp"
+#include <nytl/vec.hpp>
+#include <nytl/vecOps.hpp>
+#include <nytl/mat.hpp>
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace {
+
+constexpr auto count = 1024 * 4;
+
+// Vec3 with the old operator[] implementation
+struct SwitchVec3 {
+	float x, y, z;
+
+	static constexpr std::size_t size() { return 3; }
+	float operator[](std::size_t i) const {
+		switch(i) {
+			case 0: return x;
+			case 1: return y;
+			case 2: return z;
+			default: throw std::out_of_range("SwitchVec3[]");
+		}
+	}
+};
+
+// generic loops like the ones used in vecOps/matOps
+template<typename V>
+float dotLoop(const V& a, const V& b) {
+	auto ret = 0.f;
+	for(auto i = 0u; i < a.size(); ++i) {
+		ret += a[i] * b[i];
+	}
+	return ret;
+}
+
+template<typename V>
+float dotAll(const std::vector<V>& a, const std::vector<V>& b) {
+	auto ret = 0.f;
+	for(auto i = 0u; i < a.size(); ++i) {
+		ret += dotLoop(a[i], b[i]);
+	}
+	return ret;
+}
+
+// loop based operations, like the operators were implemented before
+template<typename V>
+V addLoop(const V& a, const V& b) {
+	V ret {};
+	for(auto i = 0u; i < a.size(); ++i) {
+		ret[i] = a[i] + b[i];
+	}
+	return ret;
+}
+
+template<typename V>
+V scaleLoop(float f, const V& a) {
+	V ret {};
+	for(auto i = 0u; i < a.size(); ++i) {
+		ret[i] = f * a[i];
+	}
+	return ret;
+}
+
+template<typename V>
+V maxLoop(V a, const V& b) {
+	for(auto i = 0u; i < a.size(); ++i) {
+		if(b[i] > a[i]) {
+			a[i] = b[i];
+		}
+	}
+	return a;
+}
+
+template<typename V>
+std::vector<V> makeVecs(float start) {
+	std::vector<V> ret(count);
+	for(auto& v : ret) {
+		for(auto i = 0u; i < v.size(); ++i) {
+			reinterpret_cast<float*>(&v)[i] = start;
+			start += 0.5f;
+		}
+	}
+	return ret;
+}
+
+} // anon namespace
+
+BENCHMARK(dot) {
+	auto a3 = makeVecs<nytl::Vec3f>(1.f);
+	auto b3 = makeVecs<nytl::Vec3f>(2.f);
+	auto a4 = makeVecs<nytl::Vec4f>(1.f);
+	auto b4 = makeVecs<nytl::Vec4f>(2.f);
+	auto as = makeVecs<SwitchVec3>(1.f);
+	auto bs = makeVecs<SwitchVec3>(2.f);
+
+	bench::measure("Vec3f loop", count, [&]{ bench::doNotOptimize(dotAll(a3, b3)); });
+	bench::measure("Vec4f loop", count, [&]{ bench::doNotOptimize(dotAll(a4, b4)); });
+	bench::measure("switch Vec3 loop", count, [&]{ bench::doNotOptimize(dotAll(as, bs)); });
+	bench::measure("Vec3f nytl::dot", count, [&]{
+		auto ret = 0.f;
+		for(auto i = 0u; i < count; ++i) ret += nytl::dot(a3[i], b3[i]);
+		bench::doNotOptimize(ret);
+	});
+	bench::measure("Vec4f nytl::dot", count, [&]{
+		auto ret = 0.f;
+		for(auto i = 0u; i < count; ++i) ret += nytl::dot(a4[i], b4[i]);
+		bench::doNotOptimize(ret);
+	});
+}
+
+BENCHMARK(add) {
+	auto a3 = makeVecs<nytl::Vec3f>(1.f);
+	auto b3 = makeVecs<nytl::Vec3f>(2.f);
+	auto a4 = makeVecs<nytl::Vec4f>(1.f);
+	auto b4 = makeVecs<nytl::Vec4f>(2.f);
+
+	bench::measure("Vec3f +", count, [&]{
+		for(auto i = 0u; i < count; ++i) a3[i] = a3[i] + b3[i];
+		bench::clobber();
+	});
+	bench::measure("Vec4f +", count, [&]{
+		for(auto i = 0u; i < count; ++i) a4[i] = a4[i] + b4[i];
+		bench::clobber();
+	});
+}
+
+// a + s * b, clamped from below by c
+template<typename V>
+void opsMeasure(const char* name) {
+	auto a = makeVecs<V>(1.f);
+	auto b = makeVecs<V>(2.f);
+	auto c = makeVecs<V>(3.f);
+	std::vector<V> out(count);
+
+	bench::measure((std::string(name) + " ops").c_str(), count, [&]{
+		using namespace nytl::vec;
+		for(auto i = 0u; i < count; ++i) {
+			out[i] = cw::max(a[i] + 0.5f * b[i], c[i]);
+		}
+		bench::clobber();
+	});
+	bench::measure((std::string(name) + " ops loop").c_str(), count, [&]{
+		for(auto i = 0u; i < count; ++i) {
+			out[i] = maxLoop(addLoop(a[i], scaleLoop(0.5f, b[i])), c[i]);
+		}
+		bench::clobber();
+	});
+}
+
+BENCHMARK(ops) {
+	opsMeasure<nytl::Vec2f>("Vec2f");
+	opsMeasure<nytl::Vec3f>("Vec3f");
+	opsMeasure<nytl::Vec4f>("Vec4f");
+
+	auto a3 = makeVecs<nytl::Vec3f>(1.f);
+	auto b3 = makeVecs<nytl::Vec3f>(2.f);
+	bench::measure("Vec3f cross", count, [&]{
+		for(auto i = 0u; i < count; ++i) a3[i] = nytl::cross(a3[i], b3[i]);
+		bench::clobber();
+	});
+}
+
+BENCHMARK(mat_vec) {
+	auto v3 = makeVecs<nytl::Vec3f>(1.f);
+	auto v4 = makeVecs<nytl::Vec4f>(1.f);
+	// permutation matrices, the values stay bounded
+	auto m3 = nytl::Mat3f {0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 1.f, 0.f, 0.f};
+	auto m4 = nytl::Mat4f {0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+		0.f, 0.f, 0.f, 1.f, 1.f, 0.f, 0.f, 0.f};
+
+	bench::measure("Mat3f * Vec3f", count, [&]{
+		for(auto& v : v3) v = m3 * v;
+		bench::clobber();
+	});
+	bench::measure("Mat4f * Vec4f", count, [&]{
+		for(auto& v : v4) v = m4 * v;
+		bench::clobber();
+	});
+}
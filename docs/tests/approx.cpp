@@ -6,6 +6,10 @@
 #include <nytl/approx.hpp>
 #include <nytl/approxVec.hpp>
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
 TEST(basic) {
 	EXPECT(nytl::approx(3.1, 0.2), 3.0);
 	EXPECT(nytl::approx(3.1f), 3.1f);
@@ -29,6 +33,12 @@ TEST(vec) {
 	EXPECT(nytl::approx(v3f), (nytl::Vec3d {1.0, 2.0, 3.0}));
 	EXPECT(nytl::approx(v3f, 0.1), (nytl::Vec3d {1.1, 2.1, 3.1}));
 	EXPECT(nytl::approx(v3f, 0.2), (nytl::Vec3d {0.9, 2.2, 2.8}));
+	EXPECT(nytl::approx(v3f) != (nytl::Vec3f {1.f, 2.f, 3.1f}), true);
+
+	nytl::Vec2d v2d {1.0, 2.0};
+	EXPECT(nytl::approx(v2d), (nytl::Vec2f {1.f, 2.f}));
+	EXPECT(nytl::approx(v2d) != (nytl::Vec2d {1.0, 2.1}), true);
+	EXPECT(nytl::approx(v2d) != (nytl::Vec3d {1.0, 2.0, 0.0}), true);
 }
 
 TEST(mat) {
@@ -36,4 +46,134 @@ TEST(mat) {
 	EXPECT(nytl::approx(m2d), m2d);
 	EXPECT(nytl::approx(m2d, 0.1), (nytl::Mat2d {1.1, 1.9, 3.1, 4.1}));
 	EXPECT(nytl::approx(m2d, 10.0), (nytl::Mat2d {11.0, 12.0, 13.0, 14.0}));
+	EXPECT(nytl::approx(m2d), (nytl::Mat2f {1.f, 2.f, 3.f, 4.f}));
+	EXPECT(nytl::approx(m2d) != (nytl::Mat2f {1.f, 2.f, 3.f, 4.1f}), true);
+}
+
+TEST(modes) {
+	using nytl::ApproxMode;
+	EXPECT(nytl::approx(100.0, 0.5, ApproxMode::absolute), 100.4);
+	EXPECT(nytl::approx(100.0, 0.5, ApproxMode::absolute) != 100.6, true);
+	EXPECT(nytl::approx(100.0, 0.01, ApproxMode::relative), 100.9);
+	EXPECT(nytl::approx(100.0, 0.01, ApproxMode::relative) != 101.1, true);
+	EXPECT(nytl::approx(0.0, 0.01, ApproxMode::relative), -0.0);
+
+	auto next = std::nextafter(1.f, 2.f);
+	auto next2 = std::nextafter(next, 2.f);
+	EXPECT(nytl::approx(1.f, 1, ApproxMode::ulp), next);
+	EXPECT(nytl::approx(1.f, 1, ApproxMode::ulp) != next2, true);
+	EXPECT(nytl::approx(0.f, 2, ApproxMode::ulp), -std::numeric_limits<float>::denorm_min());
+
+	auto nan = std::numeric_limits<double>::quiet_NaN();
+	EXPECT(nytl::approx(nan, 1.0, ApproxMode::absolute) != nan, true);
+	EXPECT(nytl::approx(nan, 1.0, ApproxMode::ulp) != nan, true);
+
+	nytl::Vec3f v {1.f, 2.f, 3.f};
+	nytl::Vec3f w {1.f, std::nextafter(2.f, 3.f), 3.f};
+	EXPECT(nytl::approx(v, 2, ApproxMode::ulp), w);
+	EXPECT(nytl::approx(v, 0, ApproxMode::ulp) != w, true);
+}
+
+TEST(compare) {
+	std::vector<float> a(1000), b(1000);
+	for(auto i = 0u; i < a.size(); ++i) {
+		a[i] = b[i] = 0.5f * i;
+	}
+
+	auto res = nytl::approxCompare(a, b);
+	EXPECT(res.equal(), true);
+	EXPECT(res.maxAbsError, 0.0);
+	EXPECT(res.maxUlpError, 0u);
+
+	b[123] += 0.25f;
+	b[987] = std::nextafter(b[987], 1000.f);
+	res = nytl::approxCompare(a, b, 1e-5);
+	EXPECT(res.equal(), false);
+	EXPECT(res.mismatch, 123u);
+	EXPECT(res.maxAbsError, 0.25);
+	EXPECT(res.maxUlpError > 1u, true);
+	EXPECT(nytl::approxEqual(a, b, 0.3, nytl::ApproxMode::absolute), true);
+
+	// mismatch in the remainder that doesn't fill a pack
+	b[123] = a[123];
+	b[999] = -1.f;
+	res = nytl::approxCompare(a, b, 0.001);
+	EXPECT(res.mismatch, 999u);
+
+	b[999] = a[999];
+	res = nytl::approxCompare(a, b, 1, nytl::ApproxMode::ulp);
+	EXPECT(res.equal(), true);
+	EXPECT(res.maxUlpError, 1u);
+
+	// nan and different sizes
+	b[500] = std::numeric_limits<float>::quiet_NaN();
+	EXPECT(nytl::approxCompare(a, b, 1.0).mismatch, 500u);
+	EXPECT(nytl::approxCompare(a, b, 1.0, nytl::ApproxMode::ulp).mismatch, 500u);
+	b.pop_back();
+	b[500] = a[500];
+	b[987] = a[987];
+	EXPECT(nytl::approxCompare(a, b).mismatch, 999u);
+
+	std::vector<double> c {1.0, 2.0}, d {1.0, 2.5};
+	EXPECT(nytl::approxCompare(c, d).mismatch, 1u);
+	EXPECT(nytl::approxCompare(nytl::Span<const double>(c), nytl::Span<const double>(d),
+		0.5, nytl::ApproxMode::absolute).equal(), true);
+
+	nytl::Mat4f m {};
+	auto m2 = m;
+	m2[3][2] = 1.f;
+	EXPECT(nytl::approx(m), m);
+	EXPECT(nytl::approx(m) != m2, true);
+}
+
+// Arrays are compared in packs, shorter ones value by value. Both must
+// give the same results, also at the boundary of the tolerance.
+TEST(consistency) {
+	using nytl::ApproxMode;
+	auto modes = {ApproxMode::mixed, ApproxMode::absolute,
+		ApproxMode::relative, ApproxMode::ulp};
+
+	// float(0.1) is larger than 0.1
+	std::vector<float> zeroes(64), tenths(64, 0.1f);
+	EXPECT(nytl::approxEqual(zeroes, tenths, 0.1, ApproxMode::absolute), false);
+	EXPECT(nytl::approx(nytl::Vec3f {}, 0.1, ApproxMode::absolute) !=
+		(nytl::Vec3f {0.1f, 0.1f, 0.1f}), true);
+
+	auto state = 1u;
+	auto next = [&]{
+		state = state * 1664525u + 1013904223u;
+		return float(state >> 8) / float(1u << 24);
+	};
+
+	for(auto mode : modes) {
+		for(auto i = 0u; i < 200; ++i) {
+			auto a = 100.f * next();
+			auto eps = (mode == ApproxMode::ulp) ? 4.0 : 1e-3 * next();
+			auto tol = (mode == ApproxMode::absolute) ? eps :
+				(mode == ApproxMode::ulp) ? 0.0 : eps * (1 + a);
+			auto b = (mode == ApproxMode::ulp) ?
+				std::nextafter(std::nextafter(a, 200.f), 200.f) :
+				float(a + tol * (1 + 1e-7 * (next() - 0.5)));
+
+			auto single = (nytl::approx(a, eps, mode) == b);
+			std::vector<float> va(64, a), vb(64, b);
+			EXPECT(nytl::approxEqual(va, vb, eps, mode), single);
+			EXPECT(nytl::approx(nytl::Vec4f {a, a, a, a}, eps, mode) ==
+				(nytl::Vec4f {b, b, b, b}), single);
+		}
+	}
+
+	// subnormal values and tolerances
+	auto denorm = std::numeric_limits<float>::denorm_min();
+	for(auto eps : {1e-45, 1e-40, 0.3}) {
+		for(auto mode : modes) {
+			for(auto k = 0u; k < 24; ++k) {
+				for(auto j = 0u; j < 24; ++j) {
+					auto a = float(k) * denorm, b = float(j) * denorm;
+					std::vector<float> va(64, a), vb(64, b);
+					EXPECT(nytl::approxEqual(va, vb, eps, mode), (nytl::approx(a, eps, mode) == b));
+				}
+			}
+		}
+	}
 }
@@ -0,0 +1,190 @@
+#include "test.hpp"
+#include <nytl/awaitableCallback.hpp>
+
+#if NYTL_COROUTINES
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// minimal eagerly started coroutine, its frame destroys itself when it finishes
+struct Detached {
+	struct promise_type {
+		Detached get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+// coroutine that owns its frame, destroys it (even when suspended) on destruction
+struct Owned {
+	struct promise_type {
+		Owned get_return_object() {
+			return {std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+
+	std::coroutine_handle<promise_type> handle;
+	~Owned() { handle.destroy(); }
+};
+
+} // anon namespace
+
+TEST(next) {
+	nytl::AwaitableCallback<void(int)> cb;
+	auto called = 0;
+	cb += [&](int) { ++called; };
+
+	std::vector<int> received;
+	auto waiter = [&]() -> Detached {
+		received.push_back(co_await cb.next());
+		received.push_back(co_await cb.next());
+	};
+
+	waiter();
+	waiter();
+	EXPECT(received.empty(), true);
+
+	// both coroutines are resumed once per call, waiting again
+	// inside the resumption waits for the next call
+	cb(1);
+	EXPECT(called, 1);
+	EXPECT((received == std::vector<int> {1, 1}), true);
+	cb(2);
+	EXPECT((received == std::vector<int> {1, 1, 2, 2}), true);
+	cb(3);
+	EXPECT(received.size(), 4u);
+
+	// multiple and no arguments, return values
+	nytl::AwaitableCallback<int(const std::string&, float)> multi;
+	multi += [](auto& str, float) { return int(str.size()); };
+	std::string str;
+	auto value = 0.f;
+	auto receive = [&]() -> Detached {
+		auto [s, f] = co_await multi.next();
+		str = s;
+		value = f;
+	};
+	receive();
+
+	auto ret = multi("abc", 2.f);
+	EXPECT(ret.size(), 1u);
+	EXPECT(ret[0], 3);
+	EXPECT(str, std::string("abc"));
+	EXPECT(value, 2.f);
+
+	nytl::AwaitableCallback<void()> empty;
+	auto resumed = false;
+	auto resume = [&]() -> Detached {
+		co_await empty.next();
+		resumed = true;
+	};
+	resume();
+	empty();
+	EXPECT(resumed, true);
+
+	// waiting coroutines are forgotten by the destroyed callback
+	auto late = std::make_unique<nytl::AwaitableCallback<void(int)>>();
+	auto wait = [&]() -> Owned { co_await late->next(); };
+	{
+		auto task = wait();
+		late.reset();
+	}
+
+	// destroyed coroutines are removed from the callback
+	late = std::make_unique<nytl::AwaitableCallback<void(int)>>();
+	{
+		auto task = wait();
+		auto other = wait();
+	}
+	(*late)(1);
+}
+
+TEST(generator) {
+	nytl::AwaitableCallback<void(int)> cb;
+	auto sum = 0;
+	auto count = 0;
+	auto finished = false;
+
+	auto consume = [&]() -> Detached {
+		auto gen = cb.emissions();
+		while(auto value = co_await gen.next()) {
+			sum += *value;
+			if(++count == 3) {
+				break;
+			}
+		}
+		finished = true;
+	};
+	consume();
+
+	cb(1);
+	cb(2);
+	EXPECT(finished, false);
+	cb(3);
+	EXPECT(finished, true);
+	EXPECT(sum, 6);
+
+	// the generator was destroyed while waiting for the callback
+	cb(4);
+	EXPECT(sum, 6);
+
+	// custom generators, exceptions
+	auto doubled = [&]() -> nytl::AsyncGenerator<int> {
+		while(true) {
+			auto value = co_await cb.next();
+			if(value < 0) {
+				throw std::runtime_error("negative");
+			}
+			co_yield 2 * value;
+		}
+	};
+
+	std::vector<int> values;
+	auto error = false;
+	auto consumeDoubled = [&]() -> Detached {
+		auto gen = doubled();
+		try {
+			while(auto value = co_await gen.next()) {
+				values.push_back(*value);
+			}
+		} catch(const std::runtime_error&) {
+			error = true;
+		}
+		EXPECT(gen.done(), true);
+	};
+	consumeDoubled();
+
+	cb(5);
+	cb(7);
+	cb(-1);
+	EXPECT((values == std::vector<int> {10, 14}), true);
+	EXPECT(error, true);
+
+	// finite generators
+	auto finite = []() -> nytl::AsyncGenerator<std::string> {
+		co_yield "a";
+		co_yield "b";
+	};
+
+	std::string joined;
+	auto join = [&]() -> Detached {
+		auto gen = finite();
+		while(auto value = co_await gen.next()) {
+			joined += *value;
+		}
+	};
+	join();
+	EXPECT(joined, std::string("ab"));
+}
+
+#endif // NYTL_COROUTINES
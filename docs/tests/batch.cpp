@@ -0,0 +1,128 @@
+// checks the span sizes, see nytl/contracts.hpp
+#define NYTL_CONTRACTS NYTL_CONTRACTS_THROW
+
+#include "test.hpp"
+#include <nytl/batchOps.hpp>
+#include <nytl/mat.hpp>
+#include <nytl/vec.hpp>
+#include <nytl/approx.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <vector>
+
+using namespace nytl;
+
+const Mat4f affine {
+	0.f, -2.f, 0.f, 1.f,
+	1.f, 0.f, 0.5f, -3.f,
+	0.f, 0.f, 3.f, 2.f,
+	0.f, 0.f, 0.f, 1.f,
+};
+
+const Mat4f projection {
+	1.f, 0.f, 0.f, 0.f,
+	0.f, 2.f, 0.f, 0.f,
+	0.f, 0.f, 1.f, -1.f,
+	0.f, 0.f, 1.f, 0.f,
+};
+
+// odd size to test the remainder handling
+std::vector<Vec3f> makePoints(unsigned count = 37) {
+	std::vector<Vec3f> ret;
+	for(auto i = 0u; i < count; ++i) {
+		ret.push_back({0.5f * i, 1.f - i, 1.f + 0.25f * i});
+	}
+	return ret;
+}
+
+Vec3f mul(const Mat4f& m, const Vec3f& p, float w) {
+	auto r = m * Vec4f{p.x, p.y, p.z, w};
+	return {r[0], r[1], r[2]};
+}
+
+TEST(points) {
+	auto points = makePoints();
+	std::vector<Vec3f> out(points.size());
+	transformPoints(affine, points, out);
+	for(auto i = 0u; i < points.size(); ++i) {
+		EXPECT(out[i], nytl::approx(mul(affine, points[i], 1.f)));
+	}
+
+	Mat<3, 4, float> m34 {
+		affine[0][0], affine[0][1], affine[0][2], affine[0][3],
+		affine[1][0], affine[1][1], affine[1][2], affine[1][3],
+		affine[2][0], affine[2][1], affine[2][2], affine[2][3],
+	};
+
+	std::vector<Vec3f> out34(points.size());
+	transformPoints(m34, points, out34);
+	EXPECT(out34 == out, true);
+
+	// in place
+	transformPoints(affine, points, points);
+	EXPECT(points == out, true);
+
+	Mat3f m3 {1.f, 2.f, 3.f, 0.f, 1.f, 0.f, -1.f, 0.f, 2.f};
+	points = makePoints();
+	transformPoints(m3, points, out);
+	for(auto i = 0u; i < points.size(); ++i) {
+		EXPECT(out[i], nytl::approx(m3 * points[i]));
+	}
+}
+
+TEST(doubles) {
+	Mat4d m;
+	for(auto r = 0u; r < 4; ++r) {
+		for(auto c = 0u; c < 4; ++c) {
+			m[r][c] = affine[r][c];
+		}
+	}
+
+	std::vector<Vec3d> points, out(11);
+	for(auto i = 0u; i < out.size(); ++i) {
+		points.push_back({0.5 * i, 1.0 - i, 0.1 * i});
+	}
+
+	transformPoints(m, points, out);
+	for(auto i = 0u; i < points.size(); ++i) {
+		auto r = m * Vec4d{points[i].x, points[i].y, points[i].z, 1.0};
+		EXPECT(out[i], nytl::approx(Vec3d{r[0], r[1], r[2]}));
+	}
+}
+
+TEST(directions) {
+	auto dirs = makePoints(5);
+	std::vector<Vec3f> out(dirs.size());
+	transformDirections(affine, dirs, out);
+	for(auto i = 0u; i < dirs.size(); ++i) {
+		EXPECT(out[i], nytl::approx(mul(affine, dirs[i], 0.f)));
+	}
+}
+
+TEST(project) {
+	auto points = makePoints();
+	std::vector<Vec3f> out(points.size());
+	projectPoints(projection, points, out);
+	for(auto i = 0u; i < points.size(); ++i) {
+		auto r = projection * Vec4f{points[i].x, points[i].y, points[i].z, 1.f};
+		auto expected = Vec3f{r[0] / r[3], r[1] / r[3], r[2] / r[3]};
+		EXPECT(out[i], nytl::approx(expected, 1e-5));
+	}
+
+	std::vector<Vec3f> small(points.size() - 1);
+	ERROR(projectPoints(projection, points, small), nytl::ContractViolation);
+}
+
+TEST(threads) {
+	auto points = makePoints(100 * 1000 + 3);
+	std::vector<Vec3f> single(points.size());
+	std::vector<Vec3f> multi(points.size());
+	nytl::TaskScheduler serial(0), scheduler(3);
+	transformPoints(affine, points, single, &serial);
+	transformPoints(affine, points, multi, &scheduler);
+	EXPECT(single == multi, true);
+
+	projectPoints(projection, points, single, &serial);
+	projectPoints(projection, points, points, &scheduler);
+	EXPECT(single == points, true);
+}
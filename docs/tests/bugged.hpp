@@ -128,6 +128,14 @@ public:
 		static const char* reset;
 	};
 
+	// Optional functions called around the units, e.g. to collect
+	// statistics. All defaulted to nullptr.
+	struct Hooks {
+		static void (*unitStarted)(const Unit&);
+		static void (*unitFinished)(const Unit&, bool failed);
+		static void (*finished)();
+	};
+
 public:
 	/// Called when a check expect fails.
 	/// Will increase the current fail count and print a debug message for
@@ -218,6 +226,10 @@ char Testing::bottomSeparator = '=';
 	const char* Testing::Escape::reset = "";
 #endif
 
+void (*Testing::Hooks::unitStarted)(const Unit&) {};
+void (*Testing::Hooks::unitFinished)(const Unit&, bool) {};
+void (*Testing::Hooks::finished)() {};
+
 
 std::vector<Testing::Unit> Testing::units {};
 unsigned int Testing::currentFailed {};
@@ -348,6 +360,9 @@ unsigned int Testing::run()
 		currentUnit = &unit;
 		auto thrown = false;
 
+		if(Hooks::unitStarted)
+			Hooks::unitStarted(unit);
+
 		try {
 			unit.func();
 		} catch(const std::exception& exception) {
@@ -358,11 +373,17 @@ unsigned int Testing::run()
 			unexpectedException("<Not a std::exception object>");
 		}
 
+		if(Hooks::unitFinished)
+			Hooks::unitFinished(unit, thrown || currentFailed);
+
 		if(thrown || currentFailed)
 			++unitsFailed;
 		totalFailed += currentFailed;
 	}
 
+	if(Hooks::finished)
+		Hooks::finished();
+
 	if(totalFailed) {
 		for(auto i = 0u; i < separationWidth; ++i)
 			*output << bottomSeparator;
@@ -0,0 +1,211 @@
+#include "test.hpp"
+#include <nytl/bvh.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+template<typename P>
+std::vector<nytl::Triangle<3, P>> randomTriangles(std::size_t count, unsigned seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<P> dist(-1, 1);
+	std::vector<nytl::Triangle<3, P>> tris(count);
+	for(auto& tri : tris) {
+		nytl::Vec3<P> center {10 * dist(rng), 10 * dist(rng), 10 * dist(rng)};
+		for(auto& p : tri.points_) {
+			p = center + nytl::Vec3<P> {dist(rng), dist(rng), dist(rng)};
+		}
+	}
+
+	return tris;
+}
+
+template<typename P>
+void checkTriangles(nytl::TaskScheduler& scheduler) {
+	using Vec3 = nytl::Vec3<P>;
+	constexpr auto eps = std::is_same_v<P, float> ? 1e-4 : 1e-9;
+	auto tris = randomTriangles<P>(5000, 3);
+	nytl::SimplexBVH<3, P, 2> bvh(tris, scheduler);
+	EXPECT(bvh.size(), tris.size());
+
+	// every simplex is referenced exactly once
+	std::vector<unsigned> seen(tris.size());
+	for(auto i = 0u; i < bvh.size(); ++i) {
+		++seen[bvh.index(i)];
+	}
+	EXPECT(std::count(seen.begin(), seen.end(), 1u), long(tris.size()));
+
+	auto bounds = bvh.bounds();
+	for(auto& tri : tris) {
+		for(auto& p : tri.points_) {
+			for(auto d = 0u; d < 3; ++d) {
+				EXPECT(p[d] >= bounds.position[d], true);
+				EXPECT(p[d] <= bounds.position[d] + bounds.size[d] + P(eps), true);
+			}
+		}
+	}
+
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<P> dist(-1, 1);
+	auto hits = 0u;
+	std::vector<Vec3> origins, dirs;
+	for(auto r = 0u; r < 300; ++r) {
+		Vec3 origin {12 * dist(rng), 12 * dist(rng), 12 * dist(rng)};
+		Vec3 dir {dist(rng), dist(rng), dist(rng)};
+		origins.push_back(origin);
+		dirs.push_back(dir);
+
+		auto expected = nytl::closestHit(tris, origin, dir);
+		auto hit = bvh.intersectRay(origin, dir);
+		EXPECT(hit.has_value(), expected.has_value());
+		EXPECT(bvh.anyHit(origin, dir), expected.has_value());
+		if(hit && expected) {
+			++hits;
+			EXPECT(hit->t, nytl::approx(expected->t, eps));
+			EXPECT(hit->index, expected->index);
+
+			// segments
+			auto end = origin + P(2) * expected->t * dir;
+			auto seg = bvh.intersectSegment(origin, end);
+			EXPECT(seg.has_value(), true);
+			EXPECT(seg->t, nytl::approx(P(0.5), eps));
+			EXPECT(bvh.anyHit(origin, dir, expected->t * P(0.999)), false);
+		}
+
+		// closest point
+		auto cp = bvh.closestPoint(origin);
+		auto best = std::numeric_limits<P>::infinity();
+		for(auto& tri : tris) {
+			best = std::min(best, nytl::length(origin - nytl::closestPoint(tri, origin)));
+		}
+		EXPECT(cp.has_value(), true);
+		EXPECT(cp->distance, nytl::approx(best, eps));
+		EXPECT(nytl::length(cp->point - origin), nytl::approx(best, eps));
+		EXPECT(bvh.closestPoint(origin, best * P(0.99)).has_value(), false);
+
+		// sphere
+		auto radius = P(2) * (1 + dist(rng));
+		std::vector<std::size_t> found;
+		bvh.querySphere(origin, radius, [&](auto id) { found.push_back(id); });
+		std::sort(found.begin(), found.end());
+		std::vector<std::size_t> inside;
+		for(auto i = 0u; i < tris.size(); ++i) {
+			if(nytl::length(origin - nytl::closestPoint(tris[i], origin)) <= radius) {
+				inside.push_back(i);
+			}
+		}
+		EXPECT(found == inside, true);
+	}
+
+	EXPECT(hits > 10u, true);
+
+	// batched rays
+	std::vector<std::optional<nytl::RayHit<P>>> batch(origins.size());
+	bvh.intersectRays(origins, dirs, batch, scheduler);
+	for(auto i = 0u; i < origins.size(); ++i) {
+		auto single = bvh.intersectRay(origins[i], dirs[i]);
+		EXPECT(batch[i].has_value(), single.has_value());
+		if(single) {
+			EXPECT(batch[i]->index, single->index);
+		}
+	}
+}
+
+} // anon namespace
+
+TEST(triangles) {
+	nytl::TaskScheduler serial(0), scheduler(3);
+	checkTriangles<float>(serial);
+	checkTriangles<double>(serial);
+	checkTriangles<float>(scheduler);
+}
+
+TEST(parallel) {
+	// large enough to be built in parallel
+	auto tris = randomTriangles<float>(1024 * 40, 5);
+	nytl::TaskScheduler single(0), scheduler(3);
+	nytl::SimplexBVH<3, float, 2> serial(tris, single);
+	nytl::SimplexBVH<3, float, 2> parallel(tris, scheduler);
+	EXPECT(parallel.size(), tris.size());
+
+	// the hierarchy does not depend on the number of threads
+	EXPECT(parallel.nodes().size(), serial.nodes().size());
+	auto sameOrder = true;
+	for(auto i = 0u; i < tris.size(); ++i) {
+		sameOrder &= (parallel.index(i) == serial.index(i));
+	}
+	EXPECT(sameOrder, true);
+
+	std::mt19937 rng(2);
+	std::uniform_real_distribution<float> dist(-1, 1);
+	for(auto r = 0u; r < 100; ++r) {
+		nytl::Vec3f origin {12 * dist(rng), 12 * dist(rng), 12 * dist(rng)};
+		nytl::Vec3f dir {dist(rng), dist(rng), dist(rng)};
+		auto a = serial.intersectRay(origin, dir);
+		auto b = parallel.intersectRay(origin, dir);
+		EXPECT(a.has_value(), b.has_value());
+		if(a && b) {
+			EXPECT(a->index, b->index);
+		}
+	}
+}
+
+TEST(degenerate) {
+	nytl::SimplexBVH<3, float, 2> empty;
+	EXPECT(empty.empty(), true);
+	EXPECT(empty.intersectRay({0.f, 0.f, 0.f}, {0.f, 0.f, 1.f}).has_value(), false);
+	EXPECT(empty.closestPoint({0.f, 0.f, 0.f}).has_value(), false);
+
+	// single triangle with a flat bounding box, axis aligned rays
+	nytl::Triangle<3, float> tri {{{{0.f, 0.f, 1.f}, {1.f, 0.f, 1.f}, {0.f, 1.f, 1.f}}}};
+	nytl::SimplexBVH<3, float, 2> single({&tri, 1});
+	auto hit = single.intersectRay({0.25f, 0.25f, 0.f}, {0.f, 0.f, 1.f});
+	EXPECT(hit.has_value(), true);
+	EXPECT(hit->t, nytl::approx(1.f));
+
+	// the ray lies in the plane of a box face
+	hit = single.intersectRay({0.f, 0.25f, 0.f}, {0.f, 0.f, 1.f});
+	EXPECT(hit.has_value(), true);
+	EXPECT(hit->uv, nytl::approx(nytl::Vec2f {0.f, 0.25f}));
+
+	// many copies of the same triangle can't be separated
+	std::vector<nytl::Triangle<3, float>> same(100, tri);
+	nytl::SimplexBVH<3, float, 2> sameBVH(same);
+	EXPECT(sameBVH.intersectRay({0.25f, 0.25f, 0.f}, {0.f, 0.f, 1.f}).has_value(), true);
+	auto count = 0u;
+	sameBVH.querySphere({0.f, 0.f, 0.f}, 1.f, [&](auto) { ++count; });
+	EXPECT(count, 100u);
+}
+
+TEST(lines) {
+	// closest point queries on 2D line segments
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<double> dist(-1, 1);
+	std::vector<nytl::Line<2>> lines(500);
+	for(auto& line : lines) {
+		nytl::Vec2d center {10 * dist(rng), 10 * dist(rng)};
+		line.points_[0] = center + nytl::Vec2d {dist(rng), dist(rng)};
+		line.points_[1] = center + nytl::Vec2d {dist(rng), dist(rng)};
+	}
+
+	nytl::SimplexBVH<2, double, 1> bvh(lines);
+	for(auto r = 0u; r < 100; ++r) {
+		nytl::Vec2d point {12 * dist(rng), 12 * dist(rng)};
+		auto best = std::numeric_limits<double>::infinity();
+		auto bestIndex = std::size_t(0);
+		for(auto i = 0u; i < lines.size(); ++i) {
+			auto d = nytl::length(point - nytl::closestPoint(lines[i], point));
+			if(d < best) {
+				best = d;
+				bestIndex = i;
+			}
+		}
+
+		auto cp = bvh.closestPoint(point);
+		EXPECT(cp->distance, nytl::approx(best));
+		EXPECT(cp->index, bestIndex);
+	}
+}
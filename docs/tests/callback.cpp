@@ -1,6 +1,11 @@
 #include "test.hpp"
 #include <nytl/callback.hpp>
 #include <nytl/tmpUtil.hpp>
+#include <nytl/tasks.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
 
 
 // TODO: more testing with custom id type and stuff
@@ -104,4 +109,77 @@ TEST(tracked) {
 	}
 
 	EXPECT(conn.connected(), false);
-}
\ No newline at end of file
+}
+
+TEST(parallel) {
+	nytl::TaskScheduler scheduler(3);
+	constexpr auto independent = nytl::ListenerMode::independent;
+
+	// results are in registration order, arguments are shared
+	nytl::Callback<std::string(const std::string&)> cb;
+	for(auto i = 0; i < 10; ++i) {
+		auto mode = (i % 3) ? independent : nytl::ListenerMode::ordered;
+		cb.add([i](auto& str) { return str + std::to_string(i); }, mode);
+	}
+
+	auto vec = cb.callParallel(scheduler, "x");
+	EXPECT(vec.size(), 10u);
+	EXPECT(vec[0], std::string("x0"));
+	EXPECT(vec[7], std::string("x7"));
+	EXPECT(vec == cb("x"), true);
+
+	// ordered functions are called in order on the calling thread
+	nytl::Callback<void(int)> vcb;
+	std::atomic<int> sum {0};
+	std::vector<int> order;
+	for(auto i = 0; i < 20; ++i) {
+		vcb.add([&](int v) { sum += v; }, independent);
+		vcb.add([&, i](int) { order.push_back(i); });
+	}
+
+	vcb.callParallel(scheduler, 2);
+	EXPECT(sum.load(), 40);
+	EXPECT(order.size(), 20u);
+	EXPECT(std::is_sorted(order.begin(), order.end()), true);
+
+	// all functions are called, the first exception is rethrown
+	vcb.clear();
+	sum = 0;
+	vcb.add([&](int) { ++sum; }, independent);
+	vcb.add([&](int) { ++sum; throw 1; }, independent);
+	vcb.add([&](int) { ++sum; throw 2; });
+	vcb.add([&](int) { ++sum; throw 3; }, independent);
+	vcb.add([&](int) { ++sum; }, independent);
+	for(auto i = 0; i < 20; ++i) {
+		auto thrown = 0;
+		try {
+			vcb.callParallel(scheduler, 0);
+		} catch(int error) {
+			thrown = error;
+		}
+
+		EXPECT(thrown, 1);
+	}
+	EXPECT(sum.load(), 100);
+
+	// works without workers and listeners as well
+	nytl::TaskScheduler single(0);
+	EXPECT(cb.callParallel(single, "y") == cb("y"), true);
+	nytl::Callback<int()> empty;
+	EXPECT(empty.callParallel(single).empty(), true);
+}
+
+// calling doesn't allocate, except the vector for the return values
+TEST(allocations) {
+	auto sum = 0;
+	nytl::Callback<void(int)> cb;
+	nytl::Callback<int(int)> rcb;
+	for(auto i = 0; i < 8; ++i) {
+		cb.add([&](int value) { sum += value; });
+		rcb.add([i](int value) { return value + i; });
+	}
+
+	EXPECT_ALLOCS(cb(1), 0u);
+	EXPECT(sum, 8);
+	EXPECT_ALLOCS(nytl::unused(rcb.call(1)), 1u);
+}
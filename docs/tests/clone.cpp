@@ -1,6 +1,11 @@
 #include "test.hpp"
 #include <nytl/clone.hpp>
 
+#include <memory_resource>
+#include <vector>
+#include <cstdint>
+#include <typeinfo>
+
 // Abstract
 struct CloneBase : public nytl::AbstractCloneable<CloneBase> {
 	virtual int value() const = 0;
@@ -136,4 +141,157 @@ TEST(clone4) {
 	auto b = nytl::cloneMove(a);
 	EXPECT(b->get().size(), 5u);
 	EXPECT(a.vals.empty(), true);
-}
\ No newline at end of file
+}
+
+// memory resources
+// counts the allocations and checks deallocations match them
+class CountingResource : public std::pmr::memory_resource {
+public:
+	int allocations {};
+	int deallocations {};
+	std::size_t bytes {};
+
+protected:
+	void* do_allocate(std::size_t size, std::size_t align) override {
+		++allocations;
+		bytes += size;
+		return std::pmr::new_delete_resource()->allocate(size, align);
+	}
+
+	void do_deallocate(void* p, std::size_t size, std::size_t align) override {
+		++deallocations;
+		bytes -= size;
+		std::pmr::new_delete_resource()->deallocate(p, size, align);
+	}
+
+	bool do_is_equal(const memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+};
+
+struct alignas(64) AlignedDerived : public nytl::DeriveCloneable<AlignedDerived, CloneBase> {
+	int value_ {};
+	int value() const override { return value_; }
+};
+
+TEST(clone_resource) {
+	CountingResource res;
+	auto derived = CloneDerived {};
+	derived.value_ = 42;
+	auto& base = static_cast<CloneBase&>(derived);
+
+	{
+		auto copy = nytl::clone(base, res);
+		EXPECT(copy->value(), 42);
+		EXPECT(res.allocations, 1);
+		EXPECT(res.bytes, sizeof(CloneDerived));
+
+		auto aligned = AlignedDerived {};
+		aligned.value_ = 7;
+		auto acopy = nytl::clone(static_cast<const CloneBase&>(aligned), res);
+		EXPECT(acopy->value(), 7);
+		EXPECT(reinterpret_cast<std::uintptr_t>(acopy.get()) % 64, 0u);
+
+		// non-abstract base
+		auto derived3 = CloneDerived3 {};
+		derived3.value3_ = 22;
+		auto copy3 = nytl::clone(static_cast<CloneBase2&>(derived3), res);
+		EXPECT(dynamic_cast<CloneDerived3&>(*copy3).value3_, 22);
+		EXPECT(res.allocations, 3);
+	}
+
+	EXPECT(res.deallocations, 3);
+	EXPECT(res.bytes, 0u);
+
+	// moving
+	Derived4 a {};
+	a.vals = {1, 2, 3};
+	auto b = nytl::cloneMove(static_cast<Base4&>(a), res);
+	EXPECT(b->get().size(), 3u);
+	EXPECT(a.vals.empty(), true);
+}
+
+TEST(clone_arena) {
+	alignas(64) unsigned char buffer[1024];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+		std::pmr::null_memory_resource());
+
+	auto derived = CloneDerived {};
+	std::vector<nytl::ResourcePtr<CloneBase>> copies;
+	for(auto i = 0; i < 10; ++i) {
+		derived.value_ = i;
+		copies.push_back(nytl::clone(static_cast<const CloneBase&>(derived), arena));
+	}
+
+	for(auto i = 0; i < 10; ++i) {
+		auto addr = reinterpret_cast<unsigned char*>(copies[i].get());
+		EXPECT(addr >= buffer && addr < buffer + sizeof(buffer), true);
+		EXPECT(copies[i]->value(), i);
+	}
+
+	// the arena is exhausted at some point
+	ERROR(for(auto i = 0; i < 100; ++i) nytl::clone(derived, arena), std::bad_alloc);
+}
+
+TEST(clone_all) {
+	std::vector<std::unique_ptr<CloneBase>> objects;
+	for(auto i = 0; i < 30; ++i) {
+		if(i % 3 == 0) {
+			auto obj = std::make_unique<CloneDerived>();
+			obj->value_ = i;
+			objects.push_back(std::move(obj));
+		} else if(i % 3 == 1) {
+			auto obj = std::make_unique<AlignedDerived>();
+			obj->value_ = i;
+			objects.push_back(std::move(obj));
+		} else {
+			auto obj = std::make_unique<CloneDerived4>();
+			obj->value_ = i;
+			obj->value3_ = 2 * i;
+			objects.push_back(std::move(obj));
+		}
+	}
+	objects.push_back(nullptr);
+
+	auto copies = nytl::cloneAll(objects);
+	EXPECT(copies.size(), objects.size());
+	EXPECT(copies.pools(), 3u);
+	EXPECT(copies[30] == nullptr, true);
+
+	for(auto i = 0u; i < 30u; ++i) {
+		EXPECT(copies[i] != objects[i].get(), true);
+		EXPECT(copies[i]->value(), int(i));
+		EXPECT(typeid(*copies[i]) == typeid(*objects[i]), true);
+		EXPECT(reinterpret_cast<std::uintptr_t>(copies[i]) % alignof(CloneBase), 0u);
+	}
+
+	// clones of one type are stored contiguously
+	auto a0 = dynamic_cast<AlignedDerived*>(copies[1]);
+	auto a1 = dynamic_cast<AlignedDerived*>(copies[4]);
+	EXPECT(a1 - a0, 1);
+	EXPECT(reinterpret_cast<std::uintptr_t>(a0) % 64, 0u);
+
+	// the base subobject is not at the start of CloneDerived4
+	auto d4 = dynamic_cast<CloneDerived4*>(copies[29]);
+	EXPECT(d4 - dynamic_cast<CloneDerived4*>(copies[2]), 9);
+	EXPECT(d4->value3_, 58);
+
+	// plain pointers and non-abstract bases
+	auto derived2 = CloneDerived2 {};
+	derived2.value2_ = 1;
+	auto derived3 = CloneDerived3 {};
+	derived3.value3_ = 3;
+	auto base2 = CloneBase2 {};
+	std::vector<const CloneBase2*> ptrs {&derived2, &derived3, &base2, &derived3};
+
+	auto moved = nytl::cloneAll(ptrs);
+	auto copies2 = std::move(moved);
+	EXPECT(copies2.size(), 4u);
+	EXPECT(copies2.pools(), 3u);
+	EXPECT(dynamic_cast<CloneDerived2&>(*copies2[0]).value2_, 1);
+	EXPECT(dynamic_cast<CloneDerived3&>(*copies2[3]).value3_, 3);
+	EXPECT(typeid(*copies2[2]) == typeid(CloneBase2), true);
+
+	auto empty = nytl::cloneAll(std::vector<CloneBase*> {});
+	EXPECT(empty.empty(), true);
+}
@@ -0,0 +1,84 @@
+// tests the checking policies from nytl/contracts.hpp
+// the policy must be selected before any nytl header is included
+#define NYTL_CONTRACTS NYTL_CONTRACTS_THROW
+
+#include "test.hpp"
+#include <nytl/contracts.hpp>
+#include <nytl/span.hpp>
+#include <nytl/vec.hpp>
+#include <nytl/mat.hpp>
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+TEST(expects) {
+	auto ok = false;
+	NYTL_EXPECTS(1 + 1 == 2);
+	ERROR(NYTL_EXPECTS(1 + 1 == 3), nytl::ContractViolation);
+
+	try {
+		NYTL_EXPECTS(ok);
+	} catch(const nytl::ContractViolation& err) {
+		EXPECT(std::string(err.expression), "ok");
+		EXPECT(err.line > 0u, true);
+		EXPECT(std::string(err.what()).find("contracts.cpp") != std::string::npos, true);
+		ok = true;
+	}
+
+	EXPECT(ok, true);
+}
+
+TEST(span) {
+	std::vector<int> values {1, 2, 3, 4};
+	auto s = nytl::span(values);
+	EXPECT(s[3], 4);
+	ERROR(s[4], nytl::ContractViolation);
+	ERROR(s[-1], nytl::ContractViolation);
+	ERROR(s.first(5), nytl::ContractViolation);
+	ERROR(s.subspan(3, 2), nytl::ContractViolation);
+	ERROR((nytl::Span<int, 3>(values.data(), 4)), nytl::ContractViolation);
+
+	// checked iterators
+	auto it = s.begin();
+	it += 4;
+	EXPECT(it == s.end(), true);
+	ERROR(*it, nytl::ContractViolation);
+	ERROR(++it, nytl::ContractViolation);
+	ERROR(s.begin() - 1, nytl::ContractViolation);
+	ERROR(s.begin() == s.subspan(1).begin(), nytl::ContractViolation);
+
+	auto sum = 0;
+	for(auto v : s) sum += v;
+	EXPECT(sum, 10);
+
+	std::reverse(s.begin(), s.end());
+	EXPECT(values.front(), 4);
+	EXPECT(std::count(s.cbegin(), s.cend(), 4), 1);
+	EXPECT(*s.rbegin(), 1);
+}
+
+TEST(vec) {
+	nytl::Vec3f v3 {1.f, 2.f, 3.f};
+	nytl::Vec2i v2 {1, 2};
+	nytl::Vec4d v4 {1.0, 2.0, 3.0, 4.0};
+
+	EXPECT(v3[2], 3.f);
+	EXPECT(v2[1], 2);
+	ERROR(v3[3], nytl::ContractViolation);
+	ERROR(v2[2], nytl::ContractViolation);
+	ERROR(v4.at(4), std::out_of_range);
+}
+
+TEST(mat) {
+	nytl::Mat<2, 3, double> m {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+	const auto& cm = m;
+
+	EXPECT(m[1][2], 6.0);
+	EXPECT(cm.at(1), (nytl::Vec3d{4.0, 5.0, 6.0}));
+	ERROR(m[2], nytl::ContractViolation);
+	ERROR(cm[2], nytl::ContractViolation);
+	ERROR(m.at(2), std::out_of_range);
+	ERROR(cm.at(2), std::out_of_range);
+}
@@ -0,0 +1,229 @@
+#include "test.hpp"
+#include <nytl/damageTracker.hpp>
+#include <nytl/rectOps.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace nytl;
+
+namespace {
+
+constexpr auto width = 200;
+constexpr auto height = 120;
+
+// pixel mask of the given rects
+std::vector<bool> rasterize(Span<const Rect2i> rects) {
+	std::vector<bool> ret(width * height);
+	for(auto& rect : rects) {
+		for(auto y = rect.position.y; y < rect.position.y + rect.size.y; ++y) {
+			for(auto x = rect.position.x; x < rect.position.x + rect.size.x; ++x) {
+				EXPECT(x >= 0 && x < width && y >= 0 && y < height, true);
+				ret[y * width + x] = true;
+			}
+		}
+	}
+	return ret;
+}
+
+// whether every pixel of a is in b
+bool covered(const std::vector<bool>& a, const std::vector<bool>& b) {
+	for(auto i = 0u; i < a.size(); ++i) {
+		if(a[i] && !b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::size_t count(const std::vector<bool>& pixels) {
+	return std::count(pixels.begin(), pixels.end(), true);
+}
+
+// random frames, the damage must cover all rects of the last age frames
+void checkCoverage(const DamageSettings& settings) {
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> pos(-20, 210);
+	std::uniform_int_distribution<int> size(0, 30);
+
+	DamageTracker<int> tracker({width, height}, settings);
+	tracker.nextFrame();
+	tracker.nextFrame();
+	tracker.nextFrame();
+
+	std::vector<std::vector<Rect2i>> frames;
+	for(auto f = 0u; f < 40; ++f) {
+		frames.emplace_back();
+		for(auto i = 0u; i < 1 + rng() % 20; ++i) {
+			Rect2i rect {{pos(rng), pos(rng)}, {size(rng), size(rng)}};
+			tracker.add(rect);
+			if(intersectsReal(rect, Rect2i{{}, {width, height}})) {
+				frames.back().push_back(intersection(rect, Rect2i{{}, {width, height}}));
+			}
+		}
+
+		for(auto age = 1u; age <= settings.maxAge; ++age) {
+			std::vector<Rect2i> expected;
+			for(auto i = 0u; i < age && i < frames.size(); ++i) {
+				auto& frame = frames[frames.size() - 1 - i];
+				expected.insert(expected.end(), frame.begin(), frame.end());
+			}
+
+			auto damage = tracker.damage(age);
+			EXPECT(covered(rasterize(expected), rasterize(damage)), true);
+			if(settings.mode == DamageMode::rects) {
+				EXPECT(damage.size() <= settings.maxRects, true);
+			} else {
+				// tiles don't overlap
+				auto pixels = std::size_t(0);
+				for(auto& rect : damage) {
+					pixels += rect.size.x * rect.size.y;
+				}
+				EXPECT(pixels, count(rasterize(damage)));
+			}
+		}
+
+		tracker.nextFrame();
+	}
+}
+
+} // anon namespace
+
+TEST(merge) {
+	DamageSettings settings;
+	settings.rectCost = 100;
+	DamageTracker<int> tracker({width, height}, settings);
+	tracker.nextFrame();
+
+	// adjacent rects are merged, far away ones not
+	tracker.add({{10, 10}, {10, 10}});
+	tracker.add({{20, 10}, {10, 10}});
+	tracker.add({{100, 100}, {10, 10}});
+	auto damage = tracker.damage(1);
+	EXPECT(damage.size(), 2u);
+	EXPECT(damage[0], (Rect2i{{10, 10}, {20, 10}}));
+	EXPECT(damage[1], (Rect2i{{100, 100}, {10, 10}}));
+
+	// contained rects are ignored, wasting less than rectCost merges
+	tracker.add({{12, 12}, {5, 5}});
+	tracker.add({{30, 10}, {9, 11}});
+	damage = tracker.damage(1);
+	EXPECT(damage.size(), 2u);
+	EXPECT(damage[1], (Rect2i{{10, 10}, {29, 11}}));
+
+	// clipped
+	tracker.add({{-10, -10}, {15, 12}});
+	tracker.add({{300, 0}, {10, 10}});
+	damage = tracker.damage(1);
+	EXPECT(damage.size(), 3u);
+	EXPECT(damage[2], (Rect2i{{0, 0}, {5, 2}}));
+
+	// merged with the rect wasting the least area
+	settings.maxRects = 2;
+	settings.rectCost = 0;
+	DamageTracker<int> limited({width, height}, settings);
+	limited.nextFrame();
+	limited.add({{0, 0}, {10, 10}});
+	limited.add({{100, 100}, {10, 10}});
+	limited.add({{0, 20}, {10, 10}});
+	damage = limited.damage(1);
+	EXPECT(damage.size(), 2u);
+	EXPECT(damage[0], (Rect2i{{100, 100}, {10, 10}}));
+	EXPECT(damage[1], (Rect2i{{0, 0}, {10, 30}}));
+}
+
+TEST(age) {
+	DamageTracker<int> tracker({width, height});
+	Rect2i full {{}, {width, height}};
+
+	// unknown contents
+	EXPECT(tracker.damage(1)[0], full);
+	tracker.nextFrame();
+	tracker.add({{0, 0}, {1, 1}});
+	EXPECT(tracker.damage(1).size(), 1u);
+	EXPECT(tracker.damage(1)[0], (Rect2i{{0, 0}, {1, 1}}));
+	EXPECT(tracker.damage(2)[0], full);
+	EXPECT(tracker.damage(0)[0], full);
+
+	tracker.nextFrame();
+	tracker.add({{100, 100}, {1, 1}});
+	EXPECT(tracker.damage(1).size(), 1u);
+	EXPECT(tracker.damage(2).size(), 2u);
+	EXPECT(tracker.damage(3)[0], full);
+
+	tracker.nextFrame();
+	EXPECT(tracker.damage(1).size(), 0u);
+	EXPECT(tracker.damage(2).size(), 1u);
+	EXPECT(tracker.damage(3).size(), 2u);
+	EXPECT(tracker.damage(4)[0], full);
+
+	tracker.addAll();
+	EXPECT(tracker.damage(1)[0], full);
+	tracker.nextFrame();
+	EXPECT(tracker.damage(1).size(), 0u);
+	EXPECT(tracker.damage(2)[0], full);
+
+	tracker.resize({50, 50});
+	EXPECT(tracker.damage(1)[0], (Rect2i{{}, {50, 50}}));
+}
+
+TEST(tiles) {
+	DamageSettings settings;
+	settings.mode = DamageMode::tiles;
+	settings.tileSize = 16;
+	DamageTracker<int> tracker({width, height}, settings);
+	tracker.nextFrame();
+
+	tracker.add({{1, 1}, {2, 2}});
+	tracker.add({{20, 5}, {30, 1}});
+	tracker.add({{190, 100}, {100, 100}});
+	auto damage = tracker.damage(1);
+	EXPECT(damage.size(), 2u);
+	EXPECT(damage[0], (Rect2i{{0, 0}, {64, 16}}));
+	EXPECT(damage[1], (Rect2i{{176, 96}, {24, 24}}));
+
+	// equal runs in consecutive rows are combined
+	tracker.nextFrame();
+	tracker.add({{16, 16}, {32, 40}});
+	damage = tracker.damage(1);
+	EXPECT(damage.size(), 1u);
+	EXPECT(damage[0], (Rect2i{{16, 16}, {32, 48}}));
+	EXPECT(tracker.damage(2).size(), 3u);
+}
+
+TEST(coverage) {
+	DamageSettings settings;
+	checkCoverage(settings);
+	settings.rectCost = 0;
+	settings.maxRects = 4;
+	checkCoverage(settings);
+	settings.mode = DamageMode::tiles;
+	settings.tileSize = 8;
+	checkCoverage(settings);
+	settings.tileSize = 100;
+	checkCoverage(settings);
+}
+
+TEST(allocations) {
+	for(auto mode : {DamageMode::rects, DamageMode::tiles}) {
+		DamageSettings settings;
+		settings.mode = mode;
+		DamageTracker<int> tracker({1920, 1080}, settings);
+		auto frame = [&](int i) {
+			tracker.add({{i, 10}, {40, 20}});
+			tracker.add({{500, i}, {8, 16}});
+			tracker.add({{3 * i, 2 * i}, {100, 100}});
+			for(auto j = 0; j < 30; ++j) {
+				tracker.add({{50 * j, 1000}, {10, 10}});
+			}
+			auto damage = tracker.damage(1 + i % 3);
+			tracker.nextFrame();
+			return damage.size();
+		};
+
+		frame(0);
+		for(auto i = 1; i < 10; ++i) {
+			EXPECT_ALLOCS(frame(i), 0u);
+		}
+	}
+}
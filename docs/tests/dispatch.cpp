@@ -0,0 +1,119 @@
+#include "test.hpp"
+#include <nytl/dispatch.hpp>
+#include <nytl/batchOps.hpp>
+#include <nytl/approx.hpp>
+#include <nytl/utf.hpp>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace nytl;
+
+// all levels compiled and supported on the running cpu
+std::vector<Isa> levels() {
+	std::vector<Isa> ret;
+	for(auto i = 0u; i < isaCount; ++i) {
+		auto isa = static_cast<Isa>(i);
+		if(compiled(isa) && supported(isa)) {
+			ret.push_back(isa);
+		}
+	}
+	return ret;
+}
+
+// returns the width it was compiled for
+struct WidthKernel {
+	template<std::size_t Bytes>
+	static std::size_t run(int) { return Bytes; }
+};
+
+TEST(selection) {
+	EXPECT(compiled(Isa::scalar), true);
+	EXPECT(supported(Isa::scalar), true);
+	EXPECT(compiled(nativeIsa), true);
+	EXPECT(supported(nativeIsa), true);
+	EXPECT(compiled(isa()), true);
+	EXPECT(supported(isa()), true);
+	EXPECT(std::strcmp(name(Isa::avx2), "avx2"), 0);
+
+	// the selected level is the widest one unless forced
+	if(!std::getenv("NYTL_ISA")) {
+		for(auto level : levels()) {
+			EXPECT(isaBytes(level) <= isaBytes(isa()), true);
+		}
+	}
+
+	using D = Dispatch<WidthKernel, std::size_t(int)>;
+	EXPECT(D::call(0), isaBytes(isa()));
+	for(auto i = 0u; i < isaCount; ++i) {
+		auto level = static_cast<Isa>(i);
+		auto func = D::get(level);
+		EXPECT(func != nullptr, compiled(level) && supported(level));
+		if(func) {
+			EXPECT(func(0), isaBytes(level));
+		}
+	}
+}
+
+// every level computes bitwise equal results
+TEST(batch) {
+	std::vector<Vec3f> points;
+	for(auto i = 0u; i < 103; ++i) {
+		points.push_back({0.5f * i, 1.f - i, 1.f + 0.25f * i});
+	}
+
+	detail::BatchMat<float> m {
+		0.f, -2.f, 0.f, 1.f,
+		1.f, 0.f, 0.5f, -3.f,
+		0.f, 0.f, 3.f, 2.f,
+		0.f, 0.f, 1.f, 4.f,
+	};
+
+	using Kernel = detail::BatchTransformKernel<true, float>;
+	using Sig = void(const detail::BatchMat<float>&, const Vec3f*, Vec3f*, size_t);
+	std::vector<Vec3f> expected(points.size());
+	Dispatch<Kernel, Sig>::get(Isa::scalar)(m, points.data(), expected.data(),
+		points.size());
+
+	for(auto level : levels()) {
+		std::vector<Vec3f> out(points.size());
+		Dispatch<Kernel, Sig>::get(level)(m, points.data(), out.data(), points.size());
+		EXPECT(std::memcmp(out.data(), expected.data(), out.size() * sizeof(Vec3f)), 0);
+	}
+}
+
+TEST(approx) {
+	std::vector<double> a, b;
+	for(auto i = 0u; i < 77; ++i) {
+		a.push_back(1.0 + i);
+		b.push_back(1.0 + i + 1e-12 * i);
+	}
+	b[61] += 0.5;
+
+	using Kernel = detail::ApproxCompareKernel<ApproxMode::mixed, true, double>;
+	using Sig = void(const double*, const double*, std::size_t, double, ApproxResult&);
+	for(auto level : levels()) {
+		ApproxResult res;
+		Dispatch<Kernel, Sig>::get(level)(a.data(), b.data(), a.size(), 1e-9, res);
+		EXPECT(res.mismatch, 61u);
+		EXPECT(res.maxAbsError, approx(0.5));
+	}
+}
+
+TEST(utf) {
+	std::string text;
+	for(auto i = 0u; i < 50; ++i) {
+		text += "aä€😀";
+	}
+
+	using Sig = std::size_t(const char*, std::size_t);
+	for(auto level : levels()) {
+		auto func = Dispatch<detail::CharCountKernel, Sig>::get(level);
+		EXPECT(func(text.data(), text.size()), 200u);
+		EXPECT(func(text.data() + 1, text.size() - 11), 195u);
+	}
+
+	EXPECT(charCount(text), 200u);
+	EXPECT(charCount("ä€"), 2u);
+}
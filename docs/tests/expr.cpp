@@ -0,0 +1,90 @@
+#include "test.hpp"
+#include <nytl/expr.hpp>
+#include <nytl/vec.hpp>
+#include <nytl/mat.hpp>
+#include <nytl/approx.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <type_traits>
+
+using nytl::expr::lazy;
+using namespace nytl;
+
+template<typename A, typename B> using AddT =
+	std::void_t<decltype(std::declval<A>() + std::declval<B>())>;
+template<typename A, typename B> using MulT =
+	std::void_t<decltype(std::declval<A>() * std::declval<B>())>;
+
+using LazyVec3f = decltype(lazy(std::declval<const Vec3f&>()));
+using LazyMat2f = decltype(lazy(std::declval<const Mat2f&>()));
+
+static_assert(validExpression<AddT, LazyVec3f, Vec3f>);
+static_assert(validExpression<AddT, Vec3f, LazyVec3f>);
+static_assert(validExpression<MulT, LazyVec3f, float>);
+static_assert(validExpression<MulT, double, LazyMat2f>);
+static_assert(!validExpression<AddT, LazyVec3f, Vec2f>);
+static_assert(!validExpression<AddT, LazyMat2f, LazyVec3f>);
+static_assert(!validExpression<AddT, LazyVec3f, float>);
+
+constexpr Vec3f a {1.f, 2.f, 3.f};
+constexpr Vec3f b {-1.f, 0.5f, 4.f};
+constexpr Vec3f c {2.f, 2.f, 2.f};
+
+TEST(vec) {
+	// constexpr evaluation
+	constexpr Vec3f ce = lazy(a) + lazy(b) * 2.f - c;
+	static_assert(ce == Vec3f{-3.f, 1.f, 9.f});
+	static_assert(expr::eval(-lazy(a) / 2.f) == Vec3f{-0.5f, -1.f, -1.5f});
+
+	Vec3f r = lazy(a) + lazy(b) * 2.f - c;
+	EXPECT(r, nytl::approx(a + 2.f * b - c));
+	EXPECT(expr::eval(2 * lazy(a) - b), nytl::approx(2 * a - b));
+
+	// the result type is the one of the eager operators
+	auto d = expr::eval(lazy(a) + Vec3d{1.0, 1.0, 1.0});
+	static_assert(std::is_same_v<decltype(d), Vec3d>);
+	EXPECT(d, nytl::approx(Vec3d{2.0, 3.0, 4.0}));
+
+	auto i = expr::eval(lazy(Vec<5, int>{1, 2, 3, 4, 5}) * 3 - Vec<5, int>{3, 3, 3, 3, 3});
+	EXPECT(i, (Vec<5, int>{0, 3, 6, 9, 12}));
+}
+
+TEST(assign) {
+	auto v = a;
+	expr::assign(v, lazy(v) * 2.f + v); // aliasing is fine
+	EXPECT(v, nytl::approx(Vec3f{3.f, 6.f, 9.f}));
+
+	auto& ret = expr::assign(v, -lazy(c));
+	EXPECT(&ret, &v);
+	EXPECT(v, nytl::approx(-c));
+
+	Vec<64, float> big {};
+	Vec<64, float> ones {};
+	for(auto j = 0u; j < 64; ++j) {
+		big[j] = j;
+		ones[j] = 1.f;
+	}
+
+	expr::assign(big, lazy(big) - ones + lazy(big) * 0.5f);
+	EXPECT(big[0], nytl::approx(-1.f));
+	EXPECT(big[63], nytl::approx(63.f * 1.5f - 1.f));
+}
+
+TEST(mat) {
+	constexpr Mat2f m {1.f, 2.f, 3.f, 4.f};
+	constexpr Mat2f id {1.f, 0.f, 0.f, 1.f};
+
+	constexpr Mat2f ce = lazy(m) * 2.f - id;
+	static_assert(ce == Mat2f{1.f, 4.f, 6.f, 7.f});
+
+	Mat2f r = lazy(m) + m - 3 * lazy(id);
+	EXPECT(r, (2 * m - 3 * id));
+
+	auto d = expr::eval(lazy(m) / 2.0);
+	static_assert(std::is_same_v<decltype(d), Mat2d>);
+	EXPECT(d, (Mat2d{0.5, 1.0, 1.5, 2.0}));
+
+	auto n = m;
+	expr::assign(n, lazy(n) + lazy(n) - m);
+	EXPECT(n, m);
+}
@@ -0,0 +1,309 @@
+#include "test.hpp"
+#include <nytl/fastMath.hpp>
+#include <nytl/vecOps.hpp>
+#include <nytl/approx.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace nytl;
+
+namespace {
+
+constexpr auto inf = std::numeric_limits<float>::infinity();
+constexpr auto qnan = std::numeric_limits<float>::quiet_NaN();
+
+// count values evenly spread over [lo, hi]
+std::vector<float> range(float lo, float hi, unsigned count = 100000) {
+	std::vector<float> ret(count);
+	for(auto i = 0u; i < count; ++i) {
+		ret[i] = lo + (hi - lo) * (double(i) / (count - 1));
+	}
+	return ret;
+}
+
+// maximum absolute (or relative) error of the given function
+template<typename F, typename R>
+double maxError(const std::vector<float>& values, F func, R ref,
+		bool relative = false) {
+	auto ret = 0.0;
+	for(auto val : values) {
+		double expected = ref(double(val));
+		double err = std::abs(func(val) - expected);
+		ret = std::max(ret, relative ? err / std::abs(expected) : err);
+	}
+	return ret;
+}
+
+bool bitwiseEqual(float a, float b) {
+	return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Equal up to the last bits. Those differ where g++ uses fma instructions
+// for the single values, e.g. with -march=native (see nytl/fastMath.hpp).
+bool close(float a, float b) {
+	return bitwiseEqual(a, b) ||
+		std::abs(a - b) <= 1e-6f * std::max(1.f, std::abs(b));
+}
+
+bool close(const std::vector<float>& a, const std::vector<float>& b) {
+	if(a.size() != b.size()) {
+		return false;
+	}
+
+	for(auto i = 0u; i < a.size(); ++i) {
+		if(!close(a[i], b[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool close(const Vec3f& a, const Vec3f& b) {
+	return close(a.x, b.x) && close(a.y, b.y) && close(a.z, b.z);
+}
+
+} // anon namespace
+
+// the documented maximum errors
+TEST(accuracy) {
+	auto fsin = [](float x) { return fast::sin(x); };
+	auto fcos = [](float x) { return fast::cos(x); };
+	auto dsin = [](double x) { return std::sin(x); };
+	auto dcos = [](double x) { return std::cos(x); };
+	EXPECT(maxError(range(-4096.f, 4096.f), fsin, dsin) < 2e-7, true);
+	EXPECT(maxError(range(-4096.f, 4096.f), fcos, dcos) < 2e-7, true);
+	EXPECT(maxError(range(-1e5f, 1e5f), fsin, dsin) < 2e-6, true);
+	EXPECT(maxError(range(-1e5f, 1e5f), fcos, dcos) < 2e-6, true);
+
+	auto fexp = [](float x) { return fast::exp(x); };
+	auto dexp = [](double x) { return std::exp(x); };
+	EXPECT(maxError(range(-87.3f, 88.7f), fexp, dexp, true) < 2e-7, true);
+
+	auto flog = [](float x) { return fast::log(x); };
+	auto dlog = [](double x) { return std::log(x); };
+	EXPECT(maxError(range(0.5f, 2.f), flog, dlog) < 1e-7, true);
+	EXPECT(maxError(range(2.f, 1e6f), flog, dlog, true) < 1e-7, true);
+	EXPECT(maxError(range(1e-6f, 0.5f), flog, dlog, true) < 1e-7, true);
+	EXPECT(maxError(range(1e-44f, 1e-38f), flog, dlog, true) < 1e-7, true);
+
+	// gamma correction, |y * ln(x)| < 3.2
+	auto fpow = [](float x) { return fast::pow(x, 1 / 2.2f); };
+	auto dpow = [](double x) { return std::pow(x, double(1 / 2.2f)); };
+	EXPECT(maxError(range(1e-3f, 1.f), fpow, dpow, true) < 9e-7, true);
+
+	auto facos = [](float x) { return fast::acos(x); };
+	auto dacos = [](double x) { return std::acos(x); };
+	EXPECT(maxError(range(-1.f, 1.f), facos, dacos) < 5e-7, true);
+
+	auto frsqrt = [](float x) { return fast::rsqrt(x); };
+	auto drsqrt = [](double x) { return 1 / std::sqrt(x); };
+	EXPECT(maxError(range(1e-3f, 1e3f), frsqrt, drsqrt, true) < 5e-6, true);
+	EXPECT(maxError(range(1e-30f, 1e-20f), frsqrt, drsqrt, true) < 5e-6, true);
+
+	// atan2 around the unit circle and along lines
+	auto err = 0.0;
+	for(auto a : range(-3.1415f, 3.1415f)) {
+		float y = 3.f * std::sin(a), x = 3.f * std::cos(a);
+		err = std::max(err, std::abs(fast::atan2(y, x) -
+			std::atan2(double(y), double(x))));
+	}
+	for(auto v : range(-100.f, 100.f)) {
+		err = std::max(err, std::abs(fast::atan2(v, 1.f) - std::atan2(v, 1.0)));
+		err = std::max(err, std::abs(fast::atan2(-1.f, v) - std::atan2(-1.0, v)));
+	}
+	EXPECT(err < 3e-7, true);
+
+	// the array versions have the same bounds
+	auto angles = range(-4096.f, 4096.f);
+	std::vector<float> out(angles.size());
+	fast::sin(angles, out);
+	err = 0.0;
+	for(auto i = 0u; i < angles.size(); ++i) {
+		err = std::max(err, std::abs(out[i] - std::sin(double(angles[i]))));
+	}
+	EXPECT(err < 2e-7, true);
+
+	auto exps = range(-87.3f, 88.7f);
+	fast::exp(exps, out);
+	err = 0.0;
+	for(auto i = 0u; i < exps.size(); ++i) {
+		auto expected = std::exp(double(exps[i]));
+		err = std::max(err, std::abs(out[i] - expected) / expected);
+	}
+	EXPECT(err < 2e-7, true);
+
+	// normalize
+	err = 0.0;
+	for(auto v : range(-100.f, 100.f, 1000)) {
+		auto n = fast::normalized(Vec3f {v, 1.f - 0.3f * v, 0.01f * v * v});
+		auto l = std::sqrt(double(n.x) * n.x + double(n.y) * n.y + double(n.z) * n.z);
+		err = std::max(err, std::abs(l - 1.0));
+	}
+	EXPECT(err < 5e-6, true);
+	EXPECT(std::abs(fast::length(Vec3f {3.f, 4.f, 12.f}) - 13.f) < 13 * 5e-6, true);
+}
+
+TEST(special) {
+	EXPECT(std::isnan(fast::sin(inf)), true);
+	EXPECT(std::isnan(fast::cos(-inf)), true);
+	EXPECT(std::isnan(fast::sin(qnan)), true);
+	EXPECT(bitwiseEqual(fast::sin(0.f), 0.f), true);
+	EXPECT(fast::cos(0.f), 1.f);
+
+	EXPECT(fast::exp(0.f), 1.f);
+	EXPECT(fast::exp(100.f), inf);
+	EXPECT(fast::exp(inf), inf);
+	EXPECT(fast::exp(-100.f), 0.f);
+	EXPECT(fast::exp(-inf), 0.f);
+	EXPECT(std::isnan(fast::exp(qnan)), true);
+
+	EXPECT(fast::log(1.f), 0.f);
+	EXPECT(fast::log(0.f), -inf);
+	EXPECT(fast::log(-0.f), -inf);
+	EXPECT(fast::log(inf), inf);
+	EXPECT(std::isnan(fast::log(-1.f)), true);
+	EXPECT(std::isnan(fast::log(qnan)), true);
+	EXPECT(fast::pow(0.f, 2.f), 0.f);
+
+	EXPECT(fast::acos(1.f), 0.f);
+	EXPECT(std::isnan(fast::acos(1.5f)), true);
+	EXPECT(std::isnan(fast::acos(qnan)), true);
+
+	// signed zeros like std::atan2
+	for(auto y : {0.f, -0.f, 1.f, -1.f}) {
+		for(auto x : {0.f, -0.f, 1.f, -1.f, inf, -inf}) {
+			EXPECT(fast::atan2(y, x), approx(std::atan2(y, x)));
+			EXPECT(std::signbit(fast::atan2(y, x)), std::signbit(y));
+		}
+	}
+
+	EXPECT(fast::normalized(Vec3f {0.f, 0.f, 0.f}), (Vec3f {0.f, 0.f, 0.f}));
+}
+
+// vecs and arrays compute the same as the single value versions
+TEST(consistency) {
+	auto values = range(-20.f, 20.f, 1001);
+	auto positive = range(1e-3f, 100.f, 1001);
+	auto unit = range(-1.f, 1.f, 1001);
+	auto count = values.size();
+
+	std::vector<float> out(count), out2(count), expected(count), expected2(count);
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::sin(values[i]);
+	fast::sin(values, out);
+	EXPECT(close(out, expected), true);
+
+	for(auto i = 0u; i < count; ++i) expected2[i] = fast::cos(values[i]);
+	fast::cos(values, out2);
+	EXPECT(close(out2, expected2), true);
+	fast::sincos(values, out, out2);
+	EXPECT(close(out, expected), true);
+	EXPECT(close(out2, expected2), true);
+
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::exp(values[i]);
+	fast::exp(values, out);
+	EXPECT(close(out, expected), true);
+
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::log(positive[i]);
+	fast::log(positive, out);
+	EXPECT(close(out, expected), true);
+
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::pow(positive[i], 2.2f);
+	fast::pow(positive, 2.2f, out);
+	EXPECT(close(out, expected), true);
+
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::pow(positive[i], unit[i]);
+	fast::pow(positive, unit, out);
+	EXPECT(close(out, expected), true);
+
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::atan2(unit[i], values[i]);
+	fast::atan2(unit, values, out);
+	EXPECT(close(out, expected), true);
+
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::acos(unit[i]);
+	fast::acos(unit, out);
+	EXPECT(close(out, expected), true);
+
+	// in place
+	out = values;
+	fast::exp(out, out);
+	for(auto i = 0u; i < count; ++i) expected[i] = fast::exp(values[i]);
+	EXPECT(close(out, expected), true);
+
+	// vecs
+	Vec<7, float> v7 {-3.f, 0.5f, 2.f, 11.f, 0.f, -0.25f, 6.f};
+	auto s7 = fast::sin(v7);
+	auto e7 = fast::exp(v7);
+	auto p7 = fast::pow(fast::exp(v7), 0.5f);
+	auto a7 = fast::atan2(v7, Vec<7, float>(s7));
+	Vec<7, float> c7, ss7;
+	fast::sincos(v7, ss7, c7);
+	for(auto i = 0u; i < 7; ++i) {
+		EXPECT(close(s7[i], fast::sin(v7[i])), true);
+		EXPECT(close(ss7[i], fast::sin(v7[i])), true);
+		EXPECT(close(c7[i], fast::cos(v7[i])), true);
+		EXPECT(close(e7[i], fast::exp(v7[i])), true);
+		EXPECT(close(p7[i], fast::pow(fast::exp(v7[i]), 0.5f)), true);
+		EXPECT(close(a7[i], fast::atan2(v7[i], s7[i])), true);
+	}
+
+	Vec2f v2 {0.25f, -0.75f};
+	EXPECT(close(fast::acos(v2)[1], fast::acos(-0.75f)), true);
+	EXPECT(close(fast::log(v2)[0], fast::log(0.25f)), true);
+	EXPECT(close(fast::cos(v2)[1], fast::cos(-0.75f)), true);
+	EXPECT(close(fast::pow(v2, Vec2f {2.f, 3.f})[0],
+		fast::pow(0.25f, 2.f)), true);
+
+	// normalize
+	std::vector<Vec3f> vecs;
+	for(auto i = 0u; i < 101; ++i) {
+		vecs.push_back({0.5f * i, 1.f - i, 1.f + 0.25f * i});
+	}
+
+	std::vector<Vec3f> normed(vecs.size());
+	fast::normalized(vecs, normed);
+	auto inPlace = vecs;
+	fast::normalize(inPlace);
+	for(auto i = 0u; i < vecs.size(); ++i) {
+		auto single = fast::normalized(vecs[i]);
+		EXPECT(close(single, normed[i]), true);
+		EXPECT(close(single, inPlace[i]), true);
+		EXPECT(normed[i], approx(normalized(vecs[i]), 1e-5));
+	}
+}
+
+// every instruction set computes the same results
+TEST(dispatch) {
+	auto values = range(-500.f, 500.f, 1003);
+	auto count = values.size();
+
+	using Sig = void(const float*, const float*, float, float*, float*, std::size_t);
+	using D = Dispatch<fast::detail::MapKernel<fast::detail::SinCosOp>, Sig>;
+	using DP = Dispatch<fast::detail::MapKernel<fast::detail::PowOp<1>>, Sig>;
+	using DA = Dispatch<fast::detail::MapKernel<fast::detail::Atan2Op>, Sig>;
+
+	std::vector<float> s(count), c(count), p(count), a(count);
+	D::get(Isa::scalar)(values.data(), nullptr, 0.f, s.data(), c.data(), count);
+	DP::get(Isa::scalar)(values.data(), nullptr, 1.5f, p.data(), nullptr, count);
+	DA::get(Isa::scalar)(values.data(), s.data(), 0.f, a.data(), nullptr, count);
+
+	for(auto i = 0u; i < isaCount; ++i) {
+		auto level = static_cast<Isa>(i);
+		if(!D::get(level)) {
+			continue;
+		}
+
+		std::vector<float> ls(count), lc(count), lp(count), la(count);
+		D::get(level)(values.data(), nullptr, 0.f, ls.data(), lc.data(), count);
+		DP::get(level)(values.data(), nullptr, 1.5f, lp.data(), nullptr, count);
+		DA::get(level)(values.data(), s.data(), 0.f, la.data(), nullptr, count);
+		EXPECT(close(ls, s), true);
+		EXPECT(close(lc, c), true);
+		EXPECT(close(lp, p), true);
+		EXPECT(close(la, a), true);
+	}
+}
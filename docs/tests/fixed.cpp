@@ -0,0 +1,288 @@
+#include "test.hpp"
+#include <nytl/fixed.hpp>
+#include <nytl/batchOps.hpp>
+#include <nytl/matOps.hpp>
+#include <nytl/vecOps.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace nytl;
+
+namespace {
+
+using F = Fixed32;
+constexpr auto eps = 1.0 / 65536; // one step of Fixed32
+
+// all levels compiled and supported on the running cpu
+std::vector<Isa> levels() {
+	std::vector<Isa> ret;
+	for(auto i = 0u; i < isaCount; ++i) {
+		auto isa = static_cast<Isa>(i);
+		if(compiled(isa) && supported(isa)) {
+			ret.push_back(isa);
+		}
+	}
+	return ret;
+}
+
+template<size_t D>
+Vec<D, F> fixed(const Vec<D, double>& vec) {
+	return static_cast<Vec<D, F>>(vec);
+}
+
+template<size_t D>
+Vec<D, double> real(const Vec<D, F>& vec) {
+	return static_cast<Vec<D, double>>(vec);
+}
+
+template<size_t R, size_t C>
+double maxDiff(const Mat<R, C, F>& a, const Mat<R, C, double>& b) {
+	auto ret = 0.0;
+	for(auto r = 0u; r < R; ++r) {
+		for(auto c = 0u; c < C; ++c) {
+			ret = std::max(ret, std::abs(double(a[r][c]) - b[r][c]));
+		}
+	}
+	return ret;
+}
+
+} // anon namespace
+
+TEST(conversion) {
+	EXPECT(F(1).raw, 65536);
+	EXPECT(F(-2).raw, -131072);
+	EXPECT(F(1.5f).raw, 98304);
+	EXPECT(F(eps / 2).raw, 1); // ties away from zero
+	EXPECT(F(-eps / 2).raw, -1);
+	EXPECT(F(eps / 3).raw, 0);
+	EXPECT(F(1e10).raw, std::numeric_limits<std::int32_t>::max());
+	EXPECT(F(-1e10f).raw, std::numeric_limits<std::int32_t>::min());
+	EXPECT(F(std::numeric_limits<float>::quiet_NaN()).raw, 0);
+	EXPECT(F(-std::numeric_limits<double>::infinity()), F::lowest());
+
+	EXPECT(float(F(0.25)), 0.25f);
+	EXPECT(double(F(-3.75)), -3.75);
+	EXPECT(int(F(2.75)), 2);
+	EXPECT(int(F(-2.75)), -2);
+	EXPECT(bool(F(0)), false);
+	EXPECT(bool(F::epsilon()), true);
+	EXPECT(double(F::max()), 32768 - eps);
+	EXPECT(double(F::lowest()), -32768.0);
+
+	using Small = Fixed<4, 4>;
+	static_assert(sizeof(Small) == 1);
+	static_assert(sizeof(Fixed<8, 8>) == 2);
+	static_assert(sizeof(Vec3x) == 12);
+	EXPECT(Small(2.5).raw, 40);
+	EXPECT(double(Small(1) / Small(3)), 0.3125); // 5 / 16
+	EXPECT(double(Small(7) + Small(1)), -8.0); // wraps
+}
+
+TEST(arithmetic) {
+	EXPECT(F(1.5) + F(2.25), F(3.75));
+	EXPECT(F(1.5) - 4, F(-2.5));
+	EXPECT(-F(1.5), F(-1.5));
+	EXPECT(F(1.5) * F(-2), F(-3));
+	EXPECT(F(-3) / F(4), F(-0.75));
+	EXPECT(2 * F(0.25), F(0.5));
+
+	// rounding
+	auto e = F::epsilon();
+	EXPECT((e * F(0.5)).raw, 1); // ties towards +infinity
+	EXPECT((-e * F(0.5)).raw, 0);
+	EXPECT((e * F(0.25)).raw, 0);
+	EXPECT((F(1) / F(3)).raw, 21845);
+	EXPECT((F(2) / F(3)).raw, 43691);
+	EXPECT((F(-2) / F(3)).raw, -43691);
+	EXPECT((e / F(2)).raw, 1); // ties away from zero
+	EXPECT((-e / F(2)).raw, -1);
+
+	// overflow wraps
+	EXPECT(F::max() + e, F::lowest());
+	EXPECT(F::lowest() - e, F::max());
+	EXPECT(-F::lowest(), F::lowest());
+	EXPECT(F(256) * F(128), F::lowest());
+
+	auto a = F(3);
+	a += 1;
+	a *= F(0.5);
+	a -= F(0.25);
+	a /= F(-0.5);
+	EXPECT(a, F(-3.5));
+
+	EXPECT(F(1) < F(1.5), true);
+	EXPECT(F(-1) > 0, false);
+	EXPECT(F(2) >= 2, true);
+	EXPECT(F(2) != 2, false);
+	EXPECT(abs(F(-1.25)), F(1.25));
+
+	EXPECT(sqrt(F(4)), F(2));
+	EXPECT(sqrt(F(2)).raw, 92682); // sqrt(2) * 2^16 = 92681.9
+	EXPECT(sqrt(F(0)), F(0));
+	EXPECT(sqrt(e).raw, 256);
+	EXPECT(sqrt(F::max()).raw, 11863283);
+}
+
+TEST(vec) {
+	auto a = Vec3x{F(3), F(4), F(12)};
+	auto b = Vec3x{F(-1), F(0.5), F(2)};
+	EXPECT(dot(a, b), F(23));
+	EXPECT(length(a), F(13));
+	EXPECT(distance(a, b), length(a - b));
+	EXPECT(a + b, (Vec3x{F(2), F(4.5), F(14)}));
+	EXPECT(F(2) * b, (Vec3x{F(-2), F(1), F(4)}));
+	EXPECT(cross(a, b), (Vec3x{F(2), F(-18), F(5.5)}));
+	EXPECT(cross(Vec2x{F(1), F(2)}, Vec2x{F(3), F(4)}), F(-2));
+
+	// the exact products are summed up, they would overflow on their own
+	auto big = Vec2x{F(200), F(-200)};
+	EXPECT(dot(big, Vec2x{F(200), F(200)}), F(0));
+	EXPECT(length(Vec2x{F(300), F(400)}), F(500));
+	EXPECT(dot(Vec2x{F::epsilon(), F::epsilon()}, Vec2x{F(0.25), F(0.25)}).raw, 1);
+
+	// the length does not have to be representable
+	auto n = normalized(Vec2x{F(30000), F(-30000)});
+	EXPECT(std::abs(double(n.x) - std::sqrt(0.5)) <= eps, true);
+	EXPECT(n.y, -n.x);
+
+	EXPECT(normalized(Vec3x{F(0), F(-7), F(0)}), (Vec3x{F(0), F(-1), F(0)}));
+	ERROR(normalized(Vec3x{F(0), F(0), F(0)}), std::domain_error);
+
+	// error below 0.75 of the last bit
+	auto err = 0.0;
+	for(auto i = 1u; i < 2000; ++i) {
+		auto v = Vec3d{0.37 * i, 1.0 - 0.011 * i, 0.0003 * i * i};
+		if(i % 3 == 0) v = 0.0001 * v;
+		auto fv = fixed(v);
+		auto l = std::sqrt(dot(real(fv), real(fv)));
+		auto nv = fv;
+		normalize(nv);
+		for(auto j = 0u; j < 3; ++j) {
+			err = std::max(err, std::abs(double(nv[j]) - double(fv[j]) / l));
+		}
+		EXPECT(std::abs(double(length(fv)) - l) <= eps / 2, true);
+	}
+	EXPECT(err < 0.75 * eps, true);
+}
+
+TEST(mat) {
+	Mat3<F> m {
+		F(0), F(1), F(2),
+		F(1), F(0), F(3),
+		F(4), F(-3), F(8),
+	};
+
+	auto md = static_cast<Mat3d>(m);
+	EXPECT(maxDiff(m * m, md * md), 0.0);
+	EXPECT((m * Vec3x{F(1), F(2), F(3)}), (Vec3x{F(8), F(10), F(22)}));
+
+	// every entry is rounded once
+	Mat2<F> small {F::epsilon(), F::epsilon(), F(0), F(0)};
+	Mat2<F> half {F(0.25), F(0), F(0.25), F(0)};
+	EXPECT((small * half)[0][0].raw, 1);
+
+	auto lu = luDecomp(m);
+	EXPECT(determinant(lu), F(-2));
+	EXPECT(determinant(m), F(-2));
+	EXPECT(maxDiff(lu.lower * lu.upper, static_cast<Mat3d>(
+		static_cast<Mat3<F>>(lu.perm) * m)), 0.0);
+
+	auto inv = inverse(m);
+	EXPECT(maxDiff(inv, inverse(md)), 0.0);
+	EXPECT(m * inv, (identity<3, F>()));
+
+	auto x = luEvaluate(lu, Vec3x{F(1), F(2), F(3)});
+	EXPECT((m * x), (Vec3x{F(1), F(2), F(3)}));
+
+	// needs pivoting in every step (cyclic permutation)
+	Mat4<F> p {
+		F(0), F(0), F(0.5), F(1),
+		F(2), F(0), F(0), F(0),
+		F(0), F(-4), F(0), F(0),
+		F(0), F(0), F(0), F(3),
+	};
+	auto pd = static_cast<Mat4d>(p);
+	EXPECT(maxDiff(inverse(p), inverse(pd)) <= eps, true); // 1/3 is rounded
+	EXPECT(determinant(p), F(-12));
+	auto y = luEvaluate(luDecomp(p), Vec4x{F(1), F(2), F(3), F(4)});
+	EXPECT(distance(real(p * y), Vec4d{1, 2, 3, 4}) <= 2 * eps, true);
+
+	// a rotation, inverse equals transpose up to rounding
+	auto c = std::cos(0.3), s = std::sin(0.3);
+	auto rotd = Mat3d {c, -s, 0, s, c, 0, 0, 0, 1};
+	auto rot = static_cast<Mat3<F>>(rotd);
+	EXPECT(maxDiff(inverse(rot), transpose(rotd)) <= 2 * eps, true);
+	EXPECT(maxDiff(rot * transpose(rot), identity<3, double>()) <= 2 * eps, true);
+}
+
+// transformPoints computes the same as mat * vec on all instruction sets
+TEST(batch) {
+	std::vector<Vec3x> points;
+	for(auto i = 0u; i < 103; ++i) {
+		points.push_back(fixed(Vec3d{0.5 * i, 1.0 - i, 1.0 + 0.0125 * i}));
+	}
+
+	Mat4<F> m {
+		F(0), F(-2), F(0), F(1),
+		F(0.7), F(0), F(0.5), F(-3.3),
+		F(0), F(0), F(3), F(2),
+		F(0.1), F(0), F(1), F(4),
+	};
+
+	std::vector<Vec3x> affine(points.size()), projected(points.size());
+	for(auto i = 0u; i < points.size(); ++i) {
+		auto& p = points[i];
+		auto r = m * Vec4x{p.x, p.y, p.z, F(1)};
+		affine[i] = {r[0], r[1], r[2]};
+		projected[i] = {r[0] / r[3], r[1] / r[3], r[2] / r[3]};
+	}
+
+	std::vector<Vec3x> out(points.size());
+	transformPoints(m, points, out);
+	EXPECT(out == affine, true);
+	projectPoints(m, points, out);
+	EXPECT(out == projected, true);
+
+	auto inPlace = points;
+	transformPoints(m, inPlace, inPlace);
+	EXPECT(inPlace == affine, true);
+
+	using Kernel = detail::BatchTransformKernel<false, F>;
+	using Sig = void(const detail::BatchMat<F>&, const Vec3x*, Vec3x*, size_t);
+	for(auto level : levels()) {
+		std::vector<Vec3x> lout(points.size());
+		Dispatch<Kernel, Sig>::get(level)(m, points.data(), lout.data(), points.size());
+		EXPECT(lout == affine, true);
+	}
+}
+
+// Only integer operations are used, the results are the same everywhere.
+// The expected values were computed once and must never change.
+TEST(determinism) {
+	auto rot = static_cast<Mat3<F>>(Mat3d {
+		0.8, -0.6, 0.0,
+		0.6, 0.8, 0.0,
+		0.0, 0.0, 1.0,
+	});
+
+	auto pos = Vec3x{F(1), F(2), F(3)};
+	auto vel = Vec3x{F(0.5), F(-0.25), F(0.125)};
+	for(auto i = 0u; i < 1000; ++i) {
+		vel = rot * vel;
+		pos += F(0.01) * vel;
+		normalize(vel);
+		if(i % 100 == 0) {
+			rot = inverse(rot * rot);
+		}
+	}
+
+	EXPECT(pos.x.raw, 66456);
+	EXPECT(pos.y.raw, 130964);
+	EXPECT(pos.z.raw, 339058);
+	EXPECT(vel.x.raw, 64253);
+	EXPECT(vel.y.raw, -6748);
+	EXPECT(vel.z.raw, 10998);
+}
@@ -60,6 +60,22 @@ TEST(basic) {
 	// 3 - nytl::mat::transpose(x) * x;
 }
 
+TEST(access) {
+	nytl::Mat<2, 3, double> a {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+	const auto& ca = a;
+
+	EXPECT(a.at(1, 2), 6.0);
+	EXPECT(ca.at(0, 1), 2.0);
+	a.at(0, 0) = -1.0;
+	EXPECT(a[0][0], -1.0);
+	ERROR(a.at(2, 0), std::out_of_range);
+	ERROR(ca.at(0, 3), std::out_of_range);
+
+	constexpr nytl::Mat2i ci {1, 2, 3, 4};
+	static_assert(ci[1][0] == 3);
+	static_assert(ci.at(0, 1) == 2);
+}
+
 TEST(echolon) {
 	nytl::Mat<3, 5, double> a {
 		2.0, 1.0, -1.0, 8.0, 80.0,
@@ -180,3 +196,33 @@ TEST(inverse) {
 		// ERROR(nytl::inverse(lups), std::invalid_argument);
 	}
 }
+
+TEST(operators) {
+	constexpr nytl::Mat<2, 3, int> a {1, 2, 3, 4, 5, 6};
+	constexpr nytl::Mat<3, 2, int> b {1, 0, 0, 1, 1, 1};
+	static_assert(a * b == nytl::Mat<2, 2, int> {4, 5, 10, 11});
+	static_assert(a * nytl::Vec3i {1, 0, -1} == nytl::Vec2i {-2, -2});
+	static_assert(-a + a == nytl::Mat<2, 3, int> {});
+	static_assert(2 * a - a == a);
+
+	// promoted like the component operations
+	constexpr nytl::Mat<2, 2, short> s {1, 2, 3, 4};
+	static_assert(std::is_same_v<decltype(s * s), nytl::Mat<2, 2, int>>);
+	static_assert(std::is_same_v<decltype(-s), nytl::Mat<2, 2, short>>);
+
+	// casts leave out or default construct the remaining values
+	static_assert(static_cast<nytl::Mat<1, 2, int>>(a) == nytl::Mat<1, 2, int> {1, 2});
+	static_assert(static_cast<nytl::Mat<3, 4, int>>(a) ==
+		nytl::Mat<3, 4, int> {1, 2, 3, 0, 4, 5, 6, 0, 0, 0, 0, 0});
+
+	auto m = nytl::Mat<2, 2, double> {1.0, 2.0, 3.0, 4.0};
+	m *= 2.0;
+	EXPECT(m, (nytl::Mat<2, 2, double> {2.0, 4.0, 6.0, 8.0}));
+	m += m;
+	m -= nytl::Mat<2, 2, int> {1, 1, 1, 1};
+	EXPECT(m, (nytl::Mat<2, 2, double> {3.0, 7.0, 11.0, 15.0}));
+
+	auto i = nytl::Mat<2, 2, int> {1, 1, 0, 1};
+	i *= nytl::Mat<2, 2, double> {2.0, 0.0, 0.0, 0.5};
+	EXPECT(i, (nytl::Mat<2, 2, int> {2, 0, 0, 0}));
+}
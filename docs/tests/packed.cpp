@@ -0,0 +1,316 @@
+// checks the range sizes, see nytl/contracts.hpp
+#define NYTL_CONTRACTS NYTL_CONTRACTS_THROW
+
+#include "test.hpp"
+#include <nytl/packed.hpp>
+#include <nytl/vecOps.hpp>
+#include <nytl/approx.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace nytl;
+
+namespace {
+
+constexpr auto inf = std::numeric_limits<float>::infinity();
+constexpr auto qnan = std::numeric_limits<float>::quiet_NaN();
+
+// count values spread over a large range, including specials
+std::vector<float> values(unsigned count = 10007) {
+	std::vector<float> ret(count);
+	auto state = 12345u;
+	for(auto& val : ret) {
+		state = state * 1664525u + 1013904223u;
+		std::memcpy(&val, &state, sizeof(float));
+	}
+
+	ret[0] = 0.f;
+	ret[1] = -0.f;
+	ret[2] = inf;
+	ret[3] = -inf;
+	ret[4] = qnan;
+	ret[5] = 65504.f;
+	ret[6] = 1e-7f;
+	ret[7] = 0.5f;
+	ret[8] = -1.f;
+	return ret;
+}
+
+bool bitwiseEqual(float a, float b) {
+	return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// unit vectors and some special cases
+std::vector<Vec3f> normals(unsigned count = 1003) {
+	std::vector<Vec3f> ret;
+	for(auto i = 0u; i < count; ++i) {
+		auto a = 0.1f * i;
+		auto z = 1.f - 2.f * i / (count - 1);
+		auto r = std::sqrt(std::max(1.f - z * z, 0.f));
+		ret.push_back({r * std::cos(a), r * std::sin(a), z});
+	}
+
+	ret[1] = {1.f, 0.f, 0.f};
+	ret[2] = {0.f, -1.f, 0.f};
+	ret[3] = {0.f, 0.f, -1.f};
+	ret[4] = {0.f, 0.f, 0.f};
+	return ret;
+}
+
+// angle between two unit vectors
+double angle(const Vec3f& a, const Vec3f& b) {
+	Vec3d da(a), db(b);
+	return std::atan2(length(cross(da, db)), dot(da, db));
+}
+
+template<typename T>
+bool samePacked(const T& a, const T& b) {
+	return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+} // anon namespace
+
+TEST(f16) {
+	EXPECT(f16(1.f).bits, 0x3c00);
+	EXPECT(f16(-2.f).bits, 0xc000);
+	EXPECT(f16(0.f).bits, 0x0000);
+	EXPECT(f16(-0.f).bits, 0x8000);
+	EXPECT(f16(65504.f).bits, 0x7bff);
+	EXPECT(f16(65519.f).bits, 0x7bff);
+	EXPECT(f16(65520.f).bits, 0x7c00); // rounds to infinity
+	EXPECT(f16(1e10f).bits, 0x7c00);
+	EXPECT(f16(-inf).bits, 0xfc00);
+	EXPECT(f16(qnan).bits, 0x7e00);
+	EXPECT(f16(6.1035156e-5f).bits, 0x0400); // smallest normal
+	EXPECT(f16(5.9604645e-8f).bits, 0x0001); // smallest subnormal
+	EXPECT(f16(1e-7f).bits, 0x0002);
+	EXPECT(f16(1e-9f).bits, 0x0000);
+
+	// round to nearest even
+	EXPECT(f16(1.f + 1 / 2048.f).bits, 0x3c00);
+	EXPECT(f16(1.f + 3 / 2048.f).bits, 0x3c02);
+
+	EXPECT(float(f16(0.333f)), approx(0.333f, 1e-3));
+	EXPECT(float(f16(-1234.5f)), -1234.f); // spacing 1, rounds to even
+	EXPECT(std::isnan(float(f16(qnan))), true);
+	EXPECT(float(f16(inf)), inf);
+
+	f16 h;
+	h.bits = 0x0001;
+	EXPECT(float(h), 5.9604645e-8f);
+	h.bits = 0x8000;
+	EXPECT(std::signbit(float(h)), true);
+
+	// every half value survives the round trip
+	auto roundTrips = true;
+	for(auto i = 0u; i < 0x10000; ++i) {
+		h.bits = std::uint16_t(i);
+		auto f = float(h);
+		if(std::isnan(f) ? !std::isnan(float(f16(f))) : f16(f).bits != h.bits) {
+			roundTrips = false;
+		}
+	}
+	EXPECT(roundTrips, true);
+}
+
+TEST(bf16) {
+	EXPECT(bf16(1.f).bits, 0x3f80);
+	EXPECT(bf16(-2.f).bits, 0xc000);
+	EXPECT(bf16(inf).bits, 0x7f80);
+	EXPECT(bf16(qnan).bits, 0x7fc0);
+	EXPECT(bf16(1e30f), approx(1e30f, 1e-2));
+	EXPECT(float(bf16(3.f)), 3.f);
+	EXPECT(float(bf16(1.f + 1 / 256.f)), 1.f); // round to nearest even
+	EXPECT(float(bf16(1.f + 3 / 256.f)), 1.f + 1 / 64.f);
+
+	// payload only in the lower bits: stays nan
+	float sig;
+	auto bits = 0x7f800001u;
+	std::memcpy(&sig, &bits, sizeof(float));
+	EXPECT(std::isnan(float(bf16(sig))), true);
+}
+
+TEST(norm) {
+	EXPECT(snorm8(1.f).value, 127);
+	EXPECT(snorm8(-1.f).value, -127);
+	EXPECT(snorm8(-2.5f).value, -127);
+	EXPECT(snorm8(0.5f).value, 64);
+	EXPECT(snorm8(qnan).value, 0);
+	EXPECT(unorm8(1.f).value, 255);
+	EXPECT(unorm8(-1.f).value, 0);
+	EXPECT(unorm8(0.5f).value, 128);
+	EXPECT(unorm16(1.f).value, 65535);
+	EXPECT(unorm16(inf).value, 65535);
+	EXPECT(snorm16(-inf).value, -32767);
+
+	snorm8 s;
+	s.value = -128;
+	EXPECT(float(s), -1.f);
+	EXPECT(float(snorm16(0.25f)), approx(0.25f, 1e-4));
+	EXPECT(float(unorm8(0.2f)), approx(0.2f, 2e-3));
+	EXPECT(float(unorm16(1.f)), 1.f);
+	EXPECT(float(snorm16(-1.f)), -1.f);
+}
+
+TEST(vec) {
+	static_assert(sizeof(Vec3h) == 6);
+	static_assert(sizeof(Vec4<unorm8>) == 4);
+
+	auto h = Vec3h(Vec3f {1.f, -0.5f, 1000.f});
+	EXPECT(h[0].bits, 0x3c00);
+	EXPECT(Vec3f(h), (Vec3f {1.f, -0.5f, 1000.f}));
+
+	auto color = Vec4<unorm8>(Vec4f {1.f, 0.f, 0.5f, 2.f});
+	EXPECT(color[2].value, 128);
+	EXPECT(color[3].value, 255);
+	EXPECT(Vec4f(color), approx(Vec4f {1.f, 0.f, 0.502f, 1.f}, 1e-3));
+
+	auto n = normalized(Vec3f {1.f, 2.f, -3.f});
+	EXPECT(Vec3f(Oct32(n)), approx(n, 1e-4));
+	EXPECT(Vec3f(Oct32(Vec3f {0.f, 0.f, 0.f})), approx(Vec3f {0.f, 0.f, 1.f}, 1e-5));
+
+	auto err = 0.0;
+	for(auto& normal : normals()) {
+		if(normal != Vec3f {0.f, 0.f, 0.f}) {
+			err = std::max(err, angle(Vec3f(Oct32(normal)), normal));
+		}
+	}
+	EXPECT(err < 7e-5, true);
+}
+
+// pack and unpack compute the same as converting the values on their own
+TEST(bulk) {
+	auto vals = values();
+	auto count = vals.size();
+
+	std::vector<f16> halfs(count);
+	std::vector<float> back(count);
+	pack(vals, halfs);
+	unpack(halfs, back);
+	auto equal = true;
+	for(auto i = 0u; i < count; ++i) {
+		auto expected = f16(vals[i]);
+		equal &= halfs[i].bits == expected.bits;
+		equal &= bitwiseEqual(back[i], float(expected));
+	}
+	EXPECT(equal, true);
+
+	std::vector<bf16> bfs(count);
+	pack(vals, bfs);
+	unpack(bfs, back);
+	equal = true;
+	for(auto i = 0u; i < count; ++i) {
+		auto expected = bf16(vals[i]);
+		equal &= bfs[i].bits == expected.bits;
+		equal &= bitwiseEqual(back[i], float(expected));
+	}
+	EXPECT(equal, true);
+
+	std::vector<snorm16> s16(count);
+	std::vector<unorm8> u8(count);
+	pack(vals, s16);
+	pack(vals, u8);
+	equal = true;
+	for(auto i = 0u; i < count; ++i) {
+		equal &= s16[i].value == snorm16(vals[i]).value;
+		equal &= u8[i].value == unorm8(vals[i]).value;
+	}
+	unpack(s16, back);
+	for(auto i = 0u; i < count; ++i) {
+		equal &= bitwiseEqual(back[i], float(s16[i]));
+	}
+	EXPECT(equal, true);
+
+	// vecs
+	std::vector<Vec3f> vecs = normals();
+	std::vector<Vec3h> hvecs(vecs.size());
+	std::vector<Vec3f> vback(vecs.size());
+	pack(vecs, hvecs);
+	unpack(hvecs, vback);
+	equal = true;
+	for(auto i = 0u; i < vecs.size(); ++i) {
+		equal &= samePacked(hvecs[i], Vec3h(vecs[i]));
+		equal &= vback[i] == Vec3f(hvecs[i]);
+	}
+	EXPECT(equal, true);
+
+	std::vector<Oct32> octs(vecs.size());
+	pack(vecs, octs);
+	unpack(octs, vback);
+	equal = true;
+	auto err = 0.0;
+	for(auto i = 0u; i < vecs.size(); ++i) {
+		equal &= samePacked(octs[i], Oct32(vecs[i]));
+		if(vecs[i] != Vec3f {0.f, 0.f, 0.f}) {
+			err = std::max(err, angle(vback[i], vecs[i]));
+		}
+	}
+	EXPECT(equal, true);
+	EXPECT(err < 7e-5, true);
+	EXPECT(vback[4], approx(Vec3f {0.f, 0.f, 1.f}, 1e-5));
+
+	// empty and smaller ranges
+	std::vector<float> empty;
+	pack(empty, halfs);
+	pack(nytl::Span<const float>(vals.data(), 3), halfs);
+	EXPECT(halfs[2].bits, 0x7c00);
+	unpack(nytl::Span<const f16>(halfs.data(), 3), back);
+	EXPECT(back[2], float(halfs[2]));
+
+	std::vector<f16> small(2);
+	ERROR(pack(nytl::Span<const float>(vals.data(), 3), small),
+		nytl::ContractViolation);
+	ERROR(unpack(halfs, nytl::Span<float>(back.data(), 2)),
+		nytl::ContractViolation);
+}
+
+// every instruction set computes bitwise equal results
+TEST(dispatch) {
+	auto vals = values();
+	auto vecs = normals();
+	auto count = vals.size();
+
+	using Sig = void(const float*, f16*, std::size_t);
+	using USig = void(const f16*, float*, std::size_t);
+	using OSig = void(const Vec3f*, Oct32*, std::size_t);
+	using UOSig = void(const Oct32*, Vec3f*, std::size_t);
+	using D = Dispatch<detail::PackKernel<f16>, Sig>;
+	using UD = Dispatch<detail::UnpackKernel<f16>, USig>;
+	using OD = Dispatch<detail::PackOctKernel, OSig>;
+	using UOD = Dispatch<detail::UnpackOctKernel, UOSig>;
+
+	std::vector<f16> halfs(count);
+	std::vector<float> back(count);
+	std::vector<Oct32> octs(vecs.size());
+	std::vector<Vec3f> vback(vecs.size());
+	D::get(Isa::scalar)(vals.data(), halfs.data(), count);
+	UD::get(Isa::scalar)(halfs.data(), back.data(), count);
+	OD::get(Isa::scalar)(vecs.data(), octs.data(), vecs.size());
+	UOD::get(Isa::scalar)(octs.data(), vback.data(), vecs.size());
+
+	for(auto i = 0u; i < isaCount; ++i) {
+		auto level = static_cast<Isa>(i);
+		if(!D::get(level)) {
+			continue;
+		}
+
+		std::vector<f16> lhalfs(count);
+		std::vector<float> lback(count);
+		std::vector<Oct32> locts(vecs.size());
+		std::vector<Vec3f> lvback(vecs.size());
+		D::get(level)(vals.data(), lhalfs.data(), count);
+		UD::get(level)(halfs.data(), lback.data(), count);
+		OD::get(level)(vecs.data(), locts.data(), vecs.size());
+		UOD::get(level)(octs.data(), lvback.data(), vecs.size());
+
+		EXPECT(std::memcmp(lhalfs.data(), halfs.data(), count * sizeof(f16)), 0);
+		EXPECT(std::memcmp(lback.data(), back.data(), count * sizeof(float)), 0);
+		EXPECT(std::memcmp(locts.data(), octs.data(), octs.size() * sizeof(Oct32)), 0);
+		EXPECT(std::memcmp(lvback.data(), vback.data(),
+			vback.size() * sizeof(Vec3f)), 0);
+	}
+}
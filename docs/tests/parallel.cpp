@@ -0,0 +1,98 @@
+#include "test.hpp"
+#include <nytl/parallel.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+TEST(algorithms) {
+	nytl::TaskScheduler scheduler(3);
+	auto policy = nytl::par::Policy {&scheduler};
+
+	std::vector<nytl::Vec3f> vecs(100000);
+	for(auto i = 0u; i < vecs.size(); ++i) {
+		vecs[i] = {float(i + 1), 2.f, -float(i % 7)};
+	}
+
+	// transform
+	std::vector<float> lengths(vecs.size());
+	nytl::par::transform(policy, vecs, lengths, [](auto& v) { return nytl::length(v); });
+	for(auto i = 0u; i < vecs.size(); i += 997) {
+		EXPECT(lengths[i], nytl::length(vecs[i]));
+	}
+
+	// normalize, fixed grain
+	auto normalized = vecs;
+	nytl::par::normalize(nytl::par::Policy {&scheduler, 100}, normalized);
+	for(auto i = 0u; i < vecs.size(); i += 997) {
+		EXPECT(normalized[i], nytl::approx(nytl::normalized(vecs[i]), 1e-6));
+	}
+
+	// exceptions are propagated
+	normalized[5000] = {};
+	ERROR(nytl::par::normalize(policy, normalized), std::domain_error);
+
+	// inverse
+	std::vector<nytl::Mat3f> mats(1000);
+	for(auto i = 0u; i < mats.size(); ++i) {
+		mats[i] = {
+			2.f, float(i), 0.f,
+			0.f, 1.f, 0.f,
+			1.f, 0.f, 3.f,
+		};
+	}
+
+	std::vector<nytl::Mat3f> inverses(mats.size());
+	nytl::par::inverse(policy, mats, inverses);
+	for(auto i = 0u; i < mats.size(); i += 97) {
+		EXPECT(inverses[i] * mats[i], nytl::approx(nytl::identity<3, float>(), 1e-4));
+	}
+
+	// points
+	nytl::Mat4f m {
+		0.f, -1.f, 0.f, 1.f,
+		1.f, 0.f, 0.f, -3.f,
+		0.f, 0.f, 1.f, 2.f,
+		0.f, 0.f, 0.f, 1.f,
+	};
+
+	std::vector<nytl::Vec3f> out(vecs.size()), expected(vecs.size());
+	nytl::par::transformPoints(policy, m, vecs, out);
+	nytl::transformPoints(m, vecs, expected);
+	EXPECT(out == expected, true);
+}
+
+TEST(deterministic) {
+	std::vector<float> values(1000003);
+	for(auto i = 0u; i < values.size(); ++i) {
+		values[i] = 1.f / float(i + 1);
+	}
+
+	auto add = [](float a, float b) { return a + b; };
+	auto expected = nytl::par::reduce(nytl::par::seq, values, 0.f, add);
+	for(auto threads : {1u, 2u, 5u}) {
+		nytl::TaskScheduler scheduler(threads);
+		for(auto grain : {0u, 1u, 3u, 1000u}) {
+			auto sum = nytl::par::reduce(nytl::par::Policy {&scheduler, grain}, values, 0.f, add);
+			EXPECT(sum, expected);
+		}
+	}
+
+	EXPECT(nytl::par::reduce(nytl::par::par, std::vector<int> {}, 0, add), 0);
+}
+
+TEST(nested) {
+	// parallel algorithms called from inside parallel algorithms must not deadlock
+	nytl::TaskScheduler scheduler(2);
+	auto policy = nytl::par::Policy {&scheduler, 1};
+
+	std::vector<std::vector<int>> rows(16, std::vector<int>(1000, 1));
+	std::vector<int> sums(rows.size());
+	nytl::par::transform(policy, rows, sums, [&](const auto& row) {
+		return nytl::par::reduce(policy, row, 0, [](int a, int b) { return a + b; });
+	});
+
+	for(auto sum : sums) {
+		EXPECT(sum, 1000);
+	}
+}
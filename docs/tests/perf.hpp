@@ -0,0 +1,331 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+// Performance instrumentation companion for bugged.hpp.
+// Replaces the global operator new to count the allocations of every thread,
+// which allows to check allocation-free code paths with
+// EXPECT_ALLOCS(expression, expected).
+// If the BUGGED_PERF environment variable is set, every unit is additionally
+// measured (wall time, allocations and - where perf_event is permitted -
+// instructions, cycles, cache and branch misses of the testing thread)
+// and a json summary is written to the file it names ("-" for stdout).
+// Configuration (define before including the file):
+//  - BUGGED_NO_ALLOC_HOOK: don't replace the global operator new, e.g. when
+//    the test replaces it itself. EXPECT_ALLOCS checks nothing then.
+
+#pragma once
+
+#include "bugged.hpp"
+
+#include <array> // std::array
+#include <chrono> // std::chrono::steady_clock
+#include <cstdint> // std::uint64_t
+#include <cstdio> // std::FILE
+#include <cstdlib> // std::malloc
+#include <cstring> // std::strcmp
+#include <new> // std::bad_alloc
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+	#include <linux/perf_event.h> // perf_event_attr
+	#include <sys/ioctl.h> // ioctl
+	#include <sys/syscall.h> // SYS_perf_event_open
+	#include <unistd.h> // syscall
+	#define BUGGED_PERF_EVENT 1
+#else
+	#define BUGGED_PERF_EVENT 0
+#endif
+
+namespace bugged {
+
+/// Counts the allocations done via the global operator new.
+class AllocCounter {
+public:
+	#ifdef BUGGED_NO_ALLOC_HOOK
+		static constexpr bool enabled = false;
+	#else
+		static constexpr bool enabled = true;
+	#endif
+
+	/// Returns the number of allocations done by the calling thread so far.
+	static std::size_t count() { return threadCount; }
+
+	/// Called by the operator new replacements.
+	static void allocated() { ++threadCount; }
+
+protected:
+	static thread_local std::size_t threadCount;
+};
+
+/// Hardware counters of the calling thread via perf_event_open.
+/// Counters that can't be opened (not linux, insufficient permissions
+/// or not supported by the cpu) are simply not available.
+class PerfCounters {
+public:
+	static constexpr auto count = 4u;
+	static constexpr const char* names[count] = {
+		"instructions", "cycles", "cacheMisses", "branchMisses"
+	};
+
+	using Values = std::array<std::int64_t, count>; // -1 if not available
+
+public:
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/// Resets and enables all available counters.
+	void start();
+
+	/// Disables all counters and returns their values.
+	Values stop();
+
+protected:
+	std::array<int, count> fds_ {};
+};
+
+/// Collects the statistics of all units when BUGGED_PERF is set.
+class Perf {
+public:
+	struct Stats {
+		Testing::Unit unit;
+		bool failed;
+		double ns;
+		std::size_t allocs;
+		PerfCounters::Values counters;
+	};
+
+	/// Registers the testing hooks if BUGGED_PERF is set.
+	/// Always returns 0, useful for static calling.
+	static int install();
+
+protected:
+	static void unitStarted(const Testing::Unit&);
+	static void unitFinished(const Testing::Unit&, bool failed);
+	static void finished();
+
+	static const char* output;
+	static PerfCounters* counters;
+	static std::vector<Stats> stats;
+	static std::chrono::steady_clock::time_point start;
+	static std::size_t startAllocs;
+};
+
+namespace {
+	static auto BUGGED_perfInstalled = Perf::install();
+}
+
+} // namespace bugged
+
+/// Expects the given expression to do exactly the given number of
+/// allocations (via the global operator new) on the calling thread.
+#define EXPECT_ALLOCS(expr, expected) { \
+	auto BUGGED_allocs = ::bugged::AllocCounter::count(); \
+	{ expr; } \
+	if(::bugged::AllocCounter::enabled) \
+		::bugged::checkExpect({__LINE__, ::bugged::stripPath(__FILE__)}, \
+			::bugged::AllocCounter::count() - BUGGED_allocs, std::size_t(expected)); \
+	}
+
+// Implementation
+#ifndef BUGGED_NO_IMPL
+
+namespace bugged {
+
+thread_local std::size_t AllocCounter::threadCount {};
+
+PerfCounters::PerfCounters()
+{
+	fds_.fill(-1);
+
+#if BUGGED_PERF_EVENT
+	constexpr std::uint64_t configs[count] = {
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+
+	for(auto i = 0u; i < count; ++i) {
+		perf_event_attr attr {};
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = configs[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fds_[i] = int(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+#endif // BUGGED_PERF_EVENT
+}
+
+PerfCounters::~PerfCounters()
+{
+#if BUGGED_PERF_EVENT
+	for(auto fd : fds_)
+		if(fd >= 0)
+			::close(fd);
+#endif // BUGGED_PERF_EVENT
+}
+
+void PerfCounters::start()
+{
+#if BUGGED_PERF_EVENT
+	for(auto fd : fds_) {
+		if(fd >= 0) {
+			::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif // BUGGED_PERF_EVENT
+}
+
+PerfCounters::Values PerfCounters::stop()
+{
+	Values ret;
+	ret.fill(-1);
+
+#if BUGGED_PERF_EVENT
+	for(auto i = 0u; i < count; ++i) {
+		if(fds_[i] < 0)
+			continue;
+
+		::ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+		std::uint64_t value {};
+		if(::read(fds_[i], &value, sizeof(value)) == sizeof(value))
+			ret[i] = std::int64_t(value);
+	}
+#endif // BUGGED_PERF_EVENT
+
+	return ret;
+}
+
+const char* Perf::output {};
+PerfCounters* Perf::counters {};
+std::vector<Perf::Stats> Perf::stats {};
+std::chrono::steady_clock::time_point Perf::start {};
+std::size_t Perf::startAllocs {};
+
+int Perf::install()
+{
+	output = std::getenv("BUGGED_PERF");
+	if(!output || !*output)
+		return 0;
+
+	Testing::Hooks::unitStarted = &Perf::unitStarted;
+	Testing::Hooks::unitFinished = &Perf::unitFinished;
+	Testing::Hooks::finished = &Perf::finished;
+	return 0;
+}
+
+void Perf::unitStarted(const Testing::Unit&)
+{
+	// opened lazily so the counters belong to the testing thread
+	if(!counters)
+		counters = new PerfCounters();
+
+	startAllocs = AllocCounter::count();
+	start = std::chrono::steady_clock::now();
+	counters->start();
+}
+
+void Perf::unitFinished(const Testing::Unit& unit, bool failed)
+{
+	auto values = counters->stop();
+	std::chrono::duration<double, std::nano> time =
+		std::chrono::steady_clock::now() - start;
+	auto allocs = AllocCounter::count() - startAllocs;
+	stats.push_back({unit, failed, time.count(), allocs, values});
+}
+
+void Perf::finished()
+{
+	auto toStdout = std::strcmp(output, "-") == 0;
+	auto file = toStdout ? stdout : std::fopen(output, "w");
+	if(!file) {
+		*Testing::output << "bugged: could not open " << output << "\n";
+		return;
+	}
+
+	std::fprintf(file, "{\n  \"units\": [");
+	auto first = true;
+	for(auto& s : stats) {
+		std::fprintf(file, "%s\n    {\"name\": \"%s\", \"file\": \"%s\", \"line\": %u, "
+			"\"failed\": %s, \"ns\": %.0f, \"allocs\": %zu", first ? "" : ",",
+			s.unit.name.c_str(), s.unit.file, s.unit.line,
+			s.failed ? "true" : "false", s.ns, s.allocs);
+		for(auto i = 0u; i < PerfCounters::count; ++i) {
+			if(s.counters[i] < 0)
+				std::fprintf(file, ", \"%s\": null", PerfCounters::names[i]);
+			else
+				std::fprintf(file, ", \"%s\": %lld", PerfCounters::names[i],
+					static_cast<long long>(s.counters[i]));
+		}
+
+		std::fprintf(file, "}");
+		first = false;
+	}
+
+	std::fprintf(file, "\n  ]\n}\n");
+	if(!toStdout)
+		std::fclose(file);
+
+	delete counters;
+	counters = nullptr;
+}
+
+} // namespace bugged
+
+#ifndef BUGGED_NO_ALLOC_HOOK
+
+void* operator new(std::size_t size)
+{
+	::bugged::AllocCounter::allocated();
+	if(auto ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+	::bugged::AllocCounter::allocated();
+	auto alignment = static_cast<std::size_t>(align);
+	size = ((size ? size : 1) + alignment - 1) & ~(alignment - 1);
+	if(auto ptr = std::aligned_alloc(alignment, size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+	return ::operator new(size, align);
+}
+
+// gcc pairs the inlined std::free with the operator new call of the caller
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+	#pragma GCC diagnostic pop
+#endif
+
+#endif // BUGGED_NO_ALLOC_HOOK
+#endif // BUGGED_NO_IMPL
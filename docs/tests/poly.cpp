@@ -0,0 +1,214 @@
+#include "test.hpp"
+#include <nytl/poly.hpp>
+
+#include <string>
+#include <cstdint>
+
+namespace {
+
+int alive = 0;
+
+struct Shape : public nytl::AbstractCloneable<Shape> {
+	Shape() { ++alive; }
+	Shape(const Shape&) { ++alive; }
+	~Shape() { --alive; }
+	virtual float area() const = 0;
+};
+
+struct Square final : public nytl::DeriveCloneable<Square, Shape> {
+	float size {};
+	Square(float s) : size(s) {}
+	float area() const override { return size * size; }
+};
+
+struct Polygon final : public nytl::DeriveCloneable<Polygon, Shape> {
+	float values[32] {};
+	std::string name;
+	Polygon(float a, std::string n) : name(std::move(n)) { values[31] = a; }
+	float area() const override { return values[31]; }
+};
+
+struct Named : public nytl::DeriveCloneable<Named, Shape> {
+	std::string name;
+	Named(std::string n) : name(std::move(n)) {}
+	float area() const override { return 0.f; }
+};
+
+} // anon namespace
+
+TEST(poly) {
+	{
+		nytl::Poly<Shape> empty;
+		EXPECT(bool(empty), false);
+		EXPECT(empty.inlined(), false);
+
+		nytl::Poly<Shape> square = Square(2.f);
+		EXPECT(square.inlined(), true);
+		EXPECT(square->area(), 4.f);
+		EXPECT(square.target<Polygon>() == nullptr, true);
+		auto target = square.target<Square>();
+		EXPECT(target != nullptr, true);
+		EXPECT(target ? target->size : 0.f, 2.f);
+
+		nytl::Poly<Shape> poly = Polygon(7.f, "poly");
+		EXPECT(poly.inlined(), false);
+		EXPECT(poly->area(), 7.f);
+		EXPECT(alive, 2);
+
+		// copies
+		auto copy = square;
+		auto pcopy = poly;
+		EXPECT(copy.inlined(), true);
+		EXPECT(copy.get() != square.get(), true);
+		EXPECT(copy->area(), 4.f);
+		EXPECT(pcopy.get() != poly.get(), true);
+		auto ptarget = pcopy.target<Polygon>();
+		EXPECT(ptarget ? ptarget->name : "", "poly");
+		EXPECT(alive, 4);
+
+		// moves: heap allocations are taken over
+		auto ptr = poly.get();
+		auto moved = std::move(poly);
+		EXPECT(moved.get(), ptr);
+		EXPECT(bool(poly), false);
+
+		auto smoved = std::move(square);
+		EXPECT(smoved.inlined(), true);
+		EXPECT(smoved->area(), 4.f);
+		EXPECT(bool(square), false);
+		EXPECT(alive, 4);
+
+		// assignment
+		copy = moved;
+		EXPECT(copy.inlined(), false);
+		EXPECT(copy->area(), 7.f);
+		moved = smoved;
+		EXPECT(moved.inlined(), true);
+		EXPECT(moved->area(), 4.f);
+		EXPECT(alive, 4);
+
+		copy.emplace<Named>("named");
+		auto ntarget = copy.target<Named>();
+		EXPECT(ntarget ? ntarget->name : "", "named");
+		copy.reset();
+		EXPECT(bool(copy), false);
+		EXPECT(alive, 3);
+	}
+
+	EXPECT(alive, 0);
+}
+
+TEST(poly_vector) {
+	{
+		nytl::PolyVector<Shape> shapes;
+		EXPECT(shapes.empty(), true);
+
+		for(auto i = 0u; i < 100; ++i) {
+			switch(i % 3) {
+				case 0: shapes.emplace_back<Square>(float(i)); break;
+				case 1: shapes.push_back(Polygon(float(i), std::to_string(i))); break;
+				case 2: shapes.emplace_back<Named>(std::to_string(i)); break;
+			}
+		}
+
+		EXPECT(shapes.size(), 100u);
+		EXPECT(alive, 100);
+		EXPECT(shapes.bytes() <= shapes.capacity(), true);
+
+		// objects are stored contiguously and got relocated correctly
+		auto first = reinterpret_cast<const unsigned char*>(&shapes[0]);
+		for(auto i = 0u; i < 100; ++i) {
+			auto addr = reinterpret_cast<const unsigned char*>(&shapes[i]);
+			EXPECT(addr >= first && addr < first + shapes.bytes(), true);
+			EXPECT(reinterpret_cast<std::uintptr_t>(addr) % alignof(Shape), 0u);
+			switch(i % 3) {
+				case 0: EXPECT(shapes[i].area(), float(i * i)); break;
+				case 1: EXPECT(dynamic_cast<Polygon&>(shapes[i]).name, std::to_string(i)); break;
+				case 2: EXPECT(shapes.type(i) == typeid(Named), true); break;
+			}
+		}
+
+		// iteration
+		auto sum = 0.f;
+		for(auto& shape : shapes) {
+			sum += shape.area();
+		}
+
+		auto visited = 0.f;
+		auto squares = 0u, others = 0u;
+		shapes.forEach<Square, Polygon>([&](auto& shape) {
+			using T = std::decay_t<decltype(shape)>;
+			if constexpr(std::is_same_v<T, Square>) {
+				++squares;
+			} else if constexpr(std::is_same_v<T, Shape>) {
+				++others;
+			}
+			visited += shape.area();
+		});
+
+		EXPECT(visited, sum);
+		EXPECT(squares, 34u);
+		EXPECT(others, 33u);
+
+		// copy
+		auto copy = shapes;
+		EXPECT(copy.size(), shapes.size());
+		EXPECT(&copy[0] != &shapes[0], true);
+		EXPECT(dynamic_cast<const Polygon&>(std::as_const(copy)[1]).name, "1");
+		EXPECT(alive, 200);
+
+		copy.pop_back();
+		copy.pop_back();
+		EXPECT(copy.size(), 98u);
+		EXPECT(copy.back().area(), 97.f);
+		EXPECT(alive, 198);
+
+		auto moved = std::move(copy);
+		EXPECT(moved.size(), 98u);
+		EXPECT(copy.empty(), true);
+
+		moved.clear();
+		EXPECT(moved.empty(), true);
+		EXPECT(moved.bytes(), 0u);
+		EXPECT(alive, 100);
+	}
+
+	EXPECT(alive, 0);
+}
+
+// Inserting a copy of an element when the buffer grows, the new object
+// must be constructed before the old ones are relocated.
+TEST(poly_vector_self_insert) {
+	{
+		nytl::PolyVector<Shape> shapes;
+		shapes.emplace_back<Named>(std::string(100, 'x'));
+		for(auto i = 0u; i < 20; ++i) {
+			auto capacity = shapes.capacity();
+			shapes.push_back(static_cast<Named&>(shapes[0]));
+			if(shapes.capacity() != capacity) {
+				EXPECT(static_cast<Named&>(shapes.back()).name, std::string(100, 'x'));
+			}
+		}
+
+		for(auto& shape : shapes) {
+			EXPECT(static_cast<Named&>(shape).name, std::string(100, 'x'));
+		}
+		EXPECT(alive, 21);
+	}
+
+	EXPECT(alive, 0);
+}
+
+// The entries and the object buffer grow geometrically, i.e. inserting
+// n objects allocates O(log n) times.
+TEST(poly_vector_growth) {
+	nytl::PolyVector<Shape> shapes;
+	auto before = bugged::AllocCounter::count();
+	for(auto i = 0u; i < 4096; ++i) {
+		shapes.emplace_back<Square>(float(i));
+	}
+
+	EXPECT(shapes.size(), 4096u);
+	auto allocs = bugged::AllocCounter::count() - before;
+	EXPECT(!bugged::AllocCounter::enabled || allocs <= 2 * 13u, true);
+}
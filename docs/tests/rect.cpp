@@ -78,3 +78,30 @@ TEST(rect) {
 		EXPECT(valid, true);
 	}
 }
+
+TEST(intersects) {
+	// crossing rects, neither contains a corner of the other
+	nytl::Rect2i a {{0, 40}, {100, 20}};
+	nytl::Rect2i b {{40, 0}, {20, 100}};
+	EXPECT(nytl::intersects(a, b), true);
+	EXPECT(nytl::intersectsReal(a, b), true);
+
+	// separated
+	nytl::Rect2i far {{100, 0}, {10, 10}};
+	EXPECT(nytl::intersects(a, far), false);
+	EXPECT(nytl::intersects(b, far), false);
+
+	// touching at an edge: intersecting, but without a common area
+	nytl::Rect2i c {{0, 0}, {10, 10}};
+	nytl::Rect2i d {{10, 0}, {10, 10}};
+	EXPECT(nytl::intersects(c, d), true);
+	EXPECT(nytl::intersects(d, c), true);
+	EXPECT(nytl::intersectsReal(c, d), false);
+	EXPECT(nytl::intersectsReal(d, c), false);
+	EXPECT(nytl::intersects(b, nytl::Rect2i{{60, 50}, {5, 5}}), true);
+	EXPECT(nytl::intersectsReal(b, nytl::Rect2i{{60, 50}, {5, 5}}), false);
+
+	EXPECT(nytl::intersects(a, a), true);
+	EXPECT(nytl::intersectsReal(a, a), true);
+	EXPECT(nytl::intersects(a, nytl::Rect2i{{200, 200}, {1, 1}}), false);
+}
@@ -0,0 +1,171 @@
+#include "test.hpp"
+#include <nytl/rectArray.hpp>
+#include <nytl/rectOps.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace nytl;
+
+namespace {
+
+template<std::size_t D, typename T>
+std::vector<Rect<D, T>> randomRects(unsigned count, std::mt19937& rng) {
+	std::uniform_int_distribution<int> pos(0, 100);
+	std::uniform_int_distribution<int> size(0, 30);
+	std::vector<Rect<D, T>> ret(count);
+	for(auto& rect : ret) {
+		for(auto a = 0u; a < D; ++a) {
+			rect.position[a] = T(pos(rng));
+			rect.size[a] = T(size(rng));
+		}
+	}
+	return ret;
+}
+
+bool bit(const std::vector<std::uint64_t>& mask, std::size_t i) {
+	return (mask[i / 64] >> (i % 64)) & 1;
+}
+
+// compares all queries with the functions from rectOps
+template<std::size_t D, typename T>
+void check(unsigned count) {
+	std::mt19937 rng(count);
+	auto rects = randomRects<D, T>(count, rng);
+	auto queries = randomRects<D, T>(20, rng);
+	RectArray<D, T> array(rects);
+	EXPECT(array.size(), count);
+
+	for(auto& query : queries) {
+		auto point = query.position;
+		auto contains = array.containsMask(point);
+		auto intersects = array.intersectsMask(query);
+		EXPECT(contains.size(), (count + 63) / 64);
+
+		std::vector<std::uint32_t> containsIds, intersectsIds, ids;
+		std::vector<Rect<D, T>> intersections;
+		array.containsAll(point, containsIds);
+		array.intersectsAll(query, intersectsIds);
+		array.intersectionAll(query, ids, intersections);
+
+		std::vector<std::uint32_t> expectContains, expectIntersects;
+		std::vector<Rect<D, T>> expectIntersections;
+		for(auto i = 0u; i < count; ++i) {
+			EXPECT(bit(contains, i), nytl::contains(rects[i], point));
+			EXPECT(bit(intersects, i), nytl::intersects(rects[i], query));
+			if(nytl::contains(rects[i], point)) {
+				expectContains.push_back(i);
+			}
+			if(nytl::intersects(rects[i], query)) {
+				expectIntersects.push_back(i);
+				expectIntersections.push_back(nytl::intersection(rects[i], query));
+			}
+		}
+
+		// unused bits are cleared
+		if(count % 64) {
+			EXPECT(contains.back() >> (count % 64), 0u);
+			EXPECT(intersects.back() >> (count % 64), 0u);
+		}
+
+		EXPECT(containsIds == expectContains, true);
+		EXPECT(intersectsIds == expectIntersects, true);
+		EXPECT(ids == expectIntersects, true);
+		EXPECT(intersections == expectIntersections, true);
+	}
+}
+
+} // anon namespace
+
+TEST(queries) {
+	check<2, float>(1);
+	check<2, float>(63);
+	check<2, float>(1000);
+	check<2, double>(130);
+	check<2, int>(257);
+	check<3, float>(3000);
+	check<1, double>(100);
+}
+
+// all levels compute the same masks
+TEST(dispatch) {
+	std::mt19937 rng(42);
+	auto rects = randomRects<2, float>(64 * 5, rng);
+	RectArray<2, float> array(rects);
+	float q[4] = {20.f, 30.f, 50.f, 40.f};
+
+	using Kernel = detail::RectOverlapKernel<2, float>;
+	using Sig = void(const float*, std::size_t, const float*, std::size_t, std::uint64_t*);
+	std::uint64_t expected[5];
+	Dispatch<Kernel, Sig>::get(Isa::scalar)(array.min(0), 64 * 5, q, 64 * 5, expected);
+
+	for(auto i = 0u; i < isaCount; ++i) {
+		auto func = Dispatch<Kernel, Sig>::get(static_cast<Isa>(i));
+		if(!func) {
+			continue;
+		}
+
+		std::uint64_t mask[5];
+		func(array.min(0), 64 * 5, q, 64 * 5, mask);
+		for(auto w = 0u; w < 5; ++w) {
+			EXPECT(mask[w], expected[w]);
+		}
+	}
+}
+
+TEST(modify) {
+	RectArray<2, int> array;
+	EXPECT(array.empty(), true);
+	EXPECT(array.containsMask({0, 0}).size(), 0u);
+
+	for(auto i = 0; i < 100; ++i) {
+		array.push_back({{i, i}, {1, 1}});
+	}
+
+	EXPECT(array.size(), 100u);
+	EXPECT(array[42], (Rect2i{{42, 42}, {1, 1}}));
+
+	std::vector<std::uint32_t> ids;
+	EXPECT(array.containsAll({42, 42}, ids), 2u);
+	EXPECT(ids[0], 41u);
+	EXPECT(ids[1], 42u);
+
+	array.set(0, {{40, 40}, {5, 5}});
+	ids.clear();
+	ids.reserve(16);
+	EXPECT_ALLOCS(array.containsAll({42, 42}, ids), 0u);
+	EXPECT(ids.size(), 3u);
+	EXPECT(ids[0], 0u);
+
+	// old rects in the padding must not be reported
+	array.clear();
+	array.push_back({{0, 0}, {1000, 1000}});
+	auto mask = array.containsMask({42, 42});
+	EXPECT(mask.size(), 1u);
+	EXPECT(mask[0], 1u);
+}
+
+TEST(lowestBit) {
+	EXPECT(lowestBit(1u), 0u);
+	EXPECT(lowestBit(0b101000u), 3u);
+	EXPECT(lowestBit(std::uint64_t(1) << 63), 63u);
+	EXPECT(lowestBit(~std::uint64_t(0)), 0u);
+}
+
+// appending to the same vectors reallocates them geometrically
+TEST(append) {
+	RectArray<2, int> array;
+	array.push_back({{0, 0}, {10, 10}});
+
+	std::vector<std::uint32_t> ids;
+	std::vector<Rect2i> rects;
+	auto before = bugged::AllocCounter::count();
+	for(auto i = 0u; i < 1024; ++i) {
+		array.intersectionAll({{1, 1}, {2, 2}}, ids, rects);
+	}
+
+	EXPECT(rects.size(), 1024u);
+	EXPECT(rects.back(), (Rect2i{{1, 1}, {2, 2}}));
+	auto allocs = bugged::AllocCounter::count() - before;
+	EXPECT(!bugged::AllocCounter::enabled || allocs <= 2 * 11u, true);
+}
@@ -0,0 +1,186 @@
+#include "test.hpp"
+#include <nytl/simplexOps.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <random>
+#include <vector>
+
+TEST(cast) {
+	nytl::Triangle<3, double> tri {{{{1., 2., 3.}, {4., 5., 6.}, {7., 8., 9.}}}};
+	auto casted = static_cast<nytl::Triangle<2, float>>(tri);
+	EXPECT(casted.points_[0], (nytl::Vec2f {1.f, 2.f}));
+	EXPECT(casted.points_[2], (nytl::Vec2f {7.f, 8.f}));
+}
+
+TEST(barycentric) {
+	// triangle in 2D
+	nytl::Triangle<2, double> tri {{{{0., 0.}, {2., 0.}, {0., 2.}}}};
+	auto coords = nytl::barycentric(tri, nytl::Vec2d {0.5, 0.5});
+	EXPECT(coords, nytl::approx(nytl::Vec3d {0.5, 0.25, 0.25}));
+	EXPECT(nytl::world(tri, coords), nytl::approx(nytl::Vec2d {0.5, 0.5}));
+	EXPECT(nytl::contains(tri, nytl::Vec2d {0.5, 0.5}), true);
+	EXPECT(nytl::contains(tri, nytl::Vec2d {1., 1.}), true);
+	EXPECT(nytl::contains(tri, nytl::Vec2d {1.1, 1.}), false);
+	EXPECT(nytl::contains(tri, nytl::Vec2d {-0.1, 1.}), false);
+
+	// triangle in 3D: the point is projected onto the plane
+	nytl::Triangle<3, float> tri3 {{{{0.f, 0.f, 1.f}, {2.f, 0.f, 1.f}, {0.f, 2.f, 1.f}}}};
+	auto coords3 = nytl::barycentric(tri3, nytl::Vec3f {0.5f, 0.5f, 3.f});
+	EXPECT(coords3, nytl::approx(nytl::Vec3f {0.5f, 0.25f, 0.25f}));
+	EXPECT(nytl::contains(tri3, nytl::Vec3f {0.5f, 0.5f, 1.f}), true);
+	EXPECT(nytl::contains(tri3, nytl::Vec3f {0.5f, 0.5f, 1.1f}), false);
+	EXPECT(nytl::contains(tri3, nytl::Vec3f {0.5f, 0.5f, 1.1f}, 0.2), true);
+
+	// line in 3D
+	nytl::Line<3> line {{{{1., 1., 1.}, {3., 1., 1.}}}};
+	auto lcoords = nytl::barycentric(line, nytl::Vec3d {1.5, 5., 1.});
+	EXPECT(lcoords, nytl::approx(nytl::Vec2d {0.75, 0.25}));
+	EXPECT(nytl::contains(line, nytl::Vec3d {2., 1., 1.}), true);
+	EXPECT(nytl::contains(line, nytl::Vec3d {2., 1.1, 1.}), false);
+
+	// tetrahedron
+	nytl::Tetrahedron<3> tet {{{
+		{0., 0., 0.}, {1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}
+	}}};
+
+	auto tcoords = nytl::barycentric(tet, nytl::Vec3d {0.1, 0.2, 0.3});
+	EXPECT(tcoords, nytl::approx(nytl::Vec4d {0.4, 0.1, 0.2, 0.3}));
+	EXPECT(nytl::contains(tet, nytl::Vec3d {0.1, 0.2, 0.3}), true);
+	EXPECT(nytl::contains(tet, nytl::Vec3d {0.5, 0.5, 0.5}), false);
+
+	// round trip for a random, non-axis aligned 4-simplex
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<double> dist(-1., 1.);
+	nytl::Simplex<4, double, 4> s {};
+	for(auto& p : s.points_) {
+		for(auto& v : p) {
+			v = dist(rng);
+		}
+	}
+
+	nytl::Vec<5, double> weights {0.1, 0.2, 0.3, 0.15, 0.25};
+	auto point = nytl::world(s, weights);
+	EXPECT(nytl::barycentric(s, point), nytl::approx(weights));
+}
+
+TEST(closest_point) {
+	nytl::Line<2> line {{{{0., 0.}, {2., 0.}}}};
+	EXPECT(nytl::closestPoint(line, nytl::Vec2d {1., 1.}),
+		nytl::approx(nytl::Vec2d {1., 0.}));
+	EXPECT(nytl::closestPoint(line, nytl::Vec2d {-1., 1.}),
+		nytl::approx(nytl::Vec2d {0., 0.}));
+	EXPECT(nytl::closestPoint(line, nytl::Vec2d {5., -1.}),
+		nytl::approx(nytl::Vec2d {2., 0.}));
+
+	nytl::Triangle<3> tri {{{{0., 0., 0.}, {1., 0., 0.}, {0., 1., 0.}}}};
+	EXPECT(nytl::closestPoint(tri, nytl::Vec3d {0.2, 0.2, 5.}),
+		nytl::approx(nytl::Vec3d {0.2, 0.2, 0.}));
+	EXPECT(nytl::closestPoint(tri, nytl::Vec3d {2., 2., 1.}),
+		nytl::approx(nytl::Vec3d {0.5, 0.5, 0.}));
+	EXPECT(nytl::closestPoint(tri, nytl::Vec3d {-1., -1., 0.}),
+		nytl::approx(nytl::Vec3d {0., 0., 0.}));
+	EXPECT(nytl::closestPoint(tri, nytl::Vec3d {0.5, -1., 0.}),
+		nytl::approx(nytl::Vec3d {0.5, 0., 0.}));
+
+	nytl::Tetrahedron<3> tet {{{
+		{0., 0., 0.}, {1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}
+	}}};
+
+	EXPECT(nytl::closestPoint(tet, nytl::Vec3d {0.1, 0.1, 0.1}),
+		nytl::approx(nytl::Vec3d {0.1, 0.1, 0.1}));
+	EXPECT(nytl::closestPoint(tet, nytl::Vec3d {1., 1., 1.}),
+		nytl::approx(nytl::Vec3d {1 / 3., 1 / 3., 1 / 3.}));
+	EXPECT(nytl::closestPoint(tet, nytl::Vec3d {0.2, 0.2, -1.}),
+		nytl::approx(nytl::Vec3d {0.2, 0.2, 0.}));
+}
+
+TEST(ray) {
+	nytl::Triangle<3, float> tri {{{{0.f, 0.f, 2.f}, {1.f, 0.f, 2.f}, {0.f, 1.f, 2.f}}}};
+	nytl::Vec3f origin {0.25f, 0.25f, 0.f};
+
+	auto hit = nytl::intersectRay(tri, origin, nytl::Vec3f {0.f, 0.f, 1.f});
+	EXPECT(hit.has_value(), true);
+	EXPECT(hit->t, nytl::approx(2.f));
+	EXPECT(hit->uv, nytl::approx(nytl::Vec2f {0.25f, 0.25f}));
+
+	// back side, unnormalized direction
+	auto back = nytl::intersectRay(tri, nytl::Vec3f {0.25f, 0.25f, 4.f},
+		nytl::Vec3f {0.f, 0.f, -2.f});
+	EXPECT(back.has_value(), true);
+	EXPECT(back->t, nytl::approx(1.f));
+
+	// misses
+	EXPECT(nytl::intersectRay(tri, origin, nytl::Vec3f {0.f, 0.f, -1.f}).has_value(), false);
+	EXPECT(nytl::intersectRay(tri, origin, nytl::Vec3f {1.f, 0.f, 0.f}).has_value(), false);
+	EXPECT(nytl::intersectRay(tri, nytl::Vec3f {0.75f, 0.75f, 0.f},
+		nytl::Vec3f {0.f, 0.f, 1.f}).has_value(), false);
+	EXPECT(nytl::intersectRay(tri, origin, nytl::Vec3f {0.f, 0.f, 1.f}, 1.5).has_value(), false);
+
+	// segments
+	auto seg = nytl::intersectSegment(tri, origin, nytl::Vec3f {0.25f, 0.25f, 4.f});
+	EXPECT(seg.has_value(), true);
+	EXPECT(seg->t, nytl::approx(0.5f));
+	EXPECT(nytl::intersectSegment(tri, origin, nytl::Vec3f {0.25f, 0.25f, 1.f}).has_value(),
+		false);
+}
+
+template<typename P>
+void checkBatch() {
+	using Vec3 = nytl::Vec3<P>;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<P> dist(-1, 1);
+
+	// triangles in front of the origin, facing it
+	std::vector<nytl::Triangle<3, P>> tris(1037);
+	for(auto& tri : tris) {
+		Vec3 center {dist(rng), dist(rng), 2 + 2 * dist(rng)};
+		for(auto& p : tri.points_) {
+			p = center + P(0.2) * Vec3 {dist(rng), dist(rng), dist(rng)};
+		}
+	}
+
+	Vec3 origin {0, 0, -1};
+	auto hits = 0u;
+	for(auto r = 0u; r < 64; ++r) {
+		Vec3 dir {P(0.3) * dist(rng), P(0.3) * dist(rng), 1};
+
+		// reference: scalar loop over all triangles
+		std::optional<nytl::RayHit<P>> expected;
+		for(auto i = 0u; i < tris.size(); ++i) {
+			auto hit = nytl::intersectRay(tris[i], origin, dir);
+			if(hit && (!expected || hit->t < expected->t)) {
+				expected = hit;
+				expected->index = i;
+			}
+		}
+
+		auto hit = nytl::closestHit(tris, origin, dir);
+		EXPECT(hit.has_value(), expected.has_value());
+		EXPECT(nytl::anyHit(tris, origin, dir), expected.has_value());
+		if(hit && expected) {
+			++hits;
+			EXPECT(hit->index, expected->index);
+			EXPECT(hit->t, nytl::approx(expected->t));
+			EXPECT(hit->uv, nytl::approx(expected->uv));
+
+			// maxT excludes the closest hit
+			auto further = nytl::closestHit(tris, origin, dir, expected->t * P(0.99));
+			EXPECT(!further || further->t <= expected->t * P(0.99), true);
+		}
+	}
+
+	EXPECT(hits > 0u, true);
+
+	// fewer triangles than lanes
+	auto small = nytl::Span<const nytl::Triangle<3, P>>(tris).first(1);
+	auto dir = Vec3 {0, 0, 1};
+	EXPECT(nytl::closestHit(small, origin, dir).has_value(),
+		nytl::intersectRay(tris[0], origin, dir).has_value());
+	EXPECT(nytl::closestHit(std::vector<nytl::Triangle<3, P>> {}, origin, dir).has_value(),
+		false);
+}
+
+TEST(batch) {
+	checkBatch<float>();
+	checkBatch<double>();
+}
@@ -3,6 +3,7 @@
 #include <nytl/tmpUtil.hpp>
 #include <string>
 #include <array>
+#include <vector>
 
 void foo(nytl::Span<std::string> names, int& count) {
 	for(auto& name : names) count += name.size();
@@ -73,3 +74,19 @@ TEST(span) {
 	foo({namesVector.data(), 4}, count);
 	foo({namesVector.data(), (int) namesVector.size()}, count);
 }
+
+// spans are non-owning views, creating and slicing them never allocates
+TEST(allocations) {
+	std::array<int, 6> arr {1, 2, 3, 4, 5, 6};
+	std::vector<int> vec(arr.begin(), arr.end());
+	auto sumSpan = [](nytl::Span<const int> span) {
+		auto sum = 0;
+		for(auto val : span) sum += val;
+		return sum;
+	};
+
+	auto sum = 0;
+	EXPECT_ALLOCS(sum += sumSpan(nytl::Span<int>(vec).subspan(1, 3)), 0u);
+	EXPECT_ALLOCS(sum += sumSpan((nytl::Span<const int, 6>(arr).subspan<2, 2>())), 0u);
+	EXPECT(sum, 2 + 3 + 4 + 3 + 4);
+}
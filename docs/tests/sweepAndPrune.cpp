@@ -0,0 +1,222 @@
+#include "test.hpp"
+#include <nytl/sweepAndPrune.hpp>
+#include <nytl/rectOps.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace nytl;
+
+namespace {
+
+template<std::size_t D, typename T>
+using Pairs = std::vector<typename SweepAndPrune<D, T>::Pair>;
+
+// all overlapping pairs of the given rects, erased ones have an empty size
+template<std::size_t D, typename T>
+Pairs<D, T> bruteForce(const std::vector<Rect<D, T>>& rects,
+		const std::vector<bool>& alive) {
+	Pairs<D, T> ret;
+	for(auto a = 0u; a < rects.size(); ++a) {
+		for(auto b = a + 1; b < rects.size(); ++b) {
+			if(alive[a] && alive[b] && intersects(rects[a], rects[b])) {
+				ret.push_back({a, b});
+			}
+		}
+	}
+	return ret;
+}
+
+template<std::size_t D, typename T>
+struct Tracker {
+	SweepAndPrune<D, T> sap;
+	std::set<typename SweepAndPrune<D, T>::Pair> pairs; // from the events
+	unsigned began {};
+	unsigned ended {};
+
+	Tracker() {
+		sap.onBegin.add([&](std::uint32_t a, std::uint32_t b) {
+			EXPECT(a < b, true);
+			EXPECT(pairs.insert({a, b}).second, true);
+			++began;
+		});
+
+		sap.onEnd.add([&](std::uint32_t a, std::uint32_t b) {
+			EXPECT(pairs.erase({a, b}), 1u);
+			++ended;
+		});
+	}
+
+	void check(const std::vector<Rect<D, T>>& rects, const std::vector<bool>& alive) {
+		auto expected = bruteForce(rects, alive);
+		EXPECT(sap.pairs() == expected, true);
+		EXPECT((Pairs<D, T>(pairs.begin(), pairs.end()) == expected), true);
+	}
+};
+
+// Moves, inserts and erases rects for some frames. Checks the pairs against
+// the brute force results or, with workers (i.e. many rects),
+// against the pairs computed on a single thread.
+template<std::size_t D>
+void simulate(unsigned count, unsigned workers, unsigned frames, float speed) {
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<float> pos(0.f, 100.f);
+	std::uniform_real_distribution<float> size(0.f, 4.f);
+	std::uniform_real_distribution<float> step(-speed, speed);
+	auto random = [&]{
+		Rect<D, float> ret;
+		for(auto a = 0u; a < D; ++a) {
+			ret.position[a] = pos(rng);
+			ret.size[a] = size(rng);
+		}
+		return ret;
+	};
+
+	Tracker<D, float> trackers[2];
+	std::vector<Rect<D, float>> rects;
+	std::vector<bool> alive;
+	TaskScheduler scheduler(workers), single(0);
+
+	auto update = [&]{
+		trackers[0].sap.update(&scheduler);
+		trackers[1].sap.update(&single);
+		if(workers == 0) {
+			trackers[0].check(rects, alive);
+			return;
+		}
+
+		EXPECT(trackers[0].sap.pairs() == trackers[1].sap.pairs(), true);
+		EXPECT(trackers[0].began, trackers[1].began);
+		EXPECT(trackers[0].ended, trackers[1].ended);
+	};
+
+	auto set = [&](std::uint32_t id) {
+		for(auto& tracker : trackers) {
+			tracker.sap.set(id, rects[id]);
+		}
+	};
+
+	for(auto i = 0u; i < count; ++i) {
+		rects.push_back(random());
+		alive.push_back(true);
+		for(auto& tracker : trackers) {
+			EXPECT(tracker.sap.insert(rects.back()), i);
+		}
+	}
+
+	update();
+	for(auto frame = 0u; frame < frames; ++frame) {
+		// coherent motion, some teleports, inserts and erases
+		for(auto i = 0u; i < rects.size(); ++i) {
+			if(!alive[i]) {
+				continue;
+			}
+
+			if(rng() % 50 == 0) {
+				rects[i] = random();
+			} else {
+				for(auto a = 0u; a < D; ++a) {
+					rects[i].position[a] += step(rng);
+				}
+			}
+
+			set(i);
+		}
+
+		for(auto i = 0u; i < 3; ++i) {
+			auto id = std::uint32_t(rng() % rects.size());
+			if(alive[id]) {
+				for(auto& tracker : trackers) {
+					tracker.sap.erase(id);
+				}
+				alive[id] = false;
+			}
+		}
+
+		// ids of rects erased in this frame are only reused after update
+		auto rect = random();
+		auto id = trackers[0].sap.insert(rect);
+		EXPECT(trackers[1].sap.insert(rect), id);
+		if(id == rects.size()) {
+			rects.emplace_back();
+			alive.push_back(false);
+		}
+
+		EXPECT(alive[id], false);
+		rects[id] = trackers[0].sap.rect(id);
+		alive[id] = true;
+
+		// everything teleports: sorted from scratch
+		if(frame == frames - 2) {
+			for(auto i = 0u; i < rects.size(); ++i) {
+				if(alive[i]) {
+					rects[i] = random();
+					set(i);
+				}
+			}
+		}
+
+		update();
+	}
+
+	EXPECT(trackers[0].sap.size(), std::size_t(std::count(alive.begin(), alive.end(), true)));
+}
+
+} // anon namespace
+
+TEST(basic) {
+	Tracker<2, int> tracker;
+	auto& sap = tracker.sap;
+	auto a = sap.insert({{0, 0}, {10, 10}});
+	auto b = sap.insert({{12, 0}, {10, 10}});
+	auto c = sap.insert({{5, 5}, {10, 10}});
+	EXPECT(sap.pairs().empty(), true);
+
+	sap.update();
+	EXPECT(tracker.began, 2u);
+	EXPECT(sap.overlapping(a, c), true);
+	EXPECT(sap.overlapping(c, b), true);
+	EXPECT(sap.overlapping(a, b), false);
+
+	// touching rects overlap
+	sap.set(b, {{10, 10}, {10, 10}});
+	sap.set(c, {{200, 200}, {1, 1}});
+	sap.update();
+	EXPECT(sap.pairs().size(), 1u);
+	EXPECT(sap.overlapping(a, b), true);
+	EXPECT(tracker.ended, 2u);
+
+	// crossing without corners inside
+	sap.set(a, {{0, 40}, {100, 20}});
+	sap.set(b, {{40, 0}, {20, 100}});
+	sap.update();
+	EXPECT(sap.overlapping(b, a), true);
+
+	sap.erase(a);
+	sap.update();
+	EXPECT(sap.pairs().empty(), true);
+	EXPECT(tracker.ended, 3u);
+	EXPECT(sap.size(), 2u);
+	EXPECT(sap.insert({{0, 0}, {100, 100}}), a);
+	EXPECT(sap.rect(b), (Rect2i{{40, 0}, {20, 100}}));
+
+	// no changes, no events
+	sap.update();
+	auto events = tracker.began + tracker.ended;
+	sap.update();
+	EXPECT(tracker.began + tracker.ended, events);
+	EXPECT(sap.pairs().size(), 1u);
+}
+
+TEST(simulation) {
+	simulate<2>(300, 0, 30, 0.5f);
+	simulate<3>(200, 0, 30, 0.5f);
+	simulate<1>(100, 0, 30, 0.5f);
+}
+
+// enough rects to sort the axes in parallel
+TEST(threads) {
+	simulate<3>(SweepAndPrune<3, float>::minParallelCount, 2, 6, 0.02f);
+}
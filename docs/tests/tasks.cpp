@@ -0,0 +1,200 @@
+#include "test.hpp"
+#include <nytl/tasks.hpp>
+#include <nytl/approxVec.hpp>
+#include <nytl/vecOps.hpp>
+
+#include <array>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+unsigned fib(nytl::TaskScheduler& scheduler, unsigned n) {
+	if(n < 2) {
+		return n;
+	}
+
+	unsigned a, b;
+	nytl::TaskGroup group(scheduler);
+	group.run([&]{ a = fib(scheduler, n - 1); });
+	b = fib(scheduler, n - 2);
+	group.wait();
+	return a + b;
+}
+
+} // anon namespace
+
+TEST(group) {
+	for(auto workers : {0u, 1u, 3u}) {
+		nytl::TaskScheduler scheduler(workers);
+		EXPECT(scheduler.workers(), workers);
+		EXPECT(fib(scheduler, 20), 6765u);
+
+		// many tasks from a task: more than fit into a deque
+		std::atomic<unsigned> counter {0};
+		nytl::TaskGroup outer(scheduler);
+		outer.run([&]{
+			nytl::TaskGroup inner(scheduler);
+			for(auto i = 0u; i < 10000; ++i) {
+				inner.run([&]{ ++counter; });
+			}
+			inner.wait();
+		});
+
+		auto completed = 0u;
+		outer.onComplete += [&]{ ++completed; };
+		outer.wait();
+		EXPECT(counter.load(), 10000u);
+		EXPECT(completed, 1u);
+
+		// detached tasks are finished by the destructor
+		for(auto i = 0u; i < 100; ++i) {
+			scheduler.spawn([&]{ ++counter; });
+		}
+	}
+}
+
+TEST(spawn) {
+	std::atomic<int> counter {0};
+	{
+		nytl::TaskScheduler scheduler(3);
+		EXPECT(scheduler.concurrency(), 4u);
+		for(auto i = 0; i < 1000; ++i) {
+			scheduler.spawn([&]{ ++counter; });
+		}
+	}
+
+	// the destructor waits for all tasks
+	EXPECT(counter.load(), 1000);
+
+	// without workers, tasks are only run by runPending
+	nytl::TaskScheduler empty(0);
+	empty.spawn([&]{ ++counter; });
+	EXPECT(counter.load(), 1000);
+	EXPECT(empty.runPending(), true);
+	EXPECT(empty.runPending(), false);
+	EXPECT(counter.load(), 1001);
+}
+
+TEST(exceptions) {
+	nytl::TaskScheduler scheduler(2);
+	nytl::TaskGroup group(scheduler);
+	std::atomic<unsigned> counter {0};
+	for(auto i = 0u; i < 100; ++i) {
+		group.run([&, i]{
+			++counter;
+			if(i == 50) {
+				throw std::runtime_error("task");
+			}
+		});
+	}
+
+	ERROR(group.wait(), std::runtime_error);
+	EXPECT(counter.load() <= 100u, true);
+	EXPECT(group.failed(), false);
+
+	// the group can be reused
+	group.run([&]{ ++counter; });
+	group.wait();
+
+	// large callables are allocated
+	std::array<double, 64> values {};
+	values[63] = 1.0;
+	auto sum = 0.0;
+	group.run([values, &sum]{ sum = values[63]; });
+	group.wait();
+	EXPECT(sum, 1.0);
+}
+
+TEST(parallel_for) {
+	nytl::TaskScheduler scheduler(3);
+	std::vector<std::atomic<unsigned>> visits(100000);
+	nytl::parallelFor(scheduler, 0, visits.size(), [&](auto i) { ++visits[i]; });
+	auto once = true;
+	for(auto& visit : visits) {
+		once &= (visit.load() == 1u);
+	}
+	EXPECT(once, true);
+
+	std::vector<nytl::Vec3f> vecs(10000, nytl::Vec3f {3.f, 0.f, 4.f});
+	nytl::parallelFor(scheduler, 10, vecs.size(), [&](auto i) {
+		nytl::normalize(vecs[i]);
+	}, 64);
+	EXPECT(vecs[9], (nytl::Vec3f {3.f, 0.f, 4.f}));
+	EXPECT(vecs[10], nytl::approx(nytl::Vec3f {0.6f, 0.f, 0.8f}, 1e-6));
+	EXPECT(vecs.back(), nytl::approx(nytl::Vec3f {0.6f, 0.f, 0.8f}, 1e-6));
+
+	ERROR(nytl::parallelFor(scheduler, 0, 1000, [](auto i) {
+		if(i == 567) {
+			throw std::runtime_error("index");
+		}
+	}, 10), std::runtime_error);
+
+	// the result does not depend on the number of threads
+	auto func = [](float acc, std::size_t i) { return acc + 1.f / (i + 1); };
+	auto add = [](float a, float b) { return a + b; };
+	nytl::TaskScheduler single(0);
+	auto a = nytl::parallelReduce(scheduler, 0, 100000, 0.f, func, add);
+	auto b = nytl::parallelReduce(single, 0, 100000, 0.f, func, add);
+	EXPECT(a, b);
+	EXPECT(a, nytl::approx(12.0901f, 1e-3));
+	EXPECT(nytl::parallelReduce(scheduler, 5, 5, 1, func, add), 1);
+}
+
+TEST(graph) {
+	nytl::TaskScheduler scheduler(3);
+
+	// diamond layers: every task of a layer depends on all tasks of the previous one
+	constexpr auto layers = 20u;
+	constexpr auto width = 8u;
+	nytl::TaskGraph graph;
+	std::atomic<unsigned> step {0};
+	std::vector<unsigned> order(layers * width);
+	for(auto l = 0u; l < layers; ++l) {
+		for(auto w = 0u; w < width; ++w) {
+			auto id = graph.add([&, l, w]{ order[l * width + w] = step++; });
+			EXPECT(id, std::size_t(l * width + w));
+			for(auto p = 0u; l > 0 && p < width; ++p) {
+				graph.precede((l - 1) * width + p, id);
+			}
+		}
+	}
+
+	std::vector<std::atomic<unsigned>> completed(graph.size());
+	graph.onTaskComplete += [&](std::size_t id) { ++completed[id]; };
+	auto done = 0u;
+	graph.onComplete += [&]{ ++done; };
+
+	for(auto run = 0u; run < 3; ++run) {
+		step = 0;
+		graph.run(scheduler);
+		EXPECT(done, run + 1);
+		for(auto l = 1u; l < layers; ++l) {
+			for(auto w = 0u; w < width; ++w) {
+				for(auto p = 0u; p < width; ++p) {
+					EXPECT(order[(l - 1) * width + p] < order[l * width + w], true);
+				}
+			}
+		}
+	}
+
+	EXPECT(completed[0].load(), 3u);
+	EXPECT(completed.back().load(), 3u);
+
+	// failing tasks skip their successors
+	nytl::TaskGraph failing;
+	auto ran = false;
+	auto first = failing.add([]{ throw std::runtime_error("graph"); });
+	auto second = failing.add([&]{ ran = true; });
+	failing.precede(first, second);
+	ERROR(failing.run(scheduler), std::runtime_error);
+	EXPECT(ran, false);
+
+	// cycles are detected
+	failing.precede(second, first);
+	ERROR(failing.run(scheduler), std::logic_error);
+
+	nytl::TaskGraph empty;
+	empty.run(scheduler);
+}
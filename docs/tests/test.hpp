@@ -4,3 +4,4 @@ namespace nytl::approxOps {}
 using namespace nytl::approxOps;
 
 #include "bugged.hpp"
+#include "perf.hpp"
@@ -0,0 +1,119 @@
+#include "test.hpp"
+#include <nytl/quat.hpp>
+#include <nytl/transform.hpp>
+#include <nytl/vecOps.hpp>
+#include <nytl/matOps.hpp>
+#include <nytl/math.hpp>
+#include <nytl/approx.hpp>
+#include <nytl/approxVec.hpp>
+
+#include <vector>
+#include <cmath>
+
+using namespace nytl;
+using nytl::constants::pi;
+
+// quaternions q and -q describe the same rotation
+bool sameRotation(const Quatd& a, const Quatd& b) {
+	return std::abs(std::abs(dot(a, b)) - 1.0) < 1e-9;
+}
+
+TEST(quat) {
+	auto q = axisAngle(Vec3d{0.0, 0.0, 1.0}, pi / 2);
+	EXPECT(length(q), nytl::approx(1.0));
+	EXPECT(apply(q, Vec3d{1.0, 0.0, 0.0}), nytl::approx(Vec3d{0.0, 1.0, 0.0}));
+	EXPECT(apply(q * q, Vec3d{1.0, 2.0, 3.0}), nytl::approx(Vec3d{-1.0, -2.0, 3.0}));
+	EXPECT(apply(Quatd{}, Vec3d{1.0, 2.0, 3.0}), (Vec3d{1.0, 2.0, 3.0}));
+
+	// composition: first b, then a
+	auto a = axisAngle(Vec3d{1.0, 0.0, 0.0}, 0.3);
+	auto b = axisAngle(normalized(Vec3d{1.0, -2.0, 0.5}), 1.7);
+	auto v = Vec3d{0.5, -1.0, 2.0};
+	EXPECT(apply(a * b, v), nytl::approx(apply(a, apply(b, v))));
+	EXPECT(sameRotation(a * conjugate(a), Quatd{}), true);
+	EXPECT(sameRotation(inverse(b), conjugate(b)), true);
+
+	// matrix conversion
+	EXPECT(toMat3(b) * v, nytl::approx(apply(b, v)));
+	auto bv = apply(b, v);
+	auto hv = toMat4(b) * Vec4d{v.x, v.y, v.z, 1.0};
+	EXPECT(hv, (nytl::approx(Vec4d{bv.x, bv.y, bv.z, 1.0})));
+	EXPECT(sameRotation(toQuat(toMat3(b)), b), true);
+	EXPECT(sameRotation(toQuat(toMat4(a * b)), a * b), true);
+	EXPECT(sameRotation(toQuat(toMat3(axisAngle(Vec3d{0.0, 1.0, 0.0}, pi))),
+		axisAngle(Vec3d{0.0, 1.0, 0.0}, pi)), true);
+
+	ERROR(normalized(Quatd{0.0, 0.0, 0.0, 0.0}), std::domain_error);
+}
+
+TEST(slerp) {
+	auto axis = Vec3d{0.0, 1.0, 0.0};
+	auto a = axisAngle(axis, 0.2);
+	auto b = axisAngle(axis, 1.4);
+	EXPECT(sameRotation(slerp(a, b, 0.0), a), true);
+	EXPECT(sameRotation(slerp(a, b, 1.0), b), true);
+	EXPECT(sameRotation(slerp(a, b, 0.5), axisAngle(axis, 0.8)), true);
+	EXPECT(sameRotation(slerp(a, b, 0.25), axisAngle(axis, 0.5)), true);
+
+	// shortest path: -b is the same rotation
+	auto nb = Quatd{-b.x, -b.y, -b.z, -b.w};
+	EXPECT(sameRotation(slerp(a, nb, 0.5), axisAngle(axis, 0.8)), true);
+
+	// (almost) equal rotations
+	EXPECT(sameRotation(slerp(a, a, 0.3), a), true);
+}
+
+TEST(transform) {
+	Transformd t;
+	t.translation = {1.0, 2.0, 3.0};
+	t.rotation = axisAngle(Vec3d{0.0, 0.0, 1.0}, pi / 2);
+	t.scale = {2.0, 2.0, 2.0};
+
+	auto p = Vec3d{1.0, 0.0, 0.0};
+	EXPECT(apply(t, p), nytl::approx(Vec3d{1.0, 4.0, 3.0}));
+	EXPECT(apply(Transformd{}, p), p);
+
+	// inverse and composition (uniform scale)
+	EXPECT(apply(inverse(t), apply(t, p)), nytl::approx(p));
+	Transformd u;
+	u.translation = {-1.0, 0.5, 0.0};
+	u.rotation = axisAngle(normalized(Vec3d{1.0, 1.0, 0.0}), 0.7);
+	u.scale = {0.5, 0.5, 0.5};
+
+	auto q = Vec3d{0.3, -2.0, 1.5};
+	EXPECT(apply(t * u, q), nytl::approx(apply(t, apply(u, q))));
+	EXPECT(apply(inverse(t * u) * t * u, q), nytl::approx(q));
+
+	// matrix conversion, also with non-uniform scale
+	u.scale = {1.0, -2.0, 3.0};
+	auto m = toMat4(u);
+	auto hq = m * Vec4d{q.x, q.y, q.z, 1.0};
+	EXPECT((Vec3d{hq[0], hq[1], hq[2]}), nytl::approx(apply(u, q)));
+	EXPECT(toMat4(t) * toMat4(u), nytl::approx(toMat4(t * u)));
+
+	auto d = toTransform(m);
+	EXPECT(apply(d, q), nytl::approx(apply(u, q)));
+	EXPECT(toMat4(d), nytl::approx(m));
+}
+
+TEST(batch) {
+	Transformf t;
+	t.translation = {1.f, -2.f, 0.5f};
+	t.rotation = axisAngle(normalized(Vec3f{1.f, 2.f, 3.f}), 0.6f);
+	t.scale = {1.5f, 0.5f, 2.f};
+
+	// odd count to test the remainder
+	std::vector<Vec3f> points;
+	for(auto i = 0u; i < 11; ++i) {
+		points.push_back({float(i), 1.f - i, 0.5f * i});
+	}
+
+	std::vector<Vec3f> out(points.size());
+	applyAll(t, points, out);
+	for(auto i = 0u; i < points.size(); ++i) {
+		EXPECT(out[i], nytl::approx(apply(t, points[i]), 1e-5));
+	}
+
+	applyAll(t, points);
+	EXPECT(points == out, true);
+}
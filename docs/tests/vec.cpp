@@ -5,6 +5,7 @@
 #include <cmath>
 #include <iomanip>
 #include <stdexcept>
+#include <type_traits>
 
 // testing both, vec and vecOps
 #include <nytl/vec.hpp>
@@ -97,6 +98,34 @@ TEST(basic) {
 	EXPECT(cpy != (Vec3d{12.0, 4.0, 1.0}), true);
 }
 
+TEST(access) {
+	// indexed access must work during constant evaluation
+	static_assert(d2c[1] == 2.5);
+	static_assert(d3f[2] == -4.0);
+	static_assert(d3f.at(0) == 100.0);
+
+	constexpr auto modified = [] {
+		auto v = Vec3i{1, 2, 3};
+		v[1] = 5;
+		v.at(2) += v[0];
+		return v;
+	}();
+	static_assert(modified == Vec3i{1, 5, 4});
+
+	auto cpy = d3a;
+	for(auto i = 0u; i < cpy.size(); ++i) {
+		cpy[i] *= 2;
+	}
+
+	EXPECT(cpy, (Vec3d{2.0, 4.0, 6.0}));
+	EXPECT(&cpy[2], &cpy.z);
+	EXPECT(&i2a[1], &i2a.y);
+	EXPECT(cpy.at(1), 4.0);
+	EXPECT(i2a.at(1), 2);
+	ERROR(cpy.at(3), std::out_of_range);
+	ERROR(i2a.at(2), std::out_of_range);
+}
+
 TEST(vec_addition) {
 	EXPECT(-d3a, nytl::approx(Vec3d{-1.0, -2.0, -3.0}));
 	EXPECT(d3a + d3b, nytl::approx(d3a));
@@ -252,3 +281,59 @@ TEST(component_wise) {
 	// pow
 	EXPECT(pow(d3f, 1), d3f);
 }
+
+// the operators are expanded over the components, check that they
+// work for all sizes, in constant expressions and keep the result types
+TEST(expanded) {
+	static_assert(i5a + i5b == nytl::Vec<5, int> {11, 22, -7, -16, 5});
+	static_assert(-i3a == Vec3i {1, 0, -2});
+	static_assert(nytl::dot(i7a, i7b) == 63);
+	static_assert(nytl::sum(i5b) == 0);
+	static_assert(nytl::multiply(i5a) == 120);
+	static_assert(vec::cw::max(i3a, Vec3i {0, 0, 0}) == Vec3i {0, 0, 2});
+	static_assert(nytl::cross(Vec3i {1, 0, 0}, Vec3i {0, 1, 0}) == Vec3i {0, 0, 1});
+
+	// results are promoted like the component operations
+	constexpr nytl::Vec<3, short> s3 {1, 2, 3};
+	static_assert(std::is_same_v<decltype(s3 + s3), Vec3i>);
+	static_assert(std::is_same_v<decltype(-s3), nytl::Vec<3, short>>);
+	static_assert(std::is_same_v<decltype(nytl::sum(s3)), int>);
+	static_assert(std::is_same_v<decltype(2.0 * i2a), Vec2d>);
+	EXPECT(nytl::sum(s3), 6);
+
+	// sizes without any or with a single component
+	constexpr nytl::Vec<0, float> e {};
+	constexpr nytl::Vec<1, float> o {-2.f};
+	static_assert(nytl::sum(e) == 0.f);
+	static_assert(nytl::multiply(e) == 1.f);
+	static_assert(nytl::dot(o, o) == 4.f);
+	static_assert(e + e == e);
+	static_assert(vec::cw::multiply(o, o) == nytl::Vec<1, float> {4.f});
+	EXPECT(std::signbit(nytl::sum(nytl::Vec<1, float> {-0.f})), true);
+
+	// casts leave out or default construct the remaining components
+	static_assert(static_cast<Vec2i>(i4a) == Vec2i {5, -2});
+	static_assert(static_cast<nytl::Vec<5, int>>(i3a) == nytl::Vec<5, int> {-1, 0, 2, 0, 0});
+	static_assert(static_cast<Vec4i>(i2a) == Vec4i {1, 2, 0, 0});
+	EXPECT(c2, (Vec4f {1243.f, 432.f, 1.f, 2.f}));
+
+	auto a = i5a;
+	a += i5b;
+	a -= i5a;
+	EXPECT(a, i5b);
+	a *= 2;
+	vec::cw::operators::operator*=(a, i5a);
+	vec::cw::operators::operator/=(a, i5a);
+	EXPECT(a, 2 * i5b);
+}
+
+// vec operations are done in place or return by value, never allocate
+TEST(allocations) {
+	auto a = d3a;
+	auto b = d3g;
+	EXPECT_ALLOCS(a = 2.0 * a + b, 0u);
+	EXPECT_ALLOCS(nytl::normalize(a), 0u);
+	EXPECT_ALLOCS(b = nytl::cross(a, b), 0u);
+	EXPECT_ALLOCS(nytl::unused(nytl::dot(a, b), nytl::length(a)), 0u);
+	EXPECT_ALLOCS(nytl::unused(vec::cw::clamp(i5b, i5a, i5a)), 0u);
+}
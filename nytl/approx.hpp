@@ -7,15 +7,26 @@
 /// By default uses a small (like 10^-10) epsilon value.
 /// Can be easily extended to custom types with floating-point
 /// components.
+/// Large arrays can be compared at once using nytl::approxCompare.
 
 #pragma once
 
 #ifndef NYTL_INCLUDE_APPROX_APPROX
 #define NYTL_INCLUDE_APPROX_APPROX
 
+#include <nytl/tmpUtil.hpp> // nytl::templatize
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/simd.hpp> // nytl::simd::Pack
+#include <nytl/dispatch.hpp> // nytl::Dispatch
+
 #include <complex> // std::complex
 #include <iosfwd> // std::ostream
-#include <nytl/tmpUtil.hpp> // nytl::templatize
+#include <cmath> // std::abs
+#include <cstdint> // std::uint64_t
+#include <cstring> // std::memcpy
+#include <algorithm> // std::max
+#include <limits> // std::numeric_limits
+#include <iterator> // std::data
 
 namespace nytl {
 
@@ -24,6 +35,69 @@ namespace nytl {
 /// it with the maximum of the compared values.
 constexpr auto defaultApproxEpsilon = 0.00000001;
 
+/// How two values are compared approximately.
+/// - mixed: |a - b| < epsilon * (1 + max(|a|, |b|)). Absolute near zero,
+///   relative for large values. The default.
+/// - absolute: |a - b| <= epsilon
+/// - relative: |a - b| <= epsilon * max(|a|, |b|)
+/// - ulp: a and b are at most epsilon representable values
+///   (units in the last place) apart. Use e.g. 4 as epsilon.
+/// NaN never compares equal in any mode.
+enum class ApproxMode {
+	mixed,
+	absolute,
+	relative,
+	ulp,
+};
+
+namespace detail {
+
+template<typename T> struct UlpInt { using type = void; };
+template<> struct UlpInt<float> { using type = std::int32_t; };
+template<> struct UlpInt<double> { using type = std::int64_t; };
+
+/// The distance of two finite floating point values in units in
+/// the last place, i.e. the number of representable values between them.
+template<typename T>
+std::uint64_t ulpDistance(T a, T b) {
+	using I = typename UlpInt<T>::type;
+	if constexpr(std::is_void_v<I>) {
+		// long double: measure in units of the spacing at the larger value
+		auto max = std::max(std::abs(a), std::abs(b));
+		auto ulp = std::nextafter(max, std::numeric_limits<T>::infinity()) - max;
+		return std::uint64_t(std::abs(a - b) / ulp);
+	} else {
+		// map the sign-magnitude representation to ordered integers,
+		// -0 and +0 both map to 0
+		I ia, ib;
+		std::memcpy(&ia, &a, sizeof(a));
+		std::memcpy(&ib, &b, sizeof(b));
+		ia = (ia < 0) ? -(ia & std::numeric_limits<I>::max()) : ia;
+		ib = (ib < 0) ? -(ib & std::numeric_limits<I>::max()) : ib;
+
+		using U = std::make_unsigned_t<I>;
+		return (ia > ib) ? U(ia) - U(ib) : U(ib) - U(ia);
+	}
+}
+
+/// Compares a and b with the given mode, see nytl::ApproxMode.
+template<typename T>
+bool approxEqual(T a, T b, double epsilon, ApproxMode mode) {
+	auto diff = std::abs(a - b);
+	if(mode == ApproxMode::mixed) {
+		auto max = std::max(std::abs(a), std::abs(b));
+		return diff < epsilon * (1 + max);
+	} else if(mode == ApproxMode::absolute) {
+		return diff <= epsilon;
+	} else if(mode == ApproxMode::relative) {
+		return diff <= epsilon * std::max(std::abs(a), std::abs(b));
+	}
+
+	return a == a && b == b && ulpDistance(a, b) <= epsilon;
+}
+
+} // namespace detail
+
 /// Represents an approximite value of type T.
 /// Usually type T is a floating-point value or something related to it, like
 /// a fp vector or matrix.
@@ -32,7 +106,8 @@ class Approx;
 
 /// Creates an Approx object for the given value and epsilon.
 template<typename T>
-Approx<T> approx(const T& value, double epsilon = defaultApproxEpsilon);
+Approx<T> approx(const T& value, double epsilon = defaultApproxEpsilon,
+	ApproxMode mode = ApproxMode::mixed);
 
 /// Default approx implementation for floating point types.
 /// Most other specializations use this implementation for their comparisons.
@@ -43,8 +118,7 @@ public:
 		"nytl::Approx only works for floating point types");
 
 	friend bool operator==(T lhs, const Approx& rhs) {
-		auto max = std::max(std::abs(lhs), std::abs(rhs.value));
-		return std::abs(lhs - rhs.value) < rhs.epsilon * (1 + max);
+		return detail::approxEqual(lhs, rhs.value, rhs.epsilon, rhs.mode);
 	}
 
 	friend bool operator==(const Approx& lhs, double rhs) {
@@ -60,6 +134,7 @@ public:
 public:
 	T value {};
 	double epsilon {defaultApproxEpsilon};
+	ApproxMode mode {ApproxMode::mixed};
 };
 
 /// Approx specialization for std::complex types.
@@ -69,8 +144,8 @@ class Approx<std::complex<T>> {
 public:
 	template<typename OT>
 	friend bool operator==(std::complex<OT> lhs, const Approx& rhs) {
-		return lhs.real() == approx(rhs.value.real(), rhs.epsilon)
-			&& lhs.imag() == approx(rhs.value.imag(), rhs.epsilon);
+		return lhs.real() == approx(rhs.value.real(), rhs.epsilon, rhs.mode)
+			&& lhs.imag() == approx(rhs.value.imag(), rhs.epsilon, rhs.mode);
 	}
 
 	template<typename OT>
@@ -91,12 +166,289 @@ public:
 public:
 	std::complex<T> value {};
 	double epsilon {defaultApproxEpsilon};
+	ApproxMode mode {ApproxMode::mixed};
 };
 
 template<typename T>
-Approx<T> approx(const T& value, double epsilon)
+Approx<T> approx(const T& value, double epsilon, ApproxMode mode)
 {
-	return {value, epsilon};
+	return {value, epsilon, mode};
+}
+
+/// The result of comparing two arrays with nytl::approxCompare.
+struct ApproxResult {
+	static constexpr auto none = std::size_t(-1);
+
+	std::size_t mismatch {none}; // index of the first mismatch
+	double maxAbsError {}; // maximum absolute difference
+	std::uint64_t maxUlpError {}; // maximum distance in units in the last place
+
+	bool equal() const { return mismatch == none; }
+	explicit operator bool() const { return equal(); }
+};
+
+namespace detail {
+
+// Stats: whether to compute the error statistics. Otherwise returns
+// on the first mismatch.
+template<ApproxMode M, bool Stats, typename T>
+void approxCompareScalar(const T* a, const T* b, std::size_t count,
+		double epsilon, ApproxResult& res) {
+	for(auto i = std::size_t(0); i < count; ++i) {
+		if(res.mismatch == res.none && !approxEqual(a[i], b[i], epsilon, M)) {
+			res.mismatch = i;
+			if constexpr(!Stats) {
+				return;
+			}
+		}
+
+		if constexpr(Stats) {
+			auto diff = double(std::abs(a[i] - b[i]));
+			res.maxAbsError = std::max(res.maxAbsError, diff);
+			if(a[i] == a[i] && b[i] == b[i]) {
+				res.maxUlpError = std::max(res.maxUlpError, ulpDistance(a[i], b[i]));
+			}
+		}
+	}
+}
+
+#if NYTL_SIMD
+
+template<ApproxMode M, bool Stats, std::size_t N, typename T>
+void approxCompareSimd(const T* a, const T* b, std::size_t count,
+		double epsilon, ApproxResult& res) {
+	using I = typename UlpInt<T>::type;
+	using U = std::make_unsigned_t<I>;
+	constexpr auto n = N;
+	constexpr auto needUlp = Stats || M == ApproxMode::ulp;
+	using PT = simd::Pack<T, n>;
+	using PI = simd::Pack<I, n>;
+	using PU = simd::Pack<U, n>;
+
+	// The lanes accepted here must also be accepted by approxEqual, which
+	// computes the tolerance in double. Rejected lanes are checked again
+	// with approxEqual, so the decisions are the same for any count.
+	// absolute: diff <= epsilon iff diff <= the largest T not above epsilon.
+	// mixed, relative: for float, the tolerance is computed in float with a
+	// relative error below 2^-22, lowered by 2^-20 and by the smallest
+	// denormal (for subnormal tolerances). It is then not above the exact one.
+	auto epsT = T(std::min(epsilon, double(std::numeric_limits<T>::max())));
+	if(double(epsT) > epsilon) {
+		epsT = std::nextafter(epsT, T(0));
+	}
+
+	constexpr auto isFloat = !std::is_same_v<T, double>;
+	constexpr auto lowerTol = isFloat ? 1 - 1.0 / (1 << 20) : 1.0;
+	constexpr auto minTol = isFloat ? std::numeric_limits<T>::denorm_min() : T(0);
+
+	PT eps, lower, denorm;
+	PU maxUlps;
+	PI magMask;
+	simd::broadcast(eps, epsT);
+	simd::broadcast(lower, T(lowerTol));
+	simd::broadcast(denorm, minTol);
+	simd::broadcast(maxUlps, U(std::min(epsilon, double(U(-1)))));
+	simd::broadcast(magMask, std::numeric_limits<I>::max());
+	auto maxAbs = PT {};
+	auto maxUlp = PU {};
+
+	// sets the mask of approximately equal lanes, updates the statistics
+	auto check = [&](const T* pa, const T* pb, PI& ok) {
+		PT x, y;
+		simd::load(x, pa);
+		simd::load(y, pb);
+		auto ix = (PI) x, iy = (PI) y;
+		auto diff = (PT) ((PI) (x - y) & magMask);
+		PI nan = (x != x) | (y != y);
+
+		PU ulp {};
+		if constexpr(needUlp) {
+			// ordered integer representations, see ulpDistance
+			auto sx = ix >> (8 * sizeof(I) - 1), sy = iy >> (8 * sizeof(I) - 1);
+			auto ox = ((ix & magMask) ^ sx) - sx;
+			auto oy = ((iy & magMask) ^ sy) - sy;
+			auto neg = (PU) (ox < oy);
+			ulp = (((PU) ox - (PU) oy) ^ neg) - neg;
+			ulp &= (PU) ~nan;
+		}
+
+		if constexpr(Stats) {
+			maxAbs = (diff > maxAbs) ? diff : maxAbs;
+			maxUlp = (ulp > maxUlp) ? ulp : maxUlp;
+		}
+
+		if constexpr(M == ApproxMode::ulp) {
+			ok = ~nan & (ulp <= maxUlps);
+		} else if constexpr(M == ApproxMode::absolute) {
+			ok = diff <= eps;
+		} else {
+			auto ax = (PI) x & magMask, ay = (PI) y & magMask;
+			auto max = (PT) ((ax > ay) ? ax : ay); // also works for the bits
+			if constexpr(M == ApproxMode::mixed) {
+				ok = diff < eps * (1 + max) * lower - denorm;
+			} else {
+				ok = diff <= eps * max * lower - denorm;
+			}
+		}
+	};
+
+	// whether a lane rejected by check is really a mismatch
+	auto mismatch = [&](T va, T vb) {
+		if constexpr(M == ApproxMode::ulp || M == ApproxMode::absolute || !isFloat) {
+			return true;
+		} else {
+			return !approxEqual(va, vb, epsilon, M);
+		}
+	};
+
+	// check blocks of packs without branching, only look for the
+	// exact index of the first mismatch once a block contains one
+	constexpr auto block = 16 * n;
+	auto i = std::size_t(0);
+	for(; i + n <= count; ) {
+		auto end = std::min(count - count % n, i + block);
+		auto bad = PI {};
+		auto ok = PI {};
+		for(auto j = i; j < end; j += n) {
+			check(a + j, b + j, ok);
+			bad |= ~ok;
+		}
+
+		if(res.mismatch == res.none) {
+			auto any = I(0);
+			for(auto l = 0u; l < n; ++l) {
+				any |= bad[l];
+			}
+
+			for(auto j = i; any && j < end && res.mismatch == res.none; j += n) {
+				check(a + j, b + j, ok);
+				for(auto l = 0u; l < n; ++l) {
+					if(!ok[l] && mismatch(a[j + l], b[j + l])) {
+						res.mismatch = j + l;
+						break;
+					}
+				}
+			}
+
+			if(!Stats && res.mismatch != res.none) {
+				return;
+			}
+		}
+
+		i = end;
+	}
+
+	// remaining values, padded with zeroes
+	if(i < count) {
+		T ta[n] {}, tb[n] {};
+		std::memcpy(ta, a + i, (count - i) * sizeof(T));
+		std::memcpy(tb, b + i, (count - i) * sizeof(T));
+		auto ok = PI {};
+		check(ta, tb, ok);
+		for(auto l = 0u; l < count - i && res.mismatch == res.none; ++l) {
+			if(!ok[l] && mismatch(ta[l], tb[l])) {
+				res.mismatch = i + l;
+			}
+		}
+	}
+
+	if constexpr(Stats) {
+		for(auto l = 0u; l < n; ++l) {
+			res.maxAbsError = std::max(res.maxAbsError, double(maxAbs[l]));
+			res.maxUlpError = std::max(res.maxUlpError, std::uint64_t(maxUlp[l]));
+		}
+	}
+}
+
+#endif // NYTL_SIMD
+
+// compiled for multiple instruction sets, see nytl/dispatch.hpp
+template<ApproxMode M, bool Stats, typename T>
+struct ApproxCompareKernel {
+	template<std::size_t Bytes>
+	static void run(const T* a, const T* b, std::size_t count,
+			double epsilon, ApproxResult& res) {
+	#if NYTL_SIMD
+		constexpr auto n = Bytes / sizeof(T);
+		if constexpr(n > 1 && !std::is_void_v<typename UlpInt<T>::type>) {
+			if(count >= n) {
+				approxCompareSimd<M, Stats, n>(a, b, count, epsilon, res);
+				return;
+			}
+		}
+	#endif // NYTL_SIMD
+
+		approxCompareScalar<M, Stats>(a, b, count, epsilon, res);
+	}
+};
+
+template<ApproxMode M, bool Stats, typename T>
+void approxCompare(const T* a, const T* b, std::size_t count,
+		double epsilon, ApproxResult& res) {
+	using Kernel = ApproxCompareKernel<M, Stats, T>;
+	using Sig = void(const T*, const T*, std::size_t, double, ApproxResult&);
+	Dispatch<Kernel, Sig>::call(a, b, count, epsilon, res);
+}
+
+template<bool Stats, typename T>
+ApproxResult approxCompare(Span<const T> a, Span<const T> b, double epsilon,
+		ApproxMode mode) {
+	static_assert(std::is_floating_point_v<T>,
+		"nytl::approxCompare only works for floating point types");
+
+	ApproxResult res;
+	auto count = std::size_t(std::min(a.size(), b.size()));
+	auto pa = a.data(), pb = b.data();
+	switch(mode) {
+		case ApproxMode::mixed:
+			approxCompare<ApproxMode::mixed, Stats>(pa, pb, count, epsilon, res); break;
+		case ApproxMode::absolute:
+			approxCompare<ApproxMode::absolute, Stats>(pa, pb, count, epsilon, res); break;
+		case ApproxMode::relative:
+			approxCompare<ApproxMode::relative, Stats>(pa, pb, count, epsilon, res); break;
+		case ApproxMode::ulp:
+			approxCompare<ApproxMode::ulp, Stats>(pa, pb, count, epsilon, res); break;
+	}
+
+	if(res.mismatch == res.none && a.size() != b.size()) {
+		res.mismatch = count;
+	}
+
+	return res;
+}
+
+template<typename A, typename T = std::remove_cv_t<
+	std::remove_pointer_t<decltype(std::data(std::declval<const A&>()))>>>
+Span<const T> approxSpan(const A& a) {
+	return {std::data(a), std::ptrdiff_t(std::size(a))};
+}
+
+} // namespace detail
+
+/// Compares the values of two arrays approximately, see nytl::ApproxMode.
+/// Returns the index of the first mismatch as well as the maximum absolute
+/// and ulp errors over all values. If the arrays have different sizes,
+/// only the common values are compared and the mismatch is at most
+/// the size of the smaller array.
+/// Large arrays are processed with simd instructions (see nytl/simd.hpp and
+/// nytl/dispatch.hpp), the decisions are the same as for single values.
+/// \param a,b Contiguous arrays of floating point values, e.g. nytl::Span
+/// or std::vector.
+template<typename A, typename B>
+ApproxResult approxCompare(const A& a, const B& b,
+		double epsilon = defaultApproxEpsilon, ApproxMode mode = ApproxMode::mixed) {
+	return detail::approxCompare<true>(detail::approxSpan(a), detail::approxSpan(b),
+		epsilon, mode);
+}
+
+/// Returns whether all values of the given arrays are approximately equal.
+/// Like nytl::approxCompare but stops at the first mismatch and does not
+/// compute the error statistics.
+template<typename A, typename B>
+bool approxEqual(const A& a, const B& b, double epsilon = defaultApproxEpsilon,
+		ApproxMode mode = ApproxMode::mixed) {
+	return detail::approxCompare<false>(detail::approxSpan(a), detail::approxSpan(b),
+		epsilon, mode).equal();
 }
 
 /// Use this namespace to enable approx printing.
@@ -4,6 +4,8 @@
 
 // TODO: better name for the header would be appreciated
 /// Approx specialization for nytl math types like nytl::Vec or nytl::Mat.
+/// The values are converted to the type of the Approx value (like for
+/// single values) and compared using nytl::approxEqual.
 
 #pragma once
 
@@ -14,6 +16,8 @@
 #include <nytl/vec.hpp> // nytl::Vec
 #include <nytl/mat.hpp> // nytl::Mat
 
+#include <array> // std::array
+
 namespace nytl {
 
 /// Approx specialization for nytl::Vec
@@ -22,17 +26,18 @@ class Approx<nytl::Vec<D, T>> {
 public:
 	template<size_t D2, typename T2>
 	friend bool operator==(const nytl::Vec<D2, T2>& lhs, const Approx& rhs) {
-		if(lhs.size() != rhs.value.size()) {
+		if constexpr(D2 != D) {
 			return false;
-		}
-
-		for(auto i = 0u; i < lhs.size(); ++i) {
-			if(lhs[i] != approx(rhs.value[i], rhs.epsilon)) {
-				return false;
+		} else {
+			// Vec2 and Vec3 store separate members, copy them into arrays
+			std::array<T, D> a, b;
+			for(auto i = 0u; i < D; ++i) {
+				a[i] = T(lhs[i]);
+				b[i] = rhs.value[i];
 			}
-		}
 
-		return true;
+			return approxEqual(a, b, rhs.epsilon, rhs.mode);
+		}
 	}
 
 	template<size_t D2, typename T2>
@@ -53,6 +58,7 @@ public:
 public:
 	nytl::Vec<D, T> value {};
 	double epsilon {defaultApproxEpsilon};
+	ApproxMode mode {ApproxMode::mixed};
 };
 
 /// Approx specialization for nytl::Mat
@@ -61,17 +67,16 @@ class Approx<nytl::Mat<R, C, T>> {
 public:
 	template<typename T2>
 	friend bool operator==(const nytl::Mat<R, C, T2>& lhs, const Approx& rhs) {
-		if(lhs.rows() != rhs.value.rows()) {
-			return false;
-		}
-
-		for(auto i = 0u; i < lhs.rows(); ++i) {
-			if(lhs[i] != approx(rhs.value[i], rhs.epsilon)) {
-				return false;
+		// the rows are separate objects, copy them into contiguous arrays
+		std::array<T, R * C> a, b;
+		for(auto r = 0u; r < R; ++r) {
+			for(auto c = 0u; c < C; ++c) {
+				a[r * C + c] = T(lhs[r][c]);
+				b[r * C + c] = rhs.value[r][c];
 			}
 		}
 
-		return true;
+		return approxEqual(a, b, rhs.epsilon, rhs.mode);
 	}
 
 	template<typename T2>
@@ -92,6 +97,7 @@ public:
 public:
 	nytl::Mat<R, C, T> value {};
 	double epsilon {defaultApproxEpsilon};
+	ApproxMode mode {ApproxMode::mixed};
 };
 
 } // namesapce nytl
@@ -0,0 +1,282 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Defines the AwaitableCallback template class and AsyncGenerator.
+/// Requires C++20 coroutine support: NYTL_COROUTINES is 1 if it is available
+/// and the classes defined, otherwise the header is empty, i.e. it can still
+/// be included from C++17 code.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_AWAITABLE_CALLBACK
+#define NYTL_INCLUDE_AWAITABLE_CALLBACK
+
+#ifndef NYTL_COROUTINES
+	#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+		#define NYTL_COROUTINES 1
+	#else
+		#define NYTL_COROUTINES 0
+	#endif
+#endif
+
+#if NYTL_COROUTINES
+
+#include <nytl/callback.hpp> // nytl::Callback
+#include <nytl/nonCopyable.hpp> // nytl::NonMovable
+
+#include <coroutine> // std::coroutine_handle
+#include <exception> // std::exception_ptr
+#include <optional> // std::optional
+#include <tuple> // std::tuple
+#include <type_traits> // std::conditional_t
+#include <utility> // std::exchange
+
+namespace nytl {
+
+/// \brief Coroutine type producing values asynchronously.
+/// The body of the coroutine can co_yield values and co_await other
+/// awaitables (e.g. AwaitableCallback::next), consumers co_await next()
+/// to resume it until it produced the next value.
+/// The coroutine does not start until the first value is requested.
+/// \module callback
+template<typename T>
+class AsyncGenerator {
+public:
+	struct promise_type;
+	using Handle = std::coroutine_handle<promise_type>;
+
+	// returns to the consumer waiting for a value
+	struct Transfer {
+		bool await_ready() const noexcept { return false; }
+		void await_resume() const noexcept {}
+		std::coroutine_handle<> await_suspend(Handle handle) noexcept {
+			auto consumer = handle.promise().consumer;
+			return consumer ? consumer : std::noop_coroutine();
+		}
+	};
+
+	struct promise_type {
+		const T* value {}; // valid while suspended in co_yield
+		std::coroutine_handle<> consumer {};
+		std::exception_ptr error {};
+
+		AsyncGenerator get_return_object() { return {Handle::from_promise(*this)}; }
+		std::suspend_always initial_suspend() const noexcept { return {}; }
+		Transfer final_suspend() const noexcept { return {}; }
+		void return_void() const noexcept {}
+		void unhandled_exception() noexcept { error = std::current_exception(); }
+
+		Transfer yield_value(const T& val) noexcept {
+			value = &val;
+			return {};
+		}
+	};
+
+	struct Next {
+		Handle handle;
+
+		bool await_ready() const noexcept { return !handle || handle.done(); }
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+			handle.promise().consumer = consumer;
+			handle.promise().value = nullptr;
+			return handle;
+		}
+
+		/// Returns the next value or an empty optional if the generator finished.
+		/// Rethrows exceptions thrown by the generator.
+		std::optional<T> await_resume() {
+			if(!handle) {
+				return {};
+			}
+
+			auto& promise = handle.promise();
+			if(promise.error) {
+				std::rethrow_exception(std::exchange(promise.error, {}));
+			}
+
+			if(handle.done() || !promise.value) {
+				return {};
+			}
+
+			return {*promise.value};
+		}
+	};
+
+public:
+	AsyncGenerator() = default;
+	AsyncGenerator(Handle handle) : handle_(handle) {}
+	~AsyncGenerator() { if(handle_) handle_.destroy(); }
+
+	AsyncGenerator(AsyncGenerator&& other) noexcept :
+		handle_(std::exchange(other.handle_, {})) {}
+	AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+		if(handle_) {
+			handle_.destroy();
+		}
+		handle_ = std::exchange(other.handle_, {});
+		return *this;
+	}
+
+	/// Returns an awaitable that resumes the generator until it produced
+	/// the next value or finished. Must not be awaited concurrently.
+	Next next() { return {handle_}; }
+
+	/// Returns whether the generator finished.
+	bool done() const { return !handle_ || handle_.done(); }
+
+protected:
+	Handle handle_ {};
+};
+
+template<typename Signature, typename ID = ConnectionID>
+class AwaitableCallback;
+
+/// \brief Callback whose calls can be awaited by coroutines.
+/// Has the same interface as nytl::Callback, additionally next() returns
+/// an awaitable for the next call and emissions() streams the calls
+/// as an AsyncGenerator.
+/// Waiting coroutines are resumed after all registered functions were
+/// called (and may therefore access the callback). Their awaiter objects
+/// live in the coroutine frame and are linked into the callback, waiting
+/// for a call does therefore not allocate.
+/// Coroutines still waiting when the callback is destroyed will
+/// not be resumed anymore.
+/// \module callback
+template<typename Ret, typename... Args, typename ID>
+class AwaitableCallback<Ret(Args...), ID> : public Callback<Ret(Args...), ID> {
+public:
+	static_assert((!std::is_rvalue_reference_v<Args> && ...),
+		"nytl::AwaitableCallback: rvalue reference parameters are not supported");
+
+	using Base = Callback<Ret(Args...), ID>;
+
+	/// The values a call is awaited as: a single argument directly,
+	/// otherwise a tuple of the arguments.
+	using Values = std::conditional_t<sizeof...(Args) == 1,
+		std::decay_t<std::tuple_element_t<0, std::tuple<Args..., void>>>,
+		std::tuple<std::decay_t<Args>...>>;
+
+	/// Awaitable returned by next(). Must be awaited directly.
+	class Awaiter : public NonMovable {
+	public:
+		Awaiter(AwaitableCallback& callback) : callback_(&callback) {}
+		~Awaiter() { unlink(); }
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) noexcept {
+			handle_ = handle;
+			link(callback_->waiters_);
+		}
+
+		Values await_resume() { return std::move(*values_); }
+
+	protected:
+		friend class AwaitableCallback;
+
+		// intrusive list, prev_ points to the pointer pointing to this
+		void link(Awaiter*& head) noexcept {
+			next_ = head;
+			if(next_) {
+				next_->prev_ = &next_;
+			}
+			prev_ = &head;
+			head = this;
+		}
+
+		void unlink() noexcept {
+			if(prev_) {
+				*prev_ = next_;
+				if(next_) {
+					next_->prev_ = prev_;
+				}
+				prev_ = nullptr;
+				next_ = nullptr;
+			}
+		}
+
+		AwaitableCallback* callback_;
+		Awaiter* next_ {};
+		Awaiter** prev_ {};
+		std::coroutine_handle<> handle_ {};
+		std::optional<Values> values_ {};
+	};
+
+public:
+	AwaitableCallback() = default;
+	~AwaitableCallback();
+
+	/// Calls all registered functions like Callback::call, then resumes
+	/// all coroutines waiting for a call with the given arguments.
+	/// Coroutines that wait again from within will be resumed by the next call.
+	auto call(Args...);
+
+	/// Operator version of call.
+	auto operator() (Args... a) {
+		return call(a...);
+	}
+
+	using Base::operator=;
+
+	/// Returns an awaitable for the next call of this callback that results
+	/// in its arguments, see Values.
+	Awaiter next() { return {*this}; }
+
+	/// Returns a generator producing the arguments of all following calls.
+	/// Calls that happen while the consumer does not wait for the generator
+	/// are not seen. The callback must outlive the generator.
+	AsyncGenerator<Values> emissions() {
+		while(true) {
+			co_yield co_await next();
+		}
+	}
+
+protected:
+	void resume(Args... args);
+
+protected:
+	Awaiter* waiters_ {};
+};
+
+// - implementation -
+template<typename Ret, typename... Args, typename ID>
+AwaitableCallback<Ret(Args...), ID>::~AwaitableCallback() {
+	while(waiters_) {
+		waiters_->unlink();
+	}
+}
+
+template<typename Ret, typename... Args, typename ID>
+auto AwaitableCallback<Ret(Args...), ID>::call(Args... args) {
+	if constexpr(std::is_same_v<Ret, void>) {
+		Base::call(args...);
+		resume(args...);
+	} else {
+		auto ret = Base::call(args...);
+		resume(args...);
+		return ret;
+	}
+}
+
+template<typename Ret, typename... Args, typename ID>
+void AwaitableCallback<Ret(Args...), ID>::resume(Args... args) {
+	// move the waiting coroutines into a local list so that coroutines
+	// waiting again are not resumed by this call. Resuming a coroutine
+	// might destroy the others (unlinking them) or this callback
+	auto waiting = std::exchange(waiters_, nullptr);
+	if(waiting) {
+		waiting->prev_ = &waiting;
+	}
+
+	while(waiting) {
+		auto awaiter = waiting;
+		awaiter->unlink();
+		awaiter->values_.emplace(args...);
+		awaiter->handle_.resume();
+	}
+}
+
+} // namespace nytl
+
+#endif // NYTL_COROUTINES
+#endif // header guard
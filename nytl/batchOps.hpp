@@ -0,0 +1,209 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Transformations of whole point/direction arrays by a matrix.
+/// Calling `mat * vec` for every point of a large mesh reloads the matrix
+/// and goes through a dot product per row for every single point.
+/// The functions here keep the matrix in (vector) registers and process
+/// multiple points per iteration (see nytl/simd.hpp), compiled for multiple
+/// instruction sets (see nytl/dispatch.hpp).
+/// All functions take the input and an output span, the output must have
+/// at least the size of the input. Both may refer to the same points
+/// (in-place transformation), but must not otherwise overlap.
+/// Large inputs are split up into tasks on a task scheduler (see nytl/tasks.hpp).
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_BATCH_OPS
+#define NYTL_INCLUDE_BATCH_OPS
+
+#include <nytl/mat.hpp> // nytl::Mat
+#include <nytl/vec.hpp> // nytl::Vec
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/simd.hpp> // nytl::simd::Pack
+#include <nytl/dispatch.hpp> // nytl::Dispatch
+#include <nytl/tmpUtil.hpp> // nytl::Identity
+#include <nytl/tasks.hpp> // nytl::parallelFor
+
+namespace nytl {
+namespace detail {
+
+// prevents deduction of T from the spans, allows to pass containers
+template<typename T> using BatchSpan = Span<typename Identity<T>::type>;
+
+// The matrix coefficients used by the batch kernels.
+// For non-projective transforms the last row is ignored.
+template<typename T> using BatchMat = Mat<4, 4, T>;
+
+#if NYTL_SIMD
+
+/// Transforms the points in packs of N with the given matrix.
+/// If Project is true, divides by the resulting w component.
+/// Returns the number of transformed points, the remainder is left.
+template<bool Project, std::size_t N, typename T>
+size_t batchTransformSimd(const BatchMat<T>& m, const Vec3<T>* in, Vec3<T>* out,
+		size_t count) {
+	using P = simd::Pack<T, N>;
+
+	P c[4][4];
+	for(auto r = 0u; r < 4; ++r) {
+		for(auto col = 0u; col < 4; ++col) {
+			simd::broadcast(c[r][col], m[r][col]);
+		}
+	}
+
+	auto i = size_t(0);
+	for(; i + N <= count; i += N) {
+		P x, y, z;
+		simd::deinterleave3<N>(&in[i].x, x, y, z);
+
+		P ox = c[0][0] * x + c[0][1] * y + c[0][2] * z + c[0][3];
+		P oy = c[1][0] * x + c[1][1] * y + c[1][2] * z + c[1][3];
+		P oz = c[2][0] * x + c[2][1] * y + c[2][2] * z + c[2][3];
+		if constexpr(Project) {
+			P iw = 1 / (c[3][0] * x + c[3][1] * y + c[3][2] * z + c[3][3]);
+			ox *= iw;
+			oy *= iw;
+			oz *= iw;
+		}
+
+		simd::interleave3<N>(&out[i].x, ox, oy, oz);
+	}
+
+	return i;
+}
+
+#endif // NYTL_SIMD
+
+/// Transforms count points with the given matrix, one at a time.
+/// If Project is true, divides by the resulting w component.
+template<bool Project, typename T>
+void batchTransformScalar(const BatchMat<T>& m, const Vec3<T>* in, Vec3<T>* out,
+		size_t count) {
+	for(auto i = size_t(0); i < count; ++i) {
+		auto p = in[i];
+		Vec3<T> o {
+			m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+			m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+			m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3],
+		};
+
+		if constexpr(Project) {
+			auto iw = 1 / (m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3]);
+			o = {o.x * iw, o.y * iw, o.z * iw};
+		}
+
+		out[i] = o;
+	}
+}
+
+// compiled for multiple instruction sets, see nytl/dispatch.hpp
+template<bool Project, typename T>
+struct BatchTransformKernel {
+	template<std::size_t Bytes>
+	static void run(const BatchMat<T>& m, const Vec3<T>* in, Vec3<T>* out,
+			size_t count) {
+		static_assert(sizeof(Vec3<T>) == 3 * sizeof(T), "Vec3 must be tightly packed");
+		auto i = size_t(0);
+
+	#if NYTL_SIMD
+		if constexpr(Bytes / sizeof(T) > 1) {
+			i = batchTransformSimd<Project, Bytes / sizeof(T)>(m, in, out, count);
+		}
+	#endif // NYTL_SIMD
+
+		batchTransformScalar<Project>(m, in + i, out + i, count - i);
+	}
+};
+
+/// Transforms count points with the given matrix.
+/// If Project is true, divides by the resulting w component.
+template<bool Project, typename T>
+void batchTransform(const BatchMat<T>& m, const Vec3<T>* in, Vec3<T>* out,
+		size_t count) {
+	using Sig = void(const BatchMat<T>&, const Vec3<T>*, Vec3<T>*, size_t);
+	Dispatch<BatchTransformKernel<Project, T>, Sig>::call(m, in, out, count);
+}
+
+/// Runs the kernel, splits it up into tasks on the given scheduler
+/// (TaskScheduler::global() if null) if the input is large enough.
+template<bool Project, typename T>
+void batch(const BatchMat<T>& m, Span<const Vec3<T>> in, Span<Vec3<T>> out,
+		TaskScheduler* scheduler) {
+	NYTL_EXPECTS(out.size() >= in.size());
+
+	// below that, a task costs more than it saves
+	constexpr auto minPerTask = size_t(1024 * 16);
+	auto count = size_t(in.size());
+	auto chunks = count / minPerTask;
+	if(chunks <= 1) {
+		batchTransform<Project>(m, in.data(), out.data(), count);
+		return;
+	}
+
+	// the last chunk handles the remainder
+	auto& tasks = scheduler ? *scheduler : TaskScheduler::global();
+	parallelFor(tasks, 0, chunks, [&](size_t c) {
+		auto off = c * minPerTask;
+		auto size = (c + 1 == chunks) ? count - off : minPerTask;
+		batchTransform<Project>(m, in.data() + off, out.data() + off, size);
+	}, 1);
+}
+
+template<size_t R, size_t C, typename T>
+constexpr BatchMat<T> batchMat(const Mat<R, C, T>& m, bool translation) {
+	static_assert(R >= 3 && R <= 4 && C >= 3 && C <= 4, "Invalid matrix dimensions");
+	BatchMat<T> ret {};
+	for(auto r = 0u; r < R; ++r) {
+		for(auto c = 0u; c < 3; ++c) {
+			ret[r][c] = m[r][c];
+		}
+
+		if constexpr(C == 4) {
+			ret[r][3] = translation ? m[r][3] : T(0);
+		}
+	}
+
+	return ret;
+}
+
+} // namespace detail
+
+/// \brief Transforms the given points by the given matrix.
+/// For a 4x4 matrix, the last row is ignored, i.e. the matrix is expected
+/// to be affine (use projectPoints otherwise). A 3x4 matrix holds the
+/// translation in its last column, a 3x3 matrix is a linear transformation.
+/// \param scheduler Large inputs are split into tasks on it,
+/// TaskScheduler::global() if null.
+template<size_t R, size_t C, typename T>
+void transformPoints(const Mat<R, C, T>& m, detail::BatchSpan<const Vec3<T>> in,
+		detail::BatchSpan<Vec3<T>> out, TaskScheduler* scheduler = nullptr) {
+	detail::batch<false, T>(detail::batchMat(m, true), in, out, scheduler);
+}
+
+/// \brief Transforms the given directions by the given matrix, i.e. ignores
+/// the translation of affine matrices.
+/// Note that normals have to be transformed by the inverse transpose.
+/// \param scheduler Large inputs are split into tasks on it,
+/// TaskScheduler::global() if null.
+template<size_t R, size_t C, typename T>
+void transformDirections(const Mat<R, C, T>& m, detail::BatchSpan<const Vec3<T>> in,
+		detail::BatchSpan<Vec3<T>> out, TaskScheduler* scheduler = nullptr) {
+	detail::batch<false, T>(detail::batchMat(m, false), in, out, scheduler);
+}
+
+/// \brief Transforms the given points by the given projective matrix and
+/// divides the results by their w component.
+/// \param scheduler Large inputs are split into tasks on it,
+/// TaskScheduler::global() if null.
+template<typename T>
+void projectPoints(const Mat<4, 4, T>& m, detail::BatchSpan<const Vec3<T>> in,
+		detail::BatchSpan<Vec3<T>> out, TaskScheduler* scheduler = nullptr) {
+	detail::batch<true, T>(m, in, out, scheduler);
+}
+
+} // namespace nytl
+
+#endif // header guard
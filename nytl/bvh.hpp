@@ -0,0 +1,819 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Bounding volume hierarchy over Simplexes (e.g. triangle meshes).
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_BVH
+#define NYTL_INCLUDE_BVH
+
+#include <nytl/simplexOps.hpp> // nytl::closestPoint
+#include <nytl/rect.hpp> // nytl::Rect
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/simd.hpp> // nytl::simd::Pack
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/tasks.hpp> // nytl::TaskScheduler
+
+#include <vector> // std::vector
+#include <optional> // std::optional
+#include <algorithm> // std::partition
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_floating_point_v
+#include <cstdint> // std::uint32_t
+#include <cmath> // std::sqrt
+
+namespace nytl {
+
+/// \brief Result of a closest point query.
+/// \module bvh
+template<std::size_t D, typename P>
+struct ClosestPoint {
+	Vec<D, P> point {}; // the closest point
+	P distance {}; // distance between the closest and the queried point
+	std::size_t index {}; // index of the simplex the closest point lies on
+};
+
+namespace detail {
+
+// Number of children per bvh node: as many as values of type P fit into
+// a vector register, but at least 4.
+template<typename P>
+constexpr std::size_t bvhWidth() {
+#if NYTL_SIMD
+	if constexpr(std::is_same_v<P, float> || std::is_same_v<P, double>) {
+		return (simd::lanes<P> > 4) ? simd::lanes<P> : 4;
+	}
+#endif // NYTL_SIMD
+	return 4;
+}
+
+// Number of values processed at once by the box tests.
+template<typename P>
+constexpr std::size_t bvhLanes() {
+#if NYTL_SIMD
+	if constexpr(std::is_same_v<P, float> || std::is_same_v<P, double>) {
+		return simd::lanes<P>;
+	}
+#endif // NYTL_SIMD
+	return 1;
+}
+
+// Value type of the box tests: a pack or, if N is 1, a scalar.
+#if NYTL_SIMD
+template<typename P, std::size_t N> struct BVHValueT { using type = simd::Pack<P, N>; };
+#else
+template<typename P, std::size_t N> struct BVHValueT { using type = P; };
+#endif // NYTL_SIMD
+
+template<typename P> struct BVHValueT<P, 1> { using type = P; };
+
+template<typename P, std::size_t N>
+inline typename BVHValueT<P, N>::type bvhLoad(const P* ptr) {
+#if NYTL_SIMD
+	if constexpr(N != 1) {
+		return simd::load<N>(ptr);
+	} else {
+		return *ptr;
+	}
+#else
+	return *ptr;
+#endif // NYTL_SIMD
+}
+
+template<typename P, typename V>
+inline void bvhStore(P* ptr, const V& value) {
+#if NYTL_SIMD
+	if constexpr(!std::is_same_v<P, V>) {
+		simd::store(ptr, value);
+	} else {
+		*ptr = value;
+	}
+#else
+	*ptr = value;
+#endif // NYTL_SIMD
+}
+
+// Axis-aligned box used while building.
+template<std::size_t D, typename P>
+struct BVHBox {
+	Vec<D, P> min;
+	Vec<D, P> max;
+
+	static BVHBox empty() {
+		BVHBox ret;
+		for(auto i = 0u; i < D; ++i) {
+			ret.min[i] = std::numeric_limits<P>::infinity();
+			ret.max[i] = -std::numeric_limits<P>::infinity();
+		}
+		return ret;
+	}
+
+	void extend(const Vec<D, P>& point) {
+		for(auto i = 0u; i < D; ++i) {
+			min[i] = std::min(min[i], point[i]);
+			max[i] = std::max(max[i], point[i]);
+		}
+	}
+
+	void extend(const BVHBox& box) {
+		for(auto i = 0u; i < D; ++i) {
+			min[i] = std::min(min[i], box.min[i]);
+			max[i] = std::max(max[i], box.max[i]);
+		}
+	}
+
+	// Half the surface area (generalized to D dimensions), used as
+	// probability measure for the surface area heuristic.
+	P area() const {
+		auto ret = P(0);
+		for(auto i = 0u; i < D; ++i) {
+			auto face = P(1);
+			for(auto j = 0u; j < D; ++j) {
+				if(j != i) {
+					face *= std::max(max[j] - min[j], P(0));
+				}
+			}
+			ret += face;
+		}
+		return ret;
+	}
+};
+
+} // namespace detail
+
+/// \brief Bounding volume hierarchy over a set of simplexes.
+/// Accelerates ray queries (for triangles in 3 dimensions), sphere and closest
+/// point queries (for all simplexes).
+/// Built with the binned surface area heuristic. The resulting tree is stored
+/// as a flat array of wide nodes: each node stores the boxes of all its
+/// children in SoA layout so that they can be tested at once (see nytl/simd.hpp).
+/// The simplexes are stored in the order of the leaves, i.e. each leaf
+/// references a contiguous range. Queries do not allocate.
+/// \tparam D,P,A The parameters of the Simplex. P must be a floating point type.
+/// \module bvh
+template<std::size_t D, typename P = double, std::size_t A = D>
+class SimplexBVH {
+public:
+	static_assert(std::is_floating_point_v<P>, "SimplexBVH requires floating point precision");
+
+	using Primitive = Simplex<D, P, A>;
+	using Point = Vec<D, P>;
+
+	/// The maximal number of children per node.
+	static constexpr std::size_t width = detail::bvhWidth<P>();
+
+	/// Leaves are created for at most this many simplexes, unless
+	/// the simplexes can't be split up (e.g. they are all at the same position).
+	static constexpr std::size_t maxLeafSize = 4;
+
+	/// Subtrees deeper than this are not split further.
+	/// Bounds the stack size needed for traversal.
+	static constexpr std::size_t maxDepth = 64;
+
+	/// Node in the flattened tree.
+	struct Node {
+		P min[D][width]; // lower bounds of the child boxes, per dimension
+		P max[D][width]; // upper bounds of the child boxes, per dimension
+		std::uint32_t first[width]; // child node index or first simplex of a leaf
+		std::uint32_t count[width]; // number of simplexes of a leaf, 0 for child nodes
+		std::uint32_t size; // number of used children
+	};
+
+public:
+	SimplexBVH() = default;
+
+	/// Builds the hierarchy for the given simplexes, see build.
+	explicit SimplexBVH(Span<const Primitive> simplexes,
+			TaskScheduler& scheduler = TaskScheduler::global()) {
+		build(simplexes, scheduler);
+	}
+
+	/// (Re-)Builds the hierarchy for the given simplexes. Copies them.
+	/// \param scheduler Large subtrees are built in parallel on its tasks.
+	/// The hierarchy does not depend on the number of threads.
+	void build(Span<const Primitive> simplexes,
+		TaskScheduler& scheduler = TaskScheduler::global());
+
+	/// \brief Returns the closest intersection of the given ray with any simplex.
+	/// RayHit::index contains the index of the hit simplex in the
+	/// span the hierarchy was built from. See nytl::intersectRay.
+	/// Only available for triangles in 3 dimensions.
+	std::optional<RayHit<P>> intersectRay(const Point& origin, const Point& dir,
+		P maxT = std::numeric_limits<P>::infinity()) const;
+
+	/// \brief Returns the closest intersection of the segment from a to b with
+	/// any simplex. The returned t is in range [0, 1].
+	std::optional<RayHit<P>> intersectSegment(const Point& a, const Point& b) const {
+		return intersectRay(a, b - a, P(1));
+	}
+
+	/// \brief Returns whether the given ray hits any simplex.
+	/// Returns as soon as any hit is found, useful e.g. for shadow rays.
+	bool anyHit(const Point& origin, const Point& dir,
+		P maxT = std::numeric_limits<P>::infinity()) const;
+
+	/// \brief Casts multiple rays, computes the closest hit for each of them.
+	/// \param scheduler The rays are split into chunks cast on its tasks.
+	void intersectRays(Span<const Point> origins, Span<const Point> dirs,
+		Span<std::optional<RayHit<P>>> hits,
+		TaskScheduler& scheduler = TaskScheduler::global()) const;
+
+	/// \brief Calls the given function with the index of every simplex that
+	/// intersects the sphere with the given center and radius.
+	/// The order of the calls is unspecified.
+	template<typename F>
+	void querySphere(const Point& center, P radius, F&& func) const;
+
+	/// \brief Returns the point on any simplex closest to the given point.
+	/// Returns an empty optional if the hierarchy is empty or all simplexes
+	/// are farther away than maxDistance.
+	std::optional<ClosestPoint<D, P>> closestPoint(const Point& point,
+		P maxDistance = std::numeric_limits<P>::infinity()) const;
+
+	/// Returns the bounds of all simplexes.
+	/// Returns an empty rect for an empty hierarchy.
+	Rect<D, P> bounds() const;
+
+	/// Returns the simplexes in the order they are referenced by the leaves.
+	Span<const Primitive> simplexes() const { return simplexes_; }
+
+	/// Returns the index of the given simplex (in the order returned by simplexes())
+	/// in the span the hierarchy was built from.
+	std::size_t index(std::size_t i) const { return indices_[i]; }
+
+	/// Returns the flattened nodes. The first node is the root.
+	Span<const Node> nodes() const { return nodes_; }
+
+	std::size_t size() const { return simplexes_.size(); }
+	bool empty() const { return simplexes_.empty(); }
+
+protected:
+	using Box = detail::BVHBox<D, P>;
+	struct BuildNode {
+		Box box;
+		std::uint32_t left, right; // child indices for inner nodes
+		std::uint32_t first, count; // range of simplexes for leaves
+	};
+
+	struct Builder {
+		std::vector<Box> boxes;
+		std::vector<Point> centers;
+		std::vector<std::uint32_t> indices;
+		std::vector<BuildNode> nodes;
+	};
+
+	// The stack size needed for traversal: for every level
+	// all but the first child may be pushed.
+	static constexpr std::size_t stackSize = maxDepth * (width - 1) + 1;
+	static constexpr auto lanes = detail::bvhLanes<P>();
+
+	static std::uint32_t buildNode(Builder& builder, std::vector<BuildNode>& nodes,
+		std::uint32_t begin, std::uint32_t end, unsigned depth, TaskScheduler* scheduler);
+	std::uint32_t collapse(const std::vector<BuildNode>& nodes, std::uint32_t id);
+
+	template<bool Any> bool trace(const Point& origin, const Point& dir,
+		P maxT, RayHit<P>& hit) const;
+	void rayBoxes(const Node& node, const P* origin, const P* inv, P maxT, P* out) const;
+	void pointBoxes(const Node& node, const Point& point, P* out) const;
+
+protected:
+	std::vector<Node> nodes_;
+	std::vector<Primitive> simplexes_;
+	std::vector<std::uint32_t> indices_;
+};
+
+// - implementation -
+template<std::size_t D, typename P, std::size_t A>
+void SimplexBVH<D, P, A>::build(Span<const Primitive> simplexes, TaskScheduler& scheduler) {
+	NYTL_EXPECTS(simplexes.size() < std::numeric_limits<std::uint32_t>::max());
+
+	nodes_.clear();
+	simplexes_.clear();
+	indices_.clear();
+
+	auto count = std::uint32_t(simplexes.size());
+	if(count == 0) {
+		return;
+	}
+
+	Builder builder;
+	builder.boxes.resize(count);
+	builder.centers.resize(count);
+	builder.indices.resize(count);
+	for(auto i = 0u; i < count; ++i) {
+		auto box = Box::empty();
+		for(auto& p : simplexes[i].points_) {
+			box.extend(p);
+		}
+
+		builder.boxes[i] = box;
+		builder.centers[i] = P(0.5) * (box.min + box.max);
+		builder.indices[i] = i;
+	}
+
+	auto parallel = (scheduler.concurrency() > 1) ? &scheduler : nullptr;
+	auto root = buildNode(builder, builder.nodes, 0, count, 0, parallel);
+
+	// reorder the simplexes to match the leaves
+	simplexes_.reserve(count);
+	for(auto id : builder.indices) {
+		simplexes_.push_back(simplexes[id]);
+	}
+	indices_ = std::move(builder.indices);
+
+	collapse(builder.nodes, root);
+}
+
+template<std::size_t D, typename P, std::size_t A>
+std::uint32_t SimplexBVH<D, P, A>::buildNode(Builder& builder,
+		std::vector<BuildNode>& nodes, std::uint32_t begin, std::uint32_t end,
+		unsigned depth, TaskScheduler* scheduler) {
+	constexpr auto binCount = 16u;
+	constexpr auto minParallelCount = 1024u * 16u;
+
+	auto box = Box::empty();
+	auto cbox = Box::empty();
+	for(auto i = begin; i < end; ++i) {
+		auto id = builder.indices[i];
+		box.extend(builder.boxes[id]);
+		cbox.extend(builder.centers[id]);
+	}
+
+	auto count = end - begin;
+	auto self = std::uint32_t(nodes.size());
+	nodes.push_back({box, 0, 0, begin, count});
+	if(count <= 1 || depth >= maxDepth) {
+		return self;
+	}
+
+	auto binOf = [&](std::uint32_t id, unsigned axis) {
+		auto extent = cbox.max[axis] - cbox.min[axis];
+		auto b = unsigned(binCount * ((builder.centers[id][axis] - cbox.min[axis]) / extent));
+		return std::min(b, binCount - 1);
+	};
+
+	// evaluate the surface area heuristic for the bin boundaries of all axes
+	auto bestCost = std::numeric_limits<P>::infinity();
+	auto bestAxis = 0u;
+	auto bestSplit = 0u;
+	for(auto axis = 0u; axis < D; ++axis) {
+		if(!(cbox.max[axis] > cbox.min[axis])) {
+			continue;
+		}
+
+		Box bins[binCount];
+		std::uint32_t counts[binCount] {};
+		for(auto& bin : bins) {
+			bin = Box::empty();
+		}
+
+		for(auto i = begin; i < end; ++i) {
+			auto id = builder.indices[i];
+			auto b = binOf(id, axis);
+			++counts[b];
+			bins[b].extend(builder.boxes[id]);
+		}
+
+		P rightCost[binCount] {};
+		auto acc = Box::empty();
+		auto accCount = 0u;
+		for(auto b = binCount - 1; b > 0; --b) {
+			acc.extend(bins[b]);
+			accCount += counts[b];
+			rightCost[b] = accCount ? acc.area() * accCount : P(0);
+		}
+
+		acc = Box::empty();
+		accCount = 0u;
+		for(auto b = 1u; b < binCount; ++b) {
+			acc.extend(bins[b - 1]);
+			accCount += counts[b - 1];
+			if(accCount == 0 || accCount == count) {
+				continue;
+			}
+
+			auto cost = acc.area() * accCount + rightCost[b];
+			if(cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = b;
+			}
+		}
+	}
+
+	// traversing a node is assumed to cost as much as testing a simplex
+	auto area = box.area();
+	auto found = bestCost < std::numeric_limits<P>::infinity();
+	if(count <= maxLeafSize && (!found || area * count <= area + bestCost)) {
+		return self;
+	}
+
+	auto first = builder.indices.begin();
+	auto mid = begin + count / 2;
+	if(found) {
+		auto it = std::partition(first + begin, first + end, [&](auto id) {
+			return binOf(id, bestAxis) < bestSplit;
+		});
+		mid = std::uint32_t(it - first);
+	}
+	// otherwise all centers are the same; splitting them anyways
+	// keeps the leaves small
+
+	std::uint32_t left, right;
+	if(scheduler && count >= minParallelCount) {
+		// build the left subtree into a separate vector in another task
+		std::vector<BuildNode> leftNodes;
+		std::uint32_t leftRoot;
+		TaskGroup group(*scheduler);
+		group.run([&]{
+			leftRoot = buildNode(builder, leftNodes, begin, mid, depth + 1, scheduler);
+		});
+		right = buildNode(builder, nodes, mid, end, depth + 1, scheduler);
+		group.wait();
+
+		auto off = std::uint32_t(nodes.size());
+		for(auto& node : leftNodes) {
+			if(!node.count) {
+				node.left += off;
+				node.right += off;
+			}
+			nodes.push_back(node);
+		}
+		left = leftRoot + off;
+	} else {
+		left = buildNode(builder, nodes, begin, mid, depth + 1, scheduler);
+		right = buildNode(builder, nodes, mid, end, depth + 1, scheduler);
+	}
+
+	nodes[self].left = left;
+	nodes[self].right = right;
+	nodes[self].count = 0;
+	return self;
+}
+
+template<std::size_t D, typename P, std::size_t A>
+std::uint32_t SimplexBVH<D, P, A>::collapse(const std::vector<BuildNode>& nodes,
+		std::uint32_t id) {
+	// pull up grandchildren, always opening the largest inner child.
+	// The root of the wide tree is always an inner node, even if it is a leaf.
+	std::uint32_t children[width] = {id};
+	auto size = 1u;
+	if(!nodes[id].count) {
+		children[0] = nodes[id].left;
+		children[size++] = nodes[id].right;
+	}
+
+	while(size < width) {
+		auto largest = width;
+		auto largestArea = -P(1);
+		for(auto i = 0u; i < size; ++i) {
+			auto& child = nodes[children[i]];
+			if(!child.count && child.box.area() > largestArea) {
+				largest = i;
+				largestArea = child.box.area();
+			}
+		}
+
+		if(largest == width) {
+			break;
+		}
+
+		auto& open = nodes[children[largest]];
+		children[largest] = open.left;
+		children[size++] = open.right;
+	}
+
+	auto self = std::uint32_t(nodes_.size());
+	nodes_.emplace_back();
+	for(auto i = 0u; i < width; ++i) {
+		for(auto d = 0u; d < D; ++d) {
+			nodes_[self].min[d][i] = std::numeric_limits<P>::infinity();
+			nodes_[self].max[d][i] = -std::numeric_limits<P>::infinity();
+		}
+		nodes_[self].first[i] = 0;
+		nodes_[self].count[i] = 0;
+	}
+
+	nodes_[self].size = size;
+	for(auto i = 0u; i < size; ++i) {
+		auto& child = nodes[children[i]];
+		for(auto d = 0u; d < D; ++d) {
+			nodes_[self].min[d][i] = child.box.min[d];
+			nodes_[self].max[d][i] = child.box.max[d];
+		}
+
+		if(child.count) {
+			nodes_[self].first[i] = child.first;
+			nodes_[self].count[i] = child.count;
+		} else {
+			// nodes_ might be reallocated
+			auto sub = collapse(nodes, children[i]);
+			nodes_[self].first[i] = sub;
+		}
+	}
+
+	return self;
+}
+
+template<std::size_t D, typename P, std::size_t A>
+void SimplexBVH<D, P, A>::rayBoxes(const Node& node, const P* origin, const P* inv,
+		P maxT, P* out) const {
+	using V = typename detail::BVHValueT<P, lanes>::type;
+	auto inf = V {} + std::numeric_limits<P>::infinity();
+	for(auto k = 0u; k < width; k += lanes) {
+		V near = V {};
+		V far = V {} + maxT;
+		for(auto d = 0u; d < D; ++d) {
+			V a = (detail::bvhLoad<P, lanes>(node.min[d] + k) - origin[d]) * inv[d];
+			V b = (detail::bvhLoad<P, lanes>(node.max[d] + k) - origin[d]) * inv[d];
+
+			V lo = (a < b) ? a : b;
+			V hi = (a < b) ? b : a;
+			near = (lo > near) ? lo : near;
+			far = (hi < far) ? hi : far;
+		}
+
+		detail::bvhStore(out + k, (near <= far) ? near : inf);
+	}
+}
+
+template<std::size_t D, typename P, std::size_t A>
+void SimplexBVH<D, P, A>::pointBoxes(const Node& node, const Point& point, P* out) const {
+	using V = typename detail::BVHValueT<P, lanes>::type;
+	for(auto k = 0u; k < width; k += lanes) {
+		V dist = V {};
+		for(auto d = 0u; d < D; ++d) {
+			V below = detail::bvhLoad<P, lanes>(node.min[d] + k) - point[d];
+			V above = point[d] - detail::bvhLoad<P, lanes>(node.max[d] + k);
+			V diff = (below > above) ? below : above;
+			diff = (diff > 0) ? diff : V {};
+			dist += diff * diff;
+		}
+
+		detail::bvhStore(out + k, dist);
+	}
+}
+
+template<std::size_t D, typename P, std::size_t A>
+template<bool Any>
+bool SimplexBVH<D, P, A>::trace(const Point& origin, const Point& dir,
+		P maxT, RayHit<P>& hit) const {
+	static_assert(D == 3 && A == 2, "Ray queries are only supported for 3D triangles");
+	if(nodes_.empty()) {
+		return false;
+	}
+
+	P o[3] = {origin[0], origin[1], origin[2]};
+
+	// Zero direction components are replaced with the smallest normal
+	// value. This keeps the inverse finite, avoiding 0 * inf for rays
+	// starting on the plane of a box face.
+	P inv[3];
+	for(auto d = 0u; d < 3; ++d) {
+		auto tiny = std::copysign(std::numeric_limits<P>::min(), dir[d]);
+		inv[d] = 1 / ((dir[d] == 0) ? tiny : dir[d]);
+	}
+
+	struct Entry {
+		std::uint32_t node;
+		P near;
+	};
+
+	Entry stack[stackSize];
+	auto sp = 0u;
+	stack[sp++] = {0u, P(0)};
+
+	auto found = false;
+	hit.t = maxT;
+	P near[width];
+	while(sp) {
+		auto entry = stack[--sp];
+		if(entry.near > hit.t) {
+			continue;
+		}
+
+		auto& node = nodes_[entry.node];
+		rayBoxes(node, o, inv, hit.t, near);
+
+		// sort the hit children by distance
+		unsigned order[width];
+		auto hits = 0u;
+		for(auto i = 0u; i < node.size; ++i) {
+			if(near[i] == std::numeric_limits<P>::infinity()) {
+				continue;
+			}
+
+			auto j = hits++;
+			for(; j > 0 && near[order[j - 1]] > near[i]; --j) {
+				order[j] = order[j - 1];
+			}
+			order[j] = i;
+		}
+
+		// test leaves directly, push nodes (farthest first)
+		for(auto i = 0u; i < hits; ++i) {
+			auto c = order[i];
+			if(!node.count[c] || near[c] > hit.t) {
+				continue;
+			}
+
+			RayHit<P> leafHit;
+			auto first = node.first[c];
+			if(detail::intersectRays<Any>(simplexes_.data() + first, node.count[c],
+					origin, dir, hit.t, leafHit) && (!found || leafHit.t < hit.t)) {
+				found = true;
+				hit.t = leafHit.t;
+				hit.uv = leafHit.uv;
+				hit.index = indices_[first + leafHit.index];
+				if constexpr(Any) {
+					return true;
+				}
+			}
+		}
+
+		for(auto i = hits; i-- > 0; ) {
+			auto c = order[i];
+			if(!node.count[c]) {
+				stack[sp++] = {node.first[c], near[c]};
+			}
+		}
+	}
+
+	return found;
+}
+
+template<std::size_t D, typename P, std::size_t A>
+std::optional<RayHit<P>> SimplexBVH<D, P, A>::intersectRay(const Point& origin,
+		const Point& dir, P maxT) const {
+	RayHit<P> hit;
+	if(trace<false>(origin, dir, maxT, hit)) {
+		return hit;
+	}
+
+	return std::nullopt;
+}
+
+template<std::size_t D, typename P, std::size_t A>
+bool SimplexBVH<D, P, A>::anyHit(const Point& origin, const Point& dir, P maxT) const {
+	RayHit<P> hit;
+	return trace<true>(origin, dir, maxT, hit);
+}
+
+template<std::size_t D, typename P, std::size_t A>
+void SimplexBVH<D, P, A>::intersectRays(Span<const Point> origins, Span<const Point> dirs,
+		Span<std::optional<RayHit<P>>> hits, TaskScheduler& scheduler) const {
+	NYTL_EXPECTS(dirs.size() == origins.size() && hits.size() >= origins.size());
+
+	// below that, spawning a task costs more than it saves
+	constexpr auto minPerTask = std::size_t(256);
+	auto count = std::size_t(origins.size());
+	auto grain = std::max(minPerTask, count / (8 * scheduler.concurrency()));
+	parallelFor(scheduler, 0, count, [&](std::size_t i) {
+		hits[i] = intersectRay(origins[i], dirs[i]);
+	}, grain);
+}
+
+template<std::size_t D, typename P, std::size_t A>
+template<typename F>
+void SimplexBVH<D, P, A>::querySphere(const Point& center, P radius, F&& func) const {
+	if(nodes_.empty()) {
+		return;
+	}
+
+	auto r2 = radius * radius;
+	std::uint32_t stack[stackSize];
+	auto sp = 0u;
+	stack[sp++] = 0u;
+
+	P dist[width];
+	while(sp) {
+		auto& node = nodes_[stack[--sp]];
+		pointBoxes(node, center, dist);
+		for(auto c = 0u; c < node.size; ++c) {
+			if(!(dist[c] <= r2)) {
+				continue;
+			}
+
+			if(!node.count[c]) {
+				stack[sp++] = node.first[c];
+				continue;
+			}
+
+			for(auto i = node.first[c]; i < node.first[c] + node.count[c]; ++i) {
+				auto diff = center - nytl::closestPoint(simplexes_[i], center);
+				if(dot(diff, diff) <= r2) {
+					func(std::size_t(indices_[i]));
+				}
+			}
+		}
+	}
+}
+
+template<std::size_t D, typename P, std::size_t A>
+std::optional<ClosestPoint<D, P>> SimplexBVH<D, P, A>::closestPoint(const Point& point,
+		P maxDistance) const {
+	if(nodes_.empty()) {
+		return std::nullopt;
+	}
+
+	struct Entry {
+		std::uint32_t node;
+		P dist;
+	};
+
+	Entry stack[stackSize];
+	auto sp = 0u;
+	stack[sp++] = {0u, P(0)};
+
+	auto found = false;
+	auto best = maxDistance * maxDistance;
+	ClosestPoint<D, P> ret;
+
+	P dist[width];
+	while(sp) {
+		auto entry = stack[--sp];
+		if(entry.dist > best) {
+			continue;
+		}
+
+		auto& node = nodes_[entry.node];
+		pointBoxes(node, point, dist);
+
+		unsigned order[width];
+		auto count = 0u;
+		for(auto i = 0u; i < node.size; ++i) {
+			if(!(dist[i] <= best)) {
+				continue;
+			}
+
+			auto j = count++;
+			for(; j > 0 && dist[order[j - 1]] > dist[i]; --j) {
+				order[j] = order[j - 1];
+			}
+			order[j] = i;
+		}
+
+		// test leaves directly (nearest first), push nodes (farthest first)
+		for(auto i = 0u; i < count; ++i) {
+			auto c = order[i];
+			if(!node.count[c] || dist[c] > best) {
+				continue;
+			}
+
+			for(auto s = node.first[c]; s < node.first[c] + node.count[c]; ++s) {
+				auto candidate = nytl::closestPoint(simplexes_[s], point);
+				auto diff = point - candidate;
+				auto d = dot(diff, diff);
+				if(d <= best && (!found || d < best)) {
+					found = true;
+					best = d;
+					ret.point = candidate;
+					ret.index = indices_[s];
+				}
+			}
+		}
+
+		for(auto i = count; i-- > 0; ) {
+			auto c = order[i];
+			if(!node.count[c] && dist[c] <= best) {
+				stack[sp++] = {node.first[c], dist[c]};
+			}
+		}
+	}
+
+	if(!found) {
+		return std::nullopt;
+	}
+
+	ret.distance = std::sqrt(best);
+	return ret;
+}
+
+template<std::size_t D, typename P, std::size_t A>
+Rect<D, P> SimplexBVH<D, P, A>::bounds() const {
+	if(nodes_.empty()) {
+		return {};
+	}
+
+	auto& root = nodes_[0];
+	Rect<D, P> ret;
+	for(auto d = 0u; d < D; ++d) {
+		auto min = std::numeric_limits<P>::infinity();
+		auto max = -std::numeric_limits<P>::infinity();
+		for(auto c = 0u; c < root.size; ++c) {
+			min = std::min(min, root.min[d][c]);
+			max = std::max(max, root.max[d][c]);
+		}
+
+		ret.position[d] = min;
+		ret.size[d] = max - min;
+	}
+
+	return ret;
+}
+
+} // namespace nytl
+
+#endif // header guard
@@ -13,7 +13,12 @@
 #include <nytl/nonCopyable.hpp> // nytl::NonCopyable
 #include <nytl/scope.hpp> // nytl::ScopeGuard
 
+#include <atomic> // std::atomic
+#include <exception> // std::exception_ptr
 #include <functional> // std::function
+#include <mutex> // std::mutex
+#include <optional> // std::optional
+#include <thread> // std::this_thread
 #include <utility> // std::move
 #include <cstdint> // std::uint64_t
 #include <cstddef> // std::size_t
@@ -47,6 +52,12 @@ namespace nytl {
 template<typename Signature, typename ID = ConnectionID>
 class Callback;
 
+/// How a function registered in a Callback is called by Callback::callParallel.
+enum class ListenerMode {
+	ordered, // called on the calling thread, in registration order
+	independent, // might be called on other threads, concurrently to other functions
+};
+
 /// Callback class typedef using TrackedConnectionID. Enables connections
 /// to see when their associated function is unregistered by another
 /// connection or because the callback was destroyed.
@@ -67,6 +78,7 @@ public:
 	struct Subscription {
 		std::function<Ret(Args...)> func;
 		ID id;
+		bool independent {};
 	};
 
 	using Signature = Ret(Args...);
@@ -80,7 +92,9 @@ public:
 	/// \returns A connection id for the registered function which can be used to
 	/// unregister it.
 	/// \throws std::invalid_argument If an empty function target is registered.
-	Connection add(std::function<Ret(Args...)>);
+	/// ! The mode parameter is not present in RecursiveCallback.
+	/// It specifies whether the function may be called concurrently by callParallel.
+	Connection add(std::function<Ret(Args...)>, ListenerMode mode = ListenerMode::ordered);
 
 	/// Calls all registered functions and returns a vector with the returned objects,
 	/// or void when this is a void callback.
@@ -90,6 +104,22 @@ public:
 	/// handlers will not be called.
 	auto call(Args...);
 
+	/// ! Not present in RecursiveCallback
+	/// Like call but runs the functions registered as independent as tasks on the
+	/// given executor, concurrently to each other. The ordered functions are called
+	/// on the calling thread in registration order meanwhile. Returns once all
+	/// functions returned, the returned objects are in registration order.
+	/// Other than call, all functions are called even if one of them throws.
+	/// Afterwards the exception of the first function (in registration order)
+	/// that threw is rethrown.
+	/// Arguments passed by reference are shared by the concurrently running functions.
+	/// The callback must not be changed while this is running.
+	/// \tparam Executor Must provide spawn(func) that runs func() on some thread and
+	/// runPending() that runs a pending task on the calling thread and returns whether
+	/// there was one, e.g. nytl::TaskScheduler.
+	template<typename Executor>
+	auto callParallel(Executor& executor, Args...);
+
 	/// Clears all registered functions.
 	void clear() noexcept;
 
@@ -144,7 +174,7 @@ Callback<Ret(Args...), ID>::~Callback()
 
 template<typename Ret, typename... Args, typename ID>
 ConnectionT<ConnectableT<ID>, ID> Callback<Ret(Args...), ID>::
-add(std::function<Ret(Args...)> func) {
+add(std::function<Ret(Args...)> func, ListenerMode mode) {
 	if(!func) {
 		throw std::invalid_argument("nytl::Callback::add: empty function");
 	}
@@ -164,6 +194,7 @@ add(std::function<Ret(Args...)> func) {
 	subs_.emplace_back();
 	subs_.back().id = id;
 	subs_.back().func = std::move(func);
+	subs_.back().independent = (mode == ListenerMode::independent);
 	return {*this, id};
 }
 
@@ -188,6 +219,100 @@ auto Callback<Ret(Args...), ID>::call(Args... a)
 	}
 }
 
+template<typename Ret, typename... Args, typename ID>
+template<typename Executor>
+auto Callback<Ret(Args...), ID>::callParallel(Executor& executor, Args... a)
+{
+	static_assert((!std::is_rvalue_reference<Args>::value && ...),
+		"nytl::Callback::callParallel: rvalue reference parameters are not supported");
+
+	constexpr auto isVoid = std::is_same<Ret, void>::value;
+	using Result = std::conditional_t<isVoid, char, std::optional<Ret>>;
+
+	// every function writes into its own slot
+	auto count = subs_.size();
+	std::vector<Result> results(isVoid ? 0 : count);
+
+	std::mutex mutex;
+	std::size_t errorIndex = count;
+	std::exception_ptr error;
+	auto callAt = [&](std::size_t i) noexcept {
+		try {
+			if constexpr(isVoid) {
+				subs_[i].func(a...);
+			} else {
+				results[i].emplace(subs_[i].func(a...));
+			}
+		} catch(...) {
+			std::lock_guard lock(mutex);
+			if(i < errorIndex) {
+				errorIndex = i;
+				error = std::current_exception();
+			}
+		}
+	};
+
+	std::atomic<std::size_t> pending {0};
+	auto join = [&]{
+		while(pending.load(std::memory_order_acquire)) {
+			if(!executor.runPending()) {
+				std::this_thread::yield();
+			}
+		}
+	};
+
+	// spawn all independent functions but the last one,
+	// it is called on this thread after the ordered ones
+	auto last = count;
+	try {
+		for(auto i = std::size_t(0); i < count; ++i) {
+			if(!subs_[i].independent) {
+				continue;
+			}
+
+			if(last != count) {
+				pending.fetch_add(1, std::memory_order_relaxed);
+				executor.spawn([&callAt, &pending, last]{
+					callAt(last);
+					pending.fetch_sub(1, std::memory_order_release);
+				});
+			}
+			last = i;
+		}
+	} catch(...) {
+		// spawned tasks reference the local state
+		pending.fetch_sub(1, std::memory_order_relaxed);
+		join();
+		throw;
+	}
+
+	for(auto i = std::size_t(0); i < count; ++i) {
+		if(!subs_[i].independent) {
+			callAt(i);
+		}
+	}
+
+	if(last != count) {
+		callAt(last);
+	}
+
+	join();
+	if(error) {
+		std::rethrow_exception(error);
+	}
+
+	if constexpr(isVoid) {
+		return;
+	} else {
+		std::vector<Ret> ret;
+		ret.reserve(count);
+		for(auto& result : results) {
+			ret.push_back(std::move(*result));
+		}
+		return ret;
+	}
+}
+
 template<typename Ret, typename... Args, typename ID>
 void Callback<Ret(Args...), ID>::clear() noexcept
 {
@@ -8,9 +8,111 @@
 #define NYTL_INCLUDE_CLONE
 
 #include <memory> // std::unique_ptr
+#include <memory_resource> // std::pmr::memory_resource
+#include <new> // placement new
+#include <utility> // std::forward
+#include <cstddef> // std::size_t
+#include <vector> // std::vector
+#include <iterator> // std::begin
+#include <type_traits> // std::remove_const_t
 
 namespace nytl {
 
+/// \brief The memory of an object cloned into a memory resource.
+/// Returned by the virtual doCloneInto/doCloneMoveInto hooks since only
+/// the implementation knows the size and alignment of the object.
+/// \module utility
+struct ClonedMemory {
+	void* object; // pointer to the most derived object
+	std::size_t size;
+	std::size_t alignment;
+};
+
+/// \brief Deleter for objects cloned into a std::pmr::memory_resource.
+/// Destroys the object and returns its memory to the resource it was
+/// allocated from. For a std::pmr::monotonic_buffer_resource, deallocation
+/// is a no-op, all memory is released with the resource.
+/// \module utility
+template<typename T>
+struct ResourceDeleter {
+	std::pmr::memory_resource* resource {};
+	ClonedMemory memory {};
+
+	void operator()(T* obj) const {
+		obj->~T();
+		resource->deallocate(memory.object, memory.size, memory.alignment);
+	}
+};
+
+/// \brief Owning pointer to an object cloned into a std::pmr::memory_resource.
+/// \module utility
+template<typename T>
+using ResourcePtr = std::unique_ptr<T, ResourceDeleter<T>>;
+
+/// \brief Describes how to copy and destroy arrays of a cloneable type.
+/// Returned by the virtual doCloneTypeInfo hook. There is only one info
+/// per type, its address can therefore be used as type id.
+/// \module utility
+struct CloneTypeInfo {
+	std::size_t size;
+	std::size_t alignment;
+
+	// Copy constructs count objects into the array at dst.
+	// src holds pointers to the most derived objects to copy.
+	void (*copyN)(const void* const* src, void* dst, std::size_t count);
+
+	// Destroys count objects in the array at objects.
+	void (*destroyN)(void* objects, std::size_t count);
+};
+
+namespace detail {
+
+template<typename T>
+void destroyN(void* objects, std::size_t count) {
+	auto ptr = static_cast<T*>(objects);
+	for(auto i = std::size_t(0); i < count; ++i) {
+		ptr[i].~T();
+	}
+}
+
+template<typename T>
+void copyN(const void* const* src, void* dst, std::size_t count) {
+	auto out = static_cast<T*>(dst);
+	auto i = std::size_t(0);
+	try {
+		for(; i < count; ++i) {
+			new(out + i) T(*static_cast<const T*>(src[i]));
+		}
+	} catch(...) {
+		destroyN<T>(dst, i);
+		throw;
+	}
+}
+
+template<typename T>
+inline constexpr CloneTypeInfo cloneTypeInfo {sizeof(T), alignof(T), &copyN<T>, &destroyN<T>};
+
+// Gives nytl::CloneBatch access to the protected doCloneTypeInfo hook.
+struct CloneAccess {
+	template<typename T>
+	static const CloneTypeInfo& typeInfo(const T& obj) { return obj.doCloneTypeInfo(); }
+};
+
+// Constructs a Derived object in memory allocated from the given resource.
+template<typename Derived, typename... Args>
+ClonedMemory constructInto(std::pmr::memory_resource& res, Args&&... args) {
+	auto mem = res.allocate(sizeof(Derived), alignof(Derived));
+	try {
+		auto obj = new(mem) Derived(std::forward<Args>(args)...);
+		return {obj, sizeof(Derived), alignof(Derived)};
+	} catch(...) {
+		res.deallocate(mem, sizeof(Derived), alignof(Derived));
+		throw;
+	}
+}
+
+} // namespace detail
+
 /// \brief Can be used to clone a Cloneable object.
 /// Will perform a copy of the actual type the interface reference references.
 /// \requires Type 'T' shall be Cloneable (i.e. derived from a nytl::Cloneable or
@@ -32,6 +134,27 @@ std::unique_ptr<T> cloneMove(T& obj) {
 	return std::unique_ptr<T>(static_cast<T*>(obj.doCloneMove()));
 }
 
+/// \brief Like nytl::clone but allocates the copy from the given memory resource
+/// instead of the global heap. Useful to clone many objects (or whole object
+/// graphs) into a std::pmr::monotonic_buffer_resource or a pool.
+/// The returned pointer destroys the object and returns the memory to
+/// the resource, so the resource must outlive it.
+/// \module utility
+template<typename T>
+ResourcePtr<T> clone(const T& obj, std::pmr::memory_resource& resource) {
+	auto mem = obj.doCloneInto(resource);
+	return {static_cast<T*>(mem.object), {&resource, mem}};
+}
+
+/// \brief Like nytl::cloneMove but allocates the moved copy from the given
+/// memory resource. See the nytl::clone overload for memory resources.
+/// \module utility
+template<typename T>
+ResourcePtr<T> cloneMove(T& obj, std::pmr::memory_resource& resource) {
+	auto mem = obj.doCloneMoveInto(resource);
+	return {static_cast<T*>(mem.object), {&resource, mem}};
+}
+
 /// \brief Can be derived from to implement the cloneMove member function for 'Derived'.
 /// \requires Type 'Derived' shall derive from this class using the CRTP idiom.
 /// For this to work, Base must have defined a virtual cloneMove member function in its interface.
@@ -42,7 +165,9 @@ template<typename Derived, typename... Bases>
 class DeriveCloneMovable : public Bases... {
 protected:
 	void* doCloneMove() override; // Base return type since CRTP
+	ClonedMemory doCloneMoveInto(std::pmr::memory_resource&) override;
 	template<typename O> friend std::unique_ptr<O> cloneMove(O&);
+	template<typename O> friend ResourcePtr<O> cloneMove(O&, std::pmr::memory_resource&);
 };
 
 template<typename Derived, typename Base>
@@ -50,7 +175,9 @@ class DeriveCloneMovable<Derived, Base> : public Base {
 protected:
 	using Base::Base;
 	void* doCloneMove() override; // Base return type since CRTP
+	ClonedMemory doCloneMoveInto(std::pmr::memory_resource&) override;
 	template<typename O> friend std::unique_ptr<O> cloneMove(O&);
+	template<typename O> friend ResourcePtr<O> cloneMove(O&, std::pmr::memory_resource&);
 };
 
 /// \brief Can be derived from to implement the clone/cloneMove member functions for 'Derived'.
@@ -64,7 +191,11 @@ class DeriveCloneable : public DeriveCloneMovable<Derived, Bases...> {
 protected:
 	using DeriveCloneMovable<Derived, Bases...>::DeriveCloneMovable;
 	void* doClone() const override; // Base return type since CRTP
+	ClonedMemory doCloneInto(std::pmr::memory_resource&) const override;
+	const CloneTypeInfo& doCloneTypeInfo() const override;
 	template<typename O> friend std::unique_ptr<O> clone(const O&);
+	template<typename O> friend ResourcePtr<O> clone(const O&, std::pmr::memory_resource&);
+	friend struct detail::CloneAccess;
 };
 
 /// \brief Can be derived from to make clone-moving for interfaces possible.
@@ -79,8 +210,10 @@ template<typename T>
 class AbstractCloneMovable {
 protected:
 	virtual void* doCloneMove() = 0;
+	virtual ClonedMemory doCloneMoveInto(std::pmr::memory_resource&) = 0;
 	virtual ~AbstractCloneMovable() = default;
 	template<typename O> friend std::unique_ptr<O> cloneMove(O&);
+	template<typename O> friend ResourcePtr<O> cloneMove(O&, std::pmr::memory_resource&);
 };
 
 /// \brief Can be derived from to make cloning for abstract classes possible.
@@ -95,7 +228,11 @@ template<typename T>
 class AbstractCloneable : public AbstractCloneMovable<T> {
 protected:
 	virtual void* doClone() const = 0;
+	virtual ClonedMemory doCloneInto(std::pmr::memory_resource&) const = 0;
+	virtual const CloneTypeInfo& doCloneTypeInfo() const = 0;
 	template<typename O> friend std::unique_ptr<O> clone(const O&);
+	template<typename O> friend ResourcePtr<O> clone(const O&, std::pmr::memory_resource&);
+	friend struct detail::CloneAccess;
 };
 
 
@@ -105,7 +242,12 @@ template<typename T>
 class CloneMovable : public AbstractCloneMovable<T> {
 protected:
 	void* doCloneMove() override { return new T(std::move(static_cast<T&>(*this))); }
+	ClonedMemory doCloneMoveInto(std::pmr::memory_resource& res) override {
+		return detail::constructInto<T>(res, std::move(static_cast<T&>(*this)));
+	}
+
 	template<typename O> friend std::unique_ptr<O> cloneMove(O&);
+	template<typename O> friend ResourcePtr<O> cloneMove(O&, std::pmr::memory_resource&);
 };
 
 /// \brief Can be used to add the clone interface to a class as well as already implement it.
@@ -115,8 +257,21 @@ class Cloneable : public AbstractCloneable<T> {
 protected:
 	void* doCloneMove() override { return new T(std::move(static_cast<T&>(*this))); }
 	void* doClone() const override { return new T(static_cast<const T&>(*this)); }
+	ClonedMemory doCloneMoveInto(std::pmr::memory_resource& res) override {
+		return detail::constructInto<T>(res, std::move(static_cast<T&>(*this)));
+	}
+	ClonedMemory doCloneInto(std::pmr::memory_resource& res) const override {
+		return detail::constructInto<T>(res, static_cast<const T&>(*this));
+	}
+	const CloneTypeInfo& doCloneTypeInfo() const override {
+		return detail::cloneTypeInfo<T>;
+	}
+
 	template<typename O> friend std::unique_ptr<O> clone(const O&);
 	template<typename O> friend std::unique_ptr<O> cloneMove(const O&);
+	template<typename O> friend ResourcePtr<O> clone(const O&, std::pmr::memory_resource&);
+	template<typename O> friend ResourcePtr<O> cloneMove(O&, std::pmr::memory_resource&);
+	friend struct detail::CloneAccess;
 };
 
 // - derive class implementation -
@@ -132,6 +287,190 @@ template<typename Derived, typename... Bases>
 void* DeriveCloneable<Derived, Bases...>::doClone() const
 	{ return new Derived(static_cast<const Derived&>(*this)); }
 
+template<typename Derived, typename... Bases>
+ClonedMemory DeriveCloneMovable<Derived, Bases...>::doCloneMoveInto(
+		std::pmr::memory_resource& res)
+	{ return detail::constructInto<Derived>(res, std::move(static_cast<Derived&>(*this))); }
+
+template<typename Derived, typename Base>
+ClonedMemory DeriveCloneMovable<Derived, Base>::doCloneMoveInto(
+		std::pmr::memory_resource& res)
+	{ return detail::constructInto<Derived>(res, std::move(static_cast<Derived&>(*this))); }
+
+template<typename Derived, typename... Bases>
+ClonedMemory DeriveCloneable<Derived, Bases...>::doCloneInto(
+		std::pmr::memory_resource& res) const
+	{ return detail::constructInto<Derived>(res, static_cast<const Derived&>(*this)); }
+
+template<typename Derived, typename... Bases>
+const CloneTypeInfo& DeriveCloneable<Derived, Bases...>::doCloneTypeInfo() const
+	{ return detail::cloneTypeInfo<Derived>; }
+
+/// \brief Clones of many Cloneable objects, grouped by their dynamic type.
+/// The clones of each type are stored contiguously in one allocation (pool),
+/// the objects can be accessed in the order they were given to nytl::cloneAll.
+/// Owns the clones, destroys them on destruction. Movable but not copyable.
+/// \module utility
+template<typename T>
+class CloneBatch {
+public:
+	CloneBatch() = default;
+	~CloneBatch() { release(); }
+
+	/// Clones all objects in the given range of (smart) pointers to T.
+	/// Null pointers are allowed and result in null pointers.
+	/// Prefer nytl::cloneAll which deduces T.
+	template<typename R>
+	explicit CloneBatch(const R& objects);
+
+	CloneBatch(CloneBatch&& other) noexcept { swap(*this, other); }
+	CloneBatch& operator=(CloneBatch&& other) noexcept {
+		swap(*this, other);
+		return *this;
+	}
+
+	/// Returns the clone of the object with the given index.
+	T* get(std::size_t i) const noexcept { return objects_[i]; }
+	T* operator[](std::size_t i) const noexcept { return objects_[i]; }
+
+	T* const* begin() const noexcept { return objects_.data(); }
+	T* const* end() const noexcept { return objects_.data() + objects_.size(); }
+
+	std::size_t size() const noexcept { return objects_.size(); }
+	bool empty() const noexcept { return objects_.empty(); }
+
+	/// The number of pools, i.e. the number of distinct types cloned.
+	std::size_t pools() const noexcept { return pools_.size(); }
+
+	friend void swap(CloneBatch& a, CloneBatch& b) noexcept {
+		using std::swap;
+		swap(a.pools_, b.pools_);
+		swap(a.objects_, b.objects_);
+	}
+
+protected:
+	struct Pool {
+		const CloneTypeInfo* info;
+		void* data {};
+		std::size_t count {}; // number of constructed objects
+	};
+
+	void release() noexcept {
+		for(auto& pool : pools_) {
+			pool.info->destroyN(pool.data, pool.count);
+			::operator delete(pool.data, std::align_val_t(pool.info->alignment));
+		}
+
+		pools_.clear();
+		objects_.clear();
+	}
+
+protected:
+	std::vector<Pool> pools_;
+	std::vector<T*> objects_;
+};
+
+template<typename T>
+template<typename R>
+CloneBatch<T>::CloneBatch(const R& objects) {
+	struct Source {
+		const void* object; // most derived object
+		std::size_t pool;
+		std::size_t slot; // index in pool
+		std::ptrdiff_t base; // offset of the T subobject
+	};
+
+	std::vector<Source> sources;
+	std::vector<std::size_t> counts;
+	sources.reserve(std::size(objects));
+
+	// find the type (pool) of every object. Objects of the same type
+	// are usually stored next to each other, so check the last one first
+	const CloneTypeInfo* last {};
+	auto lastPool = std::size_t(0);
+	for(auto& ptr : objects) {
+		if(!ptr) {
+			sources.push_back({nullptr, 0, 0, 0});
+			continue;
+		}
+
+		const T& obj = *ptr;
+		auto info = &detail::CloneAccess::typeInfo(obj);
+		if(info != last) {
+			lastPool = 0;
+			while(lastPool < pools_.size() && pools_[lastPool].info != info) {
+				++lastPool;
+			}
+
+			if(lastPool == pools_.size()) {
+				pools_.push_back({info});
+				counts.push_back(0);
+			}
+
+			last = info;
+		}
+
+		auto derived = dynamic_cast<const void*>(&obj);
+		auto base = reinterpret_cast<const unsigned char*>(&obj) -
+			static_cast<const unsigned char*>(derived);
+		sources.push_back({derived, lastPool, counts[lastPool]++, base});
+	}
+
+	// sort the objects by pool and copy them with one call per pool
+	std::vector<std::size_t> first(pools_.size());
+	for(auto i = std::size_t(1); i < pools_.size(); ++i) {
+		first[i] = first[i - 1] + counts[i - 1];
+	}
+
+	std::vector<const void*> grouped(pools_.empty() ? 0 : first.back() + counts.back());
+	for(auto& src : sources) {
+		if(src.object) {
+			grouped[first[src.pool] + src.slot] = src.object;
+		}
+	}
+
+	try {
+		for(auto i = std::size_t(0); i < pools_.size(); ++i) {
+			auto& pool = pools_[i];
+			auto align = std::align_val_t(pool.info->alignment);
+			pool.data = ::operator new(counts[i] * pool.info->size, align);
+			pool.info->copyN(grouped.data() + first[i], pool.data, counts[i]);
+			pool.count = counts[i];
+		}
+
+		objects_.reserve(sources.size());
+	} catch(...) {
+		release();
+		throw;
+	}
+
+	for(auto& src : sources) {
+		if(!src.object) {
+			objects_.push_back(nullptr);
+			continue;
+		}
+
+		auto& pool = pools_[src.pool];
+		auto obj = static_cast<unsigned char*>(pool.data) + src.slot * pool.info->size;
+		objects_.push_back(std::launder(static_cast<T*>(static_cast<void*>(obj + src.base))));
+	}
+}
+
+/// \brief Clones all objects in the given range of (smart) pointers at once.
+/// Instead of allocating every clone separately, groups the objects by
+/// their dynamic type and copies all objects of one type into one
+/// contiguous allocation. Costs one virtual call per object and one
+/// allocation per distinct type (instead of per object).
+/// The returned nytl::CloneBatch preserves the order of the given objects.
+/// \requires The pointed-to type shall be Cloneable.
+/// \module utility
+template<typename R>
+auto cloneAll(const R& objects) {
+	using Ptr = std::decay_t<decltype(*std::begin(objects))>;
+	using T = std::remove_const_t<typename std::pointer_traits<Ptr>::element_type>;
+	return CloneBatch<T>(objects);
+}
+
 }
 
 #endif //header guard
@@ -171,6 +510,18 @@ void* DeriveCloneable<Derived, Bases...>::doClone() const
 /// }
 /// ```
 ///
+/// All clone functions can also allocate from a std::pmr::memory_resource, e.g.
+/// to clone many objects into an arena and release them all at once:
+///
+/// ```cpp
+/// std::pmr::monotonic_buffer_resource arena;
+/// auto copy = nytl::clone(*ptr, arena); // nytl::ResourcePtr<Base>
+/// ```
+///
+/// Many objects (e.g. a `std::vector<std::unique_ptr<Base>>`) can be cloned
+/// at once with nytl::cloneAll. That stores the clones of each type contiguously
+/// and needs only one allocation per type.
+///
 /// Instead of `Base` you could also pass multiple bases from which to derive.
 /// If you only derive from one type you can still use its constructor, it is
 /// also used by DeriveCloneable/DeriveCloneMovable.
@@ -0,0 +1,101 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Configurable precondition checking (contracts) for nytl.
+/// The checking policy is selected at compile time by defining NYTL_CONTRACTS
+/// to one of the NYTL_CONTRACTS_* values below before including any nytl header.
+/// The policy must be the same in all translation units of a program.
+/// - NYTL_CONTRACTS_OFF (default): checks are not evaluated at all and
+///   generate no code. The checked expression is still parsed (unevaluated)
+///   so variables only used by checks don't trigger warnings.
+/// - NYTL_CONTRACTS_ASSERT: prints the violated expression with its source
+///   location to std::cerr and calls std::abort.
+/// - NYTL_CONTRACTS_THROW: throws nytl::ContractViolation.
+/// - NYTL_CONTRACTS_LOG: prints the violated expression with its source
+///   location to std::cerr and continues execution.
+/// When checks are enabled, nytl::span additionally uses checked iterators.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_CONTRACTS
+#define NYTL_INCLUDE_CONTRACTS
+
+#include <stdexcept> // std::logic_error
+#include <string> // std::string
+#include <iostream> // std::cerr
+#include <cstdlib> // std::abort
+
+#define NYTL_CONTRACTS_OFF 0
+#define NYTL_CONTRACTS_ASSERT 1
+#define NYTL_CONTRACTS_THROW 2
+#define NYTL_CONTRACTS_LOG 3
+
+#ifndef NYTL_CONTRACTS
+	#define NYTL_CONTRACTS NYTL_CONTRACTS_OFF
+#endif
+
+#if NYTL_CONTRACTS < NYTL_CONTRACTS_OFF || NYTL_CONTRACTS > NYTL_CONTRACTS_LOG
+	#error "nytl: Invalid NYTL_CONTRACTS value"
+#endif
+
+// branch prediction hints
+#if defined(__GNUC__) || defined(__clang__)
+	#define NYTL_LIKELY(x) __builtin_expect(!!(x), 1)
+	#define NYTL_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+	#define NYTL_LIKELY(x) (!!(x))
+	#define NYTL_UNLIKELY(x) (!!(x))
+#endif
+
+namespace nytl {
+
+/// Thrown by failed precondition checks when NYTL_CONTRACTS is
+/// NYTL_CONTRACTS_THROW.
+class ContractViolation : public std::logic_error {
+public:
+	ContractViolation(const char* expr, const char* file, unsigned int line,
+		const char* func) : std::logic_error(std::string("nytl: contract '")
+			.append(expr).append("' violated in ").append(func)
+			.append(" (").append(file).append(":")
+			.append(std::to_string(line)).append(")")),
+		expression(expr), file(file), line(line), function(func) {}
+
+	const char* expression;
+	const char* file;
+	unsigned int line;
+	const char* function;
+};
+
+namespace detail {
+
+/// Called by NYTL_EXPECTS for violated contracts.
+/// Implements the selected policy. Not marked noreturn since
+/// the logging policy continues execution.
+inline void contractViolated(const char* expr, const char* file,
+		unsigned int line, const char* func) {
+	if constexpr(NYTL_CONTRACTS == NYTL_CONTRACTS_THROW) {
+		throw ContractViolation(expr, file, line, func);
+	} else {
+		std::cerr << file << ":" << line << ": " << func
+			<< ": nytl: contract '" << expr << "' violated\n";
+		if constexpr(NYTL_CONTRACTS == NYTL_CONTRACTS_ASSERT) {
+			std::abort();
+		}
+	}
+}
+
+} // namespace detail
+} // namespace nytl
+
+/// \brief Checks the given precondition according to the NYTL_CONTRACTS policy.
+/// Can be used in constexpr functions, as long as the condition holds
+/// during constant evaluation.
+#if NYTL_CONTRACTS == NYTL_CONTRACTS_OFF
+	#define NYTL_EXPECTS(cond) ((void) sizeof(!(cond)))
+#else
+	#define NYTL_EXPECTS(cond) (NYTL_LIKELY(cond) ? (void) 0 : \
+		::nytl::detail::contractViolated(#cond, __FILE__, __LINE__, __func__))
+#endif
+
+#endif // header guard
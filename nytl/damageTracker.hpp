@@ -0,0 +1,390 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Tracks the damaged (changed) regions of a framebuffer over multiple frames.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_DAMAGE_TRACKER
+#define NYTL_INCLUDE_DAMAGE_TRACKER
+
+#include <nytl/rect.hpp> // nytl::Rect
+#include <nytl/rectOps.hpp> // nytl::intersection
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/math.hpp> // nytl::lowestBit
+
+#include <vector> // std::vector
+#include <algorithm> // std::min
+#include <cmath> // std::floor
+#include <cstdint> // std::uint64_t
+
+namespace nytl {
+
+/// How a DamageTracker stores the damage.
+/// \module rect
+enum class DamageMode {
+	rects, // list of rects, merged when cheaper to redraw together
+	tiles, // bitmap of fixed size tiles
+};
+
+/// Configuration of a DamageTracker.
+/// \module rect
+struct DamageSettings {
+	DamageMode mode = DamageMode::rects;
+
+	/// The highest buffer age the damage is tracked for.
+	unsigned maxAge = 3;
+
+	/// Only for DamageMode::rects: the maximum number of rects per frame.
+	/// If more are added, they are merged with the rect wasting the least area.
+	unsigned maxRects = 16;
+
+	/// Only for DamageMode::rects: the area (in pixels) that may be redrawn
+	/// in vain to save one rect (e.g. the cost of a draw call).
+	/// Rects are merged if their bounds are not larger than their union by more.
+	double rectCost = 32 * 32;
+
+	/// Only for DamageMode::tiles: the size of the tiles.
+	unsigned tileSize = 32;
+};
+
+/// \brief Accumulates the damaged regions of a framebuffer, e.g. to only
+/// redraw or present the changed parts.
+/// Keeps the damage of the last frames, damage(age) returns what has to be
+/// redrawn in a buffer that was last drawn age frames ago (see e.g.
+/// EGL_EXT_buffer_age). In DamageMode::rects, overlapping or nearby rects are
+/// merged if the wasted area costs less than an additional rect (see
+/// DamageSettings). In DamageMode::tiles the damage is rounded up to tiles,
+/// which is cheaper for many small changes.
+/// Does not allocate after construction and resize, except when damage
+/// in DamageMode::tiles is more fragmented than ever before.
+/// \tparam T The type of the coordinates, e.g. int.
+/// \module rect
+template<typename T>
+class DamageTracker {
+public:
+	using RectType = Rect<2, T>;
+
+public:
+	explicit DamageTracker(Vec2<T> size, const DamageSettings& settings = {});
+
+	/// Marks the given rect as damaged in the current frame.
+	/// It is clipped to the buffer.
+	void add(const RectType& rect);
+
+	/// Marks the whole buffer as damaged in the current frame.
+	void addAll();
+
+	/// Finishes the current frame (i.e. after it was drawn) and starts a new one.
+	void nextFrame();
+
+	/// Changes the size of the buffer. All buffers are completely damaged.
+	void resize(Vec2<T> size);
+
+	/// Returns the regions that have to be redrawn in a buffer with the given age,
+	/// i.e. the damage of the current and the age - 1 previous frames.
+	/// Returns the whole buffer if the age is 0 (unknown contents) or the damage
+	/// of so many frames is not known. The returned rects do not overlap
+	/// in DamageMode::tiles. Valid until this is called again or the tracker
+	/// is changed.
+	Span<const RectType> damage(unsigned age);
+
+	Vec2<T> size() const { return size_; }
+	const DamageSettings& settings() const { return settings_; }
+
+protected:
+	struct Frame {
+		bool full;
+		std::vector<RectType> rects; // DamageMode::rects
+		std::vector<std::uint64_t> tiles; // DamageMode::tiles
+	};
+
+	// Adds rect to the given rects, merges them if cheaper.
+	void insert(std::vector<RectType>& rects, RectType rect) const;
+
+	// Marks the tiles covered by the given rect.
+	void mark(std::vector<std::uint64_t>& tiles, const RectType& rect) const;
+
+	// Stores the set tiles in out_ as rects, runs in a row and equal
+	// runs in consecutive rows are combined.
+	void collect(const std::vector<std::uint64_t>& tiles);
+
+	Frame& frame(unsigned back) { return frames_[(current_ + frames_.size() - back) % frames_.size()]; }
+
+	static double area(const RectType& r) { return double(r.size.x) * double(r.size.y); }
+	static RectType bounds(const RectType& a, const RectType& b);
+	static bool covers(const RectType& a, const RectType& b); // whether a contains b
+
+	DamageSettings settings_;
+	Vec2<T> size_;
+	std::vector<Frame> frames_; // ring buffer
+	unsigned current_ {}; // the frame damage is added to
+	unsigned history_ {}; // number of known previous frames
+
+	std::size_t tilesX_ {}, tilesY_ {}, rowWords_ {};
+
+	// scratch storage, kept to avoid allocations
+	std::vector<RectType> out_;
+	std::vector<std::uint64_t> tiles_;
+	std::vector<std::size_t> active_, next_;
+};
+
+// - implementation -
+template<typename T>
+DamageTracker<T>::DamageTracker(Vec2<T> size, const DamageSettings& settings)
+		: settings_(settings) {
+	NYTL_EXPECTS(settings.maxAge >= 1 && settings.maxRects >= 1 && settings.tileSize >= 1);
+	frames_.resize(settings.maxAge);
+	resize(size);
+}
+
+template<typename T>
+void DamageTracker<T>::resize(Vec2<T> size) {
+	size_ = size;
+	tilesX_ = (std::size_t(size.x) + settings_.tileSize - 1) / settings_.tileSize;
+	tilesY_ = (std::size_t(size.y) + settings_.tileSize - 1) / settings_.tileSize;
+	rowWords_ = (tilesX_ + 63) / 64;
+
+	auto tiles = settings_.mode == DamageMode::tiles;
+	for(auto& frame : frames_) {
+		frame.full = false;
+		frame.rects.clear();
+		frame.rects.reserve(tiles ? 0 : settings_.maxRects + 1);
+		frame.tiles.assign(tiles ? tilesY_ * rowWords_ : 0, 0u);
+	}
+
+	// the worst case is a checkerboard pattern
+	out_.clear();
+	out_.reserve(tiles ? (tilesX_ * tilesY_ + 1) / 2 + 1 : settings_.maxRects + 1);
+	tiles_.assign(tiles ? tilesY_ * rowWords_ : 0, 0u);
+	active_.reserve(tilesX_);
+	next_.reserve(tilesX_);
+
+	history_ = 0;
+	addAll();
+}
+
+template<typename T>
+void DamageTracker<T>::add(const RectType& rect) {
+	auto& cur = frame(0);
+	if(cur.full || !intersectsReal(rect, RectType {{}, size_})) {
+		return;
+	}
+
+	auto clipped = intersection(rect, RectType {{}, size_});
+	if(settings_.mode == DamageMode::tiles) {
+		mark(cur.tiles, clipped);
+	} else {
+		insert(cur.rects, clipped);
+	}
+}
+
+template<typename T>
+void DamageTracker<T>::addAll() {
+	auto& cur = frame(0);
+	cur.full = true;
+	cur.rects.clear();
+	std::fill(cur.tiles.begin(), cur.tiles.end(), 0u);
+}
+
+template<typename T>
+void DamageTracker<T>::nextFrame() {
+	current_ = (current_ + 1) % frames_.size();
+	history_ = std::min<unsigned>(history_ + 1, unsigned(frames_.size()) - 1);
+
+	auto& cur = frame(0);
+	cur.full = false;
+	cur.rects.clear();
+	std::fill(cur.tiles.begin(), cur.tiles.end(), 0u);
+}
+
+template<typename T>
+Span<const Rect<2, T>> DamageTracker<T>::damage(unsigned age) {
+	out_.clear();
+	auto full = (age == 0 || age > history_ + 1);
+	for(auto i = 0u; !full && i < age; ++i) {
+		full = frame(i).full;
+	}
+
+	if(full) {
+		out_.push_back({{}, size_});
+		return out_;
+	}
+
+	if(settings_.mode == DamageMode::rects) {
+		for(auto i = 0u; i < age; ++i) {
+			for(auto& rect : frame(i).rects) {
+				insert(out_, rect);
+			}
+		}
+		return out_;
+	}
+
+	// tiles
+	if(age == 1) {
+		collect(frame(0).tiles);
+		return out_;
+	}
+
+	std::fill(tiles_.begin(), tiles_.end(), 0u);
+	for(auto i = 0u; i < age; ++i) {
+		auto& tiles = frame(i).tiles;
+		for(auto w = 0u; w < tiles_.size(); ++w) {
+			tiles_[w] |= tiles[w];
+		}
+	}
+
+	collect(tiles_);
+	return out_;
+}
+
+template<typename T>
+Rect<2, T> DamageTracker<T>::bounds(const RectType& a, const RectType& b) {
+	Vec2<T> min {std::min(a.position.x, b.position.x), std::min(a.position.y, b.position.y)};
+	Vec2<T> max {
+		std::max(a.position.x + a.size.x, b.position.x + b.size.x),
+		std::max(a.position.y + a.size.y, b.position.y + b.size.y)};
+	return {min, max - min};
+}
+
+template<typename T>
+bool DamageTracker<T>::covers(const RectType& a, const RectType& b) {
+	return a.position.x <= b.position.x && a.position.y <= b.position.y &&
+		a.position.x + a.size.x >= b.position.x + b.size.x &&
+		a.position.y + a.size.y >= b.position.y + b.size.y;
+}
+
+template<typename T>
+void DamageTracker<T>::insert(std::vector<RectType>& rects, RectType rect) const {
+	if(!(rect.size.x > 0) || !(rect.size.y > 0)) {
+		return;
+	}
+
+	// merging grows rect, it might have to be merged with earlier ones then
+	auto merged = true;
+	while(merged) {
+		merged = false;
+		for(auto i = std::size_t(0); i < rects.size();) {
+			auto& other = rects[i];
+			if(covers(other, rect)) {
+				return;
+			}
+
+			// area of the bounds that is not part of any of the rects
+			auto u = bounds(rect, other);
+			auto waste = area(u) - area(rect) - area(other);
+			if(intersectsReal(rect, other)) {
+				waste += area(intersection(rect, other));
+			}
+
+			if(waste <= settings_.rectCost) {
+				rect = u;
+				other = rects.back();
+				rects.pop_back();
+				merged = true;
+			} else {
+				++i;
+			}
+		}
+	}
+
+	if(rects.size() < settings_.maxRects) {
+		rects.push_back(rect);
+		return;
+	}
+
+	// too many rects: merge with the one wasting the least area.
+	// Considering all pairs instead is quadratic for every added rect
+	auto best = std::size_t(0);
+	auto bestWaste = area(bounds(rect, rects[0])) - area(rects[0]);
+	for(auto i = std::size_t(1); i < rects.size(); ++i) {
+		auto waste = area(bounds(rect, rects[i])) - area(rects[i]);
+		if(waste < bestWaste) {
+			bestWaste = waste;
+			best = i;
+		}
+	}
+
+	auto u = bounds(rect, rects[best]);
+	rects[best] = rects.back();
+	rects.pop_back();
+	insert(rects, u);
+}
+
+template<typename T>
+void DamageTracker<T>::mark(std::vector<std::uint64_t>& tiles, const RectType& rect) const {
+	auto ts = double(settings_.tileSize);
+	auto x0 = std::size_t(std::floor(double(rect.position.x) / ts));
+	auto y0 = std::size_t(std::floor(double(rect.position.y) / ts));
+	auto x1 = std::min(tilesX_, std::size_t(std::ceil(double(rect.position.x + rect.size.x) / ts)));
+	auto y1 = std::min(tilesY_, std::size_t(std::ceil(double(rect.position.y + rect.size.y) / ts)));
+
+	for(auto y = y0; y < y1; ++y) {
+		auto row = tiles.data() + y * rowWords_;
+		for(auto x = x0; x < x1;) {
+			// all bits from x to the end of the range or the word
+			auto bit = x % 64;
+			auto count = std::min<std::size_t>(64 - bit, x1 - x);
+			auto bits = (count == 64) ? ~std::uint64_t(0) : ((std::uint64_t(1) << count) - 1);
+			row[x / 64] |= bits << bit;
+			x += count;
+		}
+	}
+}
+
+template<typename T>
+void DamageTracker<T>::collect(const std::vector<std::uint64_t>& tiles) {
+	auto ts = std::size_t(settings_.tileSize);
+	auto clampX = [&](std::size_t x) { return std::min(T(x * ts), size_.x); };
+	auto clampY = [&](std::size_t y) { return std::min(T(y * ts), size_.y); };
+
+	// active_ holds the rects ending at the previous row, sorted by x
+	active_.clear();
+	for(auto y = std::size_t(0); y < tilesY_; ++y) {
+		auto row = tiles.data() + y * rowWords_;
+		auto a = std::size_t(0);
+		next_.clear();
+
+		for(auto x = std::size_t(0); x < tilesX_;) {
+			// find the next run of set bits
+			auto w = x / 64;
+			auto bits = row[w] & (~std::uint64_t(0) << (x % 64));
+			if(!bits) {
+				x = (w + 1) * 64;
+				continue;
+			}
+
+			auto start = w * 64 + lowestBit(bits);
+			auto end = start;
+			while(end < tilesX_ && (row[end / 64] >> (end % 64)) & 1) {
+				auto rest = ~row[end / 64] >> (end % 64);
+				end += rest ? lowestBit(rest) : 64 - end % 64;
+			}
+			end = std::min(end, tilesX_);
+			x = end;
+
+			RectType rect {{clampX(start), clampY(y)},
+				{T(clampX(end) - clampX(start)), T(clampY(y + 1) - clampY(y))}};
+			while(a < active_.size() && out_[active_[a]].position.x < rect.position.x) {
+				++a;
+			}
+
+			if(a < active_.size() && out_[active_[a]].position.x == rect.position.x &&
+					out_[active_[a]].size.x == rect.size.x) {
+				out_[active_[a]].size.y += rect.size.y;
+				next_.push_back(active_[a]);
+			} else {
+				next_.push_back(out_.size());
+				out_.push_back(rect);
+			}
+		}
+
+		active_.swap(next_);
+	}
+}
+
+} // namespace nytl
+
+#endif // header guard
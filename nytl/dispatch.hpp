@@ -0,0 +1,239 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Runtime selection of kernels by the instruction sets of the cpu.
+/// nytl is header-only and therefore compiled for whatever target the
+/// consumer chooses, usually the baseline (e.g. x86-64 with only sse2).
+/// Kernels dispatched through nytl::Dispatch are compiled for multiple
+/// instruction sets (using target attributes) and the best implementation
+/// supported by the running cpu is selected once, on first use.
+/// The NYTL_ISA environment variable (scalar, sse2, avx2, avx512, neon) can be
+/// used to force a lower level, e.g. for testing. Unsupported levels are ignored.
+/// Runtime dispatch is only implemented for x86 with gcc/clang. Otherwise (or
+/// if NYTL_DISPATCH is defined to 0) kernels are only compiled for the
+/// compilation target and scalar.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_DISPATCH
+#define NYTL_INCLUDE_DISPATCH
+
+#include <nytl/simd.hpp> // NYTL_SIMD
+
+#include <cstddef> // std::size_t
+#include <cstdlib> // std::getenv
+#include <cstring> // std::strcmp
+
+#ifndef NYTL_DISPATCH
+	#if NYTL_SIMD && (defined(__x86_64__) || defined(__i386__))
+		#define NYTL_DISPATCH 1
+	#else
+		#define NYTL_DISPATCH 0
+	#endif
+#endif
+
+// The kernels are inlined into the functions of all levels.
+// g++ contracts multiplications and additions into fma instructions where
+// available (e.g. for avx512 or -march=native), even in iso mode. Disabled,
+// otherwise the levels would compute different results.
+#if defined(__GNUC__) && !defined(__clang__)
+	#define NYTL_KERNEL __attribute__((flatten, optimize("fp-contract=off")))
+#elif defined(__GNUC__)
+	#define NYTL_KERNEL __attribute__((flatten))
+#else
+	#define NYTL_KERNEL
+#endif
+
+#if NYTL_DISPATCH
+	#define NYTL_TARGET_SSE2 __attribute__((target("sse2"))) NYTL_KERNEL
+	#define NYTL_TARGET_AVX2 __attribute__((target("avx2"))) NYTL_KERNEL
+	#define NYTL_TARGET_AVX512 \
+		__attribute__((target("avx512f,avx512bw,avx512dq,avx512vl"))) NYTL_KERNEL
+#endif // NYTL_DISPATCH
+
+namespace nytl {
+
+/// Instruction set levels kernels can be compiled for.
+/// The kernels are compiled without fma contraction (with gcc), so all levels
+/// compute bitwise equal results (as long as the kernels themselves don't
+/// depend on the width).
+enum class Isa : unsigned {
+	scalar,
+	sse2,
+	avx2,
+	avx512, // f, bw, dq and vl
+	neon,
+};
+
+constexpr auto isaCount = 5u;
+
+/// Returns the width of the vector registers of the given level in bytes.
+/// Returns 0 for Isa::scalar.
+constexpr std::size_t isaBytes(Isa isa) {
+	switch(isa) {
+		case Isa::sse2: return 16;
+		case Isa::avx2: return 32;
+		case Isa::avx512: return 64;
+		case Isa::neon: return 16;
+		default: return 0;
+	}
+}
+
+/// The level the code is compiled for.
+#if !NYTL_SIMD
+	constexpr auto nativeIsa = Isa::scalar;
+#elif defined(__AVX512F__) && defined(__AVX512BW__) && \
+		defined(__AVX512DQ__) && defined(__AVX512VL__)
+	constexpr auto nativeIsa = Isa::avx512;
+#elif defined(__AVX2__)
+	constexpr auto nativeIsa = Isa::avx2;
+#elif defined(__SSE2__)
+	constexpr auto nativeIsa = Isa::sse2;
+#elif defined(__ARM_NEON)
+	constexpr auto nativeIsa = Isa::neon;
+#else
+	constexpr auto nativeIsa = Isa::scalar;
+#endif
+
+/// Returns the name of the given level, as used in NYTL_ISA.
+constexpr const char* name(Isa isa) {
+	constexpr const char* names[] = {"scalar", "sse2", "avx2", "avx512", "neon"};
+	return names[static_cast<unsigned>(isa)];
+}
+
+/// Returns whether kernels are compiled for the given level.
+constexpr bool compiled(Isa isa) {
+	if(isa == Isa::scalar || isa == nativeIsa) {
+		return true;
+	}
+
+#if NYTL_DISPATCH
+	return isa != Isa::neon;
+#else
+	// lower x86 levels of the compilation target
+	return isa != Isa::neon && nativeIsa != Isa::neon &&
+		isaBytes(isa) <= isaBytes(nativeIsa);
+#endif
+}
+
+/// Returns whether the running cpu supports the given level.
+inline bool supported(Isa isa) {
+#if NYTL_DISPATCH
+	__builtin_cpu_init();
+	switch(isa) {
+		case Isa::scalar: return true;
+		case Isa::sse2: return __builtin_cpu_supports("sse2");
+		case Isa::avx2: return __builtin_cpu_supports("avx2");
+		case Isa::avx512:
+			return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+				__builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+		default: return false;
+	}
+#else
+	return compiled(isa);
+#endif
+}
+
+namespace detail {
+
+inline Isa selectIsa() {
+	auto best = Isa::scalar;
+	for(auto i = 0u; i < isaCount; ++i) {
+		auto isa = static_cast<Isa>(i);
+		if(compiled(isa) && supported(isa) && isaBytes(isa) > isaBytes(best)) {
+			best = isa;
+		}
+	}
+
+	auto forced = std::getenv("NYTL_ISA");
+	for(auto i = 0u; forced && i < isaCount; ++i) {
+		auto isa = static_cast<Isa>(i);
+		if(!std::strcmp(forced, name(isa)) && compiled(isa) && supported(isa)) {
+			return isa;
+		}
+	}
+
+	return best;
+}
+
+} // namespace detail
+
+/// Returns the level used by the dispatched kernels: the best one that is
+/// compiled and supported by the running cpu, or the one set in NYTL_ISA.
+/// Determined on the first call.
+inline Isa isa() {
+	static const auto selected = detail::selectIsa();
+	return selected;
+}
+
+/// Table of the implementations of a kernel for all compiled levels.
+/// The Kernel must have a static function template
+/// `template<std::size_t Bytes> Ret run(Args...)` where Bytes is the width
+/// of the vector registers to use (0 for the scalar implementation).
+/// It must only use packs of that width through the simd functions taking
+/// references (see nytl/simd.hpp): its code is inlined into functions
+/// compiled for the respective instruction set.
+template<typename Kernel, typename Sig> class Dispatch;
+
+template<typename Kernel, typename Ret, typename... Args>
+class Dispatch<Kernel, Ret(Args...)> {
+public:
+	using Func = Ret(*)(Args...);
+
+	/// Returns the implementation for the given level or nullptr if it
+	/// is not compiled or not supported by the running cpu.
+	static Func get(Isa isa) {
+		if(!compiled(isa) || !supported(isa)) {
+			return nullptr;
+		}
+
+		switch(isa) {
+		#if NYTL_DISPATCH
+			case Isa::sse2: return &sse2;
+			case Isa::avx2: return &avx2;
+			case Isa::avx512: return &avx512;
+		#endif // NYTL_DISPATCH
+			case Isa::scalar: return &scalar;
+			default: return &native;
+		}
+	}
+
+	/// Returns the implementation for nytl::isa().
+	static Func get() {
+		static const auto func = get(nytl::isa());
+		return func;
+	}
+
+	/// Calls the implementation for nytl::isa().
+	static Ret call(Args... args) {
+		return get()(args...);
+	}
+
+protected:
+	NYTL_KERNEL static Ret scalar(Args... args) {
+		return Kernel::template run<0>(args...);
+	}
+
+	NYTL_KERNEL static Ret native(Args... args) {
+		return Kernel::template run<isaBytes(nativeIsa)>(args...);
+	}
+
+#if NYTL_DISPATCH
+	NYTL_TARGET_SSE2 static Ret sse2(Args... args) {
+		return Kernel::template run<16>(args...);
+	}
+
+	NYTL_TARGET_AVX2 static Ret avx2(Args... args) {
+		return Kernel::template run<32>(args...);
+	}
+
+	NYTL_TARGET_AVX512 static Ret avx512(Args... args) {
+		return Kernel::template run<64>(args...);
+	}
+#endif // NYTL_DISPATCH
+};
+
+} // namespace nytl
+
+#endif // header guard
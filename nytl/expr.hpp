@@ -0,0 +1,310 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Opt-in expression templates for fused element-wise Vec/Mat arithmetic.
+/// The default operators in vec.hpp and mat.hpp materialize a temporary
+/// for every operation, so `a + b * s - c` results in three loops and three
+/// temporaries. Marking one operand with nytl::expr::lazy builds an expression
+/// instead that is evaluated in a single loop once it is converted
+/// to a Vec/Mat or written into one with nytl::expr::assign.
+/// ```cpp
+/// using nytl::expr::lazy;
+/// nytl::Vec<64, float> r = lazy(a) + lazy(b) * s - c; // one loop
+/// nytl::expr::assign(r, lazy(r) * 0.5f + a); // one loop, in place
+/// ```
+/// Note that normal operator precedence applies: in `lazy(a) + b * s`, `b * s`
+/// is still evaluated eagerly since neither of its operands is lazy.
+/// Expressions store lazy operands that are lvalues by reference, so
+/// they should not outlive them. They are usually not stored at all but
+/// directly evaluated.
+/// Only element-wise operations are supported (+, -, unary -, multiplication
+/// and division by a scalar), matrix products are never lazy.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_EXPR
+#define NYTL_INCLUDE_EXPR
+
+#include <nytl/vec.hpp> // nytl::Vec
+#include <nytl/mat.hpp> // nytl::Mat
+
+#include <type_traits> // std::enable_if_t
+#include <functional> // std::plus, std::negate
+#include <utility> // std::forward
+
+namespace nytl::expr {
+
+/// The shape of a (lazy) Vec<D> value.
+/// All shapes provide the dimensions, access to an element of an
+/// object with that shape and the concrete result type for
+/// a given value type.
+template<size_t D>
+struct VecShape {
+	static constexpr size_t rows = 1;
+	static constexpr size_t cols = D;
+	template<typename T> using Result = Vec<D, T>;
+
+	template<typename V>
+	static constexpr decltype(auto) at(V& vec, size_t, size_t c) { return vec[c]; }
+};
+
+/// The shape of a (lazy) Mat<R, C> value.
+template<size_t R, size_t C>
+struct MatShape {
+	static constexpr size_t rows = R;
+	static constexpr size_t cols = C;
+	template<typename T> using Result = Mat<R, C, T>;
+
+	template<typename M>
+	static constexpr decltype(auto) at(M& mat, size_t r, size_t c) { return mat[r][c]; }
+};
+
+/// Used as shape by scalar operands, they can be combined with every shape.
+struct ScalarShape {};
+
+namespace detail {
+template<typename T> struct ShapeOf { using type = void; };
+template<size_t D, typename T> struct ShapeOf<Vec<D, T>> { using type = VecShape<D>; };
+template<size_t R, size_t C, typename T> struct ShapeOf<Mat<R, C, T>> {
+	using type = MatShape<R, C>;
+};
+
+template<typename T> struct IsNode { static constexpr auto value = false; };
+
+template<typename A, typename B> struct CommonShape { using type = void; };
+template<typename A> struct CommonShape<A, A> { using type = A; };
+template<typename A> struct CommonShape<A, ScalarShape> { using type = A; };
+template<typename B> struct CommonShape<ScalarShape, B> { using type = B; };
+} // namespace detail
+
+/// Whether the given type is an expression node.
+template<typename T>
+constexpr auto isNode = detail::IsNode<std::decay_t<T>>::value;
+
+/// Whether the given type is a Vec or Mat, i.e. can be used
+/// as non-scalar operand in an expression.
+template<typename T>
+constexpr auto isShaped = !std::is_void_v<typename detail::ShapeOf<std::decay_t<T>>::type>;
+
+template<typename E> constexpr auto eval(const E& expr);
+
+/// The concrete Vec/Mat type an expression evaluates to.
+template<typename E> using Result = typename E::Shape::template Result<
+	std::decay_t<decltype(std::declval<const E&>()(0, 0))>>;
+
+/// CRTP base of all expression nodes.
+/// Allows to implicitly convert an expression to the Vec/Mat an eager
+/// evaluation would have returned.
+template<typename E>
+struct Expression {
+	template<typename R, typename D = E,
+		typename = std::enable_if_t<std::is_same_v<R, Result<D>>>>
+	constexpr operator R() const { return eval(static_cast<const D&>(*this)); }
+};
+
+/// Leaf expression node, wraps a Vec or Mat.
+/// If T is a reference, only stores a reference to the wrapped value.
+template<typename T>
+class Term : public Expression<Term<T>> {
+public:
+	using Shape = typename detail::ShapeOf<std::decay_t<T>>::type;
+
+public:
+	template<typename V>
+	constexpr explicit Term(V&& value) : value_(std::forward<V>(value)) {}
+	constexpr decltype(auto) operator()(size_t r, size_t c) const {
+		return Shape::at(value_, r, c);
+	}
+
+protected:
+	T value_;
+};
+
+/// Scalar operand of an expression.
+template<typename T>
+class Scalar {
+public:
+	using Shape = ScalarShape;
+
+public:
+	constexpr explicit Scalar(const T& value) : value_(value) {}
+	constexpr const T& operator()(size_t, size_t) const { return value_; }
+
+protected:
+	T value_;
+};
+
+/// Applies an element-wise operation to a single expression.
+template<typename Op, typename A>
+class Unary : public Expression<Unary<Op, A>> {
+public:
+	using Shape = typename A::Shape;
+
+public:
+	constexpr Unary(Op op, const A& a) : op_(op), a_(a) {}
+	constexpr auto operator()(size_t r, size_t c) const { return op_(a_(r, c)); }
+
+protected:
+	Op op_;
+	A a_;
+};
+
+/// Applies an element-wise operation to two expressions.
+/// They must have the same shape or one of them must be scalar.
+template<typename Op, typename A, typename B>
+class Binary : public Expression<Binary<Op, A, B>> {
+public:
+	using Shape = typename detail::CommonShape<typename A::Shape, typename B::Shape>::type;
+	static_assert(!std::is_void_v<Shape>, "nytl::expr: operands have different shapes");
+
+public:
+	constexpr Binary(Op op, const A& a, const B& b) : op_(op), a_(a), b_(b) {}
+	constexpr auto operator()(size_t r, size_t c) const {
+		return op_(a_(r, c), b_(r, c));
+	}
+
+protected:
+	Op op_;
+	A a_;
+	B b_;
+};
+
+namespace detail {
+template<typename T> struct IsNode<Term<T>> { static constexpr auto value = true; };
+template<typename Op, typename A> struct IsNode<Unary<Op, A>> {
+	static constexpr auto value = true;
+};
+template<typename Op, typename A, typename B> struct IsNode<Binary<Op, A, B>> {
+	static constexpr auto value = true;
+};
+
+// Returns the given operand as expression node
+template<typename T>
+constexpr auto node(T&& value) {
+	if constexpr(isNode<T>) {
+		return std::decay_t<T>(std::forward<T>(value));
+	} else if constexpr(isShaped<T>) {
+		// store lvalues by reference, temporaries by value
+		using Stored = std::conditional_t<std::is_lvalue_reference_v<T>,
+			const std::decay_t<T>&, std::decay_t<T>>;
+		return Term<Stored>(std::forward<T>(value));
+	} else {
+		return Scalar<std::decay_t<T>>(value);
+	}
+}
+
+template<typename T> using NodeShape = typename decltype(node(std::declval<T>()))::Shape;
+
+template<typename A, typename B> constexpr bool compatibleShapes() {
+	if constexpr((isNode<A> || isShaped<A>) && (isNode<B> || isShaped<B>)) {
+		return !std::is_void_v<typename CommonShape<NodeShape<A>, NodeShape<B>>::type>;
+	} else {
+		return false;
+	}
+}
+
+template<typename A, typename B> using EnableShaped = std::enable_if_t<
+	(isNode<A> || isNode<B>) && compatibleShapes<A, B>()>;
+
+template<typename A, typename B> using EnableScalar = std::enable_if_t<
+	isNode<A> && !isNode<B> && !isShaped<B>>;
+} // namespace detail
+
+/// Marks the given Vec or Mat as lazy operand.
+/// All operations on it will build an expression instead of
+/// evaluating them directly.
+/// If the given value is an lvalue, only a reference to it is stored.
+template<typename T, typename = std::enable_if_t<isShaped<T>>>
+constexpr auto lazy(T&& value) {
+	return detail::node(std::forward<T>(value));
+}
+
+namespace detail {
+// Writes the expression into dst in a single loop.
+// Only valid (or at least only vectorized) if dst does not alias any operand.
+template<typename Dst, typename E>
+constexpr void write(Dst& dst, const E& expr) {
+	using Shape = typename E::Shape;
+	for(auto r = 0u; r < Shape::rows; ++r)
+		for(auto c = 0u; c < Shape::cols; ++c)
+			Shape::at(dst, r, c) = expr(r, c);
+}
+} // namespace detail
+
+/// Evaluates the given expression and writes the result into the
+/// given Vec or Mat. Since all operations are element-wise, dst itself
+/// may be an operand of the expression.
+/// Every row is evaluated into a local Vec before it is stored since
+/// the compiler otherwise has to assume that writing to dst may alias
+/// the operands, which prevents vectorization.
+template<typename Dst, typename E, typename = std::enable_if_t<isNode<E>>>
+constexpr Dst& assign(Dst& dst, const E& expr) {
+	using Shape = typename E::Shape;
+	using Value = std::decay_t<decltype(expr(0, 0))>;
+	static_assert(std::is_same_v<typename detail::ShapeOf<Dst>::type, Shape>,
+		"nytl::expr::assign: destination has a different shape");
+
+	for(auto r = 0u; r < Shape::rows; ++r) {
+		Vec<Shape::cols, Value> row {};
+		for(auto c = 0u; c < Shape::cols; ++c)
+			row[c] = expr(r, c);
+		for(auto c = 0u; c < Shape::cols; ++c)
+			Shape::at(dst, r, c) = row[c];
+	}
+
+	return dst;
+}
+
+/// Evaluates the given expression and returns the resulting Vec or Mat.
+/// Returns the same type the eager operators would.
+template<typename E>
+constexpr auto eval(const E& expr) {
+	static_assert(isNode<E>, "nytl::expr::eval: no expression given");
+	Result<E> ret {};
+	detail::write(ret, expr);
+	return ret;
+}
+
+// - operators -
+template<typename A, typename B, typename = detail::EnableShaped<A, B>>
+constexpr auto operator+(A&& a, B&& b) {
+	auto na = detail::node(std::forward<A>(a));
+	auto nb = detail::node(std::forward<B>(b));
+	return Binary<std::plus<>, decltype(na), decltype(nb)>({}, na, nb);
+}
+
+template<typename A, typename B, typename = detail::EnableShaped<A, B>>
+constexpr auto operator-(A&& a, B&& b) {
+	auto na = detail::node(std::forward<A>(a));
+	auto nb = detail::node(std::forward<B>(b));
+	return Binary<std::minus<>, decltype(na), decltype(nb)>({}, na, nb);
+}
+
+template<typename A, typename = std::enable_if_t<isNode<A>>>
+constexpr auto operator-(A&& a) {
+	auto na = detail::node(std::forward<A>(a));
+	return Unary<std::negate<>, decltype(na)>({}, na);
+}
+
+template<typename A, typename F, typename = detail::EnableScalar<A, F>>
+constexpr auto operator*(A&& a, const F& f) {
+	auto na = detail::node(std::forward<A>(a));
+	return Binary<std::multiplies<>, decltype(na), Scalar<F>>({}, na, Scalar<F>(f));
+}
+
+template<typename F, typename A, typename = detail::EnableScalar<A, F>>
+constexpr auto operator*(const F& f, A&& a) {
+	auto na = detail::node(std::forward<A>(a));
+	return Binary<std::multiplies<>, Scalar<F>, decltype(na)>({}, Scalar<F>(f), na);
+}
+
+template<typename A, typename F, typename = detail::EnableScalar<A, F>>
+constexpr auto operator/(A&& a, const F& f) {
+	auto na = detail::node(std::forward<A>(a));
+	return Binary<std::divides<>, decltype(na), Scalar<F>>({}, na, Scalar<F>(f));
+}
+
+} // namespace nytl::expr
+
+#endif // header guard
@@ -0,0 +1,732 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Fast approximations of common math functions for float values,
+/// Vecs and arrays in the nytl::fast namespace.
+/// The functions are polynomial approximations (mostly the ones used by the
+/// cephes library) that only use basic arithmetic, selects and bit operations
+/// and can therefore be evaluated for multiple values at once with simd
+/// instructions (see nytl/simd.hpp). The array versions are compiled for
+/// multiple instruction sets (see nytl/dispatch.hpp).
+/// The array versions give bitwise equal results on all instruction sets
+/// (see nytl/dispatch.hpp). Single values and Vecs are compiled with the flags
+/// of the including code and give the same results unless g++ contracts
+/// multiplications and additions into fma instructions (e.g. with
+/// -march=native, disabled by -ffp-contract=off). This changes the last bits
+/// of the results but stays within the documented errors.
+/// The maximum errors given for each function were measured against the
+/// standard library functions (in double precision) over the given ranges.
+/// Use them where full precision isn't needed, e.g. for lighting or animations.
+/// Denormal results are flushed to zero.
+/// The gains come mainly from evaluating many values at once, i.e. from the
+/// array versions. For single values, the (table based) exp, log and pow and
+/// the hardware square root of the standard library may be just as fast,
+/// see docs/benchmarks/fastMath.cpp.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_FAST_MATH
+#define NYTL_INCLUDE_FAST_MATH
+
+#include <nytl/vec.hpp> // nytl::Vec
+#include <nytl/vecOps.hpp> // nytl::dot
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/simd.hpp> // nytl::simd::Pack
+#include <nytl/dispatch.hpp> // nytl::Dispatch
+
+#include <algorithm> // std::min
+#include <cstdint> // std::int32_t
+#include <cstring> // std::memcpy
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_same_v
+
+namespace nytl::fast {
+namespace detail {
+
+// All approximations are implemented once for single floats and packs of
+// floats (the type P). Results are returned through references since packs
+// may be wider than the registers of the target (see nytl/simd.hpp).
+
+// int32 type with the layout of P
+template<typename P> struct IntT { using type = decltype(P {} < P {}); };
+template<> struct IntT<float> { using type = std::int32_t; };
+template<typename P> using Int = typename IntT<P>::type;
+
+constexpr auto pi = 3.14159265358979f;
+constexpr auto halfPi = 1.57079632679490f;
+constexpr auto quarterPi = 0.785398163397448f;
+constexpr auto inf = std::numeric_limits<float>::infinity();
+constexpr auto nan = std::numeric_limits<float>::quiet_NaN();
+
+template<typename P>
+inline void splat(P& out, float value) {
+	out = P {} + value;
+}
+
+template<typename P>
+inline void toBits(const P& x, Int<P>& out) {
+	std::memcpy(&out, &x, sizeof(P));
+}
+
+template<typename P>
+inline void fromBits(const Int<P>& x, P& out) {
+	std::memcpy(&out, &x, sizeof(P));
+}
+
+// out = cond ? a : b. For single floats, gcc emits a branch for the
+// ternary operator, which is mispredicted for random input.
+template<typename P, typename C>
+inline void select(const C& cond, const P& a, const P& b, P& out) {
+	if constexpr(std::is_same_v<P, float>) {
+		std::int32_t ai, bi, mask = -std::int32_t(cond);
+		toBits(a, ai);
+		toBits(b, bi);
+		fromBits((ai & mask) | (bi & ~mask), out);
+	} else {
+		out = cond ? a : b;
+	}
+}
+
+// rounds to the nearest integer (halfway cases away from zero).
+// x must be finite and (after rounding) fit into an int32.
+template<typename P>
+inline void roundToInt(const P& x, Int<P>& out) {
+	constexpr auto signBit = std::numeric_limits<std::int32_t>::min();
+	Int<P> xb;
+	P half;
+	toBits(x, xb);
+	fromBits((xb & signBit) | 0x3f000000, half); // copysign(0.5, x)
+	P r = x + half;
+	if constexpr(std::is_same_v<P, float>) {
+		out = std::int32_t(r);
+	} else {
+		out = __builtin_convertvector(r, Int<P>);
+	}
+}
+
+template<typename P>
+inline void toFloat(const Int<P>& x, P& out) {
+	if constexpr(std::is_same_v<P, float>) {
+		out = float(x);
+	} else {
+		out = __builtin_convertvector(x, P);
+	}
+}
+
+// Magic constant estimate and two newton iterations.
+// Hardware estimates (like rsqrtps) are not used since their results
+// differ between instruction sets and vendors.
+template<typename P>
+inline void rsqrt(const P& x, P& out) {
+	Int<P> i;
+	toBits(x, i);
+	i = 0x5f375a86 - (i >> 1);
+	fromBits(i, out);
+
+	P h = 0.5f * x;
+	out = out * (1.5f - h * out * out);
+	out = out * (1.5f - h * out * out);
+}
+
+template<typename P>
+inline void sinCos(const P& x, P& s, P& c) {
+	// reduce to r in [-pi/4, pi/4], x = r + q * pi/2.
+	// pi/2 is split up into three parts, the first two have only few
+	// mantissa bits so their products with q are exact for |q| < 2^12.
+	constexpr auto maxQuadrant = 1.0e9f;
+	P t = x * 0.636619772367581f;
+	t = (t < maxQuadrant) ? t : t - t + maxQuadrant; // also for nan
+	t = (t > -maxQuadrant) ? t : t - t - maxQuadrant;
+
+	Int<P> q;
+	P k;
+	roundToInt(t, q);
+	toFloat(q, k);
+	P r = ((x - k * 1.5703125f) - k * 4.837512969970703125e-4f) -
+		k * 7.54978995489188216e-8f;
+
+	P z = r * r;
+	P sr = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z -
+		1.6666654611e-1f) * z * r + r;
+	P cr = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z +
+		4.166664568298827e-2f) * z * z - 0.5f * z + 1.f;
+
+	// swap for odd quadrants and flip the signs (via the sign bits)
+	Int<P> sb, cb, odd = -(q & 1);
+	toBits(sr, sb);
+	toBits(cr, cb);
+	fromBits(((sb & ~odd) | (cb & odd)) ^ ((q & 2) << 30), s);
+	fromBits(((cb & ~odd) | (sb & odd)) ^ (((q + 1) & 2) << 30), c);
+
+	// inf and nan
+	auto finite = (x - x) == 0.f;
+	s = finite ? s : x - x;
+	c = finite ? c : x - x;
+}
+
+template<typename P>
+inline void exp(const P& x, P& out) {
+	// ln of the largest and smallest normal float
+	constexpr auto maxArg = 88.7228391116729f;
+	constexpr auto minArg = -87.3365447505531f;
+	P lo, hi;
+	splat(lo, minArg);
+	splat(hi, maxArg);
+	P cx = (x < maxArg) ? x : hi; // also for nan
+	cx = (cx > minArg) ? cx : lo;
+
+	// x = r + q * ln(2) with r in [-ln(2)/2, ln(2)/2]
+	Int<P> q;
+	P k;
+	roundToInt(cx * 1.44269504088896f, q);
+	toFloat(q, k);
+	P r = (cx - k * 0.693359375f) + k * 2.12194440e-4f;
+
+	P z = r * r;
+	P y = (((((1.9875691500e-4f * r + 1.3981999507e-3f) * r +
+		8.3334519073e-3f) * r + 4.1665795894e-2f) * r +
+		1.6666665459e-1f) * r + 5.0000001201e-1f) * z + r + 1.f;
+
+	// scale by 2^q in two steps, 2^q itself might not be a normal float
+	Int<P> q1 = q >> 1;
+	Int<P> q2 = q - q1;
+	P s1, s2;
+	fromBits((q1 + 127) << 23, s1);
+	fromBits((q2 + 127) << 23, s2);
+	out = (y * s1) * s2;
+
+	splat(hi, inf);
+	splat(lo, 0.f);
+	out = (x > maxArg) ? hi : out;
+	out = (x < minArg) ? lo : out;
+	out = (x == x) ? out : x;
+}
+
+template<typename P>
+inline void log(const P& x, P& out) {
+	// scale denormals up into the normal range
+	constexpr auto minNormal = std::numeric_limits<float>::min();
+	auto denormal = x < minNormal;
+	P sx = denormal ? x * 8388608.f : x;
+
+	// x = m * 2^e with m in [sqrt(0.5), sqrt(2))
+	Int<P> i;
+	P m, e;
+	toBits(sx, i);
+	fromBits((i & 0x007fffff) | 0x3f000000, m);
+	toFloat((i >> 23) - 126, e);
+	e = denormal ? e - 23.f : e;
+
+	auto low = m < 0.707106781186547f;
+	select(low, e - 1.f, e, e);
+	select(low, m + m, m, m);
+	m = m - 1.f;
+
+	P z = m * m;
+	P y = ((((((((7.0376836292e-2f * m - 1.1514610310e-1f) * m +
+		1.1676998740e-1f) * m - 1.2420140846e-1f) * m +
+		1.4249322787e-1f) * m - 1.6668057665e-1f) * m +
+		2.0000714765e-1f) * m - 2.4999993993e-1f) * m +
+		3.3333331174e-1f) * m * z;
+	y = y - 2.12194440e-4f * e - 0.5f * z;
+	out = (m + y) + 0.693359375f * e;
+
+	out = (x < inf) ? out : x; // inf and nan
+	out = (x > 0.f) ? out : x - x + nan;
+	out = (x == 0.f) ? x - x - inf : out;
+}
+
+template<typename P>
+inline void atan2(const P& y, const P& x, P& out) {
+	constexpr auto signBit = std::numeric_limits<std::int32_t>::min();
+	Int<P> xb, yb;
+	toBits(x, xb);
+	toBits(y, yb);
+
+	P ax, ay, mx, mn;
+	fromBits(xb & ~signBit, ax);
+	fromBits(yb & ~signBit, ay);
+	auto swap = ay > ax;
+	select(swap, ay, ax, mx);
+	select(swap, ax, ay, mn);
+
+	// reduce to t in [-tan(pi/8), tan(pi/8)], atan(mn / mx) = atan(t) + pi/4
+	// for the upper range
+	auto upper = mn > 0.414213562373095f * mx;
+	P num, den;
+	select(upper, mn - mx, mn, num);
+	select(upper, mn + mx, mx, den);
+	den = (den == 0.f) ? den + 1.f : den;
+	P t = num / den;
+
+	P z = t * t;
+	P a = (((8.05374449538e-2f * z - 1.38776856032e-1f) * z +
+		1.99777106478e-1f) * z - 3.33329491539e-1f) * z * t + t;
+	select(upper, a + quarterPi, a, a);
+	select(swap, halfPi - a, a, a);
+
+	// quadrants, like std::atan2 for signed zeros
+	select(xb < 0, pi - a, a, a);
+	Int<P> ab;
+	toBits(a, ab);
+	fromBits(ab ^ (yb & signBit), out);
+}
+
+template<typename P>
+inline void acos(const P& x, P& out) {
+	// acos(x) = 2 * asin(sqrt((1 - |x|) / 2)) for |x| > 0.5
+	constexpr auto signBit = std::numeric_limits<std::int32_t>::min();
+	Int<P> xb;
+	P ax, z, s, rs;
+	toBits(x, xb);
+	fromBits(xb & ~signBit, ax);
+	auto upper = ax > 0.5f;
+	select(upper, 0.5f * (1.f - ax), ax * ax, z);
+	rsqrt(z, rs);
+	rs = rs * (1.5f - 0.5f * z * rs * rs); // the error of s is doubled below
+	select(upper, z * rs, ax, s);
+
+	// asin(s)
+	P p = ((((4.2163199048e-2f * z + 2.4181311049e-2f) * z +
+		4.5470025998e-2f) * z + 7.4953002686e-2f) * z +
+		1.6666752422e-1f) * z * s + s;
+
+	auto neg = x < 0.f;
+	P pu = p + p;
+	select(neg, pi - pu, pu, pu);
+	P pl;
+	select(neg, halfPi + p, halfPi - p, pl);
+	select(upper, pu, pl, out);
+	out = (ax <= 1.f) ? out : x - x + nan;
+}
+
+// The operations evaluated by the kernels below.
+// Every operation has up to 2 inputs and outputs.
+struct SinOp {
+	static constexpr auto inputs = 1u, outputs = 1u;
+	template<typename P> static void apply(const P& a, const P&, P& r, P&) {
+		P c;
+		sinCos(a, r, c);
+	}
+};
+
+struct CosOp {
+	static constexpr auto inputs = 1u, outputs = 1u;
+	template<typename P> static void apply(const P& a, const P&, P& r, P&) {
+		P s;
+		sinCos(a, s, r);
+	}
+};
+
+struct SinCosOp {
+	static constexpr auto inputs = 1u, outputs = 2u;
+	template<typename P> static void apply(const P& a, const P&, P& s, P& c) {
+		sinCos(a, s, c);
+	}
+};
+
+struct ExpOp {
+	static constexpr auto inputs = 1u, outputs = 1u;
+	template<typename P> static void apply(const P& a, const P&, P& r, P&) {
+		exp(a, r);
+	}
+};
+
+struct LogOp {
+	static constexpr auto inputs = 1u, outputs = 1u;
+	template<typename P> static void apply(const P& a, const P&, P& r, P&) {
+		log(a, r);
+	}
+};
+
+struct AcosOp {
+	static constexpr auto inputs = 1u, outputs = 1u;
+	template<typename P> static void apply(const P& a, const P&, P& r, P&) {
+		acos(a, r);
+	}
+};
+
+// a^b. With a single input, b is the same for all values
+template<unsigned Inputs>
+struct PowOp {
+	static constexpr auto inputs = Inputs, outputs = 1u;
+	template<typename P> static void apply(const P& a, const P& b, P& r, P&) {
+		P l;
+		log(a, l);
+		exp(b * l, r);
+	}
+};
+
+// atan2(a, b)
+struct Atan2Op {
+	static constexpr auto inputs = 2u, outputs = 1u;
+	template<typename P> static void apply(const P& a, const P& b, P& r, P&) {
+		atan2(a, b, r);
+	}
+};
+
+// Applies the operation to the components of the given vecs.
+// Evaluates up to 4 components at once with simd.
+template<typename Op, std::size_t D>
+void mapVec(const Vec<D, float>& a, const Vec<D, float>& b,
+		Vec<D, float>& r0, Vec<D, float>& r1) {
+#if NYTL_SIMD
+	using P = simd::Pack<float, 4>;
+	for(auto i = std::size_t(0); i < D; i += 4) {
+		// the padding is in the domain of all operations.
+		// Set component-wise, copying the partial vec into the pack
+		// would stall on the store forwarding.
+		auto n = std::min<std::size_t>(4u, D - i);
+		P pa, pb, p0, p1;
+		simd::broadcast(pa, 0.5f);
+		simd::broadcast(pb, (Op::inputs == 2) ? 0.5f : b[0]);
+		for(auto j = std::size_t(0); j < n; ++j) {
+			pa[j] = a[i + j];
+			if constexpr(Op::inputs == 2) {
+				pb[j] = b[i + j];
+			}
+		}
+
+		Op::apply(pa, pb, p0, p1);
+		for(auto j = std::size_t(0); j < n; ++j) {
+			r0[i + j] = p0[j];
+			if constexpr(Op::outputs == 2) {
+				r1[i + j] = p1[j];
+			}
+		}
+	}
+#else
+	for(auto i = std::size_t(0); i < D; ++i) {
+		Op::apply(a[i], (Op::inputs == 2) ? b[i] : b[0], r0[i], r1[i]);
+	}
+#endif // NYTL_SIMD
+}
+
+// compiled for multiple instruction sets, see nytl/dispatch.hpp.
+// If the operation has only one input, param is used as second argument.
+template<typename Op>
+struct MapKernel {
+	template<std::size_t Bytes>
+	static void run(const float* a, const float* b, float param,
+			float* r0, float* r1, std::size_t count) {
+		auto i = std::size_t(0);
+
+	#if NYTL_SIMD
+		// wider packs get split up since gcc does not use the avx512
+		// mask registers for the selects
+		constexpr auto n = std::min<std::size_t>(Bytes, 32) / sizeof(float);
+		if constexpr(n > 1) {
+			using P = simd::Pack<float, n>;
+			P pb, p0, p1;
+			simd::broadcast(pb, param);
+			for(; i + n <= count; i += n) {
+				P pa;
+				simd::load(pa, a + i);
+				if constexpr(Op::inputs == 2) {
+					simd::load(pb, b + i);
+				}
+
+				Op::apply(pa, pb, p0, p1);
+				simd::store(r0 + i, p0);
+				if constexpr(Op::outputs == 2) {
+					simd::store(r1 + i, p1);
+				}
+			}
+		}
+	#endif // NYTL_SIMD
+
+		// copy the inputs, the outputs may alias them
+		for(; i < count; ++i) {
+			float va = a[i], vb = (Op::inputs == 2) ? b[i] : param, s0, s1;
+			Op::apply(va, vb, s0, s1);
+			r0[i] = s0;
+			if constexpr(Op::outputs == 2) {
+				r1[i] = s1;
+			}
+		}
+	}
+};
+
+template<typename Op>
+void map(const float* a, const float* b, float param, float* r0, float* r1,
+		std::size_t count) {
+	using Sig = void(const float*, const float*, float, float*, float*, std::size_t);
+	Dispatch<MapKernel<Op>, Sig>::call(a, b, param, r0, r1, count);
+}
+
+struct NormalizeKernel {
+	template<std::size_t Bytes>
+	static void run(const Vec3f* in, Vec3f* out, std::size_t count) {
+		static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3 must be tightly packed");
+		auto i = std::size_t(0);
+
+	#if NYTL_SIMD
+		constexpr auto n = std::min<std::size_t>(Bytes, 32) / sizeof(float);
+		if constexpr(n > 1) {
+			using P = simd::Pack<float, n>;
+			for(; i + n <= count; i += n) {
+				P x, y, z, r;
+				simd::deinterleave3<n>(&in[i].x, x, y, z);
+				rsqrt(x * x + y * y + z * z, r);
+				simd::interleave3<n>(&out[i].x, x * r, y * r, z * r);
+			}
+		}
+	#endif // NYTL_SIMD
+
+		for(; i < count; ++i) {
+			auto v = in[i];
+			float r;
+			rsqrt(v.x * v.x + v.y * v.y + v.z * v.z, r);
+			out[i] = {v.x * r, v.y * r, v.z * r};
+		}
+	}
+};
+
+} // namespace detail
+
+// - single values -
+/// \brief Approximates 1 / sqrt(x) for positive, finite x.
+/// Maximum relative error: 5e-6.
+inline float rsqrt(float x) {
+	float ret;
+	detail::rsqrt(x, ret);
+	return ret;
+}
+
+/// \brief Approximates sin(x). Maximum absolute error: 2e-7 for |x| <= 4096,
+/// 2e-6 for |x| <= 1e5. Returns nan for infinite or nan x.
+inline float sin(float x) {
+	float s, c;
+	detail::sinCos(x, s, c);
+	return s;
+}
+
+/// \brief Approximates cos(x). Same error as nytl::fast::sin.
+inline float cos(float x) {
+	float s, c;
+	detail::sinCos(x, s, c);
+	return c;
+}
+
+/// \brief Approximates sin(x) and cos(x) together, at the cost of one of them.
+/// Same error as nytl::fast::sin.
+inline void sincos(float x, float& s, float& c) {
+	detail::sinCos(x, s, c);
+}
+
+/// \brief Approximates e^x. Maximum relative error: 2e-7.
+/// Returns infinity for x > ln(FLT_MAX) and 0 for x < ln(FLT_MIN).
+inline float exp(float x) {
+	float ret;
+	detail::exp(x, ret);
+	return ret;
+}
+
+/// \brief Approximates the natural logarithm of x.
+/// Maximum absolute error: 1e-7 for x in [0.5, 2], otherwise maximum relative
+/// error: 1e-7. Returns -infinity for 0, nan for negative x.
+inline float log(float x) {
+	float ret;
+	detail::log(x, ret);
+	return ret;
+}
+
+/// \brief Approximates x^y as e^(y * ln(x)) for positive x.
+/// The error of the logarithm is scaled by y, the maximum relative
+/// error is 2e-7 + 2e-7 * |y * ln(x)|.
+inline float pow(float x, float y) {
+	float ret, l;
+	detail::log(x, l);
+	detail::exp(y * l, ret);
+	return ret;
+}
+
+/// \brief Approximates atan2(y, x), i.e. the angle of the point (x, y) in
+/// radians in range [-pi, pi]. Maximum absolute error: 3e-7.
+/// Returns 0 for (0, 0), nan if both are infinite.
+inline float atan2(float y, float x) {
+	float ret;
+	detail::atan2(y, x, ret);
+	return ret;
+}
+
+/// \brief Approximates acos(x) for x in [-1, 1], returns nan otherwise.
+/// Maximum absolute error: 5e-7.
+inline float acos(float x) {
+	float ret;
+	detail::acos(x, ret);
+	return ret;
+}
+
+// - vecs -
+/// \brief Approximates the length of the given vector using nytl::fast::rsqrt.
+template<std::size_t D>
+float length(const Vec<D, float>& a) {
+	auto d = dot(a, a);
+	return d * rsqrt(d);
+}
+
+/// \brief Approximates the normalization of the given vector using
+/// nytl::fast::rsqrt, i.e. the length of the result differs from
+/// 1 by at most 5e-6. Unlike nytl::normalized does not throw for
+/// the null vector but returns it.
+template<std::size_t D>
+Vec<D, float> normalized(const Vec<D, float>& a) {
+	return rsqrt(dot(a, a)) * a;
+}
+
+/// \brief Normalizes the given vector in place, see nytl::fast::normalized.
+template<std::size_t D>
+void normalize(Vec<D, float>& a) {
+	a = normalized(a);
+}
+
+/// \brief Component-wise nytl::fast::sin.
+template<std::size_t D>
+Vec<D, float> sin(const Vec<D, float>& a) {
+	Vec<D, float> ret;
+	detail::mapVec<detail::SinOp>(a, a, ret, ret);
+	return ret;
+}
+
+/// \brief Component-wise nytl::fast::cos.
+template<std::size_t D>
+Vec<D, float> cos(const Vec<D, float>& a) {
+	Vec<D, float> ret;
+	detail::mapVec<detail::CosOp>(a, a, ret, ret);
+	return ret;
+}
+
+/// \brief Component-wise nytl::fast::sincos.
+template<std::size_t D>
+void sincos(const Vec<D, float>& a, Vec<D, float>& s, Vec<D, float>& c) {
+	detail::mapVec<detail::SinCosOp>(a, a, s, c);
+}
+
+/// \brief Component-wise nytl::fast::exp.
+template<std::size_t D>
+Vec<D, float> exp(const Vec<D, float>& a) {
+	Vec<D, float> ret;
+	detail::mapVec<detail::ExpOp>(a, a, ret, ret);
+	return ret;
+}
+
+/// \brief Component-wise nytl::fast::log.
+template<std::size_t D>
+Vec<D, float> log(const Vec<D, float>& a) {
+	Vec<D, float> ret;
+	detail::mapVec<detail::LogOp>(a, a, ret, ret);
+	return ret;
+}
+
+/// \brief Component-wise nytl::fast::pow with the same exponent.
+template<std::size_t D>
+Vec<D, float> pow(const Vec<D, float>& a, float exp) {
+	Vec<D, float> ret;
+	Vec<D, float> b {};
+	b[0] = exp;
+	detail::mapVec<detail::PowOp<1>>(a, b, ret, ret);
+	return ret;
+}
+
+/// \brief Component-wise nytl::fast::pow.
+template<std::size_t D>
+Vec<D, float> pow(const Vec<D, float>& a, const Vec<D, float>& exp) {
+	Vec<D, float> ret;
+	detail::mapVec<detail::PowOp<2>>(a, exp, ret, ret);
+	return ret;
+}
+
+/// \brief Component-wise nytl::fast::atan2.
+template<std::size_t D>
+Vec<D, float> atan2(const Vec<D, float>& y, const Vec<D, float>& x) {
+	Vec<D, float> ret;
+	detail::mapVec<detail::Atan2Op>(y, x, ret, ret);
+	return ret;
+}
+
+/// \brief Component-wise nytl::fast::acos.
+template<std::size_t D>
+Vec<D, float> acos(const Vec<D, float>& a) {
+	Vec<D, float> ret;
+	detail::mapVec<detail::AcosOp>(a, a, ret, ret);
+	return ret;
+}
+
+// - arrays -
+// All functions take the input and output spans, the outputs must have
+// at least the size of the input. Inputs and outputs may refer to the same
+// values (in-place evaluation), but must not otherwise overlap.
+
+/// \brief Normalizes all given vectors, see nytl::fast::normalized.
+inline void normalized(Span<const Vec3f> in, Span<Vec3f> out) {
+	NYTL_EXPECTS(out.size() >= in.size());
+	using Sig = void(const Vec3f*, Vec3f*, std::size_t);
+	Dispatch<detail::NormalizeKernel, Sig>::call(in.data(), out.data(), in.size());
+}
+
+/// \brief Normalizes all given vectors in place, see nytl::fast::normalized.
+inline void normalize(Span<Vec3f> vecs) {
+	normalized(vecs, vecs);
+}
+
+/// \brief Evaluates nytl::fast::sin for all given values.
+inline void sin(Span<const float> in, Span<float> out) {
+	NYTL_EXPECTS(out.size() >= in.size());
+	detail::map<detail::SinOp>(in.data(), nullptr, 0.f, out.data(), nullptr, in.size());
+}
+
+/// \brief Evaluates nytl::fast::cos for all given values.
+inline void cos(Span<const float> in, Span<float> out) {
+	NYTL_EXPECTS(out.size() >= in.size());
+	detail::map<detail::CosOp>(in.data(), nullptr, 0.f, out.data(), nullptr, in.size());
+}
+
+/// \brief Evaluates nytl::fast::sincos for all given values.
+inline void sincos(Span<const float> in, Span<float> s, Span<float> c) {
+	NYTL_EXPECTS(s.size() >= in.size() && c.size() >= in.size());
+	detail::map<detail::SinCosOp>(in.data(), nullptr, 0.f, s.data(), c.data(), in.size());
+}
+
+/// \brief Evaluates nytl::fast::exp for all given values.
+inline void exp(Span<const float> in, Span<float> out) {
+	NYTL_EXPECTS(out.size() >= in.size());
+	detail::map<detail::ExpOp>(in.data(), nullptr, 0.f, out.data(), nullptr, in.size());
+}
+
+/// \brief Evaluates nytl::fast::log for all given values.
+inline void log(Span<const float> in, Span<float> out) {
+	NYTL_EXPECTS(out.size() >= in.size());
+	detail::map<detail::LogOp>(in.data(), nullptr, 0.f, out.data(), nullptr, in.size());
+}
+
+/// \brief Evaluates nytl::fast::pow for all given values with the same exponent.
+inline void pow(Span<const float> in, float exp, Span<float> out) {
+	NYTL_EXPECTS(out.size() >= in.size());
+	detail::map<detail::PowOp<1>>(in.data(), nullptr, exp, out.data(), nullptr, in.size());
+}
+
+/// \brief Evaluates nytl::fast::pow for all given values and exponents.
+inline void pow(Span<const float> in, Span<const float> exp, Span<float> out) {
+	NYTL_EXPECTS(exp.size() >= in.size() && out.size() >= in.size());
+	detail::map<detail::PowOp<2>>(in.data(), exp.data(), 0.f, out.data(), nullptr,
+		in.size());
+}
+
+/// \brief Evaluates nytl::fast::atan2 for all given values.
+inline void atan2(Span<const float> y, Span<const float> x, Span<float> out) {
+	NYTL_EXPECTS(x.size() >= y.size() && out.size() >= y.size());
+	detail::map<detail::Atan2Op>(y.data(), x.data(), 0.f, out.data(), nullptr, y.size());
+}
+
+/// \brief Evaluates nytl::fast::acos for all given values.
+inline void acos(Span<const float> in, Span<float> out) {
+	NYTL_EXPECTS(out.size() >= in.size());
+	detail::map<detail::AcosOp>(in.data(), nullptr, 0.f, out.data(), nullptr, in.size());
+}
+
+} // namespace nytl::fast
+
+#endif // header guard
@@ -0,0 +1,574 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Fixed point numbers for computations that must give bitwise equal
+/// results on all machines, e.g. lockstep simulations.
+/// Fixed<IntBits, FracBits> can be used as Vec and Mat component type.
+/// It only uses integer operations, so unlike float its results
+/// don't depend on the compiler, optimization flags or instruction set.
+/// The vec and mat operations that sum up products (dot, length, normalize,
+/// cross, mat * mat, mat * vec, lu decomposition, inverse) are overloaded
+/// for fixed point values: they sum up the exact products in 64 bits and
+/// round only once.
+/// The batched point transformations from nytl/batchOps.hpp work on fixed
+/// point values as well, with integer simd kernels.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_FIXED
+#define NYTL_INCLUDE_FIXED
+
+#include <nytl/fwd/vec.hpp> // nytl::Fixed32
+#include <nytl/vec.hpp> // nytl::Vec
+#include <nytl/mat.hpp> // nytl::Mat
+#include <nytl/vecOps.hpp> // nytl::dot
+#include <nytl/matOps.hpp> // nytl::LUDecomposition
+#include <nytl/batchOps.hpp> // nytl::detail::BatchTransformKernel
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/simd.hpp> // nytl::simd::Pack
+
+#include <cmath> // std::sqrt
+#include <cstdint> // std::int64_t
+#include <iosfwd> // std::ostream
+#include <limits> // std::numeric_limits
+#include <stdexcept> // std::domain_error
+#include <type_traits> // std::conditional_t
+#include <utility> // std::index_sequence
+
+namespace nytl {
+namespace detail {
+
+// smallest signed integer type with the given number of bits
+template<unsigned Bits>
+using FixedRaw = std::conditional_t<Bits <= 8, std::int8_t,
+	std::conditional_t<Bits <= 16, std::int16_t, std::int32_t>>;
+
+// Exact products (and their sums) have 2 * F fractional bits, they are
+// accumulated in 64 bits. The sums are unsigned so that overflow wraps
+// around instead of being undefined.
+// Rounds a sum to F fractional bits, to nearest (ties towards +infinity).
+template<unsigned F>
+constexpr std::int64_t fixedRound(std::uint64_t sum) {
+	constexpr auto half = (std::uint64_t(1) << F) >> 1;
+	return std::int64_t(sum + half) >> F;
+}
+
+// num / den, rounded to nearest (ties away from zero)
+constexpr std::int64_t fixedDivide(std::int64_t num, std::int64_t den) {
+	NYTL_EXPECTS(den != 0);
+	auto q = num / den;
+	auto r = num % den;
+	if(2 * (r < 0 ? -r : r) >= (den < 0 ? -den : den)) {
+		q += ((num < 0) == (den < 0)) ? 1 : -1;
+	}
+	return q;
+}
+
+// The square root of value, rounded to nearest.
+// The double square root is correctly rounded (ieee 754) but the
+// conversion of value is not exact, so the estimate is corrected
+// with integer operations. The result does not depend on the estimate.
+inline std::uint64_t isqrt(std::uint64_t value) {
+	constexpr auto max = std::uint64_t(0xffffffffu);
+	auto ret = std::uint64_t(std::sqrt(double(value)));
+	ret = (ret > max) ? max : ret;
+	while(ret * ret > value) {
+		--ret;
+	}
+	while(ret < max && (ret + 1) * (ret + 1) <= value) {
+		++ret;
+	}
+
+	// value >= (ret + 0.5)^2
+	return ret + (value - ret * ret > ret);
+}
+
+// Index of the highest set bit, value must not be 0.
+inline unsigned highestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+	return 63u - unsigned(__builtin_clzll(value));
+#else
+	auto ret = 0u;
+	while(value >>= 1) {
+		++ret;
+	}
+	return ret;
+#endif
+}
+
+} // namespace detail
+
+/// \brief Signed fixed point number with IntBits integer bits (including
+/// the sign) and FracBits fractional bits, i.e. the value raw / 2^FracBits.
+/// Fixed32 (= Fixed<16, 16>) has the range [-32768, 32768) with steps
+/// of 2^-16 (about 1.5e-5).
+/// Addition and subtraction are exact, multiplication rounds to nearest
+/// (ties towards +infinity), division to nearest (ties away from zero).
+/// Overflow wraps around (two's complement), it is never undefined.
+/// Converts implicitly from arithmetic types: floating point values are
+/// rounded to nearest and clamped to the range, nan becomes 0.
+/// Converts explicitly to arithmetic types, integers are truncated.
+template<unsigned IntBits, unsigned FracBits>
+class Fixed {
+public:
+	static_assert(IntBits >= 2, "Fixed needs a sign bit and must be able to represent 1");
+	static_assert(IntBits + FracBits <= 32, "Fixed supports at most 32 bits");
+
+	using Raw = detail::FixedRaw<IntBits + FracBits>;
+	static constexpr auto intBits = IntBits;
+	static constexpr auto fracBits = FracBits;
+	static constexpr auto one = Raw(Raw(1) << FracBits); // raw value of 1
+
+	/// Returns the number with the given raw value.
+	static constexpr Fixed fromRaw(Raw raw) {
+		Fixed ret {};
+		ret.raw = raw;
+		return ret;
+	}
+
+	/// Returns the number with the lower bits of the given (wide) raw value.
+	static constexpr Fixed wrap(std::uint64_t raw) { return fromRaw(Raw(raw)); }
+
+	static constexpr Fixed lowest() { return fromRaw(std::numeric_limits<Raw>::min()); }
+	static constexpr Fixed max() { return fromRaw(std::numeric_limits<Raw>::max()); }
+	static constexpr Fixed epsilon() { return fromRaw(1); }
+
+public:
+	Fixed() = default;
+
+	template<typename A, typename = std::enable_if_t<std::is_arithmetic_v<A>>>
+	constexpr Fixed(A value) : raw(convert(value)) {}
+
+	template<typename A, typename = std::enable_if_t<std::is_arithmetic_v<A>>>
+	constexpr explicit operator A() const {
+		if constexpr(std::is_same_v<A, bool>) {
+			return raw != 0;
+		} else if constexpr(std::is_floating_point_v<A>) {
+			return A(raw) / A(one);
+		} else {
+			return A(raw / one);
+		}
+	}
+
+	constexpr Fixed& operator+=(Fixed other) { return *this = *this + other; }
+	constexpr Fixed& operator-=(Fixed other) { return *this = *this - other; }
+	constexpr Fixed& operator*=(Fixed other) { return *this = *this * other; }
+	constexpr Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+	friend constexpr Fixed operator+(Fixed a, Fixed b) {
+		return wrap(std::uint64_t(a.raw) + std::uint64_t(b.raw));
+	}
+
+	friend constexpr Fixed operator-(Fixed a, Fixed b) {
+		return wrap(std::uint64_t(a.raw) - std::uint64_t(b.raw));
+	}
+
+	friend constexpr Fixed operator-(Fixed a) {
+		return wrap(std::uint64_t(0) - std::uint64_t(a.raw));
+	}
+
+	friend constexpr Fixed operator*(Fixed a, Fixed b) {
+		auto product = std::uint64_t(std::int64_t(a.raw) * b.raw);
+		return wrap(detail::fixedRound<FracBits>(product));
+	}
+
+	/// \requires b must not be zero.
+	friend constexpr Fixed operator/(Fixed a, Fixed b) {
+		return wrap(detail::fixedDivide(std::int64_t(a.raw) * one, b.raw));
+	}
+
+	friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+	friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+	friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+	friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+	friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+	friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+	Raw raw;
+
+private:
+	template<typename A>
+	static constexpr Raw convert(A value) {
+		if constexpr(std::is_floating_point_v<A>) {
+			constexpr auto lo = double(std::numeric_limits<Raw>::min());
+			constexpr auto hi = double(std::numeric_limits<Raw>::max());
+			auto scaled = double(value) * one; // exact, power of two
+			if(!(scaled == scaled)) {
+				return 0;
+			}
+
+			scaled = (scaled < lo) ? lo : (scaled > hi) ? hi : scaled;
+			return Raw(std::int64_t(scaled < 0 ? scaled - 0.5 : scaled + 0.5));
+		} else {
+			return Raw(std::uint64_t(value) << FracBits);
+		}
+	}
+};
+
+/// \brief Prints the value of the given fixed point number.
+/// If this function is used, header <ostream> must be included.
+template<unsigned I, unsigned F>
+std::ostream& operator<<(std::ostream& os, const Fixed<I, F>& value) {
+	return os << double(value);
+}
+
+/// \brief Returns the absolute value. Fixed::lowest() stays negative.
+template<unsigned I, unsigned F>
+constexpr Fixed<I, F> abs(Fixed<I, F> value) {
+	return (value.raw < 0) ? -value : value;
+}
+
+/// \brief Returns the square root, rounded to nearest.
+/// \requires value must not be negative.
+template<unsigned I, unsigned F>
+Fixed<I, F> sqrt(Fixed<I, F> value) {
+	NYTL_EXPECTS(value.raw >= 0);
+	// the root of raw * 2^F has F fractional bits
+	auto raw = std::uint64_t(value.raw) << F;
+	return Fixed<I, F>::wrap(detail::isqrt(raw));
+}
+
+namespace detail {
+
+// sum of the exact products a[i] * b[i], not rounded
+template<size_t D, unsigned F1, unsigned F2, size_t... I>
+constexpr std::uint64_t fixedDot(const Vec<D, Fixed<F1, F2>>& a,
+		const Vec<D, Fixed<F1, F2>>& b, std::index_sequence<I...>) {
+	return (std::uint64_t(0) + ... +
+		std::uint64_t(std::int64_t(a[I].raw) * b[I].raw));
+}
+
+// a * d - b * c, rounded once
+template<unsigned I, unsigned F>
+constexpr Fixed<I, F> fixedDet2(Fixed<I, F> a, Fixed<I, F> b, Fixed<I, F> c,
+		Fixed<I, F> d) {
+	auto ad = std::uint64_t(std::int64_t(a.raw) * d.raw);
+	auto bc = std::uint64_t(std::int64_t(b.raw) * c.raw);
+	return Fixed<I, F>::wrap(fixedRound<F>(ad - bc));
+}
+
+} // namespace detail
+
+// - vec operations -
+/// \brief Fixed point dot product, the sum of the exact products is
+/// rounded once. Exact products can't overflow, the result is correct
+/// as long as it is representable.
+template<size_t D, unsigned I, unsigned F>
+constexpr auto dot(const Vec<D, Fixed<I, F>>& a, const Vec<D, Fixed<I, F>>& b) {
+	auto sum = detail::fixedDot(a, b, std::make_index_sequence<D> {});
+	return Fixed<I, F>::wrap(detail::fixedRound<F>(sum));
+}
+
+/// \brief Fixed point euclidean norm, computed with an integer square root
+/// of the exact squared length. Correct as long as the length is representable.
+template<size_t D, unsigned I, unsigned F>
+auto length(const Vec<D, Fixed<I, F>>& a) {
+	// the squared length has 2 * F fractional bits, its root F
+	auto sum = detail::fixedDot(a, a, std::make_index_sequence<D> {});
+	return Fixed<I, F>::wrap(detail::isqrt(sum));
+}
+
+/// \brief Returns the given fixed point vector scaled to length 1.
+/// Every component has an error below 0.75 of the last bit.
+/// The length itself does not have to be representable, i.e. the
+/// exact squared length must only be below 2^(64 - 2 * F).
+/// \throws std::domain_error if the vector has the length 0.
+template<size_t D, unsigned I, unsigned F>
+auto normalized(const Vec<D, Fixed<I, F>>& a) {
+	auto sum = detail::fixedDot(a, a, std::make_index_sequence<D> {});
+	if(sum == 0) {
+		throw std::domain_error("nytl::normalized: nullvector given");
+	}
+
+	// The squared length is scaled by 4^h into [2^60, 2^62) so that its
+	// root l = |a| * 2^h has 31 significant bits even for short vectors.
+	// Then every component is multiplied with the rounded reciprocal
+	// 2^61 / l instead of being divided: a[i] * 2^(F + h) / l.
+	// Since |a[i]| * 2^h <= l, the product is below 2^62. Both roundings
+	// add an error of about 2^(F - 30) of the last bit.
+	auto bit = detail::highestBit(sum);
+	auto h = (bit >= 62) ? -1 : int(61 - bit) / 2;
+	auto scaled = (h < 0) ? (sum >> 2) : (sum << (2 * h));
+	auto l = detail::isqrt(scaled);
+	auto inv = std::int64_t(((std::uint64_t(1) << 61) + l / 2) / l);
+
+	auto shift = unsigned(61 - int(F) - h);
+	auto half = std::uint64_t(1) << (shift - 1);
+	Vec<D, Fixed<I, F>> ret {};
+	for(auto i = 0u; i < D; ++i) {
+		auto product = std::uint64_t(std::int64_t(a[i].raw) * inv);
+		ret[i] = Fixed<I, F>::wrap(std::int64_t(product + half) >> shift);
+	}
+
+	return ret;
+}
+
+/// \brief Normalizes the given fixed point vector in place, see normalized.
+/// \throws std::domain_error if the vector has the length 0.
+template<size_t D, unsigned I, unsigned F>
+void normalize(Vec<D, Fixed<I, F>>& a) {
+	a = normalized(a);
+}
+
+/// \brief Fixed point cross product, every component is rounded once.
+template<unsigned I, unsigned F>
+constexpr auto cross(const Vec<3, Fixed<I, F>>& a, const Vec<3, Fixed<I, F>>& b) {
+	return Vec<3, Fixed<I, F>> {
+		detail::fixedDet2(a[1], a[2], b[1], b[2]),
+		detail::fixedDet2(a[2], a[0], b[2], b[0]),
+		detail::fixedDet2(a[0], a[1], b[0], b[1]),
+	};
+}
+
+/// \brief Fixed point 2-dimensional cross product, rounded once.
+template<unsigned I, unsigned F>
+constexpr auto cross(const Vec<2, Fixed<I, F>>& a, const Vec<2, Fixed<I, F>>& b) {
+	return detail::fixedDet2(a[0], a[1], b[0], b[1]);
+}
+
+// - mat operations -
+// mat * vec uses the dot overload above.
+namespace detail {
+
+// Like the generic mat operators, expanded over the indices (see nytl/mat.hpp).
+template<size_t Col, size_t M, size_t C, unsigned I, unsigned F, size_t... K>
+constexpr auto fixedRowTimesCol(const Vec<M, Fixed<I, F>>& row,
+		const Mat<M, C, Fixed<I, F>>& b, std::index_sequence<K...>) {
+	auto sum = (std::uint64_t(0) + ... +
+		std::uint64_t(std::int64_t(row[K].raw) * b[K][Col].raw));
+	return Fixed<I, F>::wrap(fixedRound<F>(sum));
+}
+
+template<size_t M, size_t C, unsigned I, unsigned F, size_t... K>
+constexpr auto fixedRowTimesMat(const Vec<M, Fixed<I, F>>& row,
+		const Mat<M, C, Fixed<I, F>>& b, std::index_sequence<K...>) {
+	return Vec<C, Fixed<I, F>> {
+		fixedRowTimesCol<K>(row, b, std::make_index_sequence<M> {})...};
+}
+
+template<size_t R, size_t M, size_t C, unsigned I, unsigned F, size_t... K>
+constexpr auto fixedMatMultiply(const Mat<R, M, Fixed<I, F>>& a,
+		const Mat<M, C, Fixed<I, F>>& b, std::index_sequence<K...>) {
+	return Mat<R, C, Fixed<I, F>> {{
+		fixedRowTimesMat(a[K], b, std::make_index_sequence<C> {})...}};
+}
+
+} // namespace detail
+
+/// \brief Fixed point matrix product, every entry is rounded once.
+template<size_t R, size_t M, size_t C, unsigned I, unsigned F>
+constexpr auto operator*(const Mat<R, M, Fixed<I, F>>& a,
+		const Mat<M, C, Fixed<I, F>>& b) {
+	return detail::fixedMatMultiply(a, b, std::make_index_sequence<R> {});
+}
+
+/// \brief Fixed point lu decomposition, see the generic luDecomp.
+/// The returned matrices are fixed point matrices as well.
+/// Always uses partial pivoting (swaps in the row with the largest absolute
+/// value) to keep the rounding errors small.
+template<size_t D, unsigned I, unsigned F>
+constexpr auto luDecomp(const Mat<D, D, Fixed<I, F>>& mat) {
+	using T = Fixed<I, F>;
+	LUDecomposition<D, T> ret {};
+	identity(ret.perm);
+	ret.upper = mat;
+
+	for(auto n = 0u; n < D; ++n) {
+		auto maxRow = n;
+		for(auto r = n + 1; r < D; ++r) {
+			if(abs(ret.upper[r][n]) > abs(ret.upper[maxRow][n])) {
+				maxRow = r;
+			}
+		}
+
+		if(maxRow != n) {
+			swapRow(ret.perm, maxRow, n);
+			swapRow(ret.upper, maxRow, n);
+			swapRow(ret.lower, maxRow, n);
+			ret.sign *= -1;
+		}
+
+		// all coefficients in the column are zero, nothing to eliminate
+		ret.lower[n][n] = T {1};
+		if(ret.upper[n][n] == T {0}) {
+			continue;
+		}
+
+		for(auto i = n + 1; i < D; ++i) {
+			auto fac = ret.upper[i][n] / ret.upper[n][n];
+			ret.upper[i][n] = T {0};
+			for(auto j = n + 1; j < D; ++j) {
+				ret.upper[i][j] -= fac * ret.upper[n][j];
+			}
+
+			ret.lower[i][n] = fac;
+		}
+	}
+
+	return ret;
+}
+
+/// \brief Returns the vector x so that A * x = b for the matrix A
+/// with the given fixed point lu decomposition (PA = LU).
+/// The substitution sums are rounded once per component.
+/// \requires The decomposed matrix must not be singular.
+template<size_t D, unsigned I, unsigned F>
+constexpr auto luEvaluate(const LUDecomposition<D, Fixed<I, F>>& lu,
+		const Vec<D, Fixed<I, F>>& b) {
+	using T = Fixed<I, F>;
+
+	// forward substitution for L * d = P * b, lower has only ones in its diagonal
+	Vec<D, T> d {};
+	for(auto i = 0u; i < D; ++i) {
+		auto sum = std::uint64_t(0);
+		for(auto j = 0u; j < D; ++j) {
+			if(lu.perm[i][j]) {
+				sum = std::uint64_t(std::int64_t(b[j].raw) * T::one);
+			}
+		}
+
+		for(auto j = 0u; j < i; ++j) {
+			sum -= std::uint64_t(std::int64_t(lu.lower[i][j].raw) * d[j].raw);
+		}
+
+		d[i] = T::wrap(detail::fixedRound<F>(sum));
+	}
+
+	// back substitution for U * x = d
+	Vec<D, T> x {};
+	for(auto i = D; i-- > 0; ) {
+		auto sum = std::uint64_t(std::int64_t(d[i].raw) * T::one);
+		for(auto j = i + 1; j < D; ++j) {
+			sum -= std::uint64_t(std::int64_t(lu.upper[i][j].raw) * x[j].raw);
+		}
+
+		// the sum has 2 * F fractional bits, the quotient F
+		x[i] = T::wrap(detail::fixedDivide(std::int64_t(sum), lu.upper[i][i].raw));
+	}
+
+	return x;
+}
+
+/// \brief Returns the determinant for the fixed point lu decomposition.
+template<size_t D, unsigned I, unsigned F>
+constexpr auto determinant(const LUDecomposition<D, Fixed<I, F>>& lu) {
+	auto ret = multiplyDiagonal(lu.upper);
+	return (lu.sign == 1) ? ret : -ret;
+}
+
+/// \brief Returns the determinant of the given fixed point matrix.
+template<size_t D, unsigned I, unsigned F>
+constexpr auto determinant(const Mat<D, D, Fixed<I, F>>& mat) {
+	return determinant(luDecomp(mat));
+}
+
+/// \brief Returns the inverse of the matrix with the given fixed point
+/// lu decomposition.
+/// \requires The decomposed matrix must not be singular.
+template<size_t D, unsigned I, unsigned F>
+constexpr auto inverse(const LUDecomposition<D, Fixed<I, F>>& lu) {
+	using T = Fixed<I, F>;
+	Mat<D, D, T> ret {};
+	for(auto i = 0u; i < D; ++i) {
+		Vec<D, T> e {};
+		e[i] = T {1};
+		col(ret, i, luEvaluate(lu, e));
+	}
+
+	return ret;
+}
+
+/// \brief Returns the inverse of the given fixed point matrix.
+/// \requires The matrix must not be singular.
+template<size_t D, unsigned I, unsigned F>
+constexpr auto inverse(const Mat<D, D, Fixed<I, F>>& mat) {
+	return inverse(luDecomp(mat));
+}
+
+namespace detail {
+
+// Batched transformations (see nytl/batchOps.hpp) of fixed point points.
+// Computes the same as mat * vec (rounding every component once).
+// The simd version transforms multiple points in 64 bit integer lanes,
+// projective transformations divide every point on its own.
+template<bool Project, unsigned IB, unsigned FB>
+struct BatchTransformKernel<Project, Fixed<IB, FB>> {
+	using T = Fixed<IB, FB>;
+	using Raw = typename T::Raw;
+
+	// the sum of the exact products of row and (p, 1)
+	static std::uint64_t row(const Vec<4, T>& r, const Vec3<T>& p) {
+		return std::uint64_t(std::int64_t(r[0].raw) * p.x.raw) +
+			std::uint64_t(std::int64_t(r[1].raw) * p.y.raw) +
+			std::uint64_t(std::int64_t(r[2].raw) * p.z.raw) +
+			std::uint64_t(std::int64_t(r[3].raw) * T::one);
+	}
+
+	template<std::size_t Bytes>
+	static void run(const BatchMat<T>& m, const Vec3<T>* in, Vec3<T>* out,
+			size_t count) {
+		static_assert(sizeof(Vec3<T>) == 3 * sizeof(T), "Vec3 must be tightly packed");
+		auto i = size_t(0);
+
+	#if NYTL_SIMD
+		// Only worth it with 64 bit lane multiplications (avx512), they are
+		// emulated for narrower instruction sets and slower than scalar code.
+		constexpr auto n = Bytes / sizeof(std::int64_t);
+		if constexpr(!Project && Bytes >= 64) {
+			using P = simd::Pack<Raw, n>;
+			using L = simd::Pack<std::int64_t, n>;
+			using U = simd::Pack<std::uint64_t, n>;
+
+			// the translation is multiplied with 1, includes the rounding offset
+			U c[3][4];
+			for(auto r = 0u; r < 3; ++r) {
+				for(auto col = 0u; col < 3; ++col) {
+					simd::broadcast(c[r][col], std::uint64_t(std::int64_t(m[r][col].raw)));
+				}
+
+				auto t = std::uint64_t(std::int64_t(m[r][3].raw) * T::one);
+				simd::broadcast(c[r][3], t + ((std::uint64_t(1) << FB) >> 1));
+			}
+
+			for(; i + n <= count; i += n) {
+				P rx, ry, rz;
+				simd::deinterleave3<n>(&in[i].x.raw, rx, ry, rz);
+				U x = __builtin_convertvector(__builtin_convertvector(rx, L), U);
+				U y = __builtin_convertvector(__builtin_convertvector(ry, L), U);
+				U z = __builtin_convertvector(__builtin_convertvector(rz, L), U);
+
+				U ox = c[0][0] * x + c[0][1] * y + c[0][2] * z + c[0][3];
+				U oy = c[1][0] * x + c[1][1] * y + c[1][2] * z + c[1][3];
+				U oz = c[2][0] * x + c[2][1] * y + c[2][2] * z + c[2][3];
+
+				P px = __builtin_convertvector(__builtin_convertvector(ox, L) >> FB, P);
+				P py = __builtin_convertvector(__builtin_convertvector(oy, L) >> FB, P);
+				P pz = __builtin_convertvector(__builtin_convertvector(oz, L) >> FB, P);
+				simd::interleave3<n>(&out[i].x.raw, px, py, pz);
+			}
+		}
+	#endif // NYTL_SIMD
+
+		for(; i < count; ++i) {
+			auto p = in[i];
+			Vec3<T> o {
+				T::wrap(fixedRound<FB>(row(m[0], p))),
+				T::wrap(fixedRound<FB>(row(m[1], p))),
+				T::wrap(fixedRound<FB>(row(m[2], p))),
+			};
+
+			if constexpr(Project) {
+				auto w = T::wrap(fixedRound<FB>(row(m[3], p)));
+				o = {o.x / w, o.y / w, o.z / w};
+			}
+
+			out[i] = o;
+		}
+	}
+};
+
+} // namespace detail
+} // namespace nytl
+
+#endif // header guard
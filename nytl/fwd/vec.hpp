@@ -19,6 +19,21 @@ template<size_t D, typename T> class Vec;
 template<typename T> class Vec<2, T>; // nytl/vec2.hpp
 template<typename T> class Vec<3, T>; // nytl/vec3.hpp
 
+// nytl/packed.hpp
+class f16;
+class bf16;
+template<typename I> class Norm;
+class Oct32;
+
+using snorm8 = Norm<std::int8_t>;
+using snorm16 = Norm<std::int16_t>;
+using unorm8 = Norm<std::uint8_t>;
+using unorm16 = Norm<std::uint16_t>;
+
+// nytl/fixed.hpp
+template<unsigned IntBits, unsigned FracBits> class Fixed;
+using Fixed32 = Fixed<16, 16>;
+
 template<typename T> using Vec2 = Vec<2, T>;
 template<typename T> using Vec3 = Vec<3, T>;
 template<typename T> using Vec4 = Vec<4, T>;
@@ -36,6 +51,8 @@ using Vec2i8 = Vec2<std::int8_t>;
 using Vec2i16 = Vec2<std::int16_t>;
 using Vec2i32 = Vec2<std::int32_t>;
 using Vec2i64 = Vec2<std::int64_t>;
+using Vec2h = Vec2<f16>;
+using Vec2x = Vec2<Fixed32>;
 
 using Vec3f = Vec3<float>;
 using Vec3i = Vec3<int>;
@@ -50,6 +67,8 @@ using Vec3i8 = Vec3<std::int8_t>;
 using Vec3i16 = Vec3<std::int16_t>;
 using Vec3i32 = Vec3<std::int32_t>;
 using Vec3i64 = Vec3<std::int64_t>;
+using Vec3h = Vec3<f16>;
+using Vec3x = Vec3<Fixed32>;
 
 using Vec4f = Vec4<float>;
 using Vec4i = Vec4<int>;
@@ -64,6 +83,8 @@ using Vec4i8 = Vec4<std::int8_t>;
 using Vec4i16 = Vec4<std::int16_t>;
 using Vec4i32 = Vec4<std::int32_t>;
 using Vec4i64 = Vec4<std::int64_t>;
+using Vec4h = Vec4<f16>;
+using Vec4x = Vec4<Fixed32>;
 
 }
 
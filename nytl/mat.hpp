@@ -12,6 +12,10 @@
 #include <nytl/fwd/mat.hpp> // nytl::Mat forward declaration
 #include <nytl/vec.hpp> // nytl::Vec
 #include <nytl/vecOps.hpp> // nytl::dot
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+
+#include <stdexcept> // std::out_of_range
+#include <utility> // std::index_sequence
 
 namespace nytl {
 
@@ -29,8 +33,9 @@ struct Mat {
 public:
 	/// Returns the ith row of the matrix.
 	/// Since this is of type nytl::Vec, mat[i][j] works.
-	constexpr auto& operator[](size_t i){ return rows_[i]; }
-	constexpr const auto& operator[](size_t i) const { return rows_[i]; }
+	/// Does not check bounds, except when contracts are enabled.
+	constexpr auto& operator[](size_t i) { NYTL_EXPECTS(i < R); return rows_[i]; }
+	constexpr const auto& operator[](size_t i) const { NYTL_EXPECTS(i < R); return rows_[i]; }
 
 	/// Returns the ith row of the matrix.
 	/// If these exceeds the size of the matrix, throws std::out_of_range.
@@ -52,9 +57,10 @@ public:
 
 	/// Utility function that throws std::out_of_range if the matrix does not have
 	/// the given row.
-	constexpr void checkRow(size_t r) {
-		if(r >= rows())
+	static constexpr void checkRow(size_t r) {
+		if(NYTL_UNLIKELY(r >= rows())) {
 			throw std::out_of_range("nytl::Mat::at");
+		}
 	}
 
 public:
@@ -62,49 +68,123 @@ public:
 };
 
 // - implementation/operators -
+// Like the vec operators, the matrix operators are expanded over the
+// (compile-time) row and column indices, see nytl/vec.hpp.
+namespace detail {
+
+template<size_t OR, size_t OC, typename OT, size_t R, size_t C, typename T, size_t... I>
+constexpr Mat<OR, OC, OT> matCast(const Mat<R, C, T>& a, std::index_sequence<I...>) {
+	// the padding rows are default constructed
+	return {{(I < R ? static_cast<Vec<OC, OT>>(a[I < R ? I : 0]) : Vec<OC, OT> {})...}};
+}
+
+// entry c of (row * b)
+template<size_t Col, size_t M, size_t C, typename T1, typename T2, size_t... I>
+constexpr auto rowTimesCol(const Vec<M, T1>& row, const Mat<M, C, T2>& b,
+		std::index_sequence<I...>) {
+	using R = decltype(row[0] * b[0][0] + row[0] * b[0][0]);
+	if constexpr(M == 0) {
+		return R {0};
+	} else {
+		return R((... + (row[I] * b[I][Col])));
+	}
+}
+
+template<size_t M, size_t C, typename T1, typename T2, size_t... I>
+constexpr auto rowTimesMat(const Vec<M, T1>& row, const Mat<M, C, T2>& b,
+		std::index_sequence<I...>) {
+	using R = decltype(row[0] * b[0][0] + row[0] * b[0][0]);
+	return Vec<C, R> {rowTimesCol<I>(row, b, std::make_index_sequence<M> {})...};
+}
+
+template<size_t R, size_t M, size_t C, typename T1, typename T2, size_t... I>
+constexpr auto matMultiply(const Mat<R, M, T1>& a, const Mat<M, C, T2>& b,
+		std::index_sequence<I...>) {
+	using V = decltype(a[0][0] * b[0][0] + a[0][0] * b[0][0]);
+	return Mat<R, C, V> {{rowTimesMat(a[I], b, std::make_index_sequence<C> {})...}};
+}
+
+template<size_t R, size_t C, typename T1, typename T2, size_t... I>
+constexpr auto matTimesVec(const Mat<R, C, T1>& a, const Vec<C, T2>& b,
+		std::index_sequence<I...>) {
+	using V = decltype(a[0][0] * b[0] + a[0][0] * b[0]);
+	return Vec<R, V> {V(dot(a[I], b))...};
+}
+
+template<typename F, size_t R, size_t C, typename T, size_t... I>
+constexpr auto matScale(const F& f, const Mat<R, C, T>& a, std::index_sequence<I...>) {
+	return Mat<R, C, decltype(f * a[0][0])> {{(f * a[I])...}};
+}
+
+template<size_t R, size_t C, typename T1, typename T2, size_t... I>
+constexpr auto matAdd(const Mat<R, C, T1>& a, const Mat<R, C, T2>& b,
+		std::index_sequence<I...>) {
+	return Mat<R, C, decltype(a[0][0] + b[0][0])> {{(a[I] + b[I])...}};
+}
+
+template<size_t R, size_t C, typename T1, typename T2, size_t... I>
+constexpr auto matSub(const Mat<R, C, T1>& a, const Mat<R, C, T2>& b,
+		std::index_sequence<I...>) {
+	return Mat<R, C, decltype(a[0][0] - b[0][0])> {{(a[I] - b[I])...}};
+}
+
+template<size_t R, size_t C, typename T1, typename T2, size_t... I>
+constexpr void matAddAssign(Mat<R, C, T1>& a, const Mat<R, C, T2>& b,
+		std::index_sequence<I...>) {
+	((a[I] += b[I]), ...);
+}
+
+template<size_t R, size_t C, typename T1, typename T2, size_t... I>
+constexpr void matSubAssign(Mat<R, C, T1>& a, const Mat<R, C, T2>& b,
+		std::index_sequence<I...>) {
+	((a[I] -= b[I]), ...);
+}
+
+template<typename F, size_t R, size_t C, typename T, size_t... I>
+constexpr void matScaleAssign(Mat<R, C, T>& a, const F& f, std::index_sequence<I...>) {
+	((a[I] *= f), ...);
+}
+
+template<size_t R, size_t C, typename T, size_t... I>
+constexpr auto matNegate(const Mat<R, C, T>& a, std::index_sequence<I...>) {
+	return Mat<R, C, T> {{(-a[I])...}};
+}
+
+template<size_t R, size_t C, typename T1, typename T2, size_t... I>
+constexpr bool matEqual(const Mat<R, C, T1>& a, const Mat<R, C, T2>& b,
+		std::index_sequence<I...>) {
+	return (... && (a[I] == b[I]));
+}
+
+} // namespace detail
+
 template<size_t R, size_t C, typename T>
 template<size_t OR, size_t OC, typename OT>
 constexpr Mat<R, C, T>::operator Mat<OR, OC, OT>() const
 {
-	Mat<OR, OC, OT> ret {};
-	for(auto r = 0u; r < std::min(R, OR); ++r)
-		for(auto c = 0u; c < std::min(C, OC); ++c)
-			ret[r][c] = (*this)[r][c];
-	return ret;
+	return detail::matCast<OR, OC, OT>(*this, std::make_index_sequence<OR> {});
 }
 
 // mat * mat
 template<typename T1, typename T2, size_t R, size_t M, size_t C>
 constexpr auto operator*(const Mat<R, M, T1>& a, const Mat<M, C, T2>& b)
 {
-	Mat<R, C, decltype(a[0][0] * b[0][0] + a[0][0] * b[0][0])> ret {};
-	for(auto r = 0u; r < R; ++r) // ret: rows
-		for(auto c = 0u; c < C; ++c) // ret: cols
-			for(auto i = 0u; i < M; ++i) // row + col dot
-				ret[r][c] += a[r][i] * b[i][c];
-	return ret;
+	return detail::matMultiply(a, b, std::make_index_sequence<R> {});
 }
 
 // mat * vec
 template<typename T1, typename T2, size_t R, size_t C>
 constexpr auto operator*(const Mat<R, C, T1>& a, const Vec<C, T2>& b)
 {
-	Vec<R, decltype(a[0][0] * b[0] + a[0][0] * b[0])> ret {};
-	for(auto r = 0u; r < R; ++r)
-		ret[r] = dot(a[r], b);
-	return ret;
+	return detail::matTimesVec(a, b, std::make_index_sequence<R> {});
 }
 
 // mat *= mat (quadratic)
 template<typename T1, typename T2, size_t D>
 constexpr auto& operator*=(Mat<D, D, T1>& a, const Mat<D, D, T2>& b)
 {
-	auto tmp = a; // needed since we write to a
-	a = {};
-	for(auto r = 0u; r < D; ++r) // ret: rows
-		for(auto c = 0u; c < D; ++c) // ret: cols
-			for(auto i = 0u; i < D; ++i) // row + col dot
-				a[r][c] += tmp[r][i] * b[i][c];
+	// the product is computed into a temporary since we write to a
+	a = static_cast<Mat<D, D, T1>>(a * b);
 	return a;
 }
 
@@ -112,20 +192,14 @@ constexpr auto& operator*=(Mat<D, D, T1>& a, const Mat<D, D, T2>& b)
 template<typename F, typename T, size_t R, size_t C>
 constexpr auto operator*(const F& f, const Mat<R, C, T>& a)
 {
-	Mat<R, C, decltype(f * a[0][0])> ret {};
-	for(auto r = 0u; r < R; ++r)
-		for(auto c = 0u; c < C; ++c)
-			ret[r][c] = f * a[r][c];
-	return ret;
+	return detail::matScale(f, a, std::make_index_sequence<R> {});
 }
 
 // mat *= fac
 template<typename F, typename T, size_t R, size_t C>
-constexpr auto& operator*=(Mat<R, C, T> a, const F& f)
+constexpr auto& operator*=(Mat<R, C, T>& a, const F& f)
 {
-	for(auto r = 0u; r < R; ++r)
-		for(auto c = 0u; c < C; ++c)
-			a[r][c] *= f;
+	detail::matScaleAssign(a, f, std::make_index_sequence<R> {});
 	return a;
 }
 
@@ -133,20 +207,14 @@ constexpr auto& operator*=(Mat<R, C, T> a, const F& f)
 template<typename T1, typename T2, size_t R, size_t C>
 constexpr auto operator+(const Mat<R, C, T1>& a, const Mat<R, C, T2>& b)
 {
-	Mat<R, C, decltype(a[0][0] + b[0][0])> ret {};
-	for(auto r = 0u; r < R; ++r)
-		for(auto c = 0u; c < C; ++c)
-			ret[r][c] = a[r][c] + b[r][c];
-	return ret;
+	return detail::matAdd(a, b, std::make_index_sequence<R> {});
 }
 
 // mat += mat
 template<typename T1, typename T2, size_t R, size_t C>
 constexpr auto& operator+=(Mat<R, C, T1>& a, const Mat<R, C, T2>& b)
 {
-	for(auto r = 0u; r < R; ++r)
-		for(auto c = 0u; c < C; ++c)
-			a[r][c] += b[r][c];
+	detail::matAddAssign(a, b, std::make_index_sequence<R> {});
 	return a;
 }
 
@@ -154,40 +222,28 @@ constexpr auto& operator+=(Mat<R, C, T1>& a, const Mat<R, C, T2>& b)
 template<typename T1, typename T2, size_t R, size_t C>
 constexpr auto operator-(const Mat<R, C, T1>& a, const Mat<R, C, T2>& b)
 {
-	Mat<R, C, decltype(a[0][0] - b[0][0])> ret {};
-	for(auto r = 0u; r < R; ++r)
-		for(auto c = 0u; c < C; ++c)
-			ret[r][c] = a[r][c] - b[r][c];
-	return ret;
+	return detail::matSub(a, b, std::make_index_sequence<R> {});
 }
 
 // mat -= mat
 template<typename T1, typename T2, size_t R, size_t C>
 constexpr auto& operator-=(Mat<R, C, T1>& a, const Mat<R, C, T2>& b)
 {
-	for(auto r = 0u; r < R; ++r)
-		for(auto c = 0u; c < C; ++c)
-			a[r][c] -= b[r][c];
+	detail::matSubAssign(a, b, std::make_index_sequence<R> {});
 	return a;
 }
 
 // -mat
 template<typename T, size_t R, size_t C>
-constexpr auto operator-(Mat<R, C, T> a)
+constexpr auto operator-(const Mat<R, C, T>& a)
 {
-	for(auto r = 0u; r < R; ++r)
-		for(auto c = 0u; c < C; ++c)
-			a[r][c] = -a[r][c];
-	return a;
+	return detail::matNegate(a, std::make_index_sequence<R> {});
 }
 
 template<typename T1, typename T2, size_t R, size_t C>
 constexpr auto operator==(const Mat<R, C, T1>& a, const Mat<R, C, T2>& b)
 {
-	for(auto i = 0u; i < R; ++i)
-		if(a.rows_[i] != b.rows_[i])
-			return false;
-	return true;
+	return detail::matEqual(a, b, std::make_index_sequence<R> {});
 }
 
 template<typename T1, typename T2, size_t R, size_t C>
@@ -62,7 +62,7 @@ std::ostream& print(std::ostream& ostream, const Mat<R, C, T>& mat,
 
 		for(auto c = 0u; c < C; c++) {
 			if(valueWidth) os.width(valueWidth);
-			if(valueWidth) os.precision(valueWidth - numberOfDigits(mat[r][c]) - 1);
+			if(valueWidth) os.precision(valueWidth - numberOfDigits(double(mat[r][c])) - 1);
 
 			os << mat[r][c];
 			if(c != C - 1)
@@ -10,6 +10,7 @@
 #define NYTL_INCLUDE_SCALAR
 
 #include <algorithm> // std::clamp
+#include <cstdint> // std::uint64_t
 
 namespace nytl {
 namespace constants {
@@ -91,6 +92,21 @@ constexpr auto clampStore(float value, float min, float max, int& store) {
 	return value;
 }
 
+/// Returns the index of the lowest set bit in the given value.
+/// The value must not be 0.
+inline unsigned lowestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+	return unsigned(__builtin_ctzll(value));
+#else
+	auto ret = 0u;
+	while(!(value & 1)) {
+		value >>= 1;
+		++ret;
+	}
+	return ret;
+#endif
+}
+
 } // namespace nytl
 
 #endif // header guard
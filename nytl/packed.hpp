@@ -0,0 +1,559 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Compact storage types for floats and (unit) vectors, e.g. for
+/// uploading vertex data to the gpu or sending snapshots over the network:
+/// half precision floats (f16, bf16), normalized integers (snorm8, snorm16,
+/// unorm8, unorm16) and octahedral encoded unit vectors (Oct32).
+/// The number types convert implicitly from and to float and can be used as
+/// Vec component types, e.g. Vec3<f16> (= Vec3h). Arithmetic is done in float.
+/// nytl::pack and nytl::unpack convert whole arrays, they are compiled for
+/// multiple instruction sets (see nytl/dispatch.hpp). Only basic integer
+/// and float operations are used, i.e. the results of all instruction
+/// sets are bitwise equal and equal to converting the values on their own.
+/// Only Oct32 may differ in the last bit when the including code is compiled
+/// with fma contraction (e.g. -march=native with g++).
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_PACKED
+#define NYTL_INCLUDE_PACKED
+
+#include <nytl/fwd/vec.hpp> // nytl::f16
+#include <nytl/vec.hpp> // nytl::Vec
+#include <nytl/vec3.hpp> // nytl::Vec3
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/simd.hpp> // nytl::simd::Pack
+#include <nytl/dispatch.hpp> // nytl::Dispatch
+#include <nytl/fastMath.hpp> // nytl::fast::detail::rsqrt
+
+#include <algorithm> // std::min
+#include <cstdint> // std::uint16_t
+#include <cstring> // std::memcpy
+#include <iterator> // std::data
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_same_v
+
+namespace nytl {
+namespace detail {
+
+// The conversions are implemented once for single values and packs (see
+// nytl/simd.hpp). Float values are of type P, integer lanes of type L.
+// The helpers from nytl/fastMath.hpp are reused.
+using fast::detail::Int;
+using fast::detail::toBits;
+using fast::detail::fromBits;
+
+// uint32 type with the layout of P
+template<typename P> struct UintT {
+#if NYTL_SIMD
+	using type = simd::Pack<std::uint32_t, sizeof(P) / sizeof(float)>;
+#endif // NYTL_SIMD
+};
+
+template<> struct UintT<float> { using type = std::uint32_t; };
+template<typename P> using Uint = typename UintT<P>::type;
+
+// See "Half to float, done quick" and the float_to_half_fast3_rtne version
+// of fabian giesen. Rounds to nearest even, values out of range become
+// infinity, nan is kept (but quiet).
+template<typename P>
+inline void floatToHalf(const P& value, Uint<P>& out) {
+	using L = Uint<P>;
+	L u;
+	std::memcpy(&u, &value, sizeof(P));
+	L sign = u & 0x80000000u;
+	u ^= sign;
+
+	// subnormal results: the float addition aligns (and rounds) the
+	// mantissa, 0.5 has the exponent of the smallest half subnormal
+	constexpr auto magicBits = 126u << 23;
+	P f, magic;
+	std::memcpy(&f, &u, sizeof(P));
+	magic = P {} + 0.5f;
+	f = f + magic;
+	L sub;
+	std::memcpy(&sub, &f, sizeof(P));
+	sub -= magicBits;
+
+	// normal results: rebias the exponent and round to nearest even
+	L normal = (u + 0xc8000fffu + ((u >> 13) & 1u)) >> 13;
+
+	L special = (u > 0x7f800000u) ? L {} + 0x7e00u : L {} + 0x7c00u;
+	out = (u < (113u << 23)) ? sub : normal;
+	out = (u >= (143u << 23)) ? special : out;
+	out |= sign >> 16;
+}
+
+template<typename P>
+inline void halfToFloat(const Uint<P>& half, P& out) {
+	using L = Uint<P>;
+	constexpr auto expMask = 0x7c00u << 13;
+	L u = (half & 0x7fffu) << 13;
+	L exp = u & expMask;
+	u += (127u - 15u) << 23;
+
+	// zero and subnormals: renormalize with a float subtraction
+	P f, magic;
+	L sub = u + (1u << 23);
+	std::memcpy(&f, &sub, sizeof(P));
+	magic = P {} + 6.103515625e-05f; // 2^-14
+	f = f - magic;
+	std::memcpy(&sub, &f, sizeof(P));
+
+	u = (exp == 0u) ? sub : u;
+	u = (exp == expMask) ? u + ((128u - 16u) << 23) : u; // inf and nan
+	u |= (half & 0x8000u) << 16;
+	std::memcpy(&out, &u, sizeof(P));
+}
+
+// Keeps the upper 16 bits, rounds to nearest even.
+template<typename P>
+inline void floatToBf16(const P& value, Uint<P>& out) {
+	using L = Uint<P>;
+	L u;
+	std::memcpy(&u, &value, sizeof(P));
+	L rounded = (u + 0x7fffu + ((u >> 16) & 1u)) >> 16;
+	L quiet = (u >> 16) | 0x40u; // rounding might turn nan into infinity
+	out = ((u & 0x7fffffffu) > 0x7f800000u) ? quiet : rounded;
+}
+
+template<typename P>
+inline void bf16ToFloat(const Uint<P>& bf, P& out) {
+	Uint<P> u = bf << 16;
+	std::memcpy(&out, &u, sizeof(P));
+}
+
+// round(clamp(value, min, 1) * max), nan becomes 0.
+template<typename P>
+inline void floatToNorm(const P& value, float min, float max, Int<P>& out) {
+	P zero {};
+	P x = (value == value) ? value : zero;
+	x = (x > min) ? x : zero + min;
+	x = (x < 1.f) ? x : zero + 1.f;
+	fast::detail::roundToInt(x * max, out);
+}
+
+// max(value / max, min)
+template<typename P>
+inline void normToFloat(const Int<P>& value, float min, float max, P& out) {
+	fast::detail::toFloat(value, out);
+	out = out / max;
+	out = (out > min) ? out : P {} + min;
+}
+
+// Octahedral mapping, see "A Survey of Efficient Representations for
+// Independent Unit Vectors" by cigolle et al.
+template<typename P>
+inline void toOctahedral(const P& x, const P& y, const P& z, P& u, P& v) {
+	constexpr auto signBit = std::numeric_limits<std::int32_t>::min();
+	Int<P> xb, yb, zb;
+	toBits(x, xb);
+	toBits(y, yb);
+	toBits(z, zb);
+
+	// project onto the octahedron
+	P ax, ay, az;
+	fromBits(xb & ~signBit, ax);
+	fromBits(yb & ~signBit, ay);
+	fromBits(zb & ~signBit, az);
+	P sum = ax + ay + az;
+	sum = (sum > 0.f) ? sum : P {} + 1.f; // null vector
+	P px = x / sum;
+	P py = y / sum;
+
+	// fold the lower hemisphere over the diagonals
+	P sx, sy, fx, fy;
+	fromBits((xb & signBit) | 0x3f800000, sx); // copysign(1, x)
+	fromBits((yb & signBit) | 0x3f800000, sy);
+	fx = (1.f - ay / sum) * sx;
+	fy = (1.f - ax / sum) * sy;
+
+	auto lower = z < 0.f;
+	u = lower ? fx : px;
+	v = lower ? fy : py;
+}
+
+template<typename P>
+inline void fromOctahedral(const P& u, const P& v, P& x, P& y, P& z) {
+	constexpr auto signBit = std::numeric_limits<std::int32_t>::min();
+	Int<P> ub, vb;
+	toBits(u, ub);
+	toBits(v, vb);
+
+	P au, av;
+	fromBits(ub & ~signBit, au);
+	fromBits(vb & ~signBit, av);
+	z = 1.f - au - av;
+
+	// unfold the lower hemisphere: move towards the axes by -z
+	P t = (z < 0.f) ? -z : P {};
+	Int<P> tb;
+	toBits(t, tb);
+	P tu, tv;
+	fromBits(tb | (ub & signBit), tu);
+	fromBits(tb | (vb & signBit), tv);
+	x = u - tu;
+	y = v - tv;
+
+	P r;
+	fast::detail::rsqrt(x * x + y * y + z * z, r);
+	x = x * r;
+	y = y * r;
+	z = z * r;
+}
+
+} // namespace detail
+
+/// \brief IEEE 754 half precision float (binary16), meant for storage.
+/// Converts implicitly from and to float, rounding to nearest even.
+/// Values out of range become infinity, nan stays nan.
+/// Range: +-65504, 11 significant bits.
+class f16 {
+public:
+	f16() = default;
+	f16(float value) {
+		std::uint32_t b;
+		detail::floatToHalf(value, b);
+		bits = std::uint16_t(b);
+	}
+
+	operator float() const {
+		float ret;
+		detail::halfToFloat(std::uint32_t(bits), ret);
+		return ret;
+	}
+
+	std::uint16_t bits;
+};
+
+/// \brief Brain float, the upper 16 bits of a float, meant for storage.
+/// Has the range of float but only 8 significant bits.
+/// Converts implicitly from and to float, rounding to nearest even.
+class bf16 {
+public:
+	bf16() = default;
+	bf16(float value) {
+		std::uint32_t b;
+		detail::floatToBf16(value, b);
+		bits = std::uint16_t(b);
+	}
+
+	operator float() const {
+		float ret;
+		detail::bf16ToFloat(std::uint32_t(bits), ret);
+		return ret;
+	}
+
+	std::uint16_t bits;
+};
+
+/// \brief Normalized integer, maps [-1, 1] (signed I) or [0, 1] (unsigned I)
+/// to the full range of I, like the snorm and unorm formats of graphics apis.
+/// Converts implicitly from and to float, values out of range are clamped,
+/// rounds to nearest. Nan becomes 0.
+/// See the snorm8, snorm16, unorm8 and unorm16 typedefs.
+template<typename I>
+class Norm {
+public:
+	static_assert(std::is_integral_v<I> && sizeof(I) <= 2);
+	static constexpr float min = std::is_signed_v<I> ? -1.f : 0.f;
+	static constexpr float max = float(std::numeric_limits<I>::max());
+
+public:
+	Norm() = default;
+	Norm(float value) {
+		std::int32_t i;
+		detail::floatToNorm(value, min, max, i);
+		this->value = I(i);
+	}
+
+	operator float() const {
+		float ret;
+		detail::normToFloat(std::int32_t(value), min, max, ret);
+		return ret;
+	}
+
+	I value;
+};
+
+/// \brief Unit vector stored with the octahedral mapping in two snorm16 values.
+/// The angular error is below 7e-5 radians (0.004 degrees).
+/// The null vector is stored as (0, 0, 1).
+class Oct32 {
+public:
+	Oct32() = default;
+	explicit Oct32(const Vec3f& normal) {
+		float u, v;
+		detail::toOctahedral(normal.x, normal.y, normal.z, u, v);
+		x = u;
+		y = v;
+	}
+
+	/// Returns the stored unit vector.
+	explicit operator Vec3f() const {
+		Vec3f ret;
+		detail::fromOctahedral(float(x), float(y), ret.x, ret.y, ret.z);
+		return ret;
+	}
+
+	snorm16 x;
+	snorm16 y;
+};
+
+namespace detail {
+
+// Storage type of the packed type T. The values are converted in the
+// lanes Lanes<P> (with the layout of the float values P) and then
+// truncated to the storage type.
+template<typename T> struct PackedTraits;
+
+template<> struct PackedTraits<f16> {
+	using Storage = std::uint16_t;
+	template<typename P> using Lanes = Uint<P>;
+
+	template<typename P>
+	static void encode(const P& value, Lanes<P>& out) { floatToHalf(value, out); }
+	template<typename P>
+	static void decode(const Lanes<P>& value, P& out) { halfToFloat(value, out); }
+};
+
+template<> struct PackedTraits<bf16> {
+	using Storage = std::uint16_t;
+	template<typename P> using Lanes = Uint<P>;
+
+	template<typename P>
+	static void encode(const P& value, Lanes<P>& out) { floatToBf16(value, out); }
+	template<typename P>
+	static void decode(const Lanes<P>& value, P& out) { bf16ToFloat(value, out); }
+};
+
+template<typename I> struct PackedTraits<Norm<I>> {
+	using Storage = I;
+	template<typename P> using Lanes = Int<P>;
+
+	template<typename P>
+	static void encode(const P& value, Lanes<P>& out) {
+		floatToNorm(value, Norm<I>::min, Norm<I>::max, out);
+	}
+
+	template<typename P>
+	static void decode(const Lanes<P>& value, P& out) {
+		normToFloat(value, Norm<I>::min, Norm<I>::max, out);
+	}
+};
+
+// Compiled for multiple instruction sets, see nytl/dispatch.hpp.
+// Wider packs get split up since gcc does not use the avx512 mask
+// registers for the selects.
+template<typename T>
+struct PackKernel {
+	template<std::size_t Bytes>
+	static void run(const float* in, T* out, std::size_t count) {
+		static_assert(sizeof(T) == sizeof(typename PackedTraits<T>::Storage));
+		auto i = std::size_t(0);
+
+	#if NYTL_SIMD
+		constexpr auto n = std::min<std::size_t>(Bytes, 32) / sizeof(float);
+		if constexpr(n > 1) {
+			using Traits = PackedTraits<T>;
+			using P = simd::Pack<float, n>;
+			using S = simd::Pack<typename Traits::Storage, n>;
+			for(; i + n <= count; i += n) {
+				P values;
+				typename Traits::template Lanes<P> lanes;
+				simd::load(values, in + i);
+				Traits::encode(values, lanes);
+				S packed = __builtin_convertvector(lanes, S);
+				std::memcpy(out + i, &packed, sizeof(packed));
+			}
+		}
+	#endif // NYTL_SIMD
+
+		for(; i < count; ++i) {
+			out[i] = T(in[i]);
+		}
+	}
+};
+
+template<typename T>
+struct UnpackKernel {
+	template<std::size_t Bytes>
+	static void run(const T* in, float* out, std::size_t count) {
+		auto i = std::size_t(0);
+
+	#if NYTL_SIMD
+		constexpr auto n = std::min<std::size_t>(Bytes, 32) / sizeof(float);
+		if constexpr(n > 1) {
+			using Traits = PackedTraits<T>;
+			using P = simd::Pack<float, n>;
+			using L = typename Traits::template Lanes<P>;
+			using S = simd::Pack<typename Traits::Storage, n>;
+			for(; i + n <= count; i += n) {
+				S packed;
+				P values;
+				std::memcpy(&packed, in + i, sizeof(packed));
+				L lanes = __builtin_convertvector(packed, L);
+				Traits::decode(lanes, values);
+				simd::store(out + i, values);
+			}
+		}
+	#endif // NYTL_SIMD
+
+		for(; i < count; ++i) {
+			out[i] = float(in[i]);
+		}
+	}
+};
+
+// An Oct32 is handled as one int32 lane, x in the lower half.
+#if NYTL_SIMD
+	constexpr auto littleEndian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+#endif // NYTL_SIMD
+
+struct PackOctKernel {
+	template<std::size_t Bytes>
+	static void run(const Vec3f* in, Oct32* out, std::size_t count) {
+		static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec3 must be tightly packed");
+		auto i = std::size_t(0);
+
+	#if NYTL_SIMD
+		constexpr auto n = std::min<std::size_t>(Bytes, 32) / sizeof(float);
+		if constexpr(n > 1 && littleEndian) {
+			using P = simd::Pack<float, n>;
+			for(; i + n <= count; i += n) {
+				P x, y, z, u, v;
+				Int<P> iu, iv;
+				simd::deinterleave3<n>(&in[i].x, x, y, z);
+				toOctahedral(x, y, z, u, v);
+				floatToNorm(u, -1.f, 32767.f, iu);
+				floatToNorm(v, -1.f, 32767.f, iv);
+				Int<P> packed = (iu & 0xffff) | (iv << 16);
+				std::memcpy(out + i, &packed, sizeof(packed));
+			}
+		}
+	#endif // NYTL_SIMD
+
+		for(; i < count; ++i) {
+			out[i] = Oct32(in[i]);
+		}
+	}
+};
+
+struct UnpackOctKernel {
+	template<std::size_t Bytes>
+	static void run(const Oct32* in, Vec3f* out, std::size_t count) {
+		auto i = std::size_t(0);
+
+	#if NYTL_SIMD
+		constexpr auto n = std::min<std::size_t>(Bytes, 32) / sizeof(float);
+		if constexpr(n > 1 && littleEndian) {
+			using P = simd::Pack<float, n>;
+			for(; i + n <= count; i += n) {
+				Int<P> packed;
+				std::memcpy(&packed, in + i, sizeof(packed));
+				P x, y, z, u, v;
+				normToFloat((packed << 16) >> 16, -1.f, 32767.f, u);
+				normToFloat(packed >> 16, -1.f, 32767.f, v);
+				fromOctahedral(u, v, x, y, z);
+				simd::interleave3<n>(&out[i].x, x, y, z);
+			}
+		}
+	#endif // NYTL_SIMD
+
+		for(; i < count; ++i) {
+			out[i] = Vec3f(in[i]);
+		}
+	}
+};
+
+// Component type and count of the values of ranges passed to pack/unpack.
+template<typename V> struct Components {
+	using type = V;
+	static constexpr auto count = std::size_t(1);
+};
+
+template<std::size_t D, typename T> struct Components<Vec<D, T>> {
+	using type = T;
+	static constexpr auto count = D;
+};
+
+template<typename R>
+using RangeValue = std::remove_cv_t<std::remove_pointer_t<
+	decltype(std::data(std::declval<R&>()))>>;
+
+} // namespace detail
+
+/// \brief Converts float values to a packed type. in must be a range
+/// (e.g. Span, std::vector) of float, out a range of a packed type.
+/// Alternatively, in can contain Vec<D, float> and out Vec<D, T>
+/// or Vec3f and Oct32.
+/// Equivalent to (but much faster than) converting every value on its own.
+/// \requires out must have at least as many values as in.
+template<typename In, typename Out>
+void pack(const In& in, Out&& out) {
+	using I = detail::RangeValue<const In>;
+	using O = detail::RangeValue<Out>;
+	NYTL_EXPECTS(std::size_t(std::size(out)) >= std::size_t(std::size(in)));
+	if(std::size(in) == 0) {
+		return;
+	}
+
+	if constexpr(std::is_same_v<O, Oct32>) {
+		static_assert(std::is_same_v<I, Vec3f>, "Only Vec3f can be packed to Oct32");
+		using Sig = void(const Vec3f*, Oct32*, std::size_t);
+		Dispatch<detail::PackOctKernel, Sig>::call(std::data(in), std::data(out),
+			std::size(in));
+	} else {
+		using T = typename detail::Components<O>::type;
+		constexpr auto d = detail::Components<I>::count;
+		static_assert(std::is_same_v<typename detail::Components<I>::type, float>,
+			"Only float values can be packed");
+		static_assert(d == detail::Components<O>::count, "Dimensions don't match");
+		static_assert(sizeof(I) == d * sizeof(float) && sizeof(O) == d * sizeof(T),
+			"Vecs must be tightly packed");
+
+		using Sig = void(const float*, T*, std::size_t);
+		Dispatch<detail::PackKernel<T>, Sig>::call(
+			reinterpret_cast<const float*>(std::data(in)),
+			reinterpret_cast<T*>(std::data(out)), d * std::size(in));
+	}
+}
+
+/// \brief Reverses nytl::pack, i.e. converts the values of the range in
+/// (with a packed type) to float. See nytl::pack for the supported ranges.
+/// \requires out must have at least as many values as in.
+template<typename In, typename Out>
+void unpack(const In& in, Out&& out) {
+	using I = detail::RangeValue<const In>;
+	using O = detail::RangeValue<Out>;
+	NYTL_EXPECTS(std::size_t(std::size(out)) >= std::size_t(std::size(in)));
+	if(std::size(in) == 0) {
+		return;
+	}
+
+	if constexpr(std::is_same_v<I, Oct32>) {
+		static_assert(std::is_same_v<O, Vec3f>, "Oct32 can only be unpacked to Vec3f");
+		using Sig = void(const Oct32*, Vec3f*, std::size_t);
+		Dispatch<detail::UnpackOctKernel, Sig>::call(std::data(in), std::data(out),
+			std::size(in));
+	} else {
+		using T = typename detail::Components<I>::type;
+		constexpr auto d = detail::Components<I>::count;
+		static_assert(std::is_same_v<typename detail::Components<O>::type, float>,
+			"Values can only be unpacked to float");
+		static_assert(d == detail::Components<O>::count, "Dimensions don't match");
+		static_assert(sizeof(I) == d * sizeof(T) && sizeof(O) == d * sizeof(float),
+			"Vecs must be tightly packed");
+
+		using Sig = void(const T*, float*, std::size_t);
+		Dispatch<detail::UnpackKernel<T>, Sig>::call(
+			reinterpret_cast<const T*>(std::data(in)),
+			reinterpret_cast<float*>(std::data(out)), d * std::size(in));
+	}
+}
+
+} // namespace nytl
+
+#endif // header guard
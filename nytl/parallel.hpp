@@ -0,0 +1,266 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Bulk vec/mat algorithms that run on multiple threads.
+/// All algorithms take an execution policy and ranges (anything
+/// std::data and std::size work with, e.g. std::vector or nytl::Span).
+/// The input is split into chunks that are processed by the tasks of a
+/// TaskScheduler; the chunk size is tuned automatically by timing a first probe.
+/// The results do not depend on the number of threads or the chunk size.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_PARALLEL
+#define NYTL_INCLUDE_PARALLEL
+
+#include <nytl/tasks.hpp> // nytl::TaskScheduler
+#include <nytl/batchOps.hpp> // nytl::detail::batchTransform
+#include <nytl/vecOps.hpp> // nytl::normalize
+#include <nytl/matOps.hpp> // nytl::inverse
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+
+#include <algorithm> // std::min
+#include <atomic> // std::atomic
+#include <chrono> // std::chrono::steady_clock
+#include <exception> // std::exception_ptr
+#include <iterator> // std::data
+#include <mutex> // std::mutex
+#include <type_traits> // std::remove_pointer_t
+#include <vector> // std::vector
+
+namespace nytl::par {
+
+/// \brief Execution policy for the parallel algorithms.
+/// \module parallel
+struct Policy {
+	TaskScheduler* scheduler {}; // TaskScheduler::global() if null
+	std::size_t grain {}; // elements per chunk, tuned automatically if zero
+	unsigned maxThreads {}; // limits the number of used threads if not zero
+};
+
+/// Runs the algorithms on the calling thread.
+constexpr Policy seq {nullptr, 0, 1};
+
+/// Runs the algorithms on the global task scheduler with tuned chunk sizes.
+constexpr Policy par {};
+
+namespace detail {
+
+// Chunks should roughly take that long, long enough to make the
+// scheduling overhead negligible, short enough for load balancing
+constexpr auto targetChunkTime = std::chrono::microseconds(50);
+
+// The remaining work is not distributed if it takes less than that
+constexpr auto minParallelTime = std::chrono::microseconds(100);
+
+template<typename F>
+struct ChunkContext {
+	F* func;
+	std::atomic<std::size_t> next;
+	std::size_t end;
+	std::size_t grain;
+	std::atomic<bool> failed;
+	std::mutex mutex;
+	std::exception_ptr error;
+
+	void run() {
+		while(!failed.load(std::memory_order_relaxed)) {
+			auto begin = next.fetch_add(grain, std::memory_order_relaxed);
+			if(begin >= end) {
+				break;
+			}
+
+			try {
+				(*func)(begin, std::min(begin + grain, end));
+			} catch(...) {
+				std::lock_guard lock(mutex);
+				if(!error) {
+					error = std::current_exception();
+				}
+				failed.store(true);
+			}
+		}
+	}
+};
+
+/// Calls func(begin, end) for chunks covering [0, count) on multiple
+/// threads. Returns once all chunks were processed. Rethrows the first
+/// exception thrown by func, remaining chunks are then skipped.
+template<typename F>
+void forChunks(const Policy& policy, std::size_t count, F&& func) {
+	using Clock = std::chrono::steady_clock;
+
+	auto& scheduler = policy.scheduler ? *policy.scheduler : TaskScheduler::global();
+	auto threads = scheduler.concurrency();
+	if(policy.maxThreads && policy.maxThreads < threads) {
+		threads = policy.maxThreads;
+	}
+
+	if(threads <= 1 || count <= 1) {
+		func(std::size_t(0), count);
+		return;
+	}
+
+	auto begin = std::size_t(0);
+	auto grain = policy.grain;
+	if(!grain) {
+		// probe with growing chunks on the calling thread until
+		// the time per element can be measured reliably
+		auto probe = std::size_t(1);
+		auto time = Clock::duration {};
+		auto probeEnd = count / (4 * threads);
+		while(true) {
+			auto end = std::min(begin + probe, count);
+			auto start = Clock::now();
+			func(begin, end);
+			time += Clock::now() - start;
+			begin = end;
+			if(time >= targetChunkTime / 4 || begin >= probeEnd) {
+				break;
+			}
+			probe *= 2;
+		}
+
+		auto perElement = double(time.count()) / begin;
+		auto remaining = count - begin;
+		if(remaining * perElement < Clock::duration(minParallelTime).count()) {
+			func(begin, count);
+			return;
+		}
+
+		grain = std::size_t(Clock::duration(targetChunkTime).count() / perElement);
+		auto balanced = (remaining + 4 * threads - 1) / (4 * threads);
+		grain = std::max<std::size_t>(1, std::min(grain, balanced));
+	}
+
+	auto chunks = (count - begin + grain - 1) / grain;
+	auto jobs = unsigned(std::min<std::size_t>(threads - 1, chunks - 1));
+
+	using Func = std::remove_reference_t<F>;
+	ChunkContext<Func> ctx {&func, {begin}, count, grain, {false}, {}, {}};
+	{
+		// the tasks reference the context, the group waits for all of
+		// them (running other pending tasks in the meantime)
+		TaskGroup group(scheduler);
+		for(auto i = 0u; i < jobs; ++i) {
+			group.run([&ctx]{ ctx.run(); });
+		}
+
+		ctx.run();
+		group.wait();
+	}
+
+	if(ctx.error) {
+		std::rethrow_exception(ctx.error);
+	}
+}
+
+template<typename R>
+auto span(R& range) {
+	using T = std::remove_pointer_t<decltype(std::data(range))>;
+	return Span<T>(std::data(range), std::ptrdiff_t(std::size(range)));
+}
+
+} // namespace detail
+
+/// \brief Sets out[i] = func(in[i]) for all values of in.
+/// \requires out must have at least as many values as in.
+/// \module parallel
+template<typename In, typename Out, typename F>
+void transform(const Policy& policy, const In& in, Out&& out, F&& func) {
+	auto src = detail::span(in);
+	auto dst = detail::span(out);
+	NYTL_EXPECTS(dst.size() >= src.size());
+	detail::forChunks(policy, src.size(), [&](std::size_t begin, std::size_t end) {
+		for(auto i = begin; i < end; ++i) {
+			dst[i] = func(src[i]);
+		}
+	});
+}
+
+/// \brief Calls func(value) for all values of the given range.
+/// \module parallel
+template<typename R, typename F>
+void forEach(const Policy& policy, R&& range, F&& func) {
+	auto values = detail::span(range);
+	detail::forChunks(policy, values.size(), [&](std::size_t begin, std::size_t end) {
+		for(auto i = begin; i < end; ++i) {
+			func(values[i]);
+		}
+	});
+}
+
+/// \brief Normalizes all vectors of the given range in place.
+/// \throws std::domain_error if any vector has the length 0.
+/// \module parallel
+template<typename R>
+void normalize(const Policy& policy, R&& vecs) {
+	forEach(policy, vecs, [](auto& vec) { nytl::normalize(vec); });
+}
+
+/// \brief Stores the inverse of the matrices in in into out.
+/// Undefined behaviour for matrices that are not invertible.
+/// \requires out must have at least as many values as in.
+/// \module parallel
+template<typename In, typename Out>
+void inverse(const Policy& policy, const In& in, Out&& out) {
+	// nytl::inverse computes with double precision
+	using Mat = std::remove_reference_t<decltype(*std::data(out))>;
+	transform(policy, in, out, [](const auto& mat) {
+		return static_cast<Mat>(nytl::inverse(mat));
+	});
+}
+
+/// \brief Transforms the given points, see nytl::transformPoints.
+/// \requires out must have at least as many values as in.
+/// \module parallel
+template<std::size_t R, std::size_t C, typename T, typename In, typename Out>
+void transformPoints(const Policy& policy, const Mat<R, C, T>& m, const In& in, Out&& out) {
+	auto src = detail::span(in);
+	auto dst = detail::span(out);
+	NYTL_EXPECTS(dst.size() >= src.size());
+
+	auto bm = nytl::detail::batchMat(m, true);
+	detail::forChunks(policy, src.size(), [&](std::size_t begin, std::size_t end) {
+		nytl::detail::batchTransform<false>(bm, src.data() + begin, dst.data() + begin,
+			end - begin);
+	});
+}
+
+/// \brief Reduces the values of the given range, e.g. to compute the sum.
+/// The values are reduced in fixed blocks (each starting with init) whose results are
+/// reduced in order, the result is therefore deterministic even for floating point
+/// values. The operation must be associative, init its identity element.
+/// \module parallel
+template<typename R, typename T, typename Op>
+T reduce(const Policy& policy, const R& range, T init, Op&& op) {
+	constexpr auto blockSize = std::size_t(1024);
+	auto values = detail::span(range);
+	auto count = std::size_t(values.size());
+	auto blocks = (count + blockSize - 1) / blockSize;
+
+	std::vector<T> partials(blocks, init);
+	detail::forChunks(policy, blocks, [&](std::size_t begin, std::size_t end) {
+		for(auto b = begin; b < end; ++b) {
+			auto acc = init;
+			auto last = std::min(count, (b + 1) * blockSize);
+			for(auto i = b * blockSize; i < last; ++i) {
+				acc = op(acc, values[i]);
+			}
+			partials[b] = acc;
+		}
+	});
+
+	auto ret = init;
+	for(auto& partial : partials) {
+		ret = op(ret, partial);
+	}
+
+	return ret;
+}
+
+} // namespace nytl::par
+
+#endif // header guard
@@ -0,0 +1,520 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Value-semantic containers for polymorphic (nytl::Cloneable) objects.
+/// nytl::Poly holds a single object and stores small objects inline,
+/// nytl::PolyVector packs heterogeneous objects into one contiguous buffer.
+/// Both copy and relocate their objects using the memory resource overloads
+/// of nytl::clone and nytl::cloneMove, i.e. the base type must be
+/// (Abstract)Cloneable or (Abstract)CloneMovable (then they can only be moved).
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_POLY
+#define NYTL_INCLUDE_POLY
+
+#include <nytl/clone.hpp> // nytl::clone
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+
+#include <memory_resource> // std::pmr::memory_resource
+#include <type_traits> // std::is_base_of
+#include <typeinfo> // std::type_info
+#include <iterator> // std::forward_iterator_tag
+#include <algorithm> // std::max
+#include <utility> // std::as_const
+#include <vector> // std::vector
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uintptr_t
+#include <new> // ::operator new, std::launder
+
+namespace nytl {
+namespace detail {
+
+// Memory resource that hands out the given buffer if the requested
+// allocation fits into it and falls back to the upstream resource otherwise.
+// Meant to be used for a single allocation only.
+class BufferResource : public std::pmr::memory_resource {
+public:
+	BufferResource(void* buffer, std::size_t size, std::pmr::memory_resource& upstream)
+		: buffer_(buffer), size_(size), upstream_(&upstream) {}
+
+protected:
+	void* do_allocate(std::size_t size, std::size_t align) override {
+		if(size <= size_ && reinterpret_cast<std::uintptr_t>(buffer_) % align == 0) {
+			return buffer_;
+		}
+
+		return upstream_->allocate(size, align);
+	}
+
+	void do_deallocate(void* p, std::size_t size, std::size_t align) override {
+		if(p != buffer_) {
+			upstream_->deallocate(p, size, align);
+		}
+	}
+
+	bool do_is_equal(const memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+
+protected:
+	void* buffer_;
+	std::size_t size_;
+	std::pmr::memory_resource* upstream_;
+};
+
+template<typename Base, typename D>
+using EnableDerived = std::enable_if_t<std::is_base_of_v<Base, std::decay_t<D>>>;
+
+// Calls f with obj casted to the first of the given types that matches
+// the dynamic type of obj. Calls f with obj itself if there is none.
+template<typename... Ds, typename B, typename F>
+void polyVisit(const std::type_info& type, B& obj, F& f) {
+	auto found = ((type == typeid(Ds) ?
+		(f(static_cast<std::conditional_t<std::is_const_v<B>, const Ds&, Ds&>>(obj)),
+		true) : false) || ...);
+	if(!found) {
+		f(obj);
+	}
+}
+
+} // namespace detail
+
+/// \brief Polymorphic value type holding an object derived from Base.
+/// Copying a Poly clones the object, moving it uses nytl::cloneMove (or
+/// just takes over the heap allocation). Objects of at most InlineSize bytes
+/// (and at most the alignment of std::max_align_t) are stored inline,
+/// larger objects are allocated on the heap.
+/// Move constructors of the derived types are expected not to throw.
+/// \tparam Base The polymorphic base type, must be CloneMovable. Must be
+/// Cloneable for Poly to be copyable.
+/// \tparam InlineSize The size of the inline storage in bytes.
+/// \module utility
+template<typename Base, std::size_t InlineSize = 4 * sizeof(void*)>
+class Poly {
+public:
+	static constexpr auto inlineSize = InlineSize;
+
+	/// Whether an object of type D will be stored inline.
+	template<typename D>
+	static constexpr bool fitsInline = sizeof(D) <= InlineSize &&
+		alignof(D) <= alignof(std::max_align_t);
+
+public:
+	Poly() noexcept = default;
+	Poly(std::nullptr_t) noexcept {}
+	~Poly() { reset(); }
+
+	/// Copies or moves the given derived object into the Poly.
+	template<typename D, typename = detail::EnableDerived<Base, D>>
+	Poly(D&& obj) { emplace<std::decay_t<D>>(std::forward<D>(obj)); }
+
+	Poly(const Poly& other) {
+		if(other.object_) {
+			auto res = resource();
+			adopt(nytl::clone(*other.object_, res));
+		}
+	}
+
+	Poly& operator=(const Poly& other) {
+		if(this != &other) {
+			Poly copy(other);
+			reset();
+			moveFrom(copy);
+		}
+		return *this;
+	}
+
+	Poly(Poly&& other) noexcept { moveFrom(other); }
+	Poly& operator=(Poly&& other) noexcept {
+		if(this != &other) {
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	/// Destroys the current object and constructs a new object of type
+	/// D with the given arguments.
+	template<typename D, typename... Args>
+	D& emplace(Args&&... args) {
+		static_assert(std::is_base_of_v<Base, D>, "Type must be derived from Base");
+		reset();
+		auto res = resource();
+		memory_ = detail::constructInto<D>(res, std::forward<Args>(args)...);
+		auto obj = static_cast<D*>(memory_.object);
+		object_ = obj;
+		return *obj;
+	}
+
+	/// Destroys the current object, if any.
+	void reset() noexcept {
+		if(!object_) {
+			return;
+		}
+
+		object_->~Base();
+		if(!inlined()) {
+			std::pmr::new_delete_resource()->deallocate(memory_.object,
+				memory_.size, memory_.alignment);
+		}
+
+		object_ = nullptr;
+		memory_ = {};
+	}
+
+	/// Returns the object if its dynamic type is exactly D, nullptr otherwise.
+	/// Calls through the returned pointer don't have to be dispatched
+	/// virtually if D (or the called function) is final.
+	template<typename D> D* target() noexcept {
+		return (object_ && typeid(*object_) == typeid(D)) ?
+			static_cast<D*>(object_) : nullptr;
+	}
+
+	template<typename D> const D* target() const noexcept {
+		return (object_ && typeid(*object_) == typeid(D)) ?
+			static_cast<const D*>(object_) : nullptr;
+	}
+
+	/// Returns whether the object is stored in the inline storage.
+	bool inlined() const noexcept { return object_ && memory_.object == buffer_; }
+
+	Base* get() noexcept { return object_; }
+	const Base* get() const noexcept { return object_; }
+
+	Base* operator->() { NYTL_EXPECTS(object_); return object_; }
+	const Base* operator->() const { NYTL_EXPECTS(object_); return object_; }
+
+	Base& operator*() { NYTL_EXPECTS(object_); return *object_; }
+	const Base& operator*() const { NYTL_EXPECTS(object_); return *object_; }
+
+	explicit operator bool() const noexcept { return object_; }
+
+protected:
+	detail::BufferResource resource() noexcept {
+		return {buffer_, InlineSize, *std::pmr::new_delete_resource()};
+	}
+
+	void adopt(ResourcePtr<Base> ptr) noexcept {
+		memory_ = ptr.get_deleter().memory;
+		object_ = ptr.release();
+	}
+
+	// expects this to be empty
+	void moveFrom(Poly& other) noexcept {
+		if(!other.object_) {
+			return;
+		}
+
+		if(other.inlined()) {
+			auto res = resource();
+			adopt(nytl::cloneMove(*other.object_, res));
+			other.reset();
+		} else {
+			object_ = other.object_;
+			memory_ = other.memory_;
+			other.object_ = nullptr;
+			other.memory_ = {};
+		}
+	}
+
+protected:
+	Base* object_ {};
+	ClonedMemory memory_ {};
+	alignas(std::max_align_t) unsigned char buffer_[InlineSize];
+};
+
+/// \brief Sequence of heterogeneous objects derived from Base, stored
+/// contiguously in one buffer in insertion order.
+/// Iterating over a PolyVector touches a linear block of memory instead of
+/// following one heap pointer per element as a `vector<unique_ptr<Base>>` does.
+/// When the buffer grows, all objects are relocated using nytl::cloneMove,
+/// therefore references to elements are invalidated by insertion.
+/// Move constructors of the derived types are expected not to throw.
+/// The alignment of derived types must not exceed the one of std::max_align_t.
+/// \tparam Base The polymorphic base type, must be CloneMovable. Must be
+/// Cloneable for PolyVector to be copyable.
+/// \module utility
+template<typename Base>
+class PolyVector {
+protected:
+	struct Entry {
+		Base* object;
+		std::size_t offset; // of the derived object in the buffer
+		const std::type_info* type;
+	};
+
+public:
+	/// Forward iterator over the objects (as Base references).
+	template<typename B, typename E>
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Base;
+		using difference_type = std::ptrdiff_t;
+		using pointer = B*;
+		using reference = B&;
+
+	public:
+		Iterator() = default;
+		explicit Iterator(E* entry) : entry_(entry) {}
+
+		B& operator*() const { return *entry_->object; }
+		B* operator->() const { return entry_->object; }
+		Iterator& operator++() { ++entry_; return *this; }
+		Iterator operator++(int) { auto copy = *this; ++entry_; return copy; }
+		bool operator==(const Iterator& other) const { return entry_ == other.entry_; }
+		bool operator!=(const Iterator& other) const { return entry_ != other.entry_; }
+
+	protected:
+		E* entry_ {};
+	};
+
+	using iterator = Iterator<Base, Entry>;
+	using const_iterator = Iterator<const Base, const Entry>;
+
+public:
+	PolyVector() = default;
+	~PolyVector() { clear(); ::operator delete(data_); }
+
+	PolyVector(const PolyVector& other) {
+		if(other.entries_.empty()) {
+			return;
+		}
+
+		data_ = static_cast<unsigned char*>(::operator new(other.size_));
+		capacity_ = other.size_;
+		entries_.reserve(other.entries_.size());
+		try {
+			for(auto& entry : other.entries_) {
+				detail::BufferResource res(data_ + entry.offset, capacity_ - entry.offset,
+					*std::pmr::null_memory_resource());
+				auto copy = nytl::clone(static_cast<const Base&>(*entry.object), res);
+				entries_.push_back({copy.release(), entry.offset, entry.type});
+			}
+		} catch(...) {
+			clear();
+			::operator delete(data_);
+			throw;
+		}
+
+		size_ = other.size_;
+	}
+
+	PolyVector& operator=(const PolyVector& other) {
+		if(this != &other) {
+			PolyVector copy(other);
+			swap(*this, copy);
+		}
+		return *this;
+	}
+
+	PolyVector(PolyVector&& other) noexcept { swap(*this, other); }
+	PolyVector& operator=(PolyVector&& other) noexcept {
+		swap(*this, other);
+		return *this;
+	}
+
+	/// Constructs a new object of type D at the end of the vector.
+	template<typename D, typename... Args>
+	D& emplace_back(Args&&... args) {
+		static_assert(std::is_base_of_v<Base, D>, "Type must be derived from Base");
+		static_assert(alignof(D) <= alignof(std::max_align_t), "Invalid alignment");
+
+		auto offset = (size_ + alignof(D) - 1) & ~(alignof(D) - 1);
+		if(entries_.size() == entries_.capacity()) { // push_back below can't throw
+			entries_.reserve(std::max(std::size_t(1), 2 * entries_.capacity()));
+		}
+
+		auto data = data_;
+		auto capacity = capacity_;
+		auto grow = offset + sizeof(D) > capacity_;
+		if(grow) {
+			capacity = std::max(2 * capacity_, offset + sizeof(D));
+			capacity = std::max(capacity, std::size_t(256));
+			data = static_cast<unsigned char*>(::operator new(capacity));
+		}
+
+		// Construct the new object before relocating the old ones since
+		// args may reference them (e.g. when pushing a copy of an element).
+		D* obj;
+		try {
+			obj = new(data + offset) D(std::forward<Args>(args)...);
+		} catch(...) {
+			if(grow) {
+				::operator delete(data);
+			}
+			throw;
+		}
+
+		if(grow) {
+			try {
+				moveTo(data, capacity);
+			} catch(...) {
+				obj->~D();
+				::operator delete(data);
+				throw;
+			}
+			adopt(data, capacity);
+		}
+
+		entries_.push_back({obj, offset, &typeid(D)});
+		size_ = offset + sizeof(D);
+		return *obj;
+	}
+
+	/// Copies or moves the given derived object to the end of the vector.
+	template<typename D, typename = detail::EnableDerived<Base, D>>
+	std::decay_t<D>& push_back(D&& obj) {
+		return emplace_back<std::decay_t<D>>(std::forward<D>(obj));
+	}
+
+	/// Destroys the last object.
+	void pop_back() {
+		NYTL_EXPECTS(!entries_.empty());
+		entries_.back().object->~Base();
+		size_ = entries_.back().offset;
+		entries_.pop_back();
+	}
+
+	/// Destroys all objects. Keeps the allocated buffer.
+	void clear() noexcept {
+		for(auto& entry : entries_) {
+			entry.object->~Base();
+		}
+
+		entries_.clear();
+		size_ = 0;
+	}
+
+	/// Makes sure the buffer can hold the given number of bytes.
+	void reserve(std::size_t bytes) {
+		if(bytes > capacity_) {
+			relocate(bytes);
+		}
+	}
+
+	/// Calls f for every object. Objects whose dynamic type is exactly
+	/// one of Ds are passed as that type, i.e. f can call their functions
+	/// without virtual dispatch (if the types or functions are final).
+	/// All other objects are passed as Base&. The types are checked in order.
+	template<typename... Ds, typename F>
+	void forEach(F&& f) {
+		for(auto& entry : entries_) {
+			detail::polyVisit<Ds...>(*entry.type, *entry.object, f);
+		}
+	}
+
+	template<typename... Ds, typename F>
+	void forEach(F&& f) const {
+		for(auto& entry : entries_) {
+			detail::polyVisit<Ds...>(*entry.type, std::as_const(*entry.object), f);
+		}
+	}
+
+	/// Returns the dynamic type of the object with the given index.
+	const std::type_info& type(std::size_t i) const {
+		NYTL_EXPECTS(i < entries_.size());
+		return *entries_[i].type;
+	}
+
+	Base& operator[](std::size_t i) {
+		NYTL_EXPECTS(i < entries_.size());
+		return *entries_[i].object;
+	}
+
+	const Base& operator[](std::size_t i) const {
+		NYTL_EXPECTS(i < entries_.size());
+		return *entries_[i].object;
+	}
+
+	Base& back() { NYTL_EXPECTS(!empty()); return *entries_.back().object; }
+	const Base& back() const { NYTL_EXPECTS(!empty()); return *entries_.back().object; }
+
+	iterator begin() noexcept { return iterator(entries_.data()); }
+	iterator end() noexcept { return iterator(entries_.data() + entries_.size()); }
+	const_iterator begin() const noexcept { return const_iterator(entries_.data()); }
+	const_iterator end() const noexcept {
+		return const_iterator(entries_.data() + entries_.size());
+	}
+
+	std::size_t size() const noexcept { return entries_.size(); }
+	bool empty() const noexcept { return entries_.empty(); }
+
+	/// The number of bytes used/allocated in the buffer.
+	std::size_t bytes() const noexcept { return size_; }
+	std::size_t capacity() const noexcept { return capacity_; }
+
+	friend void swap(PolyVector& a, PolyVector& b) noexcept {
+		using std::swap;
+		swap(a.data_, b.data_);
+		swap(a.size_, b.size_);
+		swap(a.capacity_, b.capacity_);
+		swap(a.entries_, b.entries_);
+	}
+
+protected:
+	// Moves all objects into a new buffer of the given size. Since the
+	// buffers are aligned for std::max_align_t, objects keep their offsets.
+	void relocate(std::size_t capacity) {
+		auto data = static_cast<unsigned char*>(::operator new(capacity));
+		try {
+			moveTo(data, capacity);
+		} catch(...) {
+			::operator delete(data);
+			throw;
+		}
+
+		adopt(data, capacity);
+	}
+
+	// Move constructs all objects into data, at their offsets.
+	// If a move throws, the already moved objects are destroyed again.
+	void moveTo(unsigned char* data, std::size_t capacity) {
+		auto moved = std::size_t(0);
+		try {
+			for(; moved < entries_.size(); ++moved) {
+				auto& entry = entries_[moved];
+				detail::BufferResource res(data + entry.offset, capacity - entry.offset,
+					*std::pmr::null_memory_resource());
+				nytl::cloneMove(*entry.object, res).release();
+			}
+		} catch(...) {
+			for(auto i = 0u; i < moved; ++i) {
+				auto& entry = entries_[i];
+				object(data, entry)->~Base();
+			}
+			throw;
+		}
+	}
+
+	// Destroys the old objects and frees the old buffer after moveTo(data).
+	void adopt(unsigned char* data, std::size_t capacity) noexcept {
+		for(auto& entry : entries_) {
+			auto obj = object(data, entry);
+			entry.object->~Base();
+			entry.object = obj;
+		}
+
+		::operator delete(data_);
+		data_ = data;
+		capacity_ = capacity;
+	}
+
+	// Returns the Base subobject of the given entry's object relocated into data
+	Base* object(unsigned char* data, const Entry& entry) const noexcept {
+		auto base = reinterpret_cast<unsigned char*>(entry.object) - (data_ + entry.offset);
+		return std::launder(static_cast<Base*>(static_cast<void*>(data + entry.offset + base)));
+	}
+
+protected:
+	unsigned char* data_ {};
+	std::size_t size_ {};
+	std::size_t capacity_ {};
+	std::vector<Entry> entries_;
+};
+
+} // namespace nytl
+
+#endif // header guard
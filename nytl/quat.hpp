@@ -0,0 +1,214 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Defines the nytl::Quat quaternion template class and rotation operations.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_QUAT
+#define NYTL_INCLUDE_QUAT
+
+#include <nytl/vec.hpp> // nytl::Vec
+#include <nytl/mat.hpp> // nytl::Mat
+
+#include <cmath> // std::sqrt
+#include <stdexcept> // std::domain_error
+
+namespace nytl {
+
+/// \brief Quaternion, mainly used to represent rotations.
+/// Stores the imaginary part (x, y, z) before the real part w,
+/// default-constructs to the identity rotation.
+/// Only unit quaternions represent rotations, all rotation related functions
+/// expect (and return) normalized quaternions.
+/// \tparam T The value type, should be a floating point type.
+/// \module quat
+template<typename T>
+struct Quat {
+	using Value = T;
+
+	T x {0};
+	T y {0};
+	T z {0};
+	T w {1};
+};
+
+using Quatf = Quat<float>;
+using Quatd = Quat<double>;
+
+/// \brief Returns the quaternion rotating by 'angle' radians around
+/// the given axis (right-handed). The axis must be normalized.
+template<typename T>
+Quat<T> axisAngle(const Vec3<T>& axis, T angle) {
+	auto s = std::sin(angle / 2);
+	return {axis.x * s, axis.y * s, axis.z * s, std::cos(angle / 2)};
+}
+
+/// \brief Hamilton product. The returned rotation first applies b, then a.
+template<typename T>
+constexpr Quat<T> operator*(const Quat<T>& a, const Quat<T>& b) {
+	return {
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+	};
+}
+
+template<typename T>
+constexpr bool operator==(const Quat<T>& a, const Quat<T>& b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+template<typename T>
+constexpr bool operator!=(const Quat<T>& a, const Quat<T>& b) {
+	return !(a == b);
+}
+
+/// \brief Returns the 4-dimensional dot product of the given quaternions.
+template<typename T>
+constexpr T dot(const Quat<T>& a, const Quat<T>& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+/// \brief Returns the norm of the given quaternion.
+template<typename T>
+T length(const Quat<T>& q) {
+	return std::sqrt(dot(q, q));
+}
+
+/// \brief Returns the normalized quaternion.
+/// \throws std::domain_error if the quaternion has the length 0.
+template<typename T>
+Quat<T> normalized(const Quat<T>& q) {
+	auto l = length(q);
+	if(l == T {0.0}) {
+		throw std::domain_error("nytl::normalized: null quaternion given");
+	}
+
+	return {q.x / l, q.y / l, q.z / l, q.w / l};
+}
+
+/// \brief Returns the conjugate of the given quaternion.
+/// For unit quaternions, this is the inverse rotation.
+template<typename T>
+constexpr Quat<T> conjugate(const Quat<T>& q) {
+	return {-q.x, -q.y, -q.z, q.w};
+}
+
+/// \brief Returns the inverse of the given (not necessarily normalized) quaternion.
+template<typename T>
+constexpr Quat<T> inverse(const Quat<T>& q) {
+	auto n = dot(q, q);
+	return {-q.x / n, -q.y / n, -q.z / n, q.w / n};
+}
+
+/// \brief Rotates the given vector by the given unit quaternion.
+/// Cheaper than converting the quaternion to a matrix for single vectors.
+template<typename T>
+constexpr Vec3<T> apply(const Quat<T>& q, const Vec3<T>& v) {
+	// v + 2w(u x v) + 2(u x (u x v)) for u = (q.x, q.y, q.z)
+	Vec3<T> t {
+		2 * (q.y * v.z - q.z * v.y),
+		2 * (q.z * v.x - q.x * v.z),
+		2 * (q.x * v.y - q.y * v.x),
+	};
+
+	return {
+		v.x + q.w * t.x + (q.y * t.z - q.z * t.y),
+		v.y + q.w * t.y + (q.z * t.x - q.x * t.z),
+		v.z + q.w * t.z + (q.x * t.y - q.y * t.x),
+	};
+}
+
+/// \brief Spherical linear interpolation between the given unit quaternions.
+/// Always interpolates along the shorter arc.
+/// \param t The interpolation factor, 0 returns a, 1 returns b.
+template<typename T>
+Quat<T> slerp(const Quat<T>& a, Quat<T> b, T t) {
+	auto d = dot(a, b);
+	if(d < 0) {
+		b = {-b.x, -b.y, -b.z, -b.w};
+		d = -d;
+	}
+
+	// almost the same rotation: sin(theta) is too small, lerp is exact enough
+	T fa = 1 - t;
+	T fb = t;
+	if(d < T(0.9995)) {
+		auto theta = std::acos(d);
+		auto s = std::sin(theta);
+		fa = std::sin((1 - t) * theta) / s;
+		fb = std::sin(t * theta) / s;
+	}
+
+	return normalized(Quat<T> {
+		fa * a.x + fb * b.x,
+		fa * a.y + fb * b.y,
+		fa * a.z + fb * b.z,
+		fa * a.w + fb * b.w,
+	});
+}
+
+/// \brief Returns the rotation matrix for the given unit quaternion.
+/// The matrix rotates column vectors, i.e. `toMat3(q) * v == apply(q, v)`.
+template<typename T>
+constexpr Mat<3, 3, T> toMat3(const Quat<T>& q) {
+	auto xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	auto xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	auto wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	return {
+		1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy),
+		2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx),
+		2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy),
+	};
+}
+
+/// \brief Returns the homogeneous 4x4 rotation matrix for the given unit quaternion.
+template<typename T>
+constexpr Mat<4, 4, T> toMat4(const Quat<T>& q) {
+	auto m = toMat3(q);
+	return {
+		m[0][0], m[0][1], m[0][2], 0,
+		m[1][0], m[1][1], m[1][2], 0,
+		m[2][0], m[2][1], m[2][2], 0,
+		0, 0, 0, 1,
+	};
+}
+
+/// \brief Returns the unit quaternion for the rotation in the upper left
+/// 3x3 part of the given matrix. That part must be orthonormal.
+template<size_t D, typename T>
+Quat<T> toQuat(const Mat<D, D, T>& m) {
+	static_assert(D == 3 || D == 4, "nytl::toQuat: requires a 3x3 or 4x4 matrix");
+
+	// chooses the largest of the components as divisor
+	// for numerical stability (shepperd's method)
+	Quat<T> q;
+	auto trace = m[0][0] + m[1][1] + m[2][2];
+	if(trace > 0) {
+		auto s = std::sqrt(trace + 1) * 2;
+		q = {(m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s,
+			(m[1][0] - m[0][1]) / s, s / 4};
+	} else if(m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+		auto s = std::sqrt(1 + m[0][0] - m[1][1] - m[2][2]) * 2;
+		q = {s / 4, (m[0][1] + m[1][0]) / s,
+			(m[0][2] + m[2][0]) / s, (m[2][1] - m[1][2]) / s};
+	} else if(m[1][1] > m[2][2]) {
+		auto s = std::sqrt(1 + m[1][1] - m[0][0] - m[2][2]) * 2;
+		q = {(m[0][1] + m[1][0]) / s, s / 4,
+			(m[1][2] + m[2][1]) / s, (m[0][2] - m[2][0]) / s};
+	} else {
+		auto s = std::sqrt(1 + m[2][2] - m[0][0] - m[1][1]) * 2;
+		q = {(m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s,
+			s / 4, (m[1][0] - m[0][1]) / s};
+	}
+
+	return normalized(q);
+}
+
+} // namespace nytl
+
+#endif // header guard
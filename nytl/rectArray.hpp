@@ -0,0 +1,373 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Array of Rects in SoA layout for batched containment and intersection tests.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_RECT_ARRAY
+#define NYTL_INCLUDE_RECT_ARRAY
+
+#include <nytl/rect.hpp> // nytl::Rect
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/simd.hpp> // nytl::simd::Pack
+#include <nytl/dispatch.hpp> // nytl::Dispatch
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/math.hpp> // nytl::lowestBit
+
+#include <vector> // std::vector
+#include <cstdint> // std::uint64_t
+#include <algorithm> // std::max
+#include <limits> // std::numeric_limits
+
+namespace nytl {
+namespace detail {
+
+// Tests count boxes stored in SoA layout in data (for every axis the lower
+// bounds, then the upper bounds, each stride values) against the
+// query box q (D lower bounds, then D upper bounds).
+// Sets bit i of mask if box i overlaps the query box, touching included.
+// Writes (count + 63) / 64 words, count must be a multiple of 64 or the
+// data must be padded to one. Compiled for multiple instruction sets,
+// see nytl/dispatch.hpp.
+template<std::size_t D, typename T>
+struct RectOverlapKernel {
+	template<std::size_t Bytes>
+	static void run(const T* data, std::size_t stride, const T* q,
+			std::size_t count, std::uint64_t* mask) {
+		// gcc (at least up to 12) lowers comparisons of 64 byte packs to
+		// scalar code, use 32 byte packs for avx512 as well
+		constexpr auto bytes = Bytes > 32 ? 32 : Bytes;
+		constexpr auto n = NYTL_SIMD ? bytes / sizeof(T) : 0;
+		for(auto w = std::size_t(0); w * 64 < count; ++w) {
+			auto bits = std::uint64_t(0);
+			auto base = w * 64;
+
+		#if NYTL_SIMD
+			if constexpr(n > 1) {
+				using P = simd::Pack<T, n>;
+				P qmin[D], qmax[D];
+				for(auto a = 0u; a < D; ++a) {
+					simd::broadcast(qmin[a], q[a]);
+					simd::broadcast(qmax[a], q[D + a]);
+				}
+
+				for(auto l = 0u; l < 64; l += n) {
+					P min, max;
+					simd::load(min, data + base + l);
+					simd::load(max, data + stride + base + l);
+					auto hit = (min <= qmax[0]) & (qmin[0] <= max);
+					for(auto a = 1u; a < D; ++a) {
+						simd::load(min, data + 2 * a * stride + base + l);
+						simd::load(max, data + (2 * a + 1) * stride + base + l);
+						hit &= (min <= qmax[a]) & (qmin[a] <= max);
+					}
+
+					bits |= simd::bitmask(hit) << l;
+				}
+			}
+		#endif // NYTL_SIMD
+
+			if constexpr(n <= 1) {
+				for(auto l = 0u; l < 64; ++l) {
+					auto hit = true;
+					for(auto a = 0u; a < D; ++a) {
+						auto i = base + l;
+						hit &= data[2 * a * stride + i] <= q[D + a];
+						hit &= q[a] <= data[(2 * a + 1) * stride + i];
+					}
+
+					bits |= std::uint64_t(hit) << l;
+				}
+			}
+
+			mask[w] = bits;
+		}
+	}
+};
+
+} // namespace detail
+
+/// \brief Stores Rects in structure-of-arrays layout, i.e. the lower and upper
+/// bounds of every axis in separate arrays, for tests against many Rects at
+/// once (e.g. hit-testing a cursor against all widgets).
+/// The tests process multiple Rects per instruction (see nytl/simd.hpp and
+/// nytl/dispatch.hpp) and produce bitmasks or compacted index lists.
+/// All tests have the semantics of the respective function in nytl/rectOps.hpp,
+/// i.e. points on the outline are contained and touching Rects intersect.
+/// Note that only the bounds are stored, Rects returned from this array
+/// might therefore differ in the last bits from the inserted ones.
+/// \module rect
+template<std::size_t D, typename T>
+class RectArray {
+public:
+	using RectType = Rect<D, T>;
+	using Point = Vec<D, T>;
+
+	/// Storage is allocated in blocks of this many Rects, one word of a mask.
+	static constexpr std::size_t blockSize = 64;
+
+public:
+	RectArray() = default;
+
+	/// Copies the given rects.
+	explicit RectArray(Span<const RectType> rects) { assign(rects); }
+
+	/// Replaces the stored rects by the given ones.
+	void assign(Span<const RectType> rects);
+
+	/// Appends the given rect.
+	void push_back(const RectType& rect);
+
+	/// Replaces the rect with the given index.
+	void set(std::size_t i, const RectType& rect);
+
+	/// Returns the rect with the given index.
+	RectType operator[](std::size_t i) const;
+
+	/// Allocates storage for at least the given number of rects.
+	void reserve(std::size_t count);
+	void clear() { size_ = 0; }
+
+	std::size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	/// Returns the number of words of the masks for the current size.
+	std::size_t maskSize() const { return (size_ + blockSize - 1) / blockSize; }
+
+	/// Returns the lower or upper bounds of all rects on the given axis.
+	/// The returned arrays may be larger than size().
+	const T* min(std::size_t axis) const { return data_.data() + 2 * axis * stride_; }
+	const T* max(std::size_t axis) const { return data_.data() + (2 * axis + 1) * stride_; }
+
+	/// Sets bit i (i.e. bit i % 64 of word i / 64) of the given mask if rect i
+	/// contains the given point, see nytl::contains. Unused bits are cleared.
+	/// The mask must have at least maskSize() words.
+	void containsMask(const Point& point, Span<std::uint64_t> mask) const;
+	std::vector<std::uint64_t> containsMask(const Point& point) const;
+
+	/// Sets bit i of the given mask if rect i intersects the given rect,
+	/// see nytl::intersects and containsMask.
+	void intersectsMask(const RectType& rect, Span<std::uint64_t> mask) const;
+	std::vector<std::uint64_t> intersectsMask(const RectType& rect) const;
+
+	/// Appends the indices of all rects containing the given point to out.
+	/// Returns the number of appended indices.
+	std::size_t containsAll(const Point& point, std::vector<std::uint32_t>& out) const;
+
+	/// Appends the indices of all rects intersecting the given rect to out.
+	/// Returns the number of appended indices.
+	std::size_t intersectsAll(const RectType& rect, std::vector<std::uint32_t>& out) const;
+
+	/// Appends the indices of all rects intersecting the given rect to indices
+	/// and their intersections with the rect (see nytl::intersection) to rects.
+	/// Returns the number of appended intersections.
+	std::size_t intersectionAll(const RectType& rect, std::vector<std::uint32_t>& indices,
+		std::vector<RectType>& rects) const;
+
+protected:
+	// Tests the count rects starting at first (a multiple of blockSize)
+	// against the query box [qmin, qmax], writes the bits to mask.
+	void overlap(const Point& qmin, const Point& qmax, std::size_t first,
+		std::size_t count, std::uint64_t* mask) const;
+
+	// Returns the upper bounds of the given rect.
+	static Point upper(const RectType& rect);
+
+	// Appends the indices of all set bits in the first words of mask to out.
+	static std::size_t compact(const std::uint64_t* mask, std::size_t words,
+		std::vector<std::uint32_t>& out);
+
+	// Changes the stride to the given capacity, keeps the stored rects.
+	void relayout(std::size_t capacity);
+
+	// Number of mask words computed at once by the *All functions, bounds
+	// their scratch mask (on the stack).
+	static constexpr std::size_t chunkWords = 16;
+
+	std::vector<T> data_; // for every axis stride lower, then stride upper bounds
+	std::size_t stride_ {}; // capacity, multiple of blockSize
+	std::size_t size_ {};
+};
+
+// - implementation -
+template<std::size_t D, typename T>
+void RectArray<D, T>::assign(Span<const RectType> rects) {
+	size_ = 0;
+	reserve(rects.size());
+	for(auto& rect : rects) {
+		push_back(rect);
+	}
+}
+
+template<std::size_t D, typename T>
+void RectArray<D, T>::push_back(const RectType& rect) {
+	if(size_ == stride_) {
+		relayout(std::max(2 * stride_, blockSize));
+	}
+
+	set(size_++, rect);
+}
+
+template<std::size_t D, typename T>
+void RectArray<D, T>::set(std::size_t i, const RectType& rect) {
+	NYTL_EXPECTS(i < size_);
+	for(auto a = 0u; a < D; ++a) {
+		data_[2 * a * stride_ + i] = rect.position[a];
+		data_[(2 * a + 1) * stride_ + i] = T(rect.position[a] + rect.size[a]);
+	}
+}
+
+template<std::size_t D, typename T>
+Rect<D, T> RectArray<D, T>::operator[](std::size_t i) const {
+	NYTL_EXPECTS(i < size_);
+	RectType ret;
+	for(auto a = 0u; a < D; ++a) {
+		ret.position[a] = min(a)[i];
+		ret.size[a] = T(max(a)[i] - min(a)[i]);
+	}
+	return ret;
+}
+
+template<std::size_t D, typename T>
+void RectArray<D, T>::reserve(std::size_t count) {
+	if(count > stride_) {
+		relayout(((count + blockSize - 1) / blockSize) * blockSize);
+	}
+}
+
+template<std::size_t D, typename T>
+void RectArray<D, T>::relayout(std::size_t capacity) {
+	std::vector<T> data(2 * D * capacity);
+	for(auto c = 0u; c < 2 * D; ++c) {
+		auto src = data_.begin() + c * stride_;
+		std::copy(src, src + size_, data.begin() + c * capacity);
+	}
+
+	data_ = std::move(data);
+	stride_ = capacity;
+}
+
+template<std::size_t D, typename T>
+void RectArray<D, T>::overlap(const Point& qmin, const Point& qmax,
+		std::size_t first, std::size_t count, std::uint64_t* mask) const {
+	T q[2 * D];
+	for(auto a = 0u; a < D; ++a) {
+		q[a] = qmin[a];
+		q[D + a] = qmax[a];
+	}
+
+	using Kernel = detail::RectOverlapKernel<D, T>;
+	using Sig = void(const T*, std::size_t, const T*, std::size_t, std::uint64_t*);
+	Dispatch<Kernel, Sig>::call(data_.data() + first, stride_, q, count, mask);
+
+	// the padding is tested as well, may contain old rects
+	if(count % blockSize) {
+		mask[count / blockSize] &= (std::uint64_t(1) << (count % blockSize)) - 1;
+	}
+}
+
+template<std::size_t D, typename T>
+void RectArray<D, T>::containsMask(const Point& point, Span<std::uint64_t> mask) const {
+	NYTL_EXPECTS(std::size_t(mask.size()) >= maskSize());
+	overlap(point, point, 0, size_, mask.data());
+}
+
+template<std::size_t D, typename T>
+std::vector<std::uint64_t> RectArray<D, T>::containsMask(const Point& point) const {
+	std::vector<std::uint64_t> ret(maskSize());
+	overlap(point, point, 0, size_, ret.data());
+	return ret;
+}
+
+template<std::size_t D, typename T>
+void RectArray<D, T>::intersectsMask(const RectType& rect, Span<std::uint64_t> mask) const {
+	NYTL_EXPECTS(std::size_t(mask.size()) >= maskSize());
+	overlap(rect.position, upper(rect), 0, size_, mask.data());
+}
+
+template<std::size_t D, typename T>
+std::vector<std::uint64_t> RectArray<D, T>::intersectsMask(const RectType& rect) const {
+	std::vector<std::uint64_t> ret(maskSize());
+	overlap(rect.position, upper(rect), 0, size_, ret.data());
+	return ret;
+}
+
+template<std::size_t D, typename T>
+Vec<D, T> RectArray<D, T>::upper(const RectType& rect) {
+	Point ret;
+	for(auto a = 0u; a < D; ++a) {
+		ret[a] = T(rect.position[a] + rect.size[a]);
+	}
+	return ret;
+}
+
+template<std::size_t D, typename T>
+std::size_t RectArray<D, T>::compact(const std::uint64_t* mask, std::size_t words,
+		std::vector<std::uint32_t>& out) {
+	auto count = std::size_t(0);
+	for(auto w = std::size_t(0); w < words; ++w) {
+		for(auto bits = mask[w]; bits; bits &= bits - 1) {
+			out.push_back(std::uint32_t(w * blockSize + lowestBit(bits)));
+			++count;
+		}
+	}
+
+	return count;
+}
+
+template<std::size_t D, typename T>
+std::size_t RectArray<D, T>::containsAll(const Point& point,
+		std::vector<std::uint32_t>& out) const {
+	return intersectsAll({point, {}}, out);
+}
+
+template<std::size_t D, typename T>
+std::size_t RectArray<D, T>::intersectsAll(const RectType& rect,
+		std::vector<std::uint32_t>& out) const {
+	NYTL_EXPECTS(size_ <= std::numeric_limits<std::uint32_t>::max());
+
+	const auto qmax = upper(rect);
+	std::uint64_t mask[chunkWords];
+	auto count = std::size_t(0);
+	for(auto w = std::size_t(0); w < maskSize(); w += chunkWords) {
+		auto words = std::min(chunkWords, maskSize() - w);
+		auto first = w * blockSize;
+		overlap(rect.position, qmax, first, std::min(words * blockSize, size_ - first), mask);
+
+		auto start = out.size();
+		count += compact(mask, words, out);
+		for(auto i = start; i < out.size(); ++i) {
+			out[i] += std::uint32_t(first);
+		}
+	}
+
+	return count;
+}
+
+template<std::size_t D, typename T>
+std::size_t RectArray<D, T>::intersectionAll(const RectType& rect,
+		std::vector<std::uint32_t>& indices, std::vector<RectType>& rects) const {
+	auto start = indices.size();
+	auto count = intersectsAll(rect, indices);
+
+	const auto qmax = upper(rect);
+	for(auto i = start; i < indices.size(); ++i) {
+		auto id = indices[i];
+		RectType r;
+		for(auto a = 0u; a < D; ++a) {
+			auto pos = std::max<T>(min(a)[id], rect.position[a]);
+			auto end = std::min<T>(max(a)[id], qmax[a]);
+			r.position[a] = pos;
+			r.size[a] = T(end - pos);
+		}
+		rects.push_back(r);
+	}
+
+	return count;
+}
+
+} // namespace nytl
+
+#endif // header guard
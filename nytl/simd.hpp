@@ -0,0 +1,256 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Minimal wrapper around the gcc/clang vector extensions.
+/// Used by nytl internally to implement batched kernels; those
+/// provide a scalar fallback if NYTL_SIMD is 0. Can be set to 0 before
+/// including any nytl header to force the scalar implementations.
+/// No instruction set is hardcoded here: the compiler lowers packs to
+/// whatever the target supports (or splits them up).
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_SIMD
+#define NYTL_INCLUDE_SIMD
+
+#include <cstddef> // std::size_t
+#include <cstring> // std::memcpy
+#include <cstdint> // std::uint64_t
+#include <type_traits> // std::make_unsigned_t
+#include <utility> // std::index_sequence
+
+#ifndef NYTL_SIMD
+	#if defined(__GNUC__) || defined(__clang__)
+		#define NYTL_SIMD 1
+	#else
+		#define NYTL_SIMD 0
+	#endif
+#endif
+
+#if NYTL_SIMD
+
+namespace nytl::simd {
+namespace detail {
+	template<typename T, std::size_t N> struct PackT {
+		typedef T type __attribute__((vector_size(N * sizeof(T))));
+	};
+} // namespace detail
+
+/// The size of the widest vector registers the target is known to have.
+#if defined(__AVX__)
+	constexpr std::size_t registerBytes = 32;
+#else
+	constexpr std::size_t registerBytes = 16;
+#endif
+
+/// The number of values of type T fitting into one vector register.
+/// Kernels should not use wider packs with the functions returning packs:
+/// gcc warns about the ABI of functions returning packs wider than the
+/// target's registers. Kernels compiled for multiple instruction sets
+/// (see nytl/dispatch.hpp) only use the overloads taking references.
+template<typename T>
+constexpr std::size_t lanes = registerBytes / sizeof(T);
+
+/// Vector of N values of type T. Supports the usual arithmetic operators
+/// (also with a scalar operand) and indexing. Note that packs should not
+/// be used as template arguments since the attribute would be ignored.
+template<typename T, std::size_t N>
+using Pack = typename detail::PackT<T, N>::type;
+
+/// Loads N values from the given (not necessarily aligned) address.
+template<std::size_t N, typename T>
+inline Pack<T, N> load(const T* ptr) {
+	Pack<T, N> ret;
+	std::memcpy(&ret, ptr, sizeof(ret));
+	return ret;
+}
+
+/// Loads the values of the given pack from the given (not necessarily
+/// aligned) address.
+template<typename P, typename T>
+inline void load(P& pack, const T* ptr) {
+	std::memcpy(&pack, ptr, sizeof(pack));
+}
+
+/// Stores the given pack at the given (not necessarily aligned) address.
+template<typename T, typename P>
+inline void store(T* ptr, const P& pack) {
+	std::memcpy(ptr, &pack, sizeof(pack));
+}
+
+/// Returns a pack with all N values set to the given value.
+template<std::size_t N, typename T>
+inline Pack<T, N> broadcast(T value) {
+	return Pack<T, N> {} + value;
+}
+
+/// Sets all values of the given pack to the given value.
+template<typename P, typename T>
+inline void broadcast(P& pack, T value) {
+	pack = P {} + value;
+}
+
+/// Combines the values of the two given packs and stores them in out.
+/// The indices I refer to the concatenation of a and b, must have the
+/// size of the packs. `shuffle<0, 4, 1, 5>(out, a, b)` sets out
+/// to {a[0], b[0], a[1], b[1]}.
+template<int... I, typename P>
+inline void shuffle(P& out, const P& a, const P& b) {
+#if defined(__clang__) || __GNUC__ >= 12
+	out = __builtin_shufflevector(a, b, I...);
+#else
+	using Mask = decltype(a < b);
+	out = __builtin_shuffle(a, b, Mask {I...});
+#endif
+}
+
+/// Like shuffle(out, a, b), returns the result.
+template<int... I, typename P>
+inline P shuffle(const P& a, const P& b) {
+	P ret;
+	shuffle<I...>(ret, a, b);
+	return ret;
+}
+
+namespace detail {
+	// shuffle indices for deinterleave3: first combine a and b, then take
+	// the values located in c
+	constexpr int deinterleaveAB(std::size_t n, std::size_t comp, std::size_t lane) {
+		auto f = 3 * lane + comp;
+		return (f < 2 * n) ? int(f) : 0;
+	}
+
+	constexpr int deinterleaveC(std::size_t n, std::size_t comp, std::size_t lane) {
+		auto f = 3 * lane + comp;
+		return (f < 2 * n) ? int(lane) : int(n + f - 2 * n);
+	}
+
+	// shuffle indices for interleave3: first combine x and y, then insert z
+	constexpr int interleaveXY(std::size_t n, std::size_t pack, std::size_t lane) {
+		auto f = pack * n + lane;
+		return (f % 3 == 0) ? int(f / 3) : (f % 3 == 1) ? int(n + f / 3) : 0;
+	}
+
+	constexpr int interleaveZ(std::size_t n, std::size_t pack, std::size_t lane) {
+		auto f = pack * n + lane;
+		return (f % 3 == 2) ? int(n + f / 3) : int(lane);
+	}
+
+	template<std::size_t C, typename P, std::size_t... L>
+	inline void deinterleave(P& out, const P& a, const P& b, const P& c,
+			std::index_sequence<L...>) {
+		constexpr auto n = sizeof...(L);
+		P ab;
+		shuffle<deinterleaveAB(n, C, L)...>(ab, a, b);
+		shuffle<deinterleaveC(n, C, L)...>(out, ab, c);
+	}
+
+	// combines the lanes of v with bitwise or in log2(n) steps, the result
+	// is in the first lane
+	template<std::size_t S, typename P, std::size_t... L>
+	inline void orReduce(P& v, std::index_sequence<L...> seq) {
+		if constexpr(S > 0) {
+			P shifted;
+			shuffle<int(L + S)...>(shifted, v, v);
+			v |= shifted;
+			orReduce<S / 2>(v, seq);
+		}
+	}
+
+	template<std::size_t K, typename P, std::size_t... L>
+	inline void interleave(P& out, const P& x, const P& y, const P& z,
+			std::index_sequence<L...>) {
+		constexpr auto n = sizeof...(L);
+		P xy;
+		shuffle<interleaveXY(n, K, L)...>(xy, x, y);
+		shuffle<interleaveZ(n, K, L)...>(out, xy, z);
+	}
+} // namespace detail
+
+/// Returns the lanes of the given comparison result (e.g. `a < b`) as bits,
+/// bit i is set if lane i is set. The pack must have at most 64 lanes.
+/// Avoids extracting the lanes one by one, which is expensive for wide packs.
+template<typename M>
+inline std::uint64_t bitmask(const M& mask) {
+	using L = std::remove_cv_t<std::remove_reference_t<decltype(mask[0])>>;
+	using U = std::make_unsigned_t<L>;
+	constexpr auto n = sizeof(M) / sizeof(L);
+	static_assert(n <= 64, "Too many lanes for a bitmask");
+
+	auto ret = std::uint64_t(0);
+	if constexpr(n <= 8 * sizeof(L)) {
+		M bits;
+		for(auto i = 0u; i < n; ++i) {
+			bits[i] = L(U(1) << i);
+		}
+
+		bits &= mask;
+		detail::orReduce<n / 2>(bits, std::make_index_sequence<n> {});
+		ret = U(bits[0]);
+	} else {
+		for(auto i = 0u; i < n; ++i) {
+			ret |= std::uint64_t(mask[i] & 1) << i;
+		}
+	}
+
+	return ret;
+}
+
+/// Loads N 3-component values (e.g. Vec3 points) from the given address
+/// (3 * N values) and splits them into their components.
+template<std::size_t N, typename T>
+inline void deinterleave3(const T* ptr, Pack<T, N>& x, Pack<T, N>& y, Pack<T, N>& z) {
+	Pack<T, N> a, b, c;
+	load(a, ptr);
+	load(b, ptr + N);
+	load(c, ptr + 2 * N);
+
+	auto seq = std::make_index_sequence<N> {};
+	detail::deinterleave<0>(x, a, b, c, seq);
+	detail::deinterleave<1>(y, a, b, c, seq);
+	detail::deinterleave<2>(z, a, b, c, seq);
+}
+
+/// Loads N 9-component values (e.g. triangles made up of 3 Vec3 points) from
+/// the given address (9 * N values) and splits them into their components.
+/// Component k of the values is stored in out[k].
+template<std::size_t N, typename T>
+inline void deinterleave9(const T* ptr, Pack<T, N> (&out)[9]) {
+	// split the 3 * N points first, then the points by their index
+	Pack<T, N> x[3], y[3], z[3];
+	for(auto i = 0u; i < 3; ++i) {
+		deinterleave3<N>(ptr + 3 * N * i, x[i], y[i], z[i]);
+	}
+
+	auto seq = std::make_index_sequence<N> {};
+	detail::deinterleave<0>(out[0], x[0], x[1], x[2], seq);
+	detail::deinterleave<0>(out[1], y[0], y[1], y[2], seq);
+	detail::deinterleave<0>(out[2], z[0], z[1], z[2], seq);
+	detail::deinterleave<1>(out[3], x[0], x[1], x[2], seq);
+	detail::deinterleave<1>(out[4], y[0], y[1], y[2], seq);
+	detail::deinterleave<1>(out[5], z[0], z[1], z[2], seq);
+	detail::deinterleave<2>(out[6], x[0], x[1], x[2], seq);
+	detail::deinterleave<2>(out[7], y[0], y[1], y[2], seq);
+	detail::deinterleave<2>(out[8], z[0], z[1], z[2], seq);
+}
+
+/// Reverses deinterleave3, stores the N 3-component values
+/// to the given address (3 * N values).
+template<std::size_t N, typename T>
+inline void interleave3(T* ptr, const Pack<T, N>& x, const Pack<T, N>& y,
+		const Pack<T, N>& z) {
+	auto seq = std::make_index_sequence<N> {};
+	Pack<T, N> out;
+	detail::interleave<0>(out, x, y, z, seq);
+	store(ptr, out);
+	detail::interleave<1>(out, x, y, z, seq);
+	store(ptr + N, out);
+	detail::interleave<2>(out, x, y, z, seq);
+	store(ptr + 2 * N, out);
+}
+
+} // namespace nytl::simd
+
+#endif // NYTL_SIMD
+#endif // header guard
@@ -0,0 +1,412 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Geometric queries for Simplexes: barycentric coordinates, containment,
+/// closest points and (batched) ray-triangle intersection.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_SIMPLEX_OPS
+#define NYTL_INCLUDE_SIMPLEX_OPS
+
+#include <nytl/simplex.hpp> // nytl::Simplex
+#include <nytl/vecOps.hpp> // nytl::dot
+#include <nytl/mat.hpp> // nytl::Mat
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/simd.hpp> // nytl::simd::Pack
+#include <nytl/tmpUtil.hpp> // nytl::Identity
+
+#include <optional> // std::optional
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_same_v
+#include <cmath> // std::abs
+#include <utility> // std::swap
+
+namespace nytl {
+
+/// \brief Result of a ray-triangle intersection.
+/// The hit point is `origin + t * dir` or, equivalently,
+/// `(1 - uv.x - uv.y) * p0 + uv.x * p1 + uv.y * p2`.
+/// \module simplexOps
+template<typename P>
+struct RayHit {
+	P t {}; // distance along the ray, in units of the direction length
+	Vec2<P> uv {}; // barycentric coordinates of the 2nd and 3rd point
+	std::size_t index {}; // index of the hit triangle for batched queries
+};
+
+namespace detail {
+
+/// Solves the linear system m * x = b using gaussian elimination with
+/// partial pivoting. Returns non-finite values for singular systems.
+template<std::size_t N, typename P>
+constexpr Vec<N, P> solveLinear(Mat<N, N, P> m, Vec<N, P> b) {
+	for(auto c = 0u; c < N; ++c) {
+		auto pivot = c;
+		for(auto r = c + 1; r < N; ++r) {
+			if(std::abs(m[r][c]) > std::abs(m[pivot][c])) {
+				pivot = r;
+			}
+		}
+
+		if(pivot != c) {
+			std::swap(m[pivot], m[c]);
+			std::swap(b[pivot], b[c]);
+		}
+
+		for(auto r = c + 1; r < N; ++r) {
+			auto fac = m[r][c] / m[c][c];
+			for(auto k = c; k < N; ++k) {
+				m[r][k] -= fac * m[c][k];
+			}
+			b[r] -= fac * b[c];
+		}
+	}
+
+	Vec<N, P> x {};
+	for(auto i = N; i-- > 0; ) {
+		auto sum = b[i];
+		for(auto k = i + 1; k < N; ++k) {
+			sum -= m[i][k] * x[k];
+		}
+		x[i] = sum / m[i][i];
+	}
+
+	return x;
+}
+
+/// Möller-Trumbore intersection of a single triangle.
+template<typename P>
+bool intersectRay(const Triangle<3, P>& tri, const Vec3<P>& origin,
+		const Vec3<P>& dir, P maxT, RayHit<P>& hit) {
+	auto& p = tri.points_;
+	auto e1 = p[1] - p[0];
+	auto e2 = p[2] - p[0];
+	auto pv = cross(dir, e2);
+	auto det = dot(e1, pv);
+	if(det == 0) { // ray is parallel to the triangle plane
+		return false;
+	}
+
+	auto inv = 1 / det;
+	auto tv = origin - p[0];
+	auto u = dot(tv, pv) * inv;
+	if(!(u >= 0 && u <= 1)) {
+		return false;
+	}
+
+	auto qv = cross(tv, e1);
+	auto v = dot(dir, qv) * inv;
+	if(!(v >= 0 && u + v <= 1)) {
+		return false;
+	}
+
+	auto t = dot(e2, qv) * inv;
+	if(!(t >= 0 && t <= maxT)) {
+		return false;
+	}
+
+	hit.t = t;
+	hit.uv = {u, v};
+	return true;
+}
+
+/// Intersects a ray with count triangles.
+/// If Any is true, returns as soon as any hit is found, otherwise
+/// finds the closest hit. For equal distances, the lower index wins.
+template<bool Any, typename P>
+bool intersectRays(const Triangle<3, P>* tris, std::size_t count,
+		const Vec3<P>& origin, const Vec3<P>& dir, P maxT, RayHit<P>& hit) {
+	auto found = false;
+	hit.t = maxT;
+	auto i = std::size_t(0);
+
+#if NYTL_SIMD
+	if constexpr(std::is_same_v<P, float> || std::is_same_v<P, double>) {
+		static_assert(sizeof(Triangle<3, P>) == 9 * sizeof(P),
+			"Triangle must be tightly packed");
+
+		constexpr auto n = simd::lanes<P>;
+		using PT = simd::Pack<P, n>;
+
+		auto ox = simd::broadcast<n>(origin.x);
+		auto oy = simd::broadcast<n>(origin.y);
+		auto oz = simd::broadcast<n>(origin.z);
+		auto dx = simd::broadcast<n>(dir.x);
+		auto dy = simd::broadcast<n>(dir.y);
+		auto dz = simd::broadcast<n>(dir.z);
+
+		for(; i + n <= count; i += n) {
+			// transpose n triangles into 9 component packs
+			PT c[9];
+			simd::deinterleave9<n>(&tris[i].points_[0].x, c);
+
+			PT e1x = c[3] - c[0], e1y = c[4] - c[1], e1z = c[5] - c[2];
+			PT e2x = c[6] - c[0], e2y = c[7] - c[1], e2z = c[8] - c[2];
+			PT px = dy * e2z - dz * e2y;
+			PT py = dz * e2x - dx * e2z;
+			PT pz = dx * e2y - dy * e2x;
+
+			// a determinant of zero results in non-finite values
+			// that fail all comparisons below
+			PT inv = 1 / (e1x * px + e1y * py + e1z * pz);
+			PT tx = ox - c[0], ty = oy - c[1], tz = oz - c[2];
+			PT u = (tx * px + ty * py + tz * pz) * inv;
+			PT qx = ty * e1z - tz * e1y;
+			PT qy = tz * e1x - tx * e1z;
+			PT qz = tx * e1y - ty * e1x;
+			PT v = (dx * qx + dy * qy + dz * qz) * inv;
+			PT t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+
+			auto mask = (u >= 0) & (u <= 1) & (v >= 0) & (u + v <= 1) &
+				(t >= 0) & (t <= hit.t);
+
+			// hits are rare, only resolve them lane by lane
+			auto any = mask[0];
+			for(auto l = 1u; l < n; ++l) {
+				any |= mask[l];
+			}
+
+			if(!any) {
+				continue;
+			}
+
+			for(auto l = 0u; l < n; ++l) {
+				if(mask[l] && (!found || t[l] < hit.t)) {
+					found = true;
+					hit.t = t[l];
+					hit.uv = {u[l], v[l]};
+					hit.index = i + l;
+					if constexpr(Any) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+#endif // NYTL_SIMD
+
+	RayHit<P> current;
+	for(; i < count; ++i) {
+		if(intersectRay(tris[i], origin, dir, hit.t, current) &&
+				(!found || current.t < hit.t)) {
+			found = true;
+			hit.t = current.t;
+			hit.uv = current.uv;
+			hit.index = i;
+			if constexpr(Any) {
+				return true;
+			}
+		}
+	}
+
+	return found;
+}
+
+} // namespace detail
+
+/// \brief Returns the barycentric coordinates of the given point in the given simplex.
+/// The returned coordinates sum up to 1 and weight the points of the simplex.
+/// If the simplex has a lower dimension than the space (e.g. a triangle in 3D),
+/// the coordinates of the orthogonal projection of the point onto the
+/// affine hull of the simplex are returned.
+/// Degenerate simplexes result in non-finite coordinates.
+/// \module simplexOps
+template<std::size_t D, typename P, std::size_t A>
+constexpr Vec<A + 1, P> barycentric(const Simplex<D, P, A>& simplex,
+		const Vec<D, P>& point) {
+	static_assert(A > 0, "Barycentric coordinates need at least a line");
+
+	auto& p = simplex.points_;
+	auto diff = point - p[0];
+
+	Vec<A, P> coords {};
+	if constexpr(A == D) {
+		// solve the system given by the edges directly
+		Mat<D, D, P> edges {};
+		for(auto r = 0u; r < D; ++r) {
+			for(auto c = 0u; c < A; ++c) {
+				edges[r][c] = p[c + 1][r] - p[0][r];
+			}
+		}
+
+		coords = detail::solveLinear(edges, diff);
+	} else {
+		// least squares: solve the normal equations of the edge system
+		Mat<A, A, P> gram {};
+		Vec<A, P> rhs {};
+		for(auto i = 0u; i < A; ++i) {
+			auto ei = p[i + 1] - p[0];
+			rhs[i] = dot(ei, diff);
+			for(auto j = 0u; j < A; ++j) {
+				gram[i][j] = dot(ei, p[j + 1] - p[0]);
+			}
+		}
+
+		coords = detail::solveLinear(gram, rhs);
+	}
+
+	Vec<A + 1, P> ret {};
+	ret[0] = P(1);
+	for(auto i = 0u; i < A; ++i) {
+		ret[i + 1] = coords[i];
+		ret[0] -= coords[i];
+	}
+
+	return ret;
+}
+
+/// \brief Returns the point with the given barycentric coordinates in the given simplex.
+/// The reverse operation of nytl::barycentric.
+/// \module simplexOps
+template<std::size_t D, typename P, std::size_t A>
+constexpr Vec<D, P> world(const Simplex<D, P, A>& simplex, const Vec<A + 1, P>& coords) {
+	Vec<D, P> ret {};
+	for(auto i = 0u; i <= A; ++i) {
+		ret += coords[i] * simplex.points_[i];
+	}
+
+	return ret;
+}
+
+/// \brief Returns whether the given simplex contains the given point.
+/// Points on the boundary are contained.
+/// \param epsilon Tolerance for the barycentric coordinates and (if the simplex
+/// has a lower dimension than the space) the distance of the point to its
+/// projection onto the simplex, in world units.
+/// \module simplexOps
+template<std::size_t D, typename P, std::size_t A>
+constexpr bool contains(const Simplex<D, P, A>& simplex, const Vec<D, P>& point,
+		typename Identity<P>::type epsilon = P(1e-6)) {
+	auto coords = barycentric(simplex, point);
+	for(auto i = 0u; i <= A; ++i) {
+		if(!(coords[i] >= -epsilon)) {
+			return false;
+		}
+	}
+
+	if constexpr(A < D) {
+		auto diff = point - world(simplex, coords);
+		return dot(diff, diff) <= epsilon * epsilon;
+	}
+
+	return true;
+}
+
+/// \brief Returns the point in the given simplex closest to the given point.
+/// \module simplexOps
+template<std::size_t D, typename P, std::size_t A>
+constexpr Vec<D, P> closestPoint(const Simplex<D, P, A>& simplex, const Vec<D, P>& point) {
+	auto& p = simplex.points_;
+	if constexpr(A == 0) {
+		return p[0];
+	} else if constexpr(A == 1) {
+		auto edge = p[1] - p[0];
+		auto len = dot(edge, edge);
+		if(len == 0) {
+			return p[0];
+		}
+
+		auto t = dot(point - p[0], edge) / len;
+		t = (t < 0) ? P(0) : (t > 1) ? P(1) : t;
+		return p[0] + t * edge;
+	} else {
+		auto coords = barycentric(simplex, point);
+		auto inside = true;
+		for(auto i = 0u; i <= A; ++i) {
+			inside &= (coords[i] >= 0);
+		}
+
+		if(inside) {
+			return world(simplex, coords);
+		}
+
+		// The closest point lies on a facet opposite of a point with
+		// negative coordinate. Recursively query those facets.
+		auto best = p[0];
+		auto bestDist = std::numeric_limits<P>::infinity();
+		for(auto i = 0u; i <= A; ++i) {
+			if(coords[i] >= 0) {
+				continue;
+			}
+
+			Simplex<D, P, A - 1> facet {};
+			for(auto j = 0u, k = 0u; j <= A; ++j) {
+				if(j != i) {
+					facet.points_[k++] = p[j];
+				}
+			}
+
+			auto candidate = closestPoint(facet, point);
+			auto diff = point - candidate;
+			auto dist = dot(diff, diff);
+			if(dist < bestDist) {
+				best = candidate;
+				bestDist = dist;
+			}
+		}
+
+		return best;
+	}
+}
+
+/// \brief Intersects the given ray with the given triangle (Möller-Trumbore).
+/// Hits on both sides of the triangle are reported, rays parallel
+/// to the triangle never hit it.
+/// \param dir The direction of the ray, does not have to be normalized.
+/// \param maxT Only hits with t <= maxT are reported.
+/// \module simplexOps
+template<typename P>
+std::optional<RayHit<P>> intersectRay(const Triangle<3, P>& tri, const Vec3<P>& origin,
+		const Vec3<P>& dir, typename Identity<P>::type maxT = std::numeric_limits<P>::infinity()) {
+	RayHit<P> hit;
+	if(detail::intersectRay(tri, origin, dir, maxT, hit)) {
+		return hit;
+	}
+
+	return std::nullopt;
+}
+
+/// \brief Intersects the segment from a to b with the given triangle.
+/// The returned t is in range [0, 1].
+/// \module simplexOps
+template<typename P>
+std::optional<RayHit<P>> intersectSegment(const Triangle<3, P>& tri, const Vec3<P>& a,
+		const Vec3<P>& b) {
+	return intersectRay(tri, a, b - a, P(1));
+}
+
+/// \brief Returns the closest intersection of the given ray with any of the triangles.
+/// RayHit::index contains the index of the hit triangle. If multiple triangles are
+/// hit at the same distance, the one with the lowest index is returned.
+/// Uses vectorized kernels that test multiple triangles at once (see nytl/simd.hpp).
+/// \param maxT Only hits with t <= maxT are reported.
+/// \module simplexOps
+template<typename P>
+std::optional<RayHit<P>> closestHit(Span<const Triangle<3, typename Identity<P>::type>> tris,
+		const Vec3<P>& origin, const Vec3<P>& dir,
+		typename Identity<P>::type maxT = std::numeric_limits<P>::infinity()) {
+	RayHit<P> hit;
+	if(detail::intersectRays<false>(tris.data(), tris.size(), origin, dir, maxT, hit)) {
+		return hit;
+	}
+
+	return std::nullopt;
+}
+
+/// \brief Returns whether the given ray intersects any of the given triangles.
+/// Returns as soon as any hit is found, useful e.g. for shadow rays.
+/// \param maxT Only hits with t <= maxT are considered.
+/// \module simplexOps
+template<typename P>
+bool anyHit(Span<const Triangle<3, typename Identity<P>::type>> tris,
+		const Vec3<P>& origin, const Vec3<P>& dir,
+		typename Identity<P>::type maxT = std::numeric_limits<P>::infinity()) {
+	RayHit<P> hit;
+	return detail::intersectRays<true>(tris.data(), tris.size(), origin, dir, maxT, hit);
+}
+
+} // namespace nytl
+
+#endif // header guard
@@ -22,6 +22,7 @@
 #define NYTL_INCLUDE_SPAN
 
 #include <nytl/fwd/span.hpp>
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
 #include <algorithm> // for lexicographical_compare
 #include <array>     // for array
 #include <cstddef>   // for ptrdiff_t, size_t, nullptr_t
@@ -33,10 +34,6 @@
 
 namespace nytl {
 
-// TODO: can be used for debug output
-// makes more sense as macro (so we get line/file)
-inline void Expects(bool) {}
-
 // implementation details
 namespace details {
 
@@ -80,10 +77,10 @@ public:
 	constexpr extent_type(extent_type<Other> ext) {
 		static_assert(Other == Ext || Other == dynamic_extent,
 			"Mismatch between fixed-size extent and size of initializing data.");
-		Expects(ext.size() == Ext);
+		NYTL_EXPECTS(ext.size() == Ext);
 	}
 
-	constexpr extent_type(index_type size) { Expects(size == Ext); }
+	constexpr extent_type(index_type size) { NYTL_EXPECTS(size == Ext); }
 	constexpr index_type size() const noexcept { return Ext; }
 };
 
@@ -97,7 +94,7 @@ public:
 		: size_(ext.size()) {}
 
 	explicit constexpr extent_type(index_type size)
-		: size_(size) { Expects(size >= 0); }
+		: size_(size) { NYTL_EXPECTS(size >= 0); }
 	constexpr index_type size() const noexcept { return size_; }
 
 private:
@@ -111,6 +108,133 @@ struct calculate_subspan_type {
 	   : (Extent != dynamic_extent ? Extent - Offset : Extent)>;
 };
 
+#if NYTL_CONTRACTS != NYTL_CONTRACTS_OFF
+
+// Random access iterator that remembers the range it was created for and
+// checks all dereferences, arithmetic and comparisons against it.
+// Only used as span iterator when contracts are enabled, otherwise
+// spans just use raw pointers.
+template <class ElementType>
+class checked_iterator {
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = std::remove_cv_t<ElementType>;
+	using difference_type = std::ptrdiff_t;
+	using pointer = ElementType*;
+	using reference = ElementType&;
+
+	constexpr checked_iterator() noexcept = default;
+	constexpr checked_iterator(pointer begin, pointer end, pointer current) noexcept
+		: begin_(begin), end_(end), current_(current) {}
+
+	// iterator -> const_iterator conversion
+	template <class Other, class = std::enable_if_t<
+		is_allowed_element_type_conversion<Other, ElementType>::value>>
+	constexpr checked_iterator(const checked_iterator<Other>& other) noexcept
+		: begin_(other.begin_), end_(other.end_), current_(other.current_) {}
+
+	constexpr reference operator*() const {
+		NYTL_EXPECTS(begin_ <= current_ && current_ < end_);
+		return *current_;
+	}
+
+	constexpr pointer operator->() const {
+		NYTL_EXPECTS(begin_ <= current_ && current_ < end_);
+		return current_;
+	}
+
+	constexpr reference operator[](difference_type n) const {
+		return *(*this + n);
+	}
+
+	constexpr checked_iterator& operator++() {
+		NYTL_EXPECTS(current_ < end_);
+		++current_;
+		return *this;
+	}
+
+	constexpr checked_iterator operator++(int) {
+		auto ret = *this;
+		++(*this);
+		return ret;
+	}
+
+	constexpr checked_iterator& operator--() {
+		NYTL_EXPECTS(current_ > begin_);
+		--current_;
+		return *this;
+	}
+
+	constexpr checked_iterator operator--(int) {
+		auto ret = *this;
+		--(*this);
+		return ret;
+	}
+
+	constexpr checked_iterator& operator+=(difference_type n) {
+		NYTL_EXPECTS(n >= begin_ - current_ && n <= end_ - current_);
+		current_ += n;
+		return *this;
+	}
+
+	constexpr checked_iterator& operator-=(difference_type n) {
+		return *this += -n;
+	}
+
+	friend constexpr checked_iterator operator+(checked_iterator it, difference_type n) {
+		return it += n;
+	}
+
+	friend constexpr checked_iterator operator+(difference_type n, checked_iterator it) {
+		return it += n;
+	}
+
+	friend constexpr checked_iterator operator-(checked_iterator it, difference_type n) {
+		return it -= n;
+	}
+
+	friend constexpr difference_type operator-(const checked_iterator& a,
+			const checked_iterator& b) {
+		NYTL_EXPECTS(a.begin_ == b.begin_ && a.end_ == b.end_);
+		return a.current_ - b.current_;
+	}
+
+	friend constexpr bool operator==(const checked_iterator& a, const checked_iterator& b) {
+		NYTL_EXPECTS(a.begin_ == b.begin_ && a.end_ == b.end_);
+		return a.current_ == b.current_;
+	}
+
+	friend constexpr bool operator!=(const checked_iterator& a, const checked_iterator& b) {
+		return !(a == b);
+	}
+
+	friend constexpr bool operator<(const checked_iterator& a, const checked_iterator& b) {
+		NYTL_EXPECTS(a.begin_ == b.begin_ && a.end_ == b.end_);
+		return a.current_ < b.current_;
+	}
+
+	friend constexpr bool operator>(const checked_iterator& a, const checked_iterator& b) {
+		return b < a;
+	}
+
+	friend constexpr bool operator<=(const checked_iterator& a, const checked_iterator& b) {
+		return !(b < a);
+	}
+
+	friend constexpr bool operator>=(const checked_iterator& a, const checked_iterator& b) {
+		return !(a < b);
+	}
+
+private:
+	template <class Other> friend class checked_iterator;
+
+	pointer begin_ {};
+	pointer end_ {};
+	pointer current_ {};
+};
+
+#endif // NYTL_CONTRACTS != NYTL_CONTRACTS_OFF
+
 } // namespace details
 
 template <class ElementType, std::ptrdiff_t Extent>
@@ -123,8 +247,13 @@ public:
     using pointer = element_type*;
     using reference = element_type&;
 
+#if NYTL_CONTRACTS == NYTL_CONTRACTS_OFF
     using iterator = ElementType*;
     using const_iterator = const ElementType*;
+#else
+    using iterator = details::checked_iterator<ElementType>;
+    using const_iterator = details::checked_iterator<const ElementType>;
+#endif
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
@@ -198,25 +327,25 @@ public:
     // [span.sub], span subviews
     template <std::ptrdiff_t Count>
     constexpr span<element_type, Count> first() const {
-        Expects(Count >= 0 && Count <= size());
+        NYTL_EXPECTS(Count >= 0 && Count <= size());
         return {data(), Count};
     }
 
     template <std::ptrdiff_t Count>
     constexpr span<element_type, Count> last() const {
-        Expects(Count >= 0 && size() - Count >= 0);
+        NYTL_EXPECTS(Count >= 0 && size() - Count >= 0);
         return {data() + (size() - Count), Count};
     }
 
     template <std::ptrdiff_t Offset, std::ptrdiff_t Count = dynamic_extent>
     constexpr auto subspan() const -> typename details::calculate_subspan_type<ElementType, Extent, Offset, Count>::type {
-        Expects((Offset >= 0 && size() - Offset >= 0) &&
+        NYTL_EXPECTS((Offset >= 0 && size() - Offset >= 0) &&
                 (Count == dynamic_extent || (Count >= 0 && Offset + Count <= size())));
         return {data() + Offset, Count == dynamic_extent ? size() - Offset : Count};
     }
 
     constexpr span<element_type, dynamic_extent> first(index_type count) const {
-        Expects(count >= 0 && count <= size());
+        NYTL_EXPECTS(count >= 0 && count <= size());
         return {data(), count};
     }
 
@@ -236,7 +365,7 @@ public:
     }
     constexpr bool empty() const noexcept { return size() == 0; }
     constexpr reference operator[](index_type idx) const {
-        Expects(idx >= 0 && idx < storage_.size());
+        NYTL_EXPECTS(idx >= 0 && idx < storage_.size());
         return data()[idx];
     }
 
@@ -244,11 +373,11 @@ public:
     constexpr pointer data() const noexcept { return storage_.data(); }
 
     // [span.iter], span iterator support
-    constexpr iterator begin() const noexcept { return data(); }
-    constexpr iterator end() const noexcept { return data() + size(); }
+    constexpr iterator begin() const noexcept { return make_iterator<iterator>(0); }
+    constexpr iterator end() const noexcept { return make_iterator<iterator>(size()); }
 
-    constexpr const_iterator cbegin() const noexcept { return data(); }
-    constexpr const_iterator cend() const noexcept { return data() + size(); }
+    constexpr const_iterator cbegin() const noexcept { return make_iterator<const_iterator>(0); }
+    constexpr const_iterator cend() const noexcept { return make_iterator<const_iterator>(size()); }
 
     constexpr reverse_iterator rbegin() const noexcept { return reverse_iterator{end()}; }
     constexpr reverse_iterator rend() const noexcept { return reverse_iterator{begin()}; }
@@ -277,14 +406,14 @@ private:
         template <class OtherExtentType>
         constexpr storage_type(KnownNotNull data, OtherExtentType ext)
             	: ExtentType(ext), data_(data.p) {
-            Expects(ExtentType::size() >= 0);
+            NYTL_EXPECTS(ExtentType::size() >= 0);
         }
 
         template <class OtherExtentType>
         constexpr storage_type(pointer data, OtherExtentType ext)
 				: ExtentType(ext), data_(data) {
-            Expects(ExtentType::size() >= 0);
-            Expects(data || ExtentType::size() == 0);
+            NYTL_EXPECTS(ExtentType::size() >= 0);
+            NYTL_EXPECTS(data || ExtentType::size() == 0);
         }
 
         constexpr pointer data() const noexcept { return data_; }
@@ -295,6 +424,17 @@ private:
 
     storage_type<details::extent_type<Extent>> storage_;
 
+    // Returns an iterator to the element at the given offset.
+    // Checked iterators additionally know the range of this span.
+    template <class It>
+    constexpr It make_iterator(index_type offset) const noexcept {
+#if NYTL_CONTRACTS == NYTL_CONTRACTS_OFF
+        return data() + offset;
+#else
+        return {data(), data() + size(), data() + offset};
+#endif
+    }
+
     // The rest is needed to remove unnecessary null check
     // in subspans and constructors from arrays
     constexpr span(KnownNotNull ptr, index_type count) : storage_(ptr, count) {}
@@ -311,9 +451,9 @@ private:
 
     span<element_type, dynamic_extent> make_subspan(index_type offset, index_type count,
             subspan_selector<dynamic_extent>) const {
-        Expects(offset >= 0 && size() - offset >= 0);
+        NYTL_EXPECTS(offset >= 0 && size() - offset >= 0);
         if (count == dynamic_extent) { return {KnownNotNull{data() + offset}, size() - offset}; }
-        Expects(count >= 0 && size() - offset >= count);
+        NYTL_EXPECTS(count >= 0 && size() - offset >= count);
         return {KnownNotNull{data() + offset}, count};
     }
 };
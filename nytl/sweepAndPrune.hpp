@@ -0,0 +1,399 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Sweep and prune broadphase tracking the overlapping pairs of moving Rects.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_SWEEP_AND_PRUNE
+#define NYTL_INCLUDE_SWEEP_AND_PRUNE
+
+#include <nytl/rect.hpp> // nytl::Rect
+#include <nytl/callback.hpp> // nytl::Callback
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+#include <nytl/tasks.hpp> // nytl::TaskScheduler
+
+#include <vector> // std::vector
+#include <utility> // std::pair
+#include <algorithm> // std::sort
+#include <iterator> // std::back_inserter
+#include <cstdint> // std::uint32_t
+
+namespace nytl {
+
+/// \brief Tracks all pairs of overlapping Rects in a set of moving Rects,
+/// e.g. as broadphase for collision detection.
+/// The bounds of the rects are kept sorted per axis. For temporally coherent
+/// motion the arrays are nearly sorted on every update and insertion sort
+/// only swaps few bounds; the swapped lower and upper bounds of different rects
+/// are exactly the pairs that might have started or stopped overlapping.
+/// If too many bounds are swapped (e.g. after teleporting or inserting many
+/// rects), the arrays are sorted from scratch and all pairs are recomputed
+/// by sweeping along the first axis.
+/// Overlap has the semantics of nytl::intersects, i.e. touching rects overlap.
+/// Changes are applied by update, which reports the pairs that started or
+/// stopped overlapping through the onBegin and onEnd callbacks.
+/// Not thread-safe. Can not be copied or moved.
+/// \module rect
+template<std::size_t D, typename T>
+class SweepAndPrune {
+public:
+	using RectType = Rect<D, T>;
+	using Pair = std::pair<std::uint32_t, std::uint32_t>; // first < second
+
+	/// With at least this many rects, the axes are sorted in parallel tasks.
+	static constexpr std::size_t minParallelCount = 1024 * 32;
+
+	/// Called by update for every pair of rects that started or stopped
+	/// overlapping, with the lower id first. All pairs with an erased rect stop
+	/// overlapping on the update erasing it. Called after the state was updated,
+	/// the functions may insert, erase or set rects (applied on the next update).
+	Callback<void(std::uint32_t, std::uint32_t)> onBegin;
+	Callback<void(std::uint32_t, std::uint32_t)> onEnd;
+
+public:
+	SweepAndPrune() = default;
+
+	/// Adds the given rect and returns its id.
+	/// Ids of erased rects are reused after the next update.
+	std::uint32_t insert(const RectType& rect);
+
+	/// Removes the rect with the given id.
+	void erase(std::uint32_t id);
+
+	/// Changes the bounds of the rect with the given id.
+	void set(std::uint32_t id, const RectType& rect);
+
+	/// Returns the rect with the given id.
+	RectType rect(std::uint32_t id) const;
+
+	/// Applies all changes since the last update, calls onBegin
+	/// and onEnd for the changed pairs.
+	/// \param scheduler The axes of many rects are sorted concurrently
+	/// on its tasks, TaskScheduler::global() if null. Fewer rects are
+	/// always sorted on the calling thread. The results do not depend on it.
+	void update(TaskScheduler* scheduler = nullptr);
+
+	/// Returns all overlapping pairs (as of the last update), sorted.
+	const std::vector<Pair>& pairs() const { return pairs_; }
+
+	/// Returns whether the rects with the given ids overlapped on the last update.
+	bool overlapping(std::uint32_t a, std::uint32_t b) const;
+
+	/// Returns the number of rects.
+	std::size_t size() const { return size_; }
+
+protected:
+	struct Box {
+		Vec<D, T> min;
+		Vec<D, T> max;
+		bool alive;
+	};
+
+	struct Endpoint {
+		T value;
+		std::uint32_t data; // id << 1, lowest bit set for upper bounds
+	};
+
+	// lower bounds come first for equal values, touching rects overlap
+	static bool less(const Endpoint& a, const Endpoint& b) {
+		return a.value < b.value || (a.value == b.value && (a.data & 1) < (b.data & 1));
+	}
+
+	static Pair pair(std::uint32_t a, std::uint32_t b) {
+		return a < b ? Pair {a, b} : Pair {b, a};
+	}
+
+	// Whether the given boxes overlap on all axes starting with the given one.
+	static bool overlaps(const Box& a, const Box& b, unsigned first = 0);
+
+	// Whether the given rects overlapped on the last update.
+	// Faster than looking them up in pairs_.
+	bool overlapped(std::uint32_t a, std::uint32_t b) const {
+		return a < prev_.size() && b < prev_.size() && prev_[a].alive &&
+			prev_[b].alive && overlaps(prev_[a], prev_[b]);
+	}
+
+	// Updates and sorts the bounds on the given axis, records the swapped bounds
+	// of pairs that started or stopped overlapping in candidates_.
+	// Returns false if it gave up and sorted the bounds from scratch,
+	// the candidates are incomplete then.
+	bool sortAxis(unsigned axis);
+
+	// Appends all overlapping pairs to out (unsorted).
+	void sweep(std::vector<Pair>& out);
+
+	std::vector<Box> boxes_; // by id
+	std::vector<Box> prev_; // boxes_ as of the last update
+	std::vector<Endpoint> axes_[D]; // sorted bounds on every axis
+	std::vector<Pair> candidates_[D]; // changed pairs on the last update
+	std::vector<Pair> pairs_; // sorted
+	std::vector<std::uint32_t> added_; // since the last update
+	std::vector<std::uint32_t> erased_; // since the last update
+	std::vector<std::uint32_t> free_; // ids that can be reused
+	std::size_t size_ {};
+
+	// scratch storage, kept to avoid allocations
+	std::vector<Pair> began_, ended_, merged_;
+	std::vector<std::pair<Box, std::uint32_t>> active_; // copied, scanned linearly
+	std::vector<std::uint32_t> activePos_;
+};
+
+// - implementation -
+template<std::size_t D, typename T>
+std::uint32_t SweepAndPrune<D, T>::insert(const RectType& rect) {
+	std::uint32_t id;
+	if(!free_.empty()) {
+		id = free_.back();
+		free_.pop_back();
+	} else {
+		NYTL_EXPECTS(boxes_.size() < (std::uint32_t(1) << 31));
+		id = std::uint32_t(boxes_.size());
+		boxes_.emplace_back();
+	}
+
+	boxes_[id].alive = true;
+	set(id, rect);
+	added_.push_back(id);
+	++size_;
+	return id;
+}
+
+template<std::size_t D, typename T>
+void SweepAndPrune<D, T>::erase(std::uint32_t id) {
+	NYTL_EXPECTS(id < boxes_.size() && boxes_[id].alive);
+	boxes_[id].alive = false;
+	erased_.push_back(id);
+	--size_;
+}
+
+template<std::size_t D, typename T>
+void SweepAndPrune<D, T>::set(std::uint32_t id, const RectType& rect) {
+	NYTL_EXPECTS(id < boxes_.size() && boxes_[id].alive);
+	auto& box = boxes_[id];
+	for(auto a = 0u; a < D; ++a) {
+		box.min[a] = rect.position[a];
+		box.max[a] = rect.position[a] + rect.size[a];
+	}
+}
+
+template<std::size_t D, typename T>
+Rect<D, T> SweepAndPrune<D, T>::rect(std::uint32_t id) const {
+	NYTL_EXPECTS(id < boxes_.size() && boxes_[id].alive);
+	auto& box = boxes_[id];
+	RectType ret;
+	for(auto a = 0u; a < D; ++a) {
+		ret.position[a] = box.min[a];
+		ret.size[a] = box.max[a] - box.min[a];
+	}
+	return ret;
+}
+
+template<std::size_t D, typename T>
+bool SweepAndPrune<D, T>::overlapping(std::uint32_t a, std::uint32_t b) const {
+	return std::binary_search(pairs_.begin(), pairs_.end(), pair(a, b));
+}
+
+template<std::size_t D, typename T>
+bool SweepAndPrune<D, T>::overlaps(const Box& a, const Box& b, unsigned first) {
+	for(auto i = first; i < D; ++i) {
+		if(a.min[i] > b.max[i] || b.min[i] > a.max[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template<std::size_t D, typename T>
+bool SweepAndPrune<D, T>::sortAxis(unsigned axis) {
+	auto& ends = axes_[axis];
+	auto& candidates = candidates_[axis];
+	candidates.clear();
+
+	if(!erased_.empty()) {
+		auto dead = [&](const Endpoint& e) { return !boxes_[e.data >> 1].alive; };
+		ends.erase(std::remove_if(ends.begin(), ends.end(), dead), ends.end());
+	}
+
+	// the boxes are accessed in random order, prefetching hides most misses
+	for(auto i = std::size_t(0); i < ends.size(); ++i) {
+#if defined(__GNUC__)
+		constexpr auto prefetch = 16u;
+		if(i + prefetch < ends.size()) {
+			__builtin_prefetch(&boxes_[ends[i + prefetch].data >> 1]);
+		}
+#endif
+
+		auto& e = ends[i];
+		auto& box = boxes_[e.data >> 1];
+		e.value = (e.data & 1) ? box.max[axis] : box.min[axis];
+	}
+
+	// new rects are appended, i.e. start out behind all others
+	for(auto id : added_) {
+		auto& box = boxes_[id];
+		if(box.alive) {
+			ends.push_back({box.min[axis], id << 1});
+			ends.push_back({box.max[axis], (id << 1) | 1});
+		}
+	}
+
+	// insertion sort gets slower than sorting from scratch and sweeping when
+	// the bounds moved far. Includes moving the appended bounds to their place
+	auto maxSwaps = 16 * ends.size() + 64;
+	auto swaps = std::size_t(0);
+	for(auto i = std::size_t(1); i < ends.size(); ++i) {
+		auto e = ends[i];
+		auto j = i;
+		for(; j > 0 && less(e, ends[j - 1]); --j) {
+			auto& prev = ends[j - 1];
+			auto a = e.data >> 1;
+			auto b = prev.data >> 1;
+			if((e.data & 1) != (prev.data & 1) && a != b) {
+				// a lower bound moving before an upper bound: the rects start
+				// overlapping if they do on all axes now. Otherwise they stop
+				// overlapping if they did before
+				auto changed = (e.data & 1) ?
+					overlapped(a, b) :
+					overlaps(boxes_[a], boxes_[b]);
+				if(changed) {
+					candidates.push_back(pair(a, b));
+				}
+			}
+
+			ends[j] = prev;
+			if(++swaps > maxSwaps) {
+				ends[j - 1] = e;
+				std::sort(ends.begin(), ends.end(), less);
+				return false;
+			}
+		}
+
+		ends[j] = e;
+	}
+
+	return true;
+}
+
+template<std::size_t D, typename T>
+void SweepAndPrune<D, T>::sweep(std::vector<Pair>& out) {
+	active_.clear();
+	activePos_.resize(boxes_.size());
+	for(auto& e : axes_[0]) {
+		auto id = e.data >> 1;
+		if(e.data & 1) {
+			auto pos = activePos_[id];
+			active_[pos] = active_.back();
+			activePos_[active_[pos].second] = pos;
+			active_.pop_back();
+			continue;
+		}
+
+		// overlapping on the first axis since its lower bound is before ours
+		// and its upper bound not yet reached
+		auto& box = boxes_[id];
+		for(auto& other : active_) {
+			if(overlaps(box, other.first, 1)) {
+				out.push_back(pair(id, other.second));
+			}
+		}
+
+		activePos_[id] = std::uint32_t(active_.size());
+		active_.push_back({box, id});
+	}
+}
+
+template<std::size_t D, typename T>
+void SweepAndPrune<D, T>::update(TaskScheduler* scheduler) {
+	began_.clear();
+	ended_.clear();
+
+	// all pairs of erased rects end
+	if(!erased_.empty()) {
+		auto dead = [&](const Pair& p) {
+			return !boxes_[p.first].alive || !boxes_[p.second].alive;
+		};
+		std::copy_if(pairs_.begin(), pairs_.end(), std::back_inserter(ended_), dead);
+		pairs_.erase(std::remove_if(pairs_.begin(), pairs_.end(), dead), pairs_.end());
+	}
+
+	// the axes are independent, sort them concurrently
+	// (only many rects, don't start the global scheduler otherwise)
+	bool incremental[D];
+	auto count = axes_[0].size() / 2 + added_.size();
+	auto parallel = D > 1 && count >= minParallelCount;
+	if(parallel && !scheduler) {
+		scheduler = &TaskScheduler::global();
+	}
+
+	if(parallel && scheduler->concurrency() > 1) {
+		TaskGroup group(*scheduler);
+		for(auto a = 1u; a < D; ++a) {
+			group.run([&, a]{ incremental[a] = sortAxis(a); });
+		}
+
+		incremental[0] = sortAxis(0);
+		group.wait();
+	} else {
+		for(auto a = 0u; a < D; ++a) {
+			incremental[a] = sortAxis(a);
+		}
+	}
+
+	free_.insert(free_.end(), erased_.begin(), erased_.end());
+	erased_.clear();
+	added_.clear();
+
+	// collect the pairs that changed
+	auto all = std::all_of(incremental, incremental + D, [](bool b) { return b; });
+	if(all) {
+		auto& candidates = candidates_[0];
+		for(auto a = 1u; a < D; ++a) {
+			candidates.insert(candidates.end(), candidates_[a].begin(), candidates_[a].end());
+		}
+
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()),
+			candidates.end());
+
+		auto oldEnded = ended_.size();
+		for(auto& c : candidates) {
+			auto now = overlaps(boxes_[c.first], boxes_[c.second]);
+			if(now != overlapped(c.first, c.second)) {
+				(now ? began_ : ended_).push_back(c);
+			}
+		}
+
+		// pairs_ without the ended, merged with the began pairs
+		merged_.clear();
+		std::set_difference(pairs_.begin(), pairs_.end(),
+			ended_.begin() + oldEnded, ended_.end(), std::back_inserter(merged_));
+		pairs_.clear();
+		std::merge(merged_.begin(), merged_.end(), began_.begin(), began_.end(),
+			std::back_inserter(pairs_));
+	} else {
+		merged_.clear();
+		sweep(merged_);
+		std::sort(merged_.begin(), merged_.end());
+		std::set_difference(pairs_.begin(), pairs_.end(), merged_.begin(), merged_.end(),
+			std::back_inserter(ended_));
+		std::set_difference(merged_.begin(), merged_.end(), pairs_.begin(), pairs_.end(),
+			std::back_inserter(began_));
+		pairs_.swap(merged_);
+	}
+
+	prev_ = boxes_;
+
+	for(auto& p : ended_) {
+		onEnd(p.first, p.second);
+	}
+
+	for(auto& p : began_) {
+		onBegin(p.first, p.second);
+	}
+}
+
+} // namespace nytl
+
+#endif // header guard
@@ -0,0 +1,943 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Work-stealing task scheduler with task groups, task graphs and
+/// parallelFor/parallelReduce built on top of it.
+/// Every worker owns a Chase-Lev deque: it pushes and pops tasks at the
+/// bottom while idle threads steal from the top, so the common
+/// fork/join case does not need any locks. Tasks live in pooled fixed-size
+/// slots with inline storage for the callable, spawning a task therefore
+/// does not allocate (unless the callable is larger than taskStorageSize).
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_TASKS
+#define NYTL_INCLUDE_TASKS
+
+#include <nytl/callback.hpp> // nytl::Callback
+#include <nytl/nonCopyable.hpp> // nytl::NonMovable
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
+
+#include <algorithm> // std::min
+#include <atomic> // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstddef> // std::size_t
+#include <cstdint> // std::int64_t
+#include <exception> // std::exception_ptr
+#include <functional> // std::function
+#include <memory> // std::unique_ptr
+#include <mutex> // std::mutex
+#include <new> // std::launder
+#include <stdexcept> // std::logic_error
+#include <thread> // std::thread
+#include <type_traits> // std::decay_t
+#include <utility> // std::forward
+#include <vector> // std::vector
+
+namespace nytl {
+
+/// Callables up to this size are stored inline in the pooled tasks.
+constexpr std::size_t taskStorageSize = 96;
+
+namespace detail {
+
+struct Task;
+using TaskFunc = void (*)(Task&) noexcept;
+
+// Pooled task slot. run executes and destroys the stored callable.
+struct alignas(64) Task {
+	TaskFunc run {};
+	Task* next {}; // free list or injection queue
+	Task* prev {}; // injection queue
+	alignas(std::max_align_t) unsigned char storage[taskStorageSize];
+};
+
+template<typename T>
+constexpr bool fitsTask = sizeof(T) <= taskStorageSize &&
+	alignof(T) <= alignof(std::max_align_t);
+
+template<typename T>
+T& taskData(Task& task) {
+	auto ptr = static_cast<void*>(task.storage);
+	if constexpr(fitsTask<T>) {
+		return *std::launder(static_cast<T*>(ptr));
+	} else {
+		return **std::launder(static_cast<T**>(ptr));
+	}
+}
+
+template<typename T, typename... Args>
+void emplaceTask(Task& task, Args&&... args) {
+	if constexpr(fitsTask<T>) {
+		new(task.storage) T{std::forward<Args>(args)...};
+	} else {
+		new(task.storage) T*(new T{std::forward<Args>(args)...});
+	}
+}
+
+template<typename T>
+void destroyTask(Task& task) {
+	if constexpr(fitsTask<T>) {
+		taskData<T>(task).~T();
+	} else {
+		delete &taskData<T>(task);
+	}
+}
+
+/// Fixed-capacity Chase-Lev deque, see "Correct and Efficient Work-Stealing
+/// for Weak Memory Models" (Lê et al., 2013).
+/// Only the owning thread may call push and pop, steal can be called
+/// from any thread.
+class TaskDeque {
+public:
+	static constexpr std::int64_t capacity = 4096;
+
+	/// Returns false if the deque is full.
+	bool push(Task* task) {
+		auto b = bottom_.load(std::memory_order_relaxed);
+		auto t = top_.load(std::memory_order_acquire);
+		if(b - t >= capacity) {
+			return false;
+		}
+
+		tasks_[b & (capacity - 1)].store(task, std::memory_order_relaxed);
+		bottom_.store(b + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Returns the most recently pushed task or nullptr.
+	Task* pop() {
+		auto b = bottom_.load(std::memory_order_relaxed) - 1;
+		bottom_.store(b, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto t = top_.load(std::memory_order_relaxed);
+		if(t > b) {
+			bottom_.store(b + 1, std::memory_order_release);
+			return nullptr;
+		}
+
+		auto task = tasks_[b & (capacity - 1)].load(std::memory_order_relaxed);
+		if(t == b) {
+			// last task, might race with a thief
+			if(!top_.compare_exchange_strong(t, t + 1,
+					std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				task = nullptr;
+			}
+			bottom_.store(b + 1, std::memory_order_release);
+		}
+
+		return task;
+	}
+
+	/// Returns the oldest task or nullptr if the deque is empty or
+	/// another thread was faster.
+	Task* steal() {
+		auto t = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto b = bottom_.load(std::memory_order_acquire);
+		if(t >= b) {
+			return nullptr;
+		}
+
+		auto task = tasks_[t & (capacity - 1)].load(std::memory_order_relaxed);
+		if(!top_.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+
+		return task;
+	}
+
+	bool empty() const {
+		return bottom_.load(std::memory_order_acquire) <=
+			top_.load(std::memory_order_acquire);
+	}
+
+protected:
+	alignas(64) std::atomic<std::int64_t> top_ {0};
+	alignas(64) std::atomic<std::int64_t> bottom_ {0};
+	alignas(64) std::atomic<Task*> tasks_[capacity] {};
+};
+
+} // namespace detail
+
+/// \brief Work-stealing task scheduler.
+/// Tasks spawned from a worker thread are pushed to the worker's own deque,
+/// the worker runs them in LIFO order while idle threads steal the oldest
+/// ones. Tasks spawned from other threads are put into a shared queue
+/// that is used the same way: other threads take the newest tasks, the
+/// workers the oldest ones.
+/// Threads waiting for tasks (see TaskGroup, TaskGraph) don't block but
+/// execute pending tasks in the meantime, nested parallelism is safe.
+/// \module tasks
+class TaskScheduler : public NonMovable {
+public:
+	/// Returns the global scheduler, created on first use with defaultWorkers().
+	static TaskScheduler& global() {
+		static TaskScheduler scheduler;
+		return scheduler;
+	}
+
+	/// Returns the number of hardware threads minus one, since
+	/// the thread waiting for tasks participates in executing them.
+	static unsigned defaultWorkers() {
+		auto threads = std::thread::hardware_concurrency();
+		return threads > 1 ? threads - 1 : 0;
+	}
+
+public:
+	/// Starts the given number of worker threads.
+	/// A scheduler without workers runs all tasks in runPending.
+	explicit TaskScheduler(unsigned workers = defaultWorkers());
+
+	/// Waits for all pending tasks to be executed and joins the workers.
+	~TaskScheduler();
+
+	/// Spawns a detached task executing func().
+	/// Exceptions thrown by func terminate the program, use a TaskGroup
+	/// to wait for tasks and to propagate their exceptions.
+	template<typename F>
+	void spawn(F&& func);
+
+	/// Runs one pending task on the calling thread.
+	/// Returns false if there was no task to run.
+	bool runPending();
+
+	/// Returns the number of worker threads.
+	unsigned workers() const { return unsigned(threads_.size()); }
+
+	/// Returns the number of threads that can execute tasks concurrently,
+	/// i.e. the workers and the thread waiting for them.
+	unsigned concurrency() const { return workers() + 1; }
+
+protected:
+	friend class TaskGroup;
+	friend class TaskGraph;
+
+	// number of tasks allocated at once
+	static constexpr auto blockSize = 256u;
+
+	// tasks moved between the local free lists and the shared one at once
+	static constexpr auto freeBatch = 64u;
+
+	// number of failed attempts to find a task before a worker sleeps
+	static constexpr auto spinCount = 64u;
+
+	struct alignas(64) Worker {
+		detail::TaskDeque deque;
+		detail::Task* free {}; // only accessed by the worker
+		std::size_t freeCount {};
+	};
+
+	template<typename F>
+	static void runDetached(detail::Task& task) noexcept {
+		detail::taskData<F>(task)();
+		detail::destroyTask<F>(task);
+	}
+
+	template<typename T, typename... Args>
+	void spawnTask(detail::TaskFunc run, Args&&... args);
+
+	detail::Task* allocate();
+	void release(detail::Task* task);
+	void push(detail::Task* task);
+	void execute(detail::Task* task);
+	detail::Task* find(Worker* self, unsigned start);
+	bool hasWork() const;
+	void work(unsigned index);
+
+	// executes tasks until counter is zero
+	void wait(const std::atomic<std::size_t>& counter);
+
+	Worker* currentWorker() const {
+		return (currentScheduler() == this) ? workers_[currentIndex()].get() : nullptr;
+	}
+
+	static TaskScheduler*& currentScheduler() {
+		static thread_local TaskScheduler* scheduler {};
+		return scheduler;
+	}
+
+	static unsigned& currentIndex() {
+		static thread_local unsigned index {};
+		return index;
+	}
+
+protected:
+	std::vector<std::unique_ptr<Worker>> workers_;
+	std::vector<std::thread> threads_;
+
+	// tasks spawned from other threads, intrusive list, newest first
+	std::mutex injectMutex_;
+	detail::Task* injectedHead_ {};
+	detail::Task* injectedTail_ {};
+	std::atomic<std::size_t> injectedCount_ {0};
+
+	// task pool
+	std::mutex poolMutex_;
+	detail::Task* free_ {};
+	std::vector<std::unique_ptr<detail::Task[]>> blocks_;
+
+	std::atomic<unsigned> sleeping_ {0};
+	std::mutex sleepMutex_;
+	std::condition_variable sleep_;
+	bool stop_ {};
+};
+
+/// \brief Group of tasks that can be waited for.
+/// Exceptions thrown by the tasks are propagated to the thread waiting
+/// for them. Once a task threw, the tasks of the group that did not
+/// start yet are skipped.
+/// \module tasks
+class TaskGroup : public NonMovable {
+public:
+	/// Called from wait once all tasks finished, before exceptions are rethrown.
+	Callback<void()> onComplete;
+
+public:
+	explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::global()) :
+		scheduler_(scheduler) {}
+
+	/// Waits for all tasks, their exceptions are discarded.
+	~TaskGroup() { scheduler_.wait(pending_); }
+
+	/// Spawns a task executing func() that is part of this group.
+	template<typename F>
+	void run(F&& func);
+
+	/// Waits until all tasks of this group finished, executing pending
+	/// tasks in the meantime. Rethrows the first exception thrown by
+	/// a task. The group can be reused afterwards.
+	void wait();
+
+	/// Returns whether a task of this group threw an exception since
+	/// the last call to wait. Can be used to cancel long-running tasks.
+	bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+	TaskScheduler& scheduler() const { return scheduler_; }
+
+protected:
+	template<typename F>
+	struct Stored {
+		TaskGroup* group;
+		F func;
+	};
+
+	template<typename F>
+	static void runTask(detail::Task& task) noexcept;
+	void fail(std::exception_ptr error) noexcept;
+
+protected:
+	TaskScheduler& scheduler_;
+	std::atomic<std::size_t> pending_ {0};
+	std::atomic<bool> failed_ {false};
+	std::mutex mutex_;
+	std::exception_ptr error_;
+};
+
+/// \brief Graph of tasks with dependencies that can be run multiple times.
+/// A task is started as soon as all tasks it depends on have finished.
+/// Running the graph does not allocate, the tasks are only stored as
+/// std::function once when they are added.
+/// Once a task threw an exception, the tasks that did not start yet
+/// are skipped and run rethrows it.
+/// \module tasks
+class TaskGraph : public NonMovable {
+public:
+	/// Called with the id of every task that finished successfully.
+	/// Called from the thread that executed the task, i.e. possibly
+	/// concurrently. Listeners must not be changed while the graph runs.
+	Callback<void(std::size_t)> onTaskComplete;
+
+	/// Called from run once all tasks finished, before exceptions are rethrown.
+	Callback<void()> onComplete;
+
+public:
+	TaskGraph() = default;
+
+	/// Adds a task executing func() and returns its id.
+	template<typename F>
+	std::size_t add(F&& func);
+
+	/// Makes the task after depend on the task before, i.e. after will
+	/// only be started once before has finished.
+	void precede(std::size_t before, std::size_t after);
+
+	/// Runs all tasks and waits until they finished, executing tasks on
+	/// the calling thread as well. Must not be called concurrently.
+	/// \throws std::logic_error if the dependencies contain a cycle.
+	void run(TaskScheduler& scheduler = TaskScheduler::global());
+
+	/// Removes all tasks.
+	void clear();
+
+	std::size_t size() const { return nodes_.size(); }
+
+protected:
+	struct Node {
+		std::function<void()> func;
+		std::vector<std::size_t> successors;
+		unsigned predecessors {};
+	};
+
+	struct NodeTask {
+		TaskGraph* graph;
+		std::size_t node;
+	};
+
+	static void runNode(detail::Task& task) noexcept;
+	void execute(std::size_t node) noexcept;
+	void validate();
+
+protected:
+	std::vector<Node> nodes_;
+	std::vector<std::size_t> roots_;
+	std::unique_ptr<std::atomic<unsigned>[]> remaining_;
+	bool valid_ {true};
+
+	// state of the current run
+	TaskScheduler* scheduler_ {};
+	std::atomic<std::size_t> unfinished_ {0};
+	std::atomic<bool> failed_ {false};
+	std::mutex mutex_;
+	std::exception_ptr error_;
+};
+
+namespace detail {
+
+template<typename F>
+void splitFor(TaskGroup& group, std::size_t begin, std::size_t end,
+		std::size_t grain, F& func) {
+	// split off the upper halves, thieves steal the largest ones
+	while(end - begin > grain) {
+		auto mid = begin + (end - begin) / 2;
+		group.run([&group, &func, mid, end, grain]{
+			splitFor(group, mid, end, grain, func);
+		});
+		end = mid;
+	}
+
+	if(group.failed()) {
+		return;
+	}
+
+	for(auto i = begin; i < end; ++i) {
+		func(i);
+	}
+}
+
+} // namespace detail
+
+/// \brief Calls func(i) for all i in [begin, end) on the tasks of the given scheduler.
+/// The range is split recursively into chunks of at most grain indices,
+/// if grain is zero it is chosen from the size of the range and the
+/// number of threads. Rethrows the first exception thrown by func.
+/// \module tasks
+template<typename F>
+void parallelFor(TaskScheduler& scheduler, std::size_t begin, std::size_t end,
+		F&& func, std::size_t grain = 0) {
+	if(begin >= end) {
+		return;
+	}
+
+	auto count = end - begin;
+	auto threads = scheduler.concurrency();
+	if(!grain) {
+		grain = std::max<std::size_t>(1, count / (8 * threads));
+	}
+
+	if(threads == 1 || count <= grain) {
+		for(auto i = begin; i < end; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	TaskGroup group(scheduler);
+	detail::splitFor(group, begin, end, grain, func);
+	group.wait();
+}
+
+/// \brief Calls func(i) for all i in [begin, end) on the global scheduler.
+/// \module tasks
+template<typename F>
+void parallelFor(std::size_t begin, std::size_t end, F&& func, std::size_t grain = 0) {
+	parallelFor(TaskScheduler::global(), begin, end, std::forward<F>(func), grain);
+}
+
+/// \brief Reduces the indices in [begin, end) on the tasks of the given scheduler.
+/// Every block of blockSize indices is reduced as acc = func(acc, i),
+/// starting with init. The results of the blocks are then combined in
+/// order using combine(a, b). The result therefore does not depend on the
+/// number of threads, even for floating point values. combine must be
+/// associative, init its identity element.
+/// \module tasks
+template<typename T, typename F, typename C>
+T parallelReduce(TaskScheduler& scheduler, std::size_t begin, std::size_t end,
+		T init, F&& func, C&& combine, std::size_t blockSize = 1024) {
+	NYTL_EXPECTS(blockSize > 0);
+	auto count = (end > begin) ? end - begin : 0;
+	auto blocks = (count + blockSize - 1) / blockSize;
+
+	std::vector<T> partials(blocks, init);
+	parallelFor(scheduler, 0, blocks, [&](std::size_t block) {
+		auto acc = init;
+		auto first = begin + block * blockSize;
+		auto last = std::min(end, first + blockSize);
+		for(auto i = first; i < last; ++i) {
+			acc = func(std::move(acc), i);
+		}
+		partials[block] = std::move(acc);
+	});
+
+	auto ret = init;
+	for(auto& partial : partials) {
+		ret = combine(std::move(ret), partial);
+	}
+
+	return ret;
+}
+
+/// \brief Reduces the indices in [begin, end) on the global scheduler.
+/// \module tasks
+template<typename T, typename F, typename C>
+T parallelReduce(std::size_t begin, std::size_t end, T init, F&& func, C&& combine,
+		std::size_t blockSize = 1024) {
+	return parallelReduce(TaskScheduler::global(), begin, end, std::move(init),
+		std::forward<F>(func), std::forward<C>(combine), blockSize);
+}
+
+// - implementation -
+inline TaskScheduler::TaskScheduler(unsigned workers) {
+	workers_.reserve(workers);
+	for(auto i = 0u; i < workers; ++i) {
+		workers_.push_back(std::make_unique<Worker>());
+	}
+
+	threads_.reserve(workers);
+	for(auto i = 0u; i < workers; ++i) {
+		threads_.emplace_back([this, i]{ work(i); });
+	}
+}
+
+inline TaskScheduler::~TaskScheduler() {
+	{
+		std::lock_guard lock(sleepMutex_);
+		stop_ = true;
+	}
+
+	sleep_.notify_all();
+	for(auto& thread : threads_) {
+		thread.join();
+	}
+
+	// without workers, tasks might still be pending
+	while(runPending());
+}
+
+template<typename F>
+void TaskScheduler::spawn(F&& func) {
+	using Func = std::decay_t<F>;
+	spawnTask<Func>(&runDetached<Func>, std::forward<F>(func));
+}
+
+template<typename T, typename... Args>
+void TaskScheduler::spawnTask(detail::TaskFunc run, Args&&... args) {
+	auto task = allocate();
+	try {
+		detail::emplaceTask<T>(*task, std::forward<Args>(args)...);
+	} catch(...) {
+		release(task);
+		throw;
+	}
+
+	task->run = run;
+	push(task);
+}
+
+inline detail::Task* TaskScheduler::allocate() {
+	auto worker = currentWorker();
+	if(worker && worker->free) {
+		auto task = worker->free;
+		worker->free = task->next;
+		--worker->freeCount;
+		return task;
+	}
+
+	std::lock_guard lock(poolMutex_);
+	if(!free_) {
+		blocks_.push_back(std::make_unique<detail::Task[]>(blockSize));
+		auto block = blocks_.back().get();
+		for(auto i = 0u; i + 1 < blockSize; ++i) {
+			block[i].next = &block[i + 1];
+		}
+		free_ = block;
+	}
+
+	auto task = free_;
+	free_ = task->next;
+
+	// refill the local free list
+	for(auto i = 0u; worker && free_ && i < freeBatch; ++i) {
+		auto next = free_;
+		free_ = next->next;
+		next->next = worker->free;
+		worker->free = next;
+		++worker->freeCount;
+	}
+
+	return task;
+}
+
+inline void TaskScheduler::release(detail::Task* task) {
+	auto worker = currentWorker();
+	if(!worker) {
+		std::lock_guard lock(poolMutex_);
+		task->next = free_;
+		free_ = task;
+		return;
+	}
+
+	task->next = worker->free;
+	worker->free = task;
+
+	// tasks are often released by other threads than the ones that
+	// allocated them, give them back to not grow the pool forever
+	if(++worker->freeCount > 2 * freeBatch) {
+		std::lock_guard lock(poolMutex_);
+		for(auto i = 0u; i < freeBatch; ++i) {
+			auto next = worker->free;
+			worker->free = next->next;
+			next->next = free_;
+			free_ = next;
+		}
+		worker->freeCount -= freeBatch;
+	}
+}
+
+inline void TaskScheduler::push(detail::Task* task) {
+	auto worker = currentWorker();
+	if(worker) {
+		if(!worker->deque.push(task)) {
+			// the deque is full, run the task directly
+			execute(task);
+			return;
+		}
+	} else {
+		std::lock_guard lock(injectMutex_);
+		task->prev = nullptr;
+		task->next = injectedHead_;
+		if(injectedHead_) {
+			injectedHead_->prev = task;
+		} else {
+			injectedTail_ = task;
+		}
+		injectedHead_ = task;
+		injectedCount_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// pairs with the fence in work: either the sleeping worker sees the
+	// new task or we see that it sleeps (or is about to)
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(sleeping_.load(std::memory_order_relaxed)) {
+		{
+			std::lock_guard lock(sleepMutex_);
+		}
+		sleep_.notify_one();
+	}
+}
+
+inline void TaskScheduler::execute(detail::Task* task) {
+	task->run(*task);
+	release(task);
+}
+
+inline detail::Task* TaskScheduler::find(Worker* self, unsigned start) {
+	if(self) {
+		if(auto task = self->deque.pop()) {
+			return task;
+		}
+	}
+
+	if(injectedCount_.load(std::memory_order_relaxed)) {
+		// like for the deques: workers steal the oldest task while
+		// other threads (probably waiting for it) take the newest one
+		std::lock_guard lock(injectMutex_);
+		if(auto task = self ? injectedTail_ : injectedHead_) {
+			auto& prev = task->prev ? task->prev->next : injectedHead_;
+			auto& next = task->next ? task->next->prev : injectedTail_;
+			prev = task->next;
+			next = task->prev;
+			injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+			return task;
+		}
+	}
+
+	auto count = workers_.size();
+	for(auto i = 0u; i < count; ++i) {
+		auto& victim = *workers_[(start + i) % count];
+		if(&victim == self) {
+			continue;
+		}
+
+		if(auto task = victim.deque.steal()) {
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
+inline bool TaskScheduler::runPending() {
+	auto worker = currentWorker();
+	auto task = find(worker, worker ? currentIndex() + 1 : 0u);
+	if(!task) {
+		return false;
+	}
+
+	execute(task);
+	return true;
+}
+
+inline bool TaskScheduler::hasWork() const {
+	if(injectedCount_.load(std::memory_order_relaxed)) {
+		return true;
+	}
+
+	for(auto& worker : workers_) {
+		if(!worker->deque.empty()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+inline void TaskScheduler::wait(const std::atomic<std::size_t>& counter) {
+	while(counter.load(std::memory_order_acquire)) {
+		if(!runPending()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+inline void TaskScheduler::work(unsigned index) {
+	currentScheduler() = this;
+	currentIndex() = index;
+
+	auto self = workers_[index].get();
+	auto idle = 0u;
+	while(true) {
+		if(auto task = find(self, index + 1)) {
+			execute(task);
+			idle = 0;
+			continue;
+		}
+
+		if(++idle < spinCount) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		idle = 0;
+		std::unique_lock lock(sleepMutex_);
+		sleeping_.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		sleep_.wait(lock, [&]{ return stop_ || hasWork(); });
+		sleeping_.fetch_sub(1);
+		if(stop_ && !hasWork()) {
+			return;
+		}
+	}
+}
+
+template<typename F>
+void TaskGroup::run(F&& func) {
+	using Func = std::decay_t<F>;
+	pending_.fetch_add(1, std::memory_order_relaxed);
+	try {
+		scheduler_.spawnTask<Stored<Func>>(&runTask<Func>, this, std::forward<F>(func));
+	} catch(...) {
+		pending_.fetch_sub(1, std::memory_order_relaxed);
+		throw;
+	}
+}
+
+template<typename F>
+void TaskGroup::runTask(detail::Task& task) noexcept {
+	auto& stored = detail::taskData<Stored<F>>(task);
+	auto group = stored.group;
+	if(!group->failed()) {
+		try {
+			stored.func();
+		} catch(...) {
+			group->fail(std::current_exception());
+		}
+	}
+
+	// the group might be destroyed as soon as pending_ is decreased
+	detail::destroyTask<Stored<F>>(task);
+	group->pending_.fetch_sub(1, std::memory_order_release);
+}
+
+inline void TaskGroup::fail(std::exception_ptr error) noexcept {
+	std::lock_guard lock(mutex_);
+	if(!error_) {
+		error_ = std::move(error);
+	}
+	failed_.store(true, std::memory_order_relaxed);
+}
+
+inline void TaskGroup::wait() {
+	scheduler_.wait(pending_);
+	onComplete();
+
+	if(failed()) {
+		std::exception_ptr error;
+		{
+			std::lock_guard lock(mutex_);
+			error = std::move(error_);
+			error_ = {};
+		}
+
+		failed_.store(false, std::memory_order_relaxed);
+		std::rethrow_exception(error);
+	}
+}
+
+template<typename F>
+std::size_t TaskGraph::add(F&& func) {
+	nodes_.push_back({std::function<void()>(std::forward<F>(func)), {}, 0u});
+	valid_ = false;
+	return nodes_.size() - 1;
+}
+
+inline void TaskGraph::precede(std::size_t before, std::size_t after) {
+	NYTL_EXPECTS(before < nodes_.size() && after < nodes_.size());
+	nodes_[before].successors.push_back(after);
+	++nodes_[after].predecessors;
+	valid_ = false;
+}
+
+inline void TaskGraph::clear() {
+	nodes_.clear();
+	roots_.clear();
+	remaining_.reset();
+	valid_ = true;
+}
+
+inline void TaskGraph::validate() {
+	// topological sort, all tasks are visited if there is no cycle
+	roots_.clear();
+	std::vector<unsigned> remaining(nodes_.size());
+	std::vector<std::size_t> ready;
+	for(auto i = 0u; i < nodes_.size(); ++i) {
+		remaining[i] = nodes_[i].predecessors;
+		if(!remaining[i]) {
+			roots_.push_back(i);
+			ready.push_back(i);
+		}
+	}
+
+	auto visited = std::size_t(0);
+	while(!ready.empty()) {
+		auto node = ready.back();
+		ready.pop_back();
+		++visited;
+		for(auto next : nodes_[node].successors) {
+			if(--remaining[next] == 0) {
+				ready.push_back(next);
+			}
+		}
+	}
+
+	if(visited != nodes_.size()) {
+		throw std::logic_error("nytl::TaskGraph::run: the dependencies contain a cycle");
+	}
+
+	remaining_ = std::make_unique<std::atomic<unsigned>[]>(nodes_.size());
+	valid_ = true;
+}
+
+inline void TaskGraph::run(TaskScheduler& scheduler) {
+	if(!valid_) {
+		validate();
+	}
+
+	if(!nodes_.empty()) {
+		for(auto i = 0u; i < nodes_.size(); ++i) {
+			remaining_[i].store(nodes_[i].predecessors, std::memory_order_relaxed);
+		}
+
+		scheduler_ = &scheduler;
+		unfinished_.store(nodes_.size(), std::memory_order_relaxed);
+		for(auto i = 1u; i < roots_.size(); ++i) {
+			scheduler.spawnTask<NodeTask>(&runNode, this, roots_[i]);
+		}
+
+		execute(roots_[0]);
+		scheduler.wait(unfinished_);
+	}
+
+	onComplete();
+
+	if(failed_.load(std::memory_order_relaxed)) {
+		std::exception_ptr error;
+		{
+			std::lock_guard lock(mutex_);
+			error = std::move(error_);
+			error_ = {};
+		}
+
+		failed_.store(false, std::memory_order_relaxed);
+		std::rethrow_exception(error);
+	}
+}
+
+inline void TaskGraph::runNode(detail::Task& task) noexcept {
+	auto stored = detail::taskData<NodeTask>(task);
+	detail::destroyTask<NodeTask>(task);
+	stored.graph->execute(stored.node);
+}
+
+inline void TaskGraph::execute(std::size_t node) noexcept {
+	constexpr auto none = std::size_t(-1);
+	while(true) {
+		if(!failed_.load(std::memory_order_relaxed)) {
+			try {
+				nodes_[node].func();
+				onTaskComplete(node);
+			} catch(...) {
+				std::lock_guard lock(mutex_);
+				if(!error_) {
+					error_ = std::current_exception();
+				}
+				failed_.store(true, std::memory_order_relaxed);
+			}
+		}
+
+		// continue with one of the ready successors on this thread
+		auto next = none;
+		for(auto successor : nodes_[node].successors) {
+			if(remaining_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				if(next != none) {
+					scheduler_->spawnTask<NodeTask>(&runNode, this, next);
+				}
+				next = successor;
+			}
+		}
+
+		// the graph might be destroyed once the last task finished
+		unfinished_.fetch_sub(1, std::memory_order_release);
+		if(next == none) {
+			return;
+		}
+
+		node = next;
+	}
+}
+
+} // namespace nytl
+
+#endif // header guard
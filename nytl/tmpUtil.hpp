@@ -55,6 +55,15 @@ template<typename... T> void unused(T&&...) {}
 /// \module utility
 template<typename A, typename> using Variadic = A;
 
+/// \brief Maps the given type to itself.
+/// Can be used to prevent template argument deduction from a function parameter:
+/// ```cpp
+/// // T is only deduced from value, the span can also be passed a std::vector
+/// template<typename T> void fill(nytl::Span<typename nytl::Identity<T>::type> s, T value);
+/// ```
+/// \module utility
+template<typename T> struct Identity { using type = T; };
+
 /// \brief Assures that the returned value can be used as template-dependent expressions.
 /// This allows e.g. to defer operator of function lookup so that specific headers don't
 /// have to be included by a template functions if a function is not used.
@@ -0,0 +1,150 @@
+// Copyright (c) 2017-2018 nyorain
+// Distributed under the Boost Software License, Version 1.0.
+// See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt
+
+/// \file Defines the nytl::Transform (translation, rotation, scale) template class.
+
+#pragma once
+
+#ifndef NYTL_INCLUDE_TRANSFORM
+#define NYTL_INCLUDE_TRANSFORM
+
+#include <nytl/quat.hpp> // nytl::Quat
+#include <nytl/vec.hpp> // nytl::Vec
+#include <nytl/mat.hpp> // nytl::Mat
+#include <nytl/span.hpp> // nytl::Span
+#include <nytl/batchOps.hpp> // nytl::transformPoints
+
+#include <cmath> // std::sqrt
+
+namespace nytl {
+
+/// \brief Affine transformation that first scales, then rotates and
+/// then translates a point. Cheaper to compose, invert and apply
+/// than a Mat<4, 4, T> while representing all transforms usually needed
+/// in a scene hierarchy.
+/// Composition and inversion are only exact for uniform scales
+/// since a non-uniform scale followed by a rotation cannot be represented
+/// by a scale-rotation-translation transform in general (shear).
+/// \tparam T The value type, should be a floating point type.
+/// \module transform
+template<typename T>
+struct Transform {
+	using Value = T;
+
+	Vec3<T> translation {0, 0, 0};
+	Quat<T> rotation {}; // must be normalized
+	Vec3<T> scale {1, 1, 1};
+};
+
+using Transformf = Transform<float>;
+using Transformd = Transform<double>;
+
+/// \brief Applies the given transform to the given point.
+template<typename T>
+constexpr Vec3<T> apply(const Transform<T>& t, const Vec3<T>& p) {
+	auto r = apply(t.rotation, Vec3<T> {t.scale.x * p.x, t.scale.y * p.y, t.scale.z * p.z});
+	return {r.x + t.translation.x, r.y + t.translation.y, r.z + t.translation.z};
+}
+
+/// \brief Composes the given transforms. The returned transform first
+/// applies b, then a. Only exact if a has a uniform scale.
+template<typename T>
+constexpr Transform<T> operator*(const Transform<T>& a, const Transform<T>& b) {
+	return {
+		apply(a, b.translation),
+		a.rotation * b.rotation,
+		{a.scale.x * b.scale.x, a.scale.y * b.scale.y, a.scale.z * b.scale.z},
+	};
+}
+
+/// \brief Returns the inverse transform. Only exact for uniform scales.
+template<typename T>
+constexpr Transform<T> inverse(const Transform<T>& t) {
+	Transform<T> ret;
+	ret.rotation = conjugate(t.rotation);
+	ret.scale = {1 / t.scale.x, 1 / t.scale.y, 1 / t.scale.z};
+
+	auto r = apply(ret.rotation, t.translation);
+	ret.translation = {-ret.scale.x * r.x, -ret.scale.y * r.y, -ret.scale.z * r.z};
+	return ret;
+}
+
+/// \brief Returns the affine 3x4 matrix for the given transform.
+/// The last column holds the translation.
+template<typename T>
+constexpr Mat<3, 4, T> toMat34(const Transform<T>& t) {
+	auto r = toMat3(t.rotation);
+	return {
+		r[0][0] * t.scale.x, r[0][1] * t.scale.y, r[0][2] * t.scale.z, t.translation.x,
+		r[1][0] * t.scale.x, r[1][1] * t.scale.y, r[1][2] * t.scale.z, t.translation.y,
+		r[2][0] * t.scale.x, r[2][1] * t.scale.y, r[2][2] * t.scale.z, t.translation.z,
+	};
+}
+
+/// \brief Returns the homogeneous 4x4 matrix for the given transform.
+template<typename T>
+constexpr Mat<4, 4, T> toMat4(const Transform<T>& t) {
+	auto m = toMat34(t);
+	return {
+		m[0][0], m[0][1], m[0][2], m[0][3],
+		m[1][0], m[1][1], m[1][2], m[1][3],
+		m[2][0], m[2][1], m[2][2], m[2][3],
+		0, 0, 0, 1,
+	};
+}
+
+/// \brief Decomposes the given affine 4x4 matrix into a transform.
+/// The matrix must not contain shear or projection. Reflections are
+/// represented by a negative x scale.
+template<typename T>
+Transform<T> toTransform(const Mat<4, 4, T>& m) {
+	Transform<T> ret;
+	ret.translation = {m[0][3], m[1][3], m[2][3]};
+
+	Mat<3, 3, T> r;
+	for(auto c = 0u; c < 3; ++c) {
+		auto s = std::sqrt(m[0][c] * m[0][c] + m[1][c] * m[1][c] + m[2][c] * m[2][c]);
+		ret.scale[c] = s;
+		for(auto i = 0u; i < 3; ++i) {
+			r[i][c] = m[i][c] / s;
+		}
+	}
+
+	// negative determinant: reflection
+	auto det = r[0][0] * (r[1][1] * r[2][2] - r[1][2] * r[2][1]) -
+		r[0][1] * (r[1][0] * r[2][2] - r[1][2] * r[2][0]) +
+		r[0][2] * (r[1][0] * r[2][1] - r[1][1] * r[2][0]);
+	if(det < 0) {
+		ret.scale.x = -ret.scale.x;
+		for(auto i = 0u; i < 3; ++i) {
+			r[i][0] = -r[i][0];
+		}
+	}
+
+	ret.rotation = toQuat(r);
+	return ret;
+}
+
+/// \brief Applies the given transform to all points in 'in' and writes
+/// the results to 'out', which must have at least the same size.
+/// 'in' and 'out' may refer to the same points but must not otherwise overlap.
+/// Converts the transform into an affine matrix once and uses
+/// nytl::transformPoints, i.e. only costs 9 multiply-adds per point.
+/// Not an overload of apply since that would make unqualified calls with
+/// e.g. std::vector arguments resolve to std::apply via ADL.
+template<typename T>
+void applyAll(const Transform<T>& t, Span<const Vec3<typename Transform<T>::Value>> in,
+		Span<Vec3<typename Transform<T>::Value>> out) {
+	transformPoints(toMat34(t), in, out);
+}
+
+/// \brief Applies the given transform to all given points in place.
+template<typename T>
+void applyAll(const Transform<T>& t, Span<Vec3<typename Transform<T>::Value>> points) {
+	transformPoints(toMat34(t), points, points);
+}
+
+} // namespace nytl
+
+#endif // header guard
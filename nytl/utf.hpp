@@ -9,41 +9,81 @@
 #ifndef NYTL_INCLUDE_UTF
 #define NYTL_INCLUDE_UTF
 
+#include <nytl/dispatch.hpp> // nytl::Dispatch
+#include <nytl/simd.hpp> // nytl::simd::Pack
+
 #include <string> // std::string
 #include <string_view> // std::string_view
 #include <array> // std::array
 #include <locale> // std::wstring_convert
 #include <codecvt> // std::codecvt_utf8
 #include <stdexcept> // std::out_of_range
+#include <algorithm> // std::min
 
 // all operations assume correct utf8 string and don't perform any sanity checks.
 // for implementation details see https://en.wikipedia.org/wiki/UTF-8
 
 namespace nytl {
 
+namespace detail {
+
+// Counts the bytes that are no continuation bytes (10xxxxxx), i.e. the
+// characters of valid utf8. Compiled for multiple instruction sets,
+// see nytl/dispatch.hpp.
+struct CharCountKernel {
+	template<std::size_t Bytes>
+	static std::size_t run(const char* data, std::size_t size) {
+		auto count = std::size_t(0);
+		auto i = std::size_t(0);
+
+	#if NYTL_SIMD
+		if constexpr(Bytes > 0) {
+			using P = simd::Pack<signed char, Bytes>;
+			using U = simd::Pack<unsigned char, Bytes>;
+
+			// continuation bytes are smaller than -64 as signed char
+			P min;
+			simd::broadcast(min, static_cast<signed char>(-65));
+
+			// the per-lane counters overflow after 255 packs
+			while(i + Bytes <= size) {
+				auto end = std::min(size - size % Bytes, i + 255 * Bytes);
+				auto lanes = U {};
+				for(; i < end; i += Bytes) {
+					P pack;
+					simd::load(pack, reinterpret_cast<const signed char*>(data + i));
+					lanes -= (U) (pack > min);
+				}
+
+				for(auto l = 0u; l < Bytes; ++l) {
+					count += lanes[l];
+				}
+			}
+		}
+	#endif // NYTL_SIMD
+
+		for(; i < size; ++i) {
+			count += (data[i] & 0xC0) != 0x80;
+		}
+
+		return count;
+	}
+};
+
+} // namespace detail
+
 /// \brief Returns the number of characters in a utf8-encoded unicode string.
 /// This differs from std::string::size because it does not return the bytes in the
 /// string, but the count of utf8-encoded characters.
+/// Large strings are processed with simd instructions (see nytl/dispatch.hpp).
 inline std::size_t charCount(std::string_view utf8) {
-	std::size_t count = 0u;
-	auto it = utf8.begin();
-
-	while(it != utf8.end()) {
-		auto length = 1u;
-		if((*it) & (1 << 7)) {
-			++length;
-			if((*it) & (1 << 5)) {
-				++length;
-				if((*it) & (1 << 4))
-					++length;
-			}
-		}
-
-		++count;
-		it += length;
+	using Kernel = detail::CharCountKernel;
+	if(utf8.size() < 64) {
+		return Kernel::run<0>(utf8.data(), utf8.size());
 	}
 
-	return count;
+	using Sig = std::size_t(const char*, std::size_t);
+	return Dispatch<Kernel, Sig>::call(utf8.data(), utf8.size());
 }
 
 /// \brief Returns the character at position n (started at 0) from the given utf8 string.
@@ -17,7 +17,7 @@
 
 #include <iterator> // std::reverse_iterator
 #include <array> // std::array
-#include <algorithm> // std::min
+#include <utility> // std::index_sequence
 
 namespace nytl {
 
@@ -37,12 +37,7 @@ public:
 	/// out the last values when the size of vector is shrinked (e.g.
 	/// {1, 2, 3} -> {1, 2}).
 	template<size_t OD, typename OT>
-	constexpr explicit operator Vec<OD, OT>() const {
-		auto ret = Vec<OD, OT> {};
-		for(auto i = 0u; i < std::min(D, OD); ++i)
-			ret[i] = (*this)[i];
-		return ret;
-	}
+	constexpr explicit operator Vec<OD, OT>() const;
 };
 
 template<typename... Args>
@@ -50,65 +45,131 @@ Vec(Args&&... args) ->
 	Vec<sizeof...(Args), std::common_type_t<Args...>>;
 
 // - implementation/operators -
+// The operators are written as pack expansions over the (compile-time)
+// component indices instead of loops over D. This gives straight-line
+// code that constructs the result directly, even in unoptimized
+// (debug) builds that would otherwise keep the loop and zero-initialize
+// the result before overwriting every component.
+namespace detail {
+
+template<size_t OD, typename OT, typename V, size_t... I>
+constexpr Vec<OD, OT> vecCast(const V& a, std::index_sequence<I...>) {
+	constexpr auto d = V::size();
+	if constexpr(OD <= d) {
+		return {OT(a[I])...};
+	} else {
+		// the padding components are default constructed
+		return {(I < d ? OT(a[I < d ? I : 0]) : OT {})...};
+	}
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr void vecAddAssign(Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	((a[I] += b[I]), ...);
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr void vecSubAssign(Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	((a[I] -= b[I]), ...);
+}
+
+template<size_t D, typename T, typename F, size_t... I>
+constexpr void vecScaleAssign(Vec<D, T>& a, const F& f, std::index_sequence<I...>) {
+	((a[I] *= f), ...);
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr auto vecAdd(const Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	return Vec<D, decltype(a[0] + b[0])> {(a[I] + b[I])...};
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr auto vecSub(const Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	return Vec<D, decltype(a[0] - b[0])> {(a[I] - b[I])...};
+}
+
+template<size_t D, typename T, size_t... I>
+constexpr auto vecNegate(const Vec<D, T>& a, std::index_sequence<I...>) {
+	return Vec<D, T> {T(-a[I])...};
+}
+
+template<size_t D, typename F, typename T, size_t... I>
+constexpr auto vecScale(const F& f, const Vec<D, T>& a, std::index_sequence<I...>) {
+	return Vec<D, decltype(f * a[0])> {(f * a[I])...};
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr bool vecEqual(const Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	return (... && (a[I] == b[I]));
+}
+
+} // namespace detail
+
+template<size_t D, typename T>
+template<size_t OD, typename OT>
+constexpr Vec<D, T>::operator Vec<OD, OT>() const {
+	return detail::vecCast<OD, OT>(*this, std::make_index_sequence<OD> {});
+}
+
+template<typename T>
+template<size_t OD, typename OT>
+constexpr Vec<2, T>::operator Vec<OD, OT>() const {
+	return detail::vecCast<OD, OT>(*this, std::make_index_sequence<OD> {});
+}
+
+template<typename T>
+template<size_t OD, typename OT>
+constexpr Vec<3, T>::operator Vec<OD, OT>() const {
+	return detail::vecCast<OD, OT>(*this, std::make_index_sequence<OD> {});
+}
+
 // - free operators -
 template<size_t D, typename T1, typename T2>
 constexpr Vec<D, T1>& operator+=(Vec<D, T1>& a, const Vec<D, T2>& b) noexcept {
-	for(size_t i = 0; i < D; ++i)
-		a[i] += b[i];
+	detail::vecAddAssign(a, b, std::make_index_sequence<D> {});
 	return a;
 }
 
 template<size_t D, typename T1, typename T2>
 constexpr Vec<D, T1>& operator-=(Vec<D, T1>& a, const Vec<D, T2>& b) noexcept {
-	for(size_t i = 0; i < D; ++i)
-		a[i] -= b[i];
+	detail::vecSubAssign(a, b, std::make_index_sequence<D> {});
 	return a;
 }
 
 template<size_t D, typename T, typename OT>
 constexpr Vec<D, T>& operator*=(Vec<D, T>& vec, OT fac) {
-	for(auto& val : vec)
-		val *= fac;
+	detail::vecScaleAssign(vec, fac, std::make_index_sequence<D> {});
 	return vec;
 }
 
 template<size_t D, typename T1, typename T2>
 constexpr auto operator+(const Vec<D, T1>& a, const Vec<D, T2>& b) {
-	Vec<D, decltype(a[0] + b[0])> ret {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = a[i] + b[i];
-	return ret;
+	return detail::vecAdd(a, b, std::make_index_sequence<D> {});
 }
 
 template<size_t D, typename T1, typename T2>
 constexpr auto operator-(const Vec<D, T1>& a, const Vec<D, T2>& b) {
-	Vec<D, decltype(a[0] - b[0])> ret {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = a[i] - b[i];
-	return ret;
+	return detail::vecSub(a, b, std::make_index_sequence<D> {});
 }
 
 template<size_t D, typename T>
-constexpr auto operator-(Vec<D, T> a) {
-	for(auto& val : a)
-		val = -val;
-	return a;
+constexpr auto operator-(const Vec<D, T>& a) {
+	return detail::vecNegate(a, std::make_index_sequence<D> {});
 }
 
 template<size_t D, typename F, typename T>
 constexpr auto operator*(const F& f, const Vec<D, T>& a) {
-	Vec<D, decltype(f * a[0])> ret {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = f * a[i];
-	return ret;
+	return detail::vecScale(f, a, std::make_index_sequence<D> {});
 }
 
 template<size_t D, typename T1, typename T2>
 constexpr auto operator==(const Vec<D, T1>& a, const Vec<D, T2>& b) {
-	for(auto i = 0u; i < D; ++i)
-		if(a[i] != b[i])
-			return false;
-	return true;
+	return detail::vecEqual(a, b, std::make_index_sequence<D> {});
 }
 
 template<size_t D1, size_t D2, typename T1, typename T2>
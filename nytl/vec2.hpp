@@ -10,7 +10,7 @@
 #define NYTL_INCLUDE_VEC2
 
 #include <nytl/fwd/vec.hpp> // nytl::Vec declaration
-#include <algorithm> // std::min
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
 #include <stdexcept> // std::out_of_range
 
 namespace nytl {
@@ -41,35 +41,45 @@ public:
 	constexpr T* data() { return &x; }
 	constexpr const T* data() const { return &x; }
 
-	// We could use (data()[i]) but this conflicts constexpr (gcc 7).
-	// Stl convention is not to check bounds and therefore never throw
-	// from operator[] (and so does the default Vec implementation).
-	// But we implicitly have to check bounds here and all other alternatives
-	// are worse so we throw in the case of out-of-range. It's almost free.
+	// We could use (data()[i]) but this conflicts constexpr and indexing
+	// past x is undefined behaviour anyway (which in fact stops gcc from
+	// unrolling generic loops over the components).
+	// Selecting the member instead has no exception path and folds
+	// to a single load for every index known after unrolling; variable
+	// indices compile to a select. Stl convention is not to check bounds
+	// in operator[] (and so does the default Vec implementation), use at().
+	// With enabled contracts (nytl/contracts.hpp) the index is checked
+	// and reported according to the selected policy.
 	constexpr T& operator[](size_t i) {
-		switch(i) {
-			case 0: return x;
-			case 1: return y;
-			default: throw std::out_of_range("Vec2[]");
-		}
+		NYTL_EXPECTS(i < 2);
+		return (i == 0) ? x : y;
 	}
 
 	constexpr const T& operator[](size_t i) const {
-		switch(i) {
-			case 0: return x;
-			case 1: return y;
-			default: throw std::out_of_range("Vec2[]");
+		NYTL_EXPECTS(i < 2);
+		return (i == 0) ? x : y;
+	}
+
+	/// Like operator[] but throws std::out_of_range for invalid indices.
+	constexpr T& at(size_t i) {
+		if(NYTL_UNLIKELY(i >= 2)) {
+			throw std::out_of_range("Vec2::at");
 		}
+
+		return (*this)[i];
+	}
+
+	constexpr const T& at(size_t i) const {
+		if(NYTL_UNLIKELY(i >= 2)) {
+			throw std::out_of_range("Vec2::at");
+		}
+
+		return (*this)[i];
 	}
 
 	// implemented in vec.hpp for all specializations
 	template<size_t OD, typename OT>
-	constexpr explicit operator Vec<OD, OT>() const {
-		auto ret = Vec<OD, OT> {};
-		for(auto i = 0u; i < std::min(size(), OD); ++i)
-			ret[i] = (*this)[i];
-		return ret;
-	}
+	constexpr explicit operator Vec<OD, OT>() const;
 };
 
 } // namespace nytl
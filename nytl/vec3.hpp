@@ -10,7 +10,7 @@
 #define NYTL_INCLUDE_VEC3
 
 #include <nytl/fwd/vec.hpp> // nytl::Vec declaration
-#include <algorithm> // std::min
+#include <nytl/contracts.hpp> // NYTL_EXPECTS
 #include <stdexcept> // std::out_of_range
 
 namespace nytl {
@@ -44,31 +44,35 @@ public:
 
 	// See the vec2 implementation for implementation reasoning.
 	constexpr T& operator[](size_t i) {
-		switch(i) {
-			case 0: return x;
-			case 1: return y;
-			case 2: return z;
-			default: throw std::out_of_range("Vec3[]");
-		}
+		NYTL_EXPECTS(i < 3);
+		return (i == 0) ? x : (i == 1) ? y : z;
 	}
 
 	constexpr const T& operator[](size_t i) const {
-		switch(i) {
-			case 0: return x;
-			case 1: return y;
-			case 2: return z;
-			default: throw std::out_of_range("Vec3[]");
+		NYTL_EXPECTS(i < 3);
+		return (i == 0) ? x : (i == 1) ? y : z;
+	}
+
+	/// Like operator[] but throws std::out_of_range for invalid indices.
+	constexpr T& at(size_t i) {
+		if(NYTL_UNLIKELY(i >= 3)) {
+			throw std::out_of_range("Vec3::at");
 		}
+
+		return (*this)[i];
+	}
+
+	constexpr const T& at(size_t i) const {
+		if(NYTL_UNLIKELY(i >= 3)) {
+			throw std::out_of_range("Vec3::at");
+		}
+
+		return (*this)[i];
 	}
 
 	// implemented in vec.hpp for all specializations
 	template<size_t OD, typename OT>
-	constexpr explicit operator Vec<OD, OT>() const {
-		auto ret = Vec<OD, OT> {};
-		for(auto i = 0u; i < std::min(size(), OD); ++i)
-			ret[i] = (*this)[i];
-		return ret;
-	}
+	constexpr explicit operator Vec<OD, OT>() const;
 };
 
 } // namespace nytl
@@ -16,29 +16,109 @@
 #include <nytl/math.hpp> // nytl::accumulate
 
 #include <functional> // std::plus, std::multiplies
+#include <utility> // std::index_sequence
 #include <stdexcept> // std::invalid_argument
 #include <cmath> // std::acos
 #include <iosfwd> // std::ostream
 #include <algorithm> // std::clamp
 
 namespace nytl {
+namespace detail {
+
+// Like the operators in vec.hpp, the operations are expanded over the
+// component indices, see there.
+template<typename R, size_t D, typename T, size_t... I>
+constexpr R vecSum(const Vec<D, T>& a, std::index_sequence<I...>) {
+	if constexpr(D == 0) {
+		return R {0};
+	} else {
+		return R((... + a[I]));
+	}
+}
+
+template<typename R, size_t D, typename T, size_t... I>
+constexpr R vecProduct(const Vec<D, T>& a, std::index_sequence<I...>) {
+	if constexpr(D == 0) {
+		return R {1};
+	} else {
+		return R((... * a[I]));
+	}
+}
+
+template<typename R, size_t D, typename T1, typename T2, size_t... I>
+constexpr R vecDot(const Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	if constexpr(D == 0) {
+		return R {0};
+	} else {
+		return R((... + (a[I] * b[I])));
+	}
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr void vecMultiplyAssign(Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	((a[I] *= b[I]), ...);
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr void vecDivideAssign(Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	((a[I] /= b[I]), ...);
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr auto vecMultiply(const Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	return Vec<D, decltype(a[0] * b[0])> {(a[I] * b[I])...};
+}
+
+template<size_t D, typename T1, typename T2, size_t... I>
+constexpr auto vecDivide(const Vec<D, T1>& a, const Vec<D, T2>& b,
+		std::index_sequence<I...>) {
+	return Vec<D, decltype(a[0] / b[0])> {(a[I] / b[I])...};
+}
+
+template<size_t D, typename T, typename F, size_t... I>
+constexpr auto vecScaleRight(const Vec<D, T>& a, const F& f, std::index_sequence<I...>) {
+	return Vec<D, decltype(a[0] * f)> {(a[I] * f)...};
+}
+
+template<size_t D, typename T, typename F, size_t... I>
+constexpr auto vecDivideScalar(const Vec<D, T>& a, const F& f, std::index_sequence<I...>) {
+	return Vec<D, decltype(a[0] / f)> {(a[I] / f)...};
+}
+
+template<size_t D, typename T, typename F, size_t... I>
+constexpr auto vecScalarDivide(const F& f, const Vec<D, T>& a, std::index_sequence<I...>) {
+	return Vec<D, decltype(f / a[0])> {(f / a[I])...};
+}
+
+// keeps the component of a unless the one of b is larger/smaller
+template<size_t D, typename T, size_t... I>
+constexpr auto vecMax(const Vec<D, T>& a, const Vec<D, T>& b, std::index_sequence<I...>) {
+	return Vec<D, T> {(b[I] > a[I] ? b[I] : a[I])...};
+}
+
+template<size_t D, typename T, size_t... I>
+constexpr auto vecMin(const Vec<D, T>& a, const Vec<D, T>& b, std::index_sequence<I...>) {
+	return Vec<D, T> {(b[I] < a[I] ? b[I] : a[I])...};
+}
+
+} // namespace detail
 
 /// \brief Sums up all values of the given vector using the + operator.
 template<size_t D, typename T>
 constexpr auto sum(const Vec<D, T>& a) {
-	decltype(a[0] + a[1]) ret {0};
-	for(auto& val : a)
-		ret += val;
-	return ret;
+	using R = decltype(a[0] + a[0]);
+	return detail::vecSum<R>(a, std::make_index_sequence<D> {});
 }
 
 /// \brief Multiplies all values of the given vector using the * operator.
 template<size_t D, typename T>
 constexpr auto multiply(const Vec<D, T>& a) {
-	decltype(a[0] * a[1]) ret {1};
-	for(auto& val : a)
-		ret *= val;
-	return ret;
+	using R = decltype(a[0] * a[0]);
+	return detail::vecProduct<R>(a, std::make_index_sequence<D> {});
 }
 
 /// \brief Calculates the default (real) dot product for the given vectors.
@@ -46,11 +126,8 @@ constexpr auto multiply(const Vec<D, T>& a) {
 /// not automatically handle the dot definition for other structures.
 template<size_t D, typename T1, typename T2>
 constexpr auto dot(const Vec<D, T1>& a, const Vec<D, T2>& b) {
-	decltype(a[0] * b[0] + a[0] * b[0]) ret {0};
-	for(auto i = 0u; i < D; ++i)
-		ret += a[i] * b[i];
-
-	return ret;
+	using R = decltype(a[0] * b[0] + a[0] * b[0]);
+	return detail::vecDot<R>(a, b, std::make_index_sequence<D> {});
 }
 
 /// \brief Returns the euclidean norm (or length) of the given vector.
@@ -148,11 +225,11 @@ std::ostream& operator<<(std::ostream& os, const Vec<D, T>& a) {
 /// \brief Calculates the cross product for two 3-dimensional vectors.
 template<typename T1, typename T2>
 constexpr auto cross(const Vec<3, T1>& a, const Vec<3, T2>& b) {
-	Vec<3, decltype(a[1] * b[2] - a[2] * b[1])> ret {};
-	ret[0] = (a[1] * b[2]) - (a[2] * b[1]);
-	ret[1] = (a[2] * b[0]) - (a[0] * b[2]);
-	ret[2] = (a[0] * b[1]) - (a[1] * b[0]);
-	return ret;
+	return Vec<3, decltype(a[1] * b[2] - a[2] * b[1])> {
+		(a[1] * b[2]) - (a[2] * b[1]),
+		(a[2] * b[0]) - (a[0] * b[2]),
+		(a[0] * b[1]) - (a[1] * b[0]),
+	};
 }
 
 /// \brief 2-dimensional cross product (aka normal-dot).
@@ -202,26 +279,17 @@ namespace operators {
 
 template<size_t D, typename F, typename T>
 constexpr auto operator*(const Vec<D, T>& a, const F& f) {
-	auto ret = Vec<D, decltype(a[0] * f)> {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = a[i] * f;
-	return ret;
+	return detail::vecScaleRight(a, f, std::make_index_sequence<D> {});
 }
 
 template<size_t D, typename F, typename T>
 constexpr auto operator/(const Vec<D, T>& a, const F& f) {
-	auto ret = Vec<D, decltype(a[0] / f)> {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = a[i] / f;
-	return ret;
+	return detail::vecDivideScalar(a, f, std::make_index_sequence<D> {});
 }
 
 template<size_t D, typename F, typename T>
 constexpr auto operator/(const F& f, const Vec<D, T>& a) {
-	auto ret = Vec<D, decltype(f / a[0])> {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = f / a[i];
-	return ret;
+	return detail::vecScalarDivide(f, a, std::make_index_sequence<D> {});
 }
 
 } // namespace operators
@@ -230,53 +298,39 @@ namespace cw { // vec component-wise operations
 
 /// \brief Returns a vector holding the component-wise maximum of the given vectors.
 template<size_t D, typename T>
-constexpr auto max(Vec<D, T> a, const Vec<D, T>& b) {
-	for(auto i = 0u; i < D; ++i)
-		if(b[i] > a[i])
-			a[i] = b[i];
-	return a;
+constexpr auto max(const Vec<D, T>& a, const Vec<D, T>& b) {
+	return detail::vecMax(a, b, std::make_index_sequence<D> {});
 }
 
 /// \brief Returns a vector holding the component-wise minimum of the given vectors.
 template<size_t D, typename T>
-constexpr auto min(Vec<D, T> a, const Vec<D, T>& b) {
-	for(auto i = 0u; i < D; ++i)
-		if(b[i] < a[i])
-			a[i] = b[i];
-	return a;
+constexpr auto min(const Vec<D, T>& a, const Vec<D, T>& b) {
+	return detail::vecMin(a, b, std::make_index_sequence<D> {});
 }
 
 /// \brief Returns the component-wise product of the given vectors.
 template<size_t D, typename T1, typename T2>
 constexpr auto multiply(const Vec<D, T1>& a, const Vec<D, T2>& b) {
-	Vec<D, decltype(a[0] * b[0])> ret {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = a[i] * b[i];
-	return ret;
+	return detail::vecMultiply(a, b, std::make_index_sequence<D> {});
 }
 
 /// \brief Returns the component-wise quotient of the given vectors.
 template<size_t D, typename T1, typename T2>
 constexpr auto divide(const Vec<D, T1>& a, const Vec<D, T2>& b) {
-	Vec<D, decltype(a[0] / b[0])> ret {};
-	for(auto i = 0u; i < D; ++i)
-		ret[i] = a[i] / b[i];
-	return ret;
+	return detail::vecDivide(a, b, std::make_index_sequence<D> {});
 }
 
 namespace operators {
 
 template<size_t D, typename T1, typename T2>
 constexpr Vec<D, T1>& operator*=(Vec<D, T1>& a, const Vec<D, T2>& b) noexcept {
-	for(size_t i = 0; i < D; ++i)
-		a[i] *= b[i];
+	detail::vecMultiplyAssign(a, b, std::make_index_sequence<D> {});
 	return a;
 }
 
 template<size_t D, typename T1, typename T2>
 constexpr Vec<D, T1>& operator/=(Vec<D, T1>& a, const Vec<D, T2>& b) noexcept {
-	for(size_t i = 0; i < D; ++i)
-		a[i] /= b[i];
+	detail::vecDivideAssign(a, b, std::make_index_sequence<D> {});
 	return a;
 }
 